@@ -0,0 +1,289 @@
+#!/usr/bin/env python3
+"""Reports who holds the FreeRTOS heap, from a dump of the heap trace.
+
+The dump is the output of HEAPTRACE_Dump() (see lib/include/aws_heap_trace.h)
+captured from the device log. The last dump found in the log is reported:
+
+* the bytes in use per task and per call site, with the most each of them
+  held at once during the trace,
+* the free ranges the trace saw, which is how fragmented the heap is.
+
+Call sites are printed as addresses, or as functions and source lines when
+the image is given with --elf. Use --tool-prefix for a cross toolchain, e.g.
+--tool-prefix arm-none-eabi-.
+"""
+
+import argparse
+import bisect
+import collections
+import subprocess
+import sys
+
+DUMP_TAG = 'HEAPTRACE,'
+
+
+class Dump(object):
+    def __init__(self):
+        self.recorded = 0
+        self.in_dump = 0
+        self.free_heap = 0
+        self.minimum_ever_free_heap = 0
+        self.reference_address = 0
+        self.task_names = {}
+        self.records = []
+
+
+class Usage(object):
+    """Heap held by a task or a call site."""
+
+    def __init__(self):
+        self.live_bytes = 0
+        self.live_blocks = 0
+        self.peak_bytes = 0
+        self.allocations = 0
+        self.frees = 0
+
+    def allocate(self, size):
+        self.live_bytes += size
+        self.live_blocks += 1
+        self.allocations += 1
+        self.peak_bytes = max(self.peak_bytes, self.live_bytes)
+
+    def free(self, size):
+        self.live_bytes -= size
+        self.live_blocks -= 1
+
+
+def parse_dumps(lines):
+    """Returns the dumps found in the log, in order."""
+    dumps = []
+    dump = None
+    for line in lines:
+        start = line.find(DUMP_TAG)
+        if start < 0:
+            continue
+        fields = line[start + len(DUMP_TAG):].strip().split(',')
+        kind = fields[0]
+        if kind == 'BEGIN':
+            dump = Dump()
+            dump.recorded = int(fields[1])
+            dump.in_dump = int(fields[2])
+            dump.free_heap = int(fields[3])
+            dump.minimum_ever_free_heap = int(fields[4])
+            dump.reference_address = int(fields[5], 16)
+        elif dump is None:
+            continue
+        elif kind == 'TASK':
+            dump.task_names[int(fields[1], 16)] = ','.join(fields[2:])
+        elif kind in ('M', 'F'):
+            dump.records.append((kind == 'F',
+                                 int(fields[1]),
+                                 int(fields[2], 16),
+                                 int(fields[3], 16),
+                                 int(fields[4], 16),
+                                 int(fields[5])))
+        elif kind == 'END':
+            dumps.append(dump)
+            dump = None
+    return dumps
+
+
+def resolve_call_sites(addresses, elf, tool_prefix, reference_address):
+    """Returns a name for every call site, using the symbols of the image."""
+    names = dict((address, '0x%x' % address) for address in addresses)
+    if not elf or not addresses:
+        return names
+
+    # The image may have been relocated when it was loaded, e.g. on a host.
+    symbols = subprocess.check_output([tool_prefix + 'nm', elf]).decode()
+    offset = 0
+    for symbol in symbols.splitlines():
+        fields = symbol.split()
+        if len(fields) == 3 and fields[2] == 'HEAPTRACE_Dump':
+            offset = reference_address - int(fields[0], 16)
+
+    # The return address is after the call, so look up the byte before it.
+    ordered = sorted(addresses)
+    output = subprocess.check_output(
+        [tool_prefix + 'addr2line', '-f', '-C', '-s', '-e', elf] +
+        ['0x%x' % (address - offset - 1) for address in ordered]).decode()
+    lines = output.splitlines()
+    for index, address in enumerate(ordered):
+        function = lines[2 * index]
+        location = lines[2 * index + 1]
+        names[address] = '%s (%s)' % (function, location)
+    return names
+
+
+class Ranges(object):
+    """Disjoint address ranges, adjacent ranges merged."""
+
+    def __init__(self):
+        self.starts = []
+        self.ends = []
+
+    def add(self, start, end):
+        if start >= end:
+            return
+        self.remove(start, end)
+        index = bisect.bisect_left(self.starts, start)
+        if index > 0 and self.ends[index - 1] == start:
+            index -= 1
+            start = self.starts[index]
+            del self.starts[index], self.ends[index]
+        if index < len(self.starts) and self.starts[index] == end:
+            end = self.ends[index]
+            del self.starts[index], self.ends[index]
+        self.starts.insert(index, start)
+        self.ends.insert(index, end)
+
+    def remove(self, start, end):
+        if start >= end:
+            return
+        first = bisect.bisect_right(self.ends, start)
+        last = bisect.bisect_left(self.starts, end)
+        kept = []
+        for index in range(first, last):
+            if self.starts[index] < start:
+                kept.append((self.starts[index], start))
+            if self.ends[index] > end:
+                kept.append((end, self.ends[index]))
+        self.starts[first:last] = [range_[0] for range_ in kept]
+        self.ends[first:last] = [range_[1] for range_ in kept]
+
+    def sizes(self):
+        return [end - start for start, end in zip(self.starts, self.ends)]
+
+
+def replay(dump):
+    """Replays the records, returns the usages, the blocks still in use and the
+    ranges known to be free."""
+    tasks = collections.defaultdict(Usage)
+    call_sites = collections.defaultdict(Usage)
+    live = {}
+    free = Ranges()
+    untracked_frees = 0
+    untracked_bytes = 0
+
+    for is_free, _, task, caller, address, size in dump.records:
+        if is_free:
+            free.add(address, address + size)
+        else:
+            free.remove(address, address + size)
+
+        if not is_free:
+            if address in live:
+                # The free of the previous block at this address was lost.
+                _, old_task, old_caller, old_size = live.pop(address)
+                tasks[old_task].free(old_size)
+                call_sites[old_caller].free(old_size)
+            live[address] = (address, task, caller, size)
+            tasks[task].allocate(size)
+            call_sites[caller].allocate(size)
+        elif address in live:
+            _, owner, owner_caller, owner_size = live.pop(address)
+            tasks[owner].free(owner_size)
+            tasks[task].frees += 1
+            call_sites[owner_caller].free(owner_size)
+        else:
+            # Allocated before the oldest record of the dump.
+            untracked_frees += 1
+            untracked_bytes += size
+
+    return tasks, call_sites, sorted(live.values()), free, untracked_frees, untracked_bytes
+
+
+def print_table(title, header, rows):
+    print(title)
+    widths = [max(len(str(row[column])) for row in [header] + rows)
+              for column in range(len(header))]
+    for row in [header] + rows:
+        cells = [str(row[0]).ljust(widths[0])]
+        cells += [str(cell).rjust(width) for cell, width in zip(row[1:], widths[1:])]
+        print('  ' + '  '.join(cells))
+    print('')
+
+
+def print_fragmentation(blocks, free, dump):
+    """Only the memory freed during the trace is known to be free. The rest
+    of the span of the blocks in use can be blocks allocated before the trace,
+    or the gaps between the regions of heap_5 and heap_6, so it is unknown."""
+    print('Free ranges seen in the trace')
+    holes = free.sizes()
+    hole_bytes = sum(holes)
+    in_use = sum(block[3] for block in blocks)
+    print('  blocks in use          %d, %d bytes' % (len(blocks), in_use))
+    if blocks:
+        span = blocks[-1][0] + blocks[-1][3] - blocks[0][0]
+        known = Ranges()
+        for start, end in zip(free.starts, free.ends):
+            known.add(start, end)
+        for block in blocks:
+            known.add(block[0], block[0] + block[3])
+        known.remove(known.starts[0], blocks[0][0])
+        known.remove(blocks[-1][0] + blocks[-1][3], known.ends[-1])
+        print('  span of the blocks     %d bytes, %d unknown' % (span, span - sum(known.sizes())))
+    print('  free ranges            %d, %d bytes' % (len(holes), hole_bytes))
+    if holes:
+        print('  largest free range     %d bytes' % max(holes))
+        print('  share of the free heap %d per mille' % (hole_bytes * 1000 // max(dump.free_heap, 1)))
+        sizes = collections.Counter(1 << (hole.bit_length() - 1) for hole in holes)
+        for size in sorted(sizes):
+            print('    %8d - %8d bytes  %d' % (size, 2 * size - 1, sizes[size]))
+    print('')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('log', help='log holding the dump, or - for stdin')
+    parser.add_argument('--elf', help='image of the firmware, to name the call sites')
+    parser.add_argument('--tool-prefix', default='', help='prefix of nm and addr2line')
+    parser.add_argument('--top', type=int, default=20, help='number of call sites listed')
+    args = parser.parse_args()
+
+    if args.log == '-':
+        dumps = parse_dumps(sys.stdin)
+    else:
+        with open(args.log, errors='replace') as log:
+            dumps = parse_dumps(log)
+
+    if not dumps:
+        print('No heap trace dump found in %s.' % args.log)
+        return 1
+
+    dump = dumps[-1]
+    tasks, call_sites, blocks, free, untracked_frees, untracked_bytes = replay(dump)
+    names = resolve_call_sites(list(call_sites), args.elf, args.tool_prefix,
+                               dump.reference_address)
+
+    print('Heap trace of %d calls, %d in the dump' % (dump.recorded, dump.in_dump))
+    print('Free heap %d bytes, minimum ever %d bytes' %
+          (dump.free_heap, dump.minimum_ever_free_heap))
+    if dump.recorded > dump.in_dump or untracked_frees:
+        print('The oldest calls are not in the dump: %d frees of %d bytes allocated '
+              'before the first record are not counted.' % (untracked_frees, untracked_bytes))
+    print('')
+
+    rows = []
+    for task, usage in sorted(tasks.items(), key=lambda item: -item[1].live_bytes):
+        name = dump.task_names.get(task, '0x%x' % task if task else '(no task)')
+        rows.append((name, usage.live_bytes, usage.live_blocks, usage.peak_bytes,
+                     usage.allocations, usage.frees))
+    print_table('Heap per task',
+                ('task', 'live_bytes', 'live_blocks', 'peak_bytes', 'allocs', 'frees'), rows)
+
+    rows = []
+    for caller, usage in sorted(call_sites.items(),
+                                key=lambda item: (-item[1].live_bytes, -item[1].peak_bytes))[:args.top]:
+        rows.append((names[caller], usage.live_bytes, usage.live_blocks, usage.peak_bytes,
+                     usage.allocations))
+    print_table('Heap per call site',
+                ('call site', 'live_bytes', 'live_blocks', 'peak_bytes', 'allocs'), rows)
+
+    print_fragmentation(blocks, free, dump)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
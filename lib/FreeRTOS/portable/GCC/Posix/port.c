@@ -0,0 +1,437 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for the Linux/POSIX
+ * simulator.
+ *
+ * Each task executes in its own pthread, but only the thread of the task
+ * selected by the scheduler is ever allowed to run - all the other task
+ * threads are blocked on a semaphore held in their xThreadState structure.
+ * A context switch therefore consists of posting the semaphore of the thread
+ * being switched in, then waiting on the semaphore of the thread being
+ * switched out.
+ *
+ * The tick interrupt is simulated by SIGALRM, generated by a fixed rate
+ * interval timer.  The interval timer re-arms itself from its own expiry
+ * time, so unlike the Windows simulator (which sleeps between ticks) the tick
+ * does not drift as host load varies.  The signal is only ever unmasked in the
+ * thread of the running task, and only then when that task is not within a
+ * critical section, so the tick handler always runs on, and switches away
+ * from, the running task.
+ *----------------------------------------------------------*/
+
+/* Standard includes. */
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define portTICK_SIGNAL					SIGALRM
+#define portNO_CRITICAL_NESTING			( ( UBaseType_t ) 0 )
+#define portUSECS_PER_SEC				( 1000000UL )
+#define portNSECS_PER_SEC				( 1000000000ULL )
+
+/* The host stack size given to each task thread.  The FreeRTOS stack buffer
+only holds the xThreadState structure, the real stack belongs to the thread. */
+#ifndef portTHREAD_STACK_SIZE
+	#define portTHREAD_STACK_SIZE		( 256U * 1024U )
+#endif
+
+/* The POSIX simulator runs each task in a thread.  The context switching is
+managed by the threads, so the task stack does not have to be managed directly,
+although the task stack is still used to hold an xThreadState structure this is
+the only thing it will ever hold.  The structure indirectly maps the task handle
+to a thread handle. */
+typedef struct
+{
+	/* Handle of the thread that executes the task. */
+	pthread_t xThread;
+
+	/* Posted to allow the thread to run. */
+	sem_t xWakeSemaphore;
+
+	/* The task function and its parameter, as passed to xTaskCreate(). */
+	TaskFunction_t pxCode;
+	void *pvParameters;
+
+} xThreadState;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Entry point of every task thread.  Waits to be scheduled for the first time
+ * before calling the task function.
+ */
+static void *prvThreadEntry( void *pvParameters );
+
+/*
+ * Hand the host CPU from the thread of the task that was running to the thread
+ * of the task now referenced by pxCurrentTCB.  Must be called with the tick
+ * signal masked.
+ */
+static void prvSwitchThread( xThreadState *pxOldThread, xThreadState *pxNewThread );
+
+/*
+ * Block the calling thread until its wake semaphore is posted.
+ */
+static void prvSuspendSelf( xThreadState *pxThread );
+
+/*
+ * The simulated tick interrupt handler.
+ */
+static void prvTickSignalHandler( int iSignal );
+
+/*
+ * Mask or unmask the tick signal for the calling thread.
+ */
+static void prvMaskTickSignal( void );
+static void prvUnmaskTickSignal( void );
+
+/*-----------------------------------------------------------*/
+
+/* Pointer to the TCB of the currently executing task. */
+extern void *pxCurrentTCB;
+
+/* The critical nesting count of the calling thread.  Each task has its own
+thread, so this is effectively held per task and is preserved across context
+switches.  Initialised to a non-zero value so the thread that calls
+vTaskStartScheduler() never unmasks the tick signal. */
+static __thread UBaseType_t uxCriticalNesting = 9999UL;
+
+/* Used to ensure nothing is processed during the startup sequence. */
+static volatile BaseType_t xPortRunning = pdFALSE;
+
+/* Posted by vPortEndScheduler() to return from xPortStartScheduler(). */
+static sem_t xSchedulerEndSemaphore;
+
+/* The set containing just the tick signal. */
+static sigset_t xTickSignalSet;
+
+/*-----------------------------------------------------------*/
+
+static xThreadState *prvGetThreadState( void *pvTCB )
+{
+	/* The first member of the TCB is the top of stack, which points to the
+	xThreadState structure. */
+	return ( xThreadState * ) *( ( size_t * ) pvTCB );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMaskTickSignal( void )
+{
+	( void ) pthread_sigmask( SIG_BLOCK, &xTickSignalSet, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvUnmaskTickSignal( void )
+{
+	( void ) pthread_sigmask( SIG_UNBLOCK, &xTickSignalSet, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSuspendSelf( xThreadState *pxThread )
+{
+	/* sem_wait() is also the cancellation point at which a deleted task's
+	thread is terminated by vPortCancelThread(). */
+	while( sem_wait( &( pxThread->xWakeSemaphore ) ) != 0 )
+	{
+		configASSERT( errno == EINTR );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchThread( xThreadState *pxOldThread, xThreadState *pxNewThread )
+{
+	if( pxOldThread != pxNewThread )
+	{
+		( void ) sem_post( &( pxNewThread->xWakeSemaphore ) );
+		prvSuspendSelf( pxOldThread );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void *prvThreadEntry( void *pvParameters )
+{
+xThreadState *pxThreadState = ( xThreadState * ) pvParameters;
+
+	/* The thread was created with all signals masked.  Wait until the
+	scheduler selects this task for the first time. */
+	prvSuspendSelf( pxThreadState );
+
+	/* Tasks start with interrupts enabled. */
+	uxCriticalNesting = portNO_CRITICAL_NESTING;
+	prvUnmaskTickSignal();
+
+	pxThreadState->pxCode( pxThreadState->pvParameters );
+
+	/* Tasks must not return from their implementing function. */
+	configASSERT( pdFALSE );
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+xThreadState *pxThreadState = NULL;
+int8_t *pcTopOfStack = ( int8_t * ) pxTopOfStack;
+pthread_attr_t xThreadAttributes;
+sigset_t xAllSignals, xOldSignals;
+int iResult;
+
+	/* In this simulated case a stack is not initialised, but instead a thread
+	is created that will execute the task being created.  The thread handles
+	the context switching itself.  The xThreadState object is placed onto
+	the stack that was created for the task - so the stack buffer is still
+	used, just not in the conventional way.  It will not be used for anything
+	other than holding this structure. */
+	pcTopOfStack -= sizeof( xThreadState );
+	pcTopOfStack = ( int8_t * ) ( ( ( portPOINTER_SIZE_TYPE ) pcTopOfStack ) & ( ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) ) );
+	pxThreadState = ( xThreadState * ) pcTopOfStack;
+
+	pxThreadState->pxCode = pxCode;
+	pxThreadState->pvParameters = pvParameters;
+	iResult = sem_init( &( pxThreadState->xWakeSemaphore ), 0, 0 );
+	configASSERT( iResult == 0 );
+
+	( void ) pthread_attr_init( &xThreadAttributes );
+	( void ) pthread_attr_setstacksize( &xThreadAttributes, portTHREAD_STACK_SIZE );
+
+	/* The new thread inherits the signal mask of the creating thread, so mask
+	everything while it is created.  The tick signal is unmasked again when the
+	task first runs. */
+	sigfillset( &xAllSignals );
+	( void ) pthread_sigmask( SIG_SETMASK, &xAllSignals, &xOldSignals );
+	iResult = pthread_create( &( pxThreadState->xThread ), &xThreadAttributes, prvThreadEntry, pxThreadState );
+	( void ) pthread_sigmask( SIG_SETMASK, &xOldSignals, NULL );
+	( void ) pthread_attr_destroy( &xThreadAttributes );
+
+	configASSERT( iResult == 0 );
+	( void ) iResult;
+
+	return ( StackType_t * ) pxThreadState;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+struct sigaction xTickAction;
+struct itimerval xTimerValue;
+xThreadState *pxThreadState;
+
+	/* The calling thread never runs a task, so keep the tick signal masked in
+	it for as long as the scheduler is running. */
+	sigemptyset( &xTickSignalSet );
+	sigaddset( &xTickSignalSet, portTICK_SIGNAL );
+	prvMaskTickSignal();
+
+	( void ) sem_init( &xSchedulerEndSemaphore, 0, 0 );
+
+	/* Install the tick handler.  The tick signal is masked while the handler
+	executes, which is equivalent to the tick interrupt not nesting. */
+	memset( &xTickAction, 0x00, sizeof( xTickAction ) );
+	xTickAction.sa_handler = prvTickSignalHandler;
+	xTickAction.sa_flags = SA_RESTART;
+	sigfillset( &( xTickAction.sa_mask ) );
+
+	if( sigaction( portTICK_SIGNAL, &xTickAction, NULL ) != 0 )
+	{
+		printf( "Failed to install the tick signal handler.\r\n" );
+		return pdFAIL;
+	}
+
+	/* Start the interval timer that generates the tick. */
+	xTimerValue.it_interval.tv_sec = 0;
+	xTimerValue.it_interval.tv_usec = portUSECS_PER_SEC / configTICK_RATE_HZ;
+	xTimerValue.it_value = xTimerValue.it_interval;
+
+	if( setitimer( ITIMER_REAL, &xTimerValue, NULL ) != 0 )
+	{
+		printf( "Failed to start the tick timer.\r\n" );
+		return pdFAIL;
+	}
+
+	xPortRunning = pdTRUE;
+
+	/* Start the highest priority task by obtaining its associated thread
+	state structure, in which is stored the wake semaphore. */
+	pxThreadState = prvGetThreadState( pxCurrentTCB );
+	( void ) sem_post( &( pxThreadState->xWakeSemaphore ) );
+
+	/* Wait here until vPortEndScheduler() is called. */
+	while( sem_wait( &xSchedulerEndSemaphore ) != 0 )
+	{
+		configASSERT( errno == EINTR );
+	}
+
+	/* Stop the tick. */
+	memset( &xTimerValue, 0x00, sizeof( xTimerValue ) );
+	( void ) setitimer( ITIMER_REAL, &xTimerValue, NULL );
+
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+xThreadState *pxThreadState;
+
+	prvMaskTickSignal();
+	xPortRunning = pdFALSE;
+
+	/* Let xPortStartScheduler() return to the thread that started the
+	scheduler, then park the calling task's thread for good.  The application
+	is expected to exit the process once vTaskStartScheduler() returns. */
+	pxThreadState = prvGetThreadState( pxCurrentTCB );
+	( void ) sem_post( &xSchedulerEndSemaphore );
+	prvSuspendSelf( pxThreadState );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTickSignalHandler( int iSignal )
+{
+xThreadState *pxOldThread;
+
+	( void ) iSignal;
+
+	if( xPortRunning == pdTRUE )
+	{
+		/* Only the running task's thread accepts the tick signal, and only
+		when it is outside of a critical section. */
+		configASSERT( uxCriticalNesting == portNO_CRITICAL_NESTING );
+
+		if( xTaskIncrementTick() != pdFALSE )
+		{
+			pxOldThread = prvGetThreadState( pxCurrentTCB );
+
+			/* Select the next task to run. */
+			vTaskSwitchContext();
+
+			/* The signal remains masked until this thread is switched back
+			in and the handler returns. */
+			prvSwitchThread( pxOldThread, prvGetThreadState( pxCurrentTCB ) );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+sigset_t xOldSignals;
+xThreadState *pxOldThread;
+
+	/* Mask the tick for the duration of the switch, remembering whether it
+	was masked on entry as portYIELD() can be called from within a critical
+	section. */
+	( void ) pthread_sigmask( SIG_BLOCK, &xTickSignalSet, &xOldSignals );
+
+	pxOldThread = prvGetThreadState( pxCurrentTCB );
+
+	/* Select the next task to run. */
+	vTaskSwitchContext();
+
+	prvSwitchThread( pxOldThread, prvGetThreadState( pxCurrentTCB ) );
+
+	/* Switched back in - restore the signal mask of this task. */
+	( void ) pthread_sigmask( SIG_SETMASK, &xOldSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortCancelThread( void *pvTaskToDelete )
+{
+xThreadState *pxThreadState;
+
+	/* Find the thread of the task being deleted.  Only the running task
+	executes, so that thread is blocked in prvSuspendSelf(), which is a
+	cancellation point. */
+	pxThreadState = prvGetThreadState( pvTaskToDelete );
+
+	( void ) pthread_cancel( pxThreadState->xThread );
+	( void ) pthread_join( pxThreadState->xThread, NULL );
+	( void ) sem_destroy( &( pxThreadState->xWakeSemaphore ) );
+}
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	prvMaskTickSignal();
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	prvUnmaskTickSignal();
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	/* The tick signal is masked for the entire critical section, effectively
+	disabling (simulated) interrupts. */
+	if( xPortRunning == pdTRUE )
+	{
+		prvMaskTickSignal();
+	}
+
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	if( uxCriticalNesting > portNO_CRITICAL_NESTING )
+	{
+		uxCriticalNesting--;
+
+		/* Any tick that became pending while the signal was masked is
+		delivered as soon as it is unmasked. */
+		if( ( uxCriticalNesting == portNO_CRITICAL_NESTING ) && ( xPortRunning == pdTRUE ) )
+		{
+			prvUnmaskTickSignal();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullPortGetMonotonicTimeNs( void )
+{
+struct timespec xNow;
+
+	( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+	return ( ( uint64_t ) xNow.tv_sec * portNSECS_PER_SEC ) + ( uint64_t ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
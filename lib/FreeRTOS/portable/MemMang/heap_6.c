@@ -0,0 +1,716 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * A sample implementation of pvPortMalloc() and vPortFree() that takes a
+ * constant time whatever the state of the heap.  Like heap_5.c, the heap can
+ * be defined across multiple non-contiguous regions, and adjacent free blocks
+ * are combined (coalesced) as they are freed.
+ *
+ * See heap_1.c, heap_2.c, heap_3.c, heap_4.c and heap_5.c for alternative
+ * implementations, and the memory management pages of http://www.FreeRTOS.org
+ * for more information.
+ *
+ * The free blocks are kept in segregated lists (two level segregated fit, or
+ * TLSF).  The first level splits the block sizes into powers of two, and the
+ * second level splits each power of two into heapSL_INDEX_COUNT lists of
+ * equal width.  A bitmap of the non-empty lists is kept for each level, so
+ * finding a free block large enough for a request, and taking it out of its
+ * list, is a couple of bit scans whatever the number of free blocks.  Each
+ * block records the block just below it in memory, so a block being freed is
+ * combined with its neighbours without walking any list.
+ *
+ * heap_4.c and heap_5.c walk the free list from the lowest address until a
+ * block is large enough (first fit), so the time pvPortMalloc() takes grows
+ * with the number of free blocks.  This implementation takes a block from the
+ * smallest list whose blocks are all large enough (good fit), and uses two
+ * more pointers per block than heap_5.c.
+ *
+ * uxPortGetHeapClassStats() reports the free blocks and the allocations of
+ * each first level size class.
+ *
+ * Usage notes:
+ *
+ * vPortDefineHeapRegions() ***must*** be called before pvPortMalloc(), as
+ * with heap_5.c - see heap_5.c for how to define the regions.  The regions do
+ * not need to be in address order.  Each region must be smaller than
+ * 2 ^ configHEAP_MAX_BLOCK_SIZE_LOG2 bytes.
+ *
+ * configHEAP_MAX_BLOCK_SIZE_LOG2 can be defined in FreeRTOSConfig.h to set
+ * the size of the largest block, and so the number of first level lists.  It
+ * defaults to 24 (16 MB).
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+#ifndef configHEAP_MAX_BLOCK_SIZE_LOG2
+	#define configHEAP_MAX_BLOCK_SIZE_LOG2	24
+#endif
+
+/* Block sizes are multiples of portBYTE_ALIGNMENT. */
+#if( portBYTE_ALIGNMENT == 32 )
+	#define heapALIGNMENT_LOG2	5
+#elif( portBYTE_ALIGNMENT == 16 )
+	#define heapALIGNMENT_LOG2	4
+#elif( portBYTE_ALIGNMENT == 8 )
+	#define heapALIGNMENT_LOG2	3
+#elif( portBYTE_ALIGNMENT == 4 )
+	#define heapALIGNMENT_LOG2	2
+#elif( portBYTE_ALIGNMENT == 2 )
+	#define heapALIGNMENT_LOG2	1
+#else
+	#define heapALIGNMENT_LOG2	0
+#endif
+
+/* Number of second level lists per power of two. */
+#define heapSL_INDEX_COUNT_LOG2		3
+#define heapSL_INDEX_COUNT			( 1U << heapSL_INDEX_COUNT_LOG2 )
+
+/* Blocks smaller than heapSMALL_BLOCK_SIZE all belong to the first class,
+whose second level lists are portBYTE_ALIGNMENT bytes apart.  Each larger
+power of two has a class of its own. */
+#define heapFL_INDEX_SHIFT			( heapSL_INDEX_COUNT_LOG2 + heapALIGNMENT_LOG2 )
+#define heapSMALL_BLOCK_SIZE		( ( size_t ) 1 << heapFL_INDEX_SHIFT )
+#define heapFL_INDEX_COUNT			( configHEAP_MAX_BLOCK_SIZE_LOG2 - heapFL_INDEX_SHIFT + 1 )
+#define heapMAXIMUM_BLOCK_SIZE		( ( ( size_t ) 1 << configHEAP_MAX_BLOCK_SIZE_LOG2 ) - portBYTE_ALIGNMENT )
+
+#if( heapFL_INDEX_COUNT > 31 )
+	#error configHEAP_MAX_BLOCK_SIZE_LOG2 is too large for the first level bitmap
+#endif
+
+/* Assumes 8bit bytes! */
+#define heapBITS_PER_BYTE		( ( size_t ) 8 )
+
+/* The header of every block.  Only the first two members are kept while the
+block is allocated, the free list links overlap the start of the memory
+returned to the application. */
+typedef struct A_BLOCK_HEADER
+{
+	struct A_BLOCK_HEADER *pxPreviousPhysicalBlock;	/*<< The block just below this one in its region, or NULL for the first block of a region. */
+	size_t xBlockSize;								/*<< The size of the block, header included. */
+	struct A_BLOCK_HEADER *pxNextFreeBlock;			/*<< The next block in the same free list. */
+	struct A_BLOCK_HEADER *pxPreviousFreeBlock;		/*<< The previous block in the same free list. */
+} BlockHeader_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Returns the index of the highest or of the lowest bit set in a non-zero
+ * value.
+ */
+static UBaseType_t prvHighestBitSet( size_t xValue );
+static UBaseType_t prvLowestBitSet( uint32_t ulValue );
+
+/*
+ * Returns the lists that a free block of xBlockSize bytes belongs to.
+ */
+static void prvMapBlockSize( size_t xBlockSize, UBaseType_t *puxFirstLevel, UBaseType_t *puxSecondLevel );
+
+/*
+ * Returns the first free block of the smallest non-empty list whose blocks
+ * are all at least xBlockSize bytes, or NULL if there is none.
+ */
+static BlockHeader_t *prvFindFreeBlock( size_t xBlockSize );
+
+/*
+ * Adds a free block to its list, or takes it out.
+ */
+static void prvInsertFreeBlock( BlockHeader_t *pxBlock );
+static void prvRemoveFreeBlock( BlockHeader_t *pxBlock );
+
+/*
+ * Returns the block just above pxBlock in its region.
+ */
+static BlockHeader_t *prvNextPhysicalBlock( const BlockHeader_t *pxBlock );
+
+/*-----------------------------------------------------------*/
+
+/* The size of the part of the header kept while a block is allocated, and of
+the whole header.  Both are multiples of portBYTE_ALIGNMENT. */
+static const size_t xHeapStructSize	= ( offsetof( BlockHeader_t, pxNextFreeBlock ) + ( ( size_t ) ( portBYTE_ALIGNMENT - 1 ) ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+static const size_t xMinimumBlockSize = ( sizeof( BlockHeader_t ) + ( ( size_t ) ( portBYTE_ALIGNMENT - 1 ) ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+/* The free lists, and the bitmaps of the non-empty ones.  Bit n of
+ulFirstLevelBitmap is set if any of the lists of class n is non-empty, and
+bit m of ulSecondLevelBitmaps[ n ] if list m of class n is non-empty. */
+static BlockHeader_t *pxFreeLists[ heapFL_INDEX_COUNT ][ heapSL_INDEX_COUNT ];
+static uint32_t ulFirstLevelBitmap = 0U;
+static uint32_t ulSecondLevelBitmaps[ heapFL_INDEX_COUNT ];
+
+/* The statistics of each first level class. */
+static HeapClassStats_t xClassStats[ heapFL_INDEX_COUNT ];
+
+/* Keeps track of the number of free bytes remaining, but says nothing about
+fragmentation. */
+static size_t xFreeBytesRemaining = 0U;
+static size_t xMinimumEverFreeBytesRemaining = 0U;
+
+/* Gets set to the top bit of an size_t type.  When this bit in the xBlockSize
+member of an BlockHeader_t structure is set then the block belongs to the
+application.  When the bit is free the block is still part of the free heap
+space. */
+static size_t xBlockAllocatedBit = 0;
+
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+BlockHeader_t *pxBlock, *pxNewBlock, *pxNextBlock;
+void *pvReturn = NULL;
+UBaseType_t uxFirstLevel, uxSecondLevel;
+
+	/* The heap must be initialised before the first call to
+	prvPortMalloc(). */
+	configASSERT( xBlockAllocatedBit );
+
+	vTaskSuspendAll();
+	{
+		/* Requests larger than the largest block would overflow the size
+		calculations below. */
+		if( ( xWantedSize > 0 ) && ( xWantedSize <= ( heapMAXIMUM_BLOCK_SIZE - xHeapStructSize ) ) )
+		{
+			/* The wanted size is increased so it can contain the block
+			header in addition to the requested amount of bytes, and so that
+			the block can hold the free list links once it is freed. */
+			xWantedSize += xHeapStructSize;
+
+			/* Ensure that blocks are always aligned to the required number
+			of bytes. */
+			if( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) != 0x00 )
+			{
+				xWantedSize += ( portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK ) );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			if( xWantedSize < xMinimumBlockSize )
+			{
+				xWantedSize = xMinimumBlockSize;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxBlock = prvFindFreeBlock( xWantedSize );
+
+			if( pxBlock != NULL )
+			{
+				prvRemoveFreeBlock( pxBlock );
+
+				/* If the block is larger than required it can be split into
+				two.  The blocks around a free block are never free, so the
+				remainder does not need to be combined with anything. */
+				if( ( pxBlock->xBlockSize - xWantedSize ) >= xMinimumBlockSize )
+				{
+					/* The void cast is used to prevent byte alignment
+					warnings from the compiler. */
+					pxNewBlock = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xWantedSize );
+					pxNewBlock->xBlockSize = pxBlock->xBlockSize - xWantedSize;
+					pxNewBlock->pxPreviousPhysicalBlock = pxBlock;
+					pxBlock->xBlockSize = xWantedSize;
+
+					pxNextBlock = prvNextPhysicalBlock( pxNewBlock );
+					pxNextBlock->pxPreviousPhysicalBlock = pxNewBlock;
+
+					prvInsertFreeBlock( pxNewBlock );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				xFreeBytesRemaining -= pxBlock->xBlockSize;
+
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				prvMapBlockSize( pxBlock->xBlockSize, &uxFirstLevel, &uxSecondLevel );
+				xClassStats[ uxFirstLevel ].xAllocations++;
+
+				/* The block is being returned - it is allocated and owned by
+				the application. */
+				pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xHeapStructSize );
+				pxBlock->xBlockSize |= xBlockAllocatedBit;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		traceMALLOC( pvReturn, xWantedSize );
+	}
+	( void ) xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+uint8_t *puc = ( uint8_t * ) pv;
+BlockHeader_t *pxBlock, *pxNeighbour;
+
+	if( pv != NULL )
+	{
+		/* The memory being freed will have a block header immediately before
+		it. */
+		puc -= xHeapStructSize;
+
+		/* This casting is to keep the compiler from issuing warnings. */
+		pxBlock = ( void * ) puc;
+
+		/* Check the block is actually allocated. */
+		configASSERT( ( pxBlock->xBlockSize & xBlockAllocatedBit ) != 0 );
+
+		if( ( pxBlock->xBlockSize & xBlockAllocatedBit ) != 0 )
+		{
+			vTaskSuspendAll();
+			{
+				/* The block is being returned to the heap - it is no longer
+				allocated.  Unlike heap_4.c, this must not be done before the
+				scheduler is suspended, as another task freeing the block next
+				to this one would combine the two while this block is not in
+				a free list. */
+				pxBlock->xBlockSize &= ~xBlockAllocatedBit;
+				xFreeBytesRemaining += pxBlock->xBlockSize;
+				traceFREE( pv, pxBlock->xBlockSize );
+
+				/* Combine the block with the block below it if that one is
+				free. */
+				pxNeighbour = pxBlock->pxPreviousPhysicalBlock;
+				if( ( pxNeighbour != NULL ) && ( ( pxNeighbour->xBlockSize & xBlockAllocatedBit ) == 0 ) )
+				{
+					prvRemoveFreeBlock( pxNeighbour );
+					pxNeighbour->xBlockSize += pxBlock->xBlockSize;
+					pxBlock = pxNeighbour;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				/* Combine the block with the block above it if that one is
+				free.  The end marker of the region is never free. */
+				pxNeighbour = prvNextPhysicalBlock( pxBlock );
+				if( ( pxNeighbour->xBlockSize & xBlockAllocatedBit ) == 0 )
+				{
+					prvRemoveFreeBlock( pxNeighbour );
+					pxBlock->xBlockSize += pxNeighbour->xBlockSize;
+					pxNeighbour = prvNextPhysicalBlock( pxBlock );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				pxNeighbour->pxPreviousPhysicalBlock = pxBlock;
+				prvInsertFreeBlock( pxBlock );
+			}
+			( void ) xTaskResumeAll();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortGetHeapClassStats( HeapClassStats_t *pxStats, UBaseType_t uxMaxClasses )
+{
+UBaseType_t uxClass;
+
+	if( uxMaxClasses > ( UBaseType_t ) heapFL_INDEX_COUNT )
+	{
+		uxMaxClasses = ( UBaseType_t ) heapFL_INDEX_COUNT;
+	}
+
+	vTaskSuspendAll();
+	{
+		for( uxClass = 0; uxClass < uxMaxClasses; uxClass++ )
+		{
+			pxStats[ uxClass ] = xClassStats[ uxClass ];
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	return uxMaxClasses;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvHighestBitSet( size_t xValue )
+{
+UBaseType_t uxBit;
+
+	#if defined( __GNUC__ )
+	{
+		uxBit = ( UBaseType_t ) ( ( sizeof( unsigned long ) * heapBITS_PER_BYTE ) - 1U - ( size_t ) __builtin_clzl( ( unsigned long ) xValue ) );
+	}
+	#else
+	{
+		uxBit = 0;
+
+		while( ( xValue >> uxBit ) > ( size_t ) 1 )
+		{
+			uxBit++;
+		}
+	}
+	#endif
+
+	return uxBit;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvLowestBitSet( uint32_t ulValue )
+{
+UBaseType_t uxBit;
+
+	#if defined( __GNUC__ )
+	{
+		uxBit = ( UBaseType_t ) __builtin_ctz( ulValue );
+	}
+	#else
+	{
+		uxBit = 0;
+
+		while( ( ulValue & ( ( uint32_t ) 1 << uxBit ) ) == 0U )
+		{
+			uxBit++;
+		}
+	}
+	#endif
+
+	return uxBit;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMapBlockSize( size_t xBlockSize, UBaseType_t *puxFirstLevel, UBaseType_t *puxSecondLevel )
+{
+UBaseType_t uxHighestBit;
+
+	if( xBlockSize < heapSMALL_BLOCK_SIZE )
+	{
+		*puxFirstLevel = 0;
+		*puxSecondLevel = ( UBaseType_t ) ( xBlockSize >> heapALIGNMENT_LOG2 );
+	}
+	else
+	{
+		uxHighestBit = prvHighestBitSet( xBlockSize );
+		*puxFirstLevel = uxHighestBit - ( heapFL_INDEX_SHIFT - 1U );
+		*puxSecondLevel = ( UBaseType_t ) ( ( xBlockSize >> ( uxHighestBit - heapSL_INDEX_COUNT_LOG2 ) ) ^ heapSL_INDEX_COUNT );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BlockHeader_t *prvFindFreeBlock( size_t xBlockSize )
+{
+BlockHeader_t *pxBlock = NULL;
+UBaseType_t uxFirstLevel, uxSecondLevel;
+uint32_t ulBitmap;
+
+	/* Round the size up to the next list, so that every block of the list
+	found is large enough. */
+	if( xBlockSize >= heapSMALL_BLOCK_SIZE )
+	{
+		xBlockSize += ( ( size_t ) 1 << ( prvHighestBitSet( xBlockSize ) - heapSL_INDEX_COUNT_LOG2 ) ) - 1U;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	prvMapBlockSize( xBlockSize, &uxFirstLevel, &uxSecondLevel );
+
+	if( uxFirstLevel < ( UBaseType_t ) heapFL_INDEX_COUNT )
+	{
+		/* A list of the same class, starting with the one the size maps
+		to. */
+		ulBitmap = ulSecondLevelBitmaps[ uxFirstLevel ] & ( ~( uint32_t ) 0 << uxSecondLevel );
+
+		if( ulBitmap == 0U )
+		{
+			/* Otherwise the first list of the next non-empty class. */
+			ulBitmap = ulFirstLevelBitmap & ( ~( uint32_t ) 0 << ( uxFirstLevel + 1U ) );
+
+			if( ulBitmap != 0U )
+			{
+				uxFirstLevel = prvLowestBitSet( ulBitmap );
+				ulBitmap = ulSecondLevelBitmaps[ uxFirstLevel ];
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( ulBitmap != 0U )
+		{
+			uxSecondLevel = prvLowestBitSet( ulBitmap );
+			pxBlock = pxFreeLists[ uxFirstLevel ][ uxSecondLevel ];
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( BlockHeader_t *pxBlock )
+{
+UBaseType_t uxFirstLevel, uxSecondLevel;
+
+	prvMapBlockSize( pxBlock->xBlockSize, &uxFirstLevel, &uxSecondLevel );
+
+	pxBlock->pxPreviousFreeBlock = NULL;
+	pxBlock->pxNextFreeBlock = pxFreeLists[ uxFirstLevel ][ uxSecondLevel ];
+
+	if( pxBlock->pxNextFreeBlock != NULL )
+	{
+		pxBlock->pxNextFreeBlock->pxPreviousFreeBlock = pxBlock;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	pxFreeLists[ uxFirstLevel ][ uxSecondLevel ] = pxBlock;
+	ulFirstLevelBitmap |= ( uint32_t ) 1 << uxFirstLevel;
+	ulSecondLevelBitmaps[ uxFirstLevel ] |= ( uint32_t ) 1 << uxSecondLevel;
+
+	xClassStats[ uxFirstLevel ].xFreeBlocks++;
+	xClassStats[ uxFirstLevel ].xFreeBytes += pxBlock->xBlockSize;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( BlockHeader_t *pxBlock )
+{
+UBaseType_t uxFirstLevel, uxSecondLevel;
+
+	prvMapBlockSize( pxBlock->xBlockSize, &uxFirstLevel, &uxSecondLevel );
+
+	if( pxBlock->pxNextFreeBlock != NULL )
+	{
+		pxBlock->pxNextFreeBlock->pxPreviousFreeBlock = pxBlock->pxPreviousFreeBlock;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	if( pxBlock->pxPreviousFreeBlock != NULL )
+	{
+		pxBlock->pxPreviousFreeBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+	}
+	else
+	{
+		/* The block was the first of its list. */
+		pxFreeLists[ uxFirstLevel ][ uxSecondLevel ] = pxBlock->pxNextFreeBlock;
+
+		if( pxBlock->pxNextFreeBlock == NULL )
+		{
+			ulSecondLevelBitmaps[ uxFirstLevel ] &= ~( ( uint32_t ) 1 << uxSecondLevel );
+
+			if( ulSecondLevelBitmaps[ uxFirstLevel ] == 0U )
+			{
+				ulFirstLevelBitmap &= ~( ( uint32_t ) 1 << uxFirstLevel );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+	xClassStats[ uxFirstLevel ].xFreeBlocks--;
+	xClassStats[ uxFirstLevel ].xFreeBytes -= pxBlock->xBlockSize;
+}
+/*-----------------------------------------------------------*/
+
+static BlockHeader_t *prvNextPhysicalBlock( const BlockHeader_t *pxBlock )
+{
+	/* The void cast is used to prevent byte alignment warnings from the
+	compiler. */
+	return ( void * ) ( ( ( uint8_t * ) pxBlock ) + ( pxBlock->xBlockSize & ~xBlockAllocatedBit ) );
+}
+/*-----------------------------------------------------------*/
+
+void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions )
+{
+BlockHeader_t *pxFirstBlockInRegion, *pxEnd;
+size_t xTotalRegionSize, xTotalHeapSize = 0;
+BaseType_t xDefinedRegions = 0;
+size_t xAddress, xAlignedHeap;
+const HeapRegion_t *pxHeapRegion;
+UBaseType_t uxClass;
+
+	/* Can only call once! */
+	configASSERT( xBlockAllocatedBit == 0 );
+
+	/* Work out the position of the top bit in a size_t variable. */
+	xBlockAllocatedBit = ( ( size_t ) 1 ) << ( ( sizeof( size_t ) * heapBITS_PER_BYTE ) - 1 );
+
+	for( uxClass = 0; uxClass < ( UBaseType_t ) heapFL_INDEX_COUNT; uxClass++ )
+	{
+		if( uxClass == 0 )
+		{
+			xClassStats[ uxClass ].xMinimumBlockSize = 0;
+		}
+		else
+		{
+			xClassStats[ uxClass ].xMinimumBlockSize = ( size_t ) 1 << ( uxClass + heapFL_INDEX_SHIFT - 1U );
+		}
+	}
+
+	pxHeapRegion = &( pxHeapRegions[ xDefinedRegions ] );
+
+	while( pxHeapRegion->xSizeInBytes > 0 )
+	{
+		xTotalRegionSize = pxHeapRegion->xSizeInBytes;
+
+		/* Ensure the heap region starts on a correctly aligned boundary. */
+		xAddress = ( size_t ) pxHeapRegion->pucStartAddress;
+		if( ( xAddress & portBYTE_ALIGNMENT_MASK ) != 0 )
+		{
+			xAddress += ( portBYTE_ALIGNMENT - 1 );
+			xAddress &= ~portBYTE_ALIGNMENT_MASK;
+
+			/* Adjust the size for the bytes lost to alignment. */
+			xTotalRegionSize -= xAddress - ( size_t ) pxHeapRegion->pucStartAddress;
+		}
+
+		xAlignedHeap = xAddress;
+
+		/* pxEnd marks the end of the region.  It is a block that is always
+		allocated, so the last block of the region is never combined with
+		anything above it. */
+		xAddress = xAlignedHeap + xTotalRegionSize;
+		xAddress -= xHeapStructSize;
+		xAddress &= ~portBYTE_ALIGNMENT_MASK;
+		pxEnd = ( BlockHeader_t * ) xAddress;
+
+		/* To start with there is a single free block in this region that is
+		sized to take up the entire heap region minus the space taken by the
+		end marker. */
+		pxFirstBlockInRegion = ( BlockHeader_t * ) xAlignedHeap;
+		pxFirstBlockInRegion->pxPreviousPhysicalBlock = NULL;
+		pxFirstBlockInRegion->xBlockSize = xAddress - xAlignedHeap;
+
+		/* The block must fit in the first level lists. */
+		configASSERT( pxFirstBlockInRegion->xBlockSize >= xMinimumBlockSize );
+		configASSERT( pxFirstBlockInRegion->xBlockSize <= heapMAXIMUM_BLOCK_SIZE );
+
+		pxEnd->pxPreviousPhysicalBlock = pxFirstBlockInRegion;
+		pxEnd->xBlockSize = xBlockAllocatedBit;
+
+		prvInsertFreeBlock( pxFirstBlockInRegion );
+		xTotalHeapSize += pxFirstBlockInRegion->xBlockSize;
+
+		/* Move onto the next HeapRegion_t structure. */
+		xDefinedRegions++;
+		pxHeapRegion = &( pxHeapRegions[ xDefinedRegions ] );
+	}
+
+	xMinimumEverFreeBytesRemaining = xTotalHeapSize;
+	xFreeBytesRemaining = xTotalHeapSize;
+
+	/* Check something was actually defined before it is accessed. */
+	configASSERT( xTotalHeapSize );
+}
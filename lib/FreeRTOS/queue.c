@@ -128,6 +128,61 @@ typedef xQUEUE Queue_t;
 
 /*-----------------------------------------------------------*/
 
+/*
+ * Queues created dynamically can be taken from pools of fixed size blocks
+ * rather than from the heap.  A block is a Queue_t followed by a storage area
+ * of the size the pool was configured with: none for the semaphore pool, and
+ * configQUEUE_POOL_STORAGE_SIZE bytes for the queue pool.  Taking and
+ * returning a block is O(1), and blocks returned to a pool are only reused by
+ * that pool, so creating and deleting semaphores and small queues does not
+ * fragment the heap.  A queue that does not fit, or that is created when its
+ * pools are empty, is allocated from the heap.
+ */
+#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( ( configSEMAPHORE_POOL_LENGTH > 0 ) || ( configQUEUE_POOL_LENGTH > 0 ) ) )
+
+	typedef struct QueuePool
+	{
+		void *pvFreeBlocks;				/*< Blocks returned to the pool, linked through their first bytes. */
+		uint8_t *pucNextUnused;			/*< The first block that was never taken, so the pool needs no initialisation. */
+		uint8_t * const pucStart;		/*< The first block of the pool. */
+		uint8_t * const pucEnd;			/*< The byte after the last block of the pool. */
+		const size_t xBlockSize;		/*< The size of a block, Queue_t included. */
+		const size_t xStorageSize;		/*< The largest storage area a block holds. */
+	} QueuePool_t;
+
+	#if( configSEMAPHORE_POOL_LENGTH > 0 )
+		PRIVILEGED_DATA static Queue_t xSemaphorePoolBlocks[ configSEMAPHORE_POOL_LENGTH ];
+	#endif
+
+	#if( configQUEUE_POOL_LENGTH > 0 )
+		/* The storage area follows the Queue_t without padding, as the storage
+		area of a queue allocated from the heap does. */
+		typedef struct QueuePoolBlock
+		{
+			Queue_t xQueue;
+			uint8_t ucStorage[ configQUEUE_POOL_STORAGE_SIZE ];
+		} QueuePoolBlock_t;
+
+		PRIVILEGED_DATA static QueuePoolBlock_t xQueuePoolBlocks[ configQUEUE_POOL_LENGTH ];
+	#endif
+
+	/* In the order they are tried, smallest storage area first. */
+	PRIVILEGED_DATA static QueuePool_t xQueuePools[] =
+	{
+		#if( configSEMAPHORE_POOL_LENGTH > 0 )
+			{ NULL, ( uint8_t * ) xSemaphorePoolBlocks, ( uint8_t * ) xSemaphorePoolBlocks, ( uint8_t * ) &( xSemaphorePoolBlocks[ configSEMAPHORE_POOL_LENGTH ] ), sizeof( Queue_t ), ( size_t ) 0 },
+		#endif
+		#if( configQUEUE_POOL_LENGTH > 0 )
+			{ NULL, ( uint8_t * ) xQueuePoolBlocks, ( uint8_t * ) xQueuePoolBlocks, ( uint8_t * ) &( xQueuePoolBlocks[ configQUEUE_POOL_LENGTH ] ), sizeof( QueuePoolBlock_t ), ( size_t ) configQUEUE_POOL_STORAGE_SIZE },
+		#endif
+	};
+
+	#define queueNUMBER_OF_POOLS	( sizeof( xQueuePools ) / sizeof( xQueuePools[ 0 ] ) )
+
+#endif /* configSEMAPHORE_POOL_LENGTH, configQUEUE_POOL_LENGTH */
+
+/*-----------------------------------------------------------*/
+
 /*
  * The queue registry is just a means for kernel aware debuggers to locate
  * queue structures.  It has no other purpose so is an optional component.
@@ -204,6 +259,15 @@ static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer
  */
 static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength, const UBaseType_t uxItemSize, uint8_t *pucQueueStorage, const uint8_t ucQueueType, Queue_t *pxNewQueue ) PRIVILEGED_FUNCTION;
 
+/*
+ * Allocate a queue structure followed by a storage area of xStorageSize bytes
+ * from the first pool it fits that is not empty, or from the heap.
+ */
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+	static Queue_t *prvAllocateQueue( const size_t xStorageSize ) PRIVILEGED_FUNCTION;
+	static void prvFreeQueue( Queue_t *pxQueue ) PRIVILEGED_FUNCTION;
+#endif
+
 /*
  * Mutexes are a special type of queue.  When a mutex is created, first the
  * queue is created, then prvInitialiseMutex() is called to configure the queue
@@ -375,7 +439,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 			xQueueSizeInBytes = ( size_t ) ( uxQueueLength * uxItemSize ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
 		}
 
-		pxNewQueue = ( Queue_t * ) pvPortMalloc( sizeof( Queue_t ) + xQueueSizeInBytes );
+		pxNewQueue = prvAllocateQueue( xQueueSizeInBytes );
 
 		if( pxNewQueue != NULL )
 		{
@@ -405,6 +469,109 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 #endif /* configSUPPORT_STATIC_ALLOCATION */
 /*-----------------------------------------------------------*/
 
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+	static Queue_t *prvAllocateQueue( const size_t xStorageSize )
+	{
+	void *pvReturn = NULL;
+
+		#if( ( configSEMAPHORE_POOL_LENGTH > 0 ) || ( configQUEUE_POOL_LENGTH > 0 ) )
+		{
+		QueuePool_t *pxPool;
+		size_t x;
+
+			vTaskSuspendAll();
+			{
+				for( x = 0; ( x < queueNUMBER_OF_POOLS ) && ( pvReturn == NULL ); x++ )
+				{
+					pxPool = &( xQueuePools[ x ] );
+
+					if( xStorageSize <= pxPool->xStorageSize )
+					{
+						if( pxPool->pvFreeBlocks != NULL )
+						{
+							pvReturn = pxPool->pvFreeBlocks;
+							pxPool->pvFreeBlocks = *( ( void ** ) pvReturn );
+						}
+						else if( pxPool->pucNextUnused < pxPool->pucEnd )
+						{
+							pvReturn = pxPool->pucNextUnused;
+							pxPool->pucNextUnused += pxPool->xBlockSize;
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+			}
+			( void ) xTaskResumeAll();
+		}
+		#endif /* configSEMAPHORE_POOL_LENGTH, configQUEUE_POOL_LENGTH */
+
+		if( pvReturn == NULL )
+		{
+			pvReturn = pvPortMalloc( sizeof( Queue_t ) + xStorageSize );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return ( Queue_t * ) pvReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvFreeQueue( Queue_t *pxQueue )
+	{
+	BaseType_t xFromPool = pdFALSE;
+
+		#if( ( configSEMAPHORE_POOL_LENGTH > 0 ) || ( configQUEUE_POOL_LENGTH > 0 ) )
+		{
+		QueuePool_t *pxPool;
+		size_t x;
+
+			for( x = 0; x < queueNUMBER_OF_POOLS; x++ )
+			{
+				pxPool = &( xQueuePools[ x ] );
+
+				if( ( ( uint8_t * ) pxQueue >= pxPool->pucStart ) && ( ( uint8_t * ) pxQueue < pxPool->pucEnd ) )
+				{
+					vTaskSuspendAll();
+					{
+						*( ( void ** ) pxQueue ) = pxPool->pvFreeBlocks;
+						pxPool->pvFreeBlocks = ( void * ) pxQueue;
+					}
+					( void ) xTaskResumeAll();
+
+					xFromPool = pdTRUE;
+					break;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+		#endif /* configSEMAPHORE_POOL_LENGTH, configQUEUE_POOL_LENGTH */
+
+		if( xFromPool == pdFALSE )
+		{
+			vPortFree( pxQueue );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
 static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength, const UBaseType_t uxItemSize, uint8_t *pucQueueStorage, const uint8_t ucQueueType, Queue_t *pxNewQueue )
 {
 	/* Remove compiler warnings about unused parameters should
@@ -1955,7 +2122,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 	{
 		/* The queue can only have been allocated dynamically - free it
 		again. */
-		vPortFree( pxQueue );
+		prvFreeQueue( pxQueue );
 	}
 	#elif( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
 	{
@@ -1963,7 +2130,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 		check before attempting to free the memory. */
 		if( pxQueue->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
 		{
-			vPortFree( pxQueue );
+			prvFreeQueue( pxQueue );
 		}
 		else
 		{
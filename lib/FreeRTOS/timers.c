@@ -58,6 +58,36 @@ configUSE_TIMERS is set to 1 in FreeRTOSConfig.h. */
 /* Misc definitions. */
 #define tmrNO_DELAY		( TickType_t ) 0U
 
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	#if( configUSE_16_BIT_TICKS == 1 )
+		#define tmrWHEEL_MAX_LEVELS		3
+	#else
+		#define tmrWHEEL_MAX_LEVELS		6
+	#endif
+
+	/* Timers beyond the reach of the wheel are parked in the top level, which
+	must therefore not be level 0, where timers expire rather than cascade. */
+	#if( ( configTIMER_WHEEL_LEVELS < 2 ) || ( configTIMER_WHEEL_LEVELS > tmrWHEEL_MAX_LEVELS ) )
+		#error configTIMER_WHEEL_LEVELS must be between 2 and 6, or between 2 and 3 if configUSE_16_BIT_TICKS is 1.
+	#endif
+
+	/* Each level of the wheel has 32 slots, so the slots in use are a 32 bit
+	bitmap.  A slot of level n spans 32 ^ n ticks. */
+	#define tmrWHEEL_SLOTS_LOG2					( 5U )
+	#define tmrWHEEL_SLOTS						( 1U << tmrWHEEL_SLOTS_LOG2 )
+	#define tmrWHEEL_SHIFT( uxLevel )			( ( uxLevel ) * tmrWHEEL_SLOTS_LOG2 )
+	#define tmrWHEEL_SPAN( uxLevel )			( ( TickType_t ) 1U << tmrWHEEL_SHIFT( uxLevel ) )
+	#define tmrWHEEL_SLOT( xTime, uxLevel )		( ( UBaseType_t ) ( ( xTime ) >> tmrWHEEL_SHIFT( uxLevel ) ) & ( UBaseType_t ) ( tmrWHEEL_SLOTS - 1U ) )
+
+	/* The wheel works on tick differences from the time it has been advanced
+	to, so a time has been reached whether or not the tick count overflowed in
+	between. */
+	#define tmrTIME_HAS_BEEN_REACHED( xTime, xTimeNow )	( ( TickType_t ) ( ( xTime ) - xTimerWheelTime ) <= ( TickType_t ) ( ( xTimeNow ) - xTimerWheelTime ) )
+#else
+	#define tmrTIME_HAS_BEEN_REACHED( xTime, xTimeNow )	( ( xTime ) <= ( xTimeNow ) )
+#endif
+
 /* The name assigned to the timer service task.  This can be overridden by
 defining trmTIMER_SERVICE_TASK_NAME in FreeRTOSConfig.h. */
 #ifndef configTIMER_SERVICE_TASK_NAME
@@ -73,6 +103,12 @@ typedef struct tmrTimerControl
 	UBaseType_t				uxAutoReload;		/*<< Set to pdTRUE if the timer should be automatically restarted once expired.  Set to pdFALSE if the timer is, in effect, a one-shot timer. */
 	void 					*pvTimerID;			/*<< An ID to identify the timer.  This allows the timer to be identified when the same callback is used for multiple timers. */
 	TimerCallbackFunction_t	pxCallbackFunction;	/*<< The function that will be called when the timer expires. */
+	#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+		ListItem_t			xCommandListItem;	/*<< Used to reference the timer from the list of timers that have a command pending. */
+		TickType_t			xPendingValue;		/*<< The command time of a pending start or stop, or the new period of a pending change period. */
+		TickType_t			xPendingPeriod;		/*<< The period set by a change period command that a later command replaced, or 0. */
+		BaseType_t			xPendingCommand;	/*<< The command pending, tmrCOMMAND_START, tmrCOMMAND_STOP or tmrCOMMAND_CHANGE_PERIOD. */
+	#endif
 	#if( configUSE_TRACE_FACILITY == 1 )
 		UBaseType_t			uxTimerNumber;		/*<< An ID assigned by trace tools such as FreeRTOS+Trace */
 	#endif
@@ -125,18 +161,56 @@ typedef struct tmrTimerQueueMessage
 /*lint -save -e956 A manual analysis and inspection has been used to determine
 which static variables must be declared volatile. */
 
-/* The list in which active timers are stored.  Timers are referenced in expire
-time order, with the nearest expiry time at the front of the list.  Only the
-timer service task is allowed to access these lists. */
-PRIVILEGED_DATA static List_t xActiveTimerList1;
-PRIVILEGED_DATA static List_t xActiveTimerList2;
-PRIVILEGED_DATA static List_t *pxCurrentTimerList;
-PRIVILEGED_DATA static List_t *pxOverflowTimerList;
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	/* The wheel in which active timers are stored.  A timer that expires less
+	than 32 ticks after xTimerWheelTime is in the level 0 slot of its expiry
+	time.  A timer that expires further ahead is in the slot of the level that
+	spans its expiry time, and is moved down the levels (cascaded) when the
+	wheel reaches the start of that slot.  Each bit of
+	ulTimerWheelSlotsInUse[] is set while the slot it indexes is not empty, so
+	the next slot to process is found without walking the slots.  Only the
+	timer service task is allowed to access the wheel. */
+	PRIVILEGED_DATA static List_t xTimerWheel[ configTIMER_WHEEL_LEVELS ][ tmrWHEEL_SLOTS ];
+	PRIVILEGED_DATA static uint32_t ulTimerWheelSlotsInUse[ configTIMER_WHEEL_LEVELS ];
+
+	/* All the timers that expire before this time have been processed, and
+	all the slots that start at or before this time have been cascaded. */
+	PRIVILEGED_DATA static TickType_t xTimerWheelTime = ( TickType_t ) 0U;
+
+#else
+
+	/* The list in which active timers are stored.  Timers are referenced in expire
+	time order, with the nearest expiry time at the front of the list.  Only the
+	timer service task is allowed to access these lists. */
+	PRIVILEGED_DATA static List_t xActiveTimerList1;
+	PRIVILEGED_DATA static List_t xActiveTimerList2;
+	PRIVILEGED_DATA static List_t *pxCurrentTimerList;
+	PRIVILEGED_DATA static List_t *pxOverflowTimerList;
+
+#endif /* configUSE_TIMER_WHEEL */
 
 /* A queue that is used to send commands to the timer service task. */
 PRIVILEGED_DATA static QueueHandle_t xTimerQueue = NULL;
 PRIVILEGED_DATA static TaskHandle_t xTimerTaskHandle = NULL;
 
+#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+	/* The timers that have a command pending, in the order their first command
+	was sent.  Only the timer that makes the list not empty queues a message to
+	wake the timer service task, which empties the list when it runs. */
+	PRIVILEGED_DATA static List_t xPendingCommandList;
+#endif
+
+#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configTIMER_POOL_LENGTH > 0 ) )
+	/* Timers created dynamically are taken from this pool before the heap.
+	Timers returned to the pool are linked through their first bytes, and the
+	timers that were never taken follow pxNextUnusedTimer, so the pool needs no
+	initialisation. */
+	PRIVILEGED_DATA static Timer_t xTimerPool[ configTIMER_POOL_LENGTH ];
+	PRIVILEGED_DATA static void *pvFreeTimers = NULL;
+	PRIVILEGED_DATA static Timer_t *pxNextUnusedTimer = xTimerPool;
+#endif
+
 /*lint -restore */
 
 /*-----------------------------------------------------------*/
@@ -151,6 +225,15 @@ PRIVILEGED_DATA static TaskHandle_t xTimerTaskHandle = NULL;
 
 #endif
 
+/*
+ * Allocate a timer structure from the pool if it is not empty, or from the
+ * heap, and free it to where it came from.
+ */
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+	static Timer_t *prvAllocateTimer( void ) PRIVILEGED_FUNCTION;
+	static void prvFreeTimer( Timer_t * const pxTimer ) PRIVILEGED_FUNCTION;
+#endif
+
 /*
  * Initialise the infrastructure used by the timer service task if it has not
  * been initialised already.
@@ -170,23 +253,78 @@ static void prvTimerTask( void *pvParameters ) PRIVILEGED_FUNCTION;
  */
 static void prvProcessReceivedCommands( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Receive the next command from the timer queue or, when commands are
+ * coalesced and the queue is empty, take the command pending in the first
+ * timer of the pending list.  Returns pdFAIL when there is no command left.
+ */
+static BaseType_t prvReceiveCommand( DaemonTaskMessage_t * const pxMessage ) PRIVILEGED_FUNCTION;
+
+#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+
+	/*
+	 * Leave a start, reset, stop or change period command in the timer,
+	 * replacing any command already pending, and wake the timer service task
+	 * if no other timer has a command pending.  Returns pdFAIL for the
+	 * commands that must be queued instead.
+	 */
+	static BaseType_t prvPendCommand( Timer_t * const pxTimer, const BaseType_t xCommandID, const TickType_t xOptionalValue, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TIMER_COMMAND_COALESCING */
+
 /*
  * Insert the timer into either xActiveTimerList1, or xActiveTimerList2,
- * depending on if the expire time causes a timer counter overflow.
+ * depending on if the expire time causes a timer counter overflow, or into
+ * the timing wheel.
  */
 static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime ) PRIVILEGED_FUNCTION;
 
 /*
- * An active timer has reached its expire time.  Reload the timer if it is an
- * auto reload timer, then call its callback.
+ * Remove an active timer from the list or the slot of the wheel it is in.
+ */
+static void prvRemoveTimerFromActiveList( Timer_t * const pxTimer ) PRIVILEGED_FUNCTION;
+
+/*
+ * The time at which one or more timers expire has been reached.  Process the
+ * timer that expires first, or all the timers that expire at that time if the
+ * timing wheel is used.
  */
 static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
 
 /*
- * The tick count has overflowed.  Switch the timer lists after ensuring the
- * current timer list does not still reference some timers.
+ * An active timer has reached its expire time.  Reload the timer if it is an
+ * auto reload timer, then call its callback.
  */
-static void prvSwitchTimerLists( void ) PRIVILEGED_FUNCTION;
+static void prvExpireTimer( Timer_t * const pxTimer, const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	/*
+	 * File the timer, whose list item value is its expiry time, in the slot of
+	 * the wheel that will be processed or cascaded at or before that time.
+	 */
+	static void prvInsertTimerInWheel( Timer_t * const pxTimer, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Set the wheel time to xTime, cascading the slots that start at xTime
+	 * into the lower levels.
+	 */
+	static void prvAdvanceTimerWheel( const TickType_t xTime ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * The index of the lowest bit set in ulBits, which must not be 0.
+	 */
+	static UBaseType_t prvLowestBitSet( const uint32_t ulBits ) PRIVILEGED_FUNCTION;
+
+#else
+
+	/*
+	 * The tick count has overflowed.  Switch the timer lists after ensuring the
+	 * current timer list does not still reference some timers.
+	 */
+	static void prvSwitchTimerLists( void ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TIMER_WHEEL */
 
 /*
  * Obtain the current tick count, setting *pxTimerListsWereSwitched to pdTRUE
@@ -283,7 +421,7 @@ BaseType_t xReturn = pdFAIL;
 	{
 	Timer_t *pxNewTimer;
 
-		pxNewTimer = ( Timer_t * ) pvPortMalloc( sizeof( Timer_t ) );
+		pxNewTimer = prvAllocateTimer();
 
 		if( pxNewTimer != NULL )
 		{
@@ -305,6 +443,76 @@ BaseType_t xReturn = pdFAIL;
 #endif /* configSUPPORT_STATIC_ALLOCATION */
 /*-----------------------------------------------------------*/
 
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+	static Timer_t *prvAllocateTimer( void )
+	{
+	void *pvReturn = NULL;
+
+		#if( configTIMER_POOL_LENGTH > 0 )
+		{
+			vTaskSuspendAll();
+			{
+				if( pvFreeTimers != NULL )
+				{
+					pvReturn = pvFreeTimers;
+					pvFreeTimers = *( ( void ** ) pvReturn );
+				}
+				else if( pxNextUnusedTimer < &( xTimerPool[ configTIMER_POOL_LENGTH ] ) )
+				{
+					pvReturn = ( void * ) pxNextUnusedTimer;
+					pxNextUnusedTimer++;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			( void ) xTaskResumeAll();
+		}
+		#endif /* configTIMER_POOL_LENGTH */
+
+		if( pvReturn == NULL )
+		{
+			pvReturn = pvPortMalloc( sizeof( Timer_t ) );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return ( Timer_t * ) pvReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvFreeTimer( Timer_t * const pxTimer )
+	{
+		#if( configTIMER_POOL_LENGTH > 0 )
+		{
+			if( ( pxTimer >= xTimerPool ) && ( pxTimer < &( xTimerPool[ configTIMER_POOL_LENGTH ] ) ) )
+			{
+				vTaskSuspendAll();
+				{
+					*( ( void ** ) pxTimer ) = pvFreeTimers;
+					pvFreeTimers = ( void * ) pxTimer;
+				}
+				( void ) xTaskResumeAll();
+			}
+			else
+			{
+				vPortFree( pxTimer );
+			}
+		}
+		#else
+		{
+			vPortFree( pxTimer );
+		}
+		#endif /* configTIMER_POOL_LENGTH */
+	}
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
 #if( configSUPPORT_STATIC_ALLOCATION == 1 )
 
 	TimerHandle_t xTimerCreateStatic(	const char * const pcTimerName,		/*lint !e971 Unqualified char types are allowed for strings and single characters only. */
@@ -373,6 +581,14 @@ static void prvInitialiseNewTimer(	const char * const pcTimerName,			/*lint !e97
 		pxNewTimer->pvTimerID = pvTimerID;
 		pxNewTimer->pxCallbackFunction = pxCallbackFunction;
 		vListInitialiseItem( &( pxNewTimer->xTimerListItem ) );
+
+		#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+		{
+			vListInitialiseItem( &( pxNewTimer->xCommandListItem ) );
+			listSET_LIST_ITEM_OWNER( &( pxNewTimer->xCommandListItem ), pxNewTimer );
+		}
+		#endif /* configUSE_TIMER_COMMAND_COALESCING */
+
 		traceTIMER_CREATE( pxNewTimer );
 	}
 }
@@ -389,25 +605,40 @@ DaemonTaskMessage_t xMessage;
 	on a particular timer definition. */
 	if( xTimerQueue != NULL )
 	{
-		/* Send a command to the timer service task to start the xTimer timer. */
-		xMessage.xMessageID = xCommandID;
-		xMessage.u.xTimerParameters.xMessageValue = xOptionalValue;
-		xMessage.u.xTimerParameters.pxTimer = ( Timer_t * ) xTimer;
+		#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+		{
+			/* Leave the command in the timer if it is one that can be
+			collapsed with the commands that follow it. */
+			xReturn = prvPendCommand( ( Timer_t * ) xTimer, xCommandID, xOptionalValue, pxHigherPriorityTaskWoken );
+		}
+		#endif /* configUSE_TIMER_COMMAND_COALESCING */
 
-		if( xCommandID < tmrFIRST_FROM_ISR_COMMAND )
+		if( xReturn == pdFAIL )
 		{
-			if( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING )
+			/* Send a command to the timer service task to start the xTimer timer. */
+			xMessage.xMessageID = xCommandID;
+			xMessage.u.xTimerParameters.xMessageValue = xOptionalValue;
+			xMessage.u.xTimerParameters.pxTimer = ( Timer_t * ) xTimer;
+
+			if( xCommandID < tmrFIRST_FROM_ISR_COMMAND )
 			{
-				xReturn = xQueueSendToBack( xTimerQueue, &xMessage, xTicksToWait );
+				if( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING )
+				{
+					xReturn = xQueueSendToBack( xTimerQueue, &xMessage, xTicksToWait );
+				}
+				else
+				{
+					xReturn = xQueueSendToBack( xTimerQueue, &xMessage, tmrNO_DELAY );
+				}
 			}
 			else
 			{
-				xReturn = xQueueSendToBack( xTimerQueue, &xMessage, tmrNO_DELAY );
+				xReturn = xQueueSendToBackFromISR( xTimerQueue, &xMessage, pxHigherPriorityTaskWoken );
 			}
 		}
 		else
 		{
-			xReturn = xQueueSendToBackFromISR( xTimerQueue, &xMessage, pxHigherPriorityTaskWoken );
+			mtCOVERAGE_TEST_MARKER();
 		}
 
 		traceTIMER_COMMAND_SEND( xTimer, xCommandID, xOptionalValue, xReturn );
@@ -421,6 +652,125 @@ DaemonTaskMessage_t xMessage;
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+
+static BaseType_t prvPendCommand( Timer_t * const pxTimer, const BaseType_t xCommandID, const TickType_t xOptionalValue, BaseType_t * const pxHigherPriorityTaskWoken )
+{
+BaseType_t xReturn = pdPASS, xWakeTimerTask = pdFALSE, xPendingCommand;
+UBaseType_t uxSavedInterruptStatus = 0U;
+DaemonTaskMessage_t xMessage;
+
+	switch( xCommandID )
+	{
+		case tmrCOMMAND_START :
+		case tmrCOMMAND_START_FROM_ISR :
+		case tmrCOMMAND_RESET :
+		case tmrCOMMAND_RESET_FROM_ISR :
+			xPendingCommand = tmrCOMMAND_START;
+			break;
+
+		case tmrCOMMAND_STOP :
+		case tmrCOMMAND_STOP_FROM_ISR :
+			xPendingCommand = tmrCOMMAND_STOP;
+			break;
+
+		case tmrCOMMAND_CHANGE_PERIOD :
+		case tmrCOMMAND_CHANGE_PERIOD_FROM_ISR :
+			xPendingCommand = tmrCOMMAND_CHANGE_PERIOD;
+			break;
+
+		default :
+			/* tmrCOMMAND_START_DONT_TRACE, which the timer service task sends
+			itself, and tmrCOMMAND_DELETE are queued. */
+			xPendingCommand = xCommandID;
+			xReturn = pdFAIL;
+			break;
+	}
+
+	/* The other commands are queued.  A delete leaves the command pending, if
+	any, for the timer service task to drop when it deletes the timer, so the
+	command still takes effect if the delete cannot be queued. */
+	if( xReturn != pdFAIL )
+	{
+		if( xCommandID < tmrFIRST_FROM_ISR_COMMAND )
+		{
+			taskENTER_CRITICAL();
+		}
+		else
+		{
+			uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		}
+		{
+			if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xCommandListItem ) ) != pdFALSE ) /*lint !e961. The cast is only redundant when NULL is passed into the macro. */
+			{
+				/* No command is pending for this timer yet. */
+				xWakeTimerTask = listLIST_IS_EMPTY( &xPendingCommandList );
+				vListInsertEnd( &xPendingCommandList, &( pxTimer->xCommandListItem ) );
+				pxTimer->xPendingPeriod = ( TickType_t ) 0U;
+				pxTimer->xPendingCommand = xPendingCommand;
+				pxTimer->xPendingValue = xOptionalValue;
+			}
+			else
+			{
+				/* The command replaces the one pending.  Only the period set
+				by a change period command outlives a start or a stop sent after
+				it. */
+				if( ( pxTimer->xPendingCommand == tmrCOMMAND_CHANGE_PERIOD ) && ( xPendingCommand != tmrCOMMAND_CHANGE_PERIOD ) )
+				{
+					pxTimer->xPendingPeriod = pxTimer->xPendingValue;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				pxTimer->xPendingCommand = xPendingCommand;
+				pxTimer->xPendingValue = xOptionalValue;
+			}
+		}
+		if( xCommandID < tmrFIRST_FROM_ISR_COMMAND )
+		{
+			taskEXIT_CRITICAL();
+		}
+		else
+		{
+			portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	if( xWakeTimerTask != pdFALSE )
+	{
+		/* The command stays pending if the queue is full, as the timer service
+		task empties the pending list each time it empties the queue, so the
+		message is not waited for. */
+		xMessage.xMessageID = tmrCOMMAND_PROCESS_PENDING;
+		xMessage.u.xTimerParameters.xMessageValue = ( TickType_t ) 0U;
+		xMessage.u.xTimerParameters.pxTimer = NULL;
+
+		if( xCommandID < tmrFIRST_FROM_ISR_COMMAND )
+		{
+			( void ) xQueueSendToBack( xTimerQueue, &xMessage, tmrNO_DELAY );
+		}
+		else
+		{
+			( void ) xQueueSendToBackFromISR( xTimerQueue, &xMessage, pxHigherPriorityTaskWoken );
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xReturn;
+}
+
+#endif /* configUSE_TIMER_COMMAND_COALESCING */
+/*-----------------------------------------------------------*/
+
 TaskHandle_t xTimerGetTimerDaemonTaskHandle( void )
 {
 	/* If xTimerGetTimerDaemonTaskHandle() is called before the scheduler has been
@@ -460,13 +810,45 @@ Timer_t *pxTimer = ( Timer_t * ) xTimer;
 /*-----------------------------------------------------------*/
 
 static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow )
+{
+	#if( configUSE_TIMER_WHEEL == 1 )
+	{
+	List_t * const pxExpiredTimers = &( xTimerWheel[ 0 ][ tmrWHEEL_SLOT( xNextExpireTime, 0U ) ] );
+	UBaseType_t uxTimersToExpire;
+
+		/* Cascading the slots that start at this time can add timers to the
+		level 0 slot of this time, so cascade first.  All the timers in the
+		level 0 slot then expire at this time. */
+		prvAdvanceTimerWheel( xNextExpireTime );
+
+		/* Only expire the timers in the slot now.  An auto-reload timer that
+		is processed late can be filed back into the same slot, at the end of
+		it, when removing it left the wheel empty and the wheel was brought to
+		the current time. */
+		uxTimersToExpire = listCURRENT_LIST_LENGTH( pxExpiredTimers );
+
+		while( uxTimersToExpire > 0U )
+		{
+			prvExpireTimer( ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxExpiredTimers ), xNextExpireTime, xTimeNow );
+			uxTimersToExpire--;
+		}
+	}
+	#else
+	{
+		/* A check has already been performed to ensure the list is not
+		empty. */
+		prvExpireTimer( ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList ), xNextExpireTime, xTimeNow );
+	}
+	#endif /* configUSE_TIMER_WHEEL */
+}
+/*-----------------------------------------------------------*/
+
+static void prvExpireTimer( Timer_t * const pxTimer, const TickType_t xNextExpireTime, const TickType_t xTimeNow )
 {
 BaseType_t xResult;
-Timer_t * const pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList );
 
-	/* Remove the timer from the list of active timers.  A check has already
-	been performed to ensure the list is not empty. */
-	( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+	/* Remove the timer from the list of active timers. */
+	prvRemoveTimerFromActiveList( pxTimer );
 	traceTIMER_EXPIRED( pxTimer );
 
 	/* If the timer is an auto reload timer then calculate the next
@@ -551,7 +933,7 @@ BaseType_t xTimerListsWereSwitched;
 		if( xTimerListsWereSwitched == pdFALSE )
 		{
 			/* The tick count has not overflowed, has the timer expired? */
-			if( ( xListWasEmpty == pdFALSE ) && ( xNextExpireTime <= xTimeNow ) )
+			if( ( xListWasEmpty == pdFALSE ) && ( tmrTIME_HAS_BEEN_REACHED( xNextExpireTime, xTimeNow ) != pdFALSE ) )
 			{
 				( void ) xTaskResumeAll();
 				prvProcessExpiredTimer( xNextExpireTime, xTimeNow );
@@ -564,12 +946,16 @@ BaseType_t xTimerListsWereSwitched;
 				received - whichever comes first.  The following line cannot
 				be reached unless xNextExpireTime > xTimeNow, except in the
 				case when the current timer list is empty. */
-				if( xListWasEmpty != pdFALSE )
+				#if( configUSE_TIMER_WHEEL == 0 )
 				{
-					/* The current timer list is empty - is the overflow list
-					also empty? */
-					xListWasEmpty = listLIST_IS_EMPTY( pxOverflowTimerList );
+					if( xListWasEmpty != pdFALSE )
+					{
+						/* The current timer list is empty - is the overflow list
+						also empty? */
+						xListWasEmpty = listLIST_IS_EMPTY( pxOverflowTimerList );
+					}
 				}
+				#endif /* configUSE_TIMER_WHEEL */
 
 				vQueueWaitForMessageRestricted( xTimerQueue, ( xNextExpireTime - xTimeNow ), xListWasEmpty );
 
@@ -595,6 +981,52 @@ BaseType_t xTimerListsWereSwitched;
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_WHEEL == 1 )
+
+static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty )
+{
+TickType_t xNextExpireTime = ( TickType_t ) 0U, xSlotStart;
+UBaseType_t uxLevel, uxSlotsAhead, uxShift;
+uint32_t ulSlotsInUse;
+
+	/* The next time to process is the start of the nearest slot in use, over
+	all the levels.  On level 0 that is when the timers of the slot expire, on
+	the other levels it is when the slot is cascaded.  The bitmap of each level
+	is rotated so that bit 0 is the slot after the slot of the wheel time:
+	the slot of the wheel time itself has already been processed or cascaded,
+	so the timers it holds are a full turn of the level ahead. */
+	*pxListWasEmpty = pdTRUE;
+
+	for( uxLevel = 0U; uxLevel < ( UBaseType_t ) configTIMER_WHEEL_LEVELS; uxLevel++ )
+	{
+		ulSlotsInUse = ulTimerWheelSlotsInUse[ uxLevel ];
+
+		if( ulSlotsInUse != 0UL )
+		{
+			uxShift = ( tmrWHEEL_SLOT( xTimerWheelTime, uxLevel ) + 1U ) & ( tmrWHEEL_SLOTS - 1U );
+
+			if( uxShift != 0U )
+			{
+				ulSlotsInUse = ( ulSlotsInUse >> uxShift ) | ( ulSlotsInUse << ( tmrWHEEL_SLOTS - uxShift ) );
+			}
+
+			uxSlotsAhead = prvLowestBitSet( ulSlotsInUse ) + 1U;
+			xSlotStart = ( ( xTimerWheelTime >> tmrWHEEL_SHIFT( uxLevel ) ) + ( TickType_t ) uxSlotsAhead ) << tmrWHEEL_SHIFT( uxLevel );
+
+			if( ( *pxListWasEmpty != pdFALSE ) || ( ( TickType_t ) ( xSlotStart - xTimerWheelTime ) < ( TickType_t ) ( xNextExpireTime - xTimerWheelTime ) ) )
+			{
+				xNextExpireTime = xSlotStart;
+			}
+
+			*pxListWasEmpty = pdFALSE;
+		}
+	}
+
+	return xNextExpireTime;
+}
+
+#else
+
 static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty )
 {
 TickType_t xNextExpireTime;
@@ -619,8 +1051,23 @@ TickType_t xNextExpireTime;
 
 	return xNextExpireTime;
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_WHEEL == 1 )
+
+static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched )
+{
+	/* The wheel works on tick differences, so there are no lists to switch
+	when the tick count overflows. */
+	*pxTimerListsWereSwitched = pdFALSE;
+
+	return xTaskGetTickCount();
+}
+
+#else
+
 static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched )
 {
 TickType_t xTimeNow;
@@ -642,6 +1089,8 @@ PRIVILEGED_DATA static TickType_t xLastTime = ( TickType_t ) 0U; /*lint !e956 Va
 
 	return xTimeNow;
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime )
@@ -651,6 +1100,21 @@ BaseType_t xProcessTimerNow = pdFALSE;
 	listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
 	listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
 
+	#if( configUSE_TIMER_WHEEL == 1 )
+	{
+		/* The expiry time is the command time plus the period, so the timer
+		has expired if a period has elapsed since the command was issued,
+		whether or not the tick count overflowed in between. */
+		if( ( ( TickType_t ) ( xTimeNow - xCommandTime ) ) >= pxTimer->xTimerPeriodInTicks ) /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+		{
+			xProcessTimerNow = pdTRUE;
+		}
+		else
+		{
+			prvInsertTimerInWheel( pxTimer, xTimeNow );
+		}
+	}
+	#else
 	if( xNextExpiryTime <= xTimeNow )
 	{
 		/* Has the expiry time elapsed between the command to start/reset a
@@ -680,11 +1144,207 @@ BaseType_t xProcessTimerNow = pdFALSE;
 			vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
 		}
 	}
+	#endif /* configUSE_TIMER_WHEEL */
 
 	return xProcessTimerNow;
 }
 /*-----------------------------------------------------------*/
 
+static void prvRemoveTimerFromActiveList( Timer_t * const pxTimer )
+{
+	#if( configUSE_TIMER_WHEEL == 1 )
+	{
+	List_t * const pxSlot = ( List_t * ) listLIST_ITEM_CONTAINER( &( pxTimer->xTimerListItem ) );
+	UBaseType_t uxSlot;
+
+		if( uxListRemove( &( pxTimer->xTimerListItem ) ) == ( UBaseType_t ) 0 )
+		{
+			/* The slot is now empty, clear its bit. */
+			uxSlot = ( UBaseType_t ) ( pxSlot - &( xTimerWheel[ 0 ][ 0 ] ) );
+			ulTimerWheelSlotsInUse[ uxSlot / tmrWHEEL_SLOTS ] &= ~( ( uint32_t ) 1UL << ( uxSlot % tmrWHEEL_SLOTS ) );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#else
+	{
+		( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+	}
+	#endif /* configUSE_TIMER_WHEEL */
+}
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	static void prvInsertTimerInWheel( Timer_t * const pxTimer, const TickType_t xTimeNow )
+	{
+	const TickType_t xExpiryTime = listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) );
+	TickType_t xTicksToExpiry;
+	UBaseType_t uxLevel, uxSlot;
+
+		/* An empty wheel is brought to the current time, so the wheel time
+		never falls a tick count overflow behind while no timer is active. */
+		for( uxLevel = 0U; uxLevel < ( UBaseType_t ) configTIMER_WHEEL_LEVELS; uxLevel++ )
+		{
+			if( ulTimerWheelSlotsInUse[ uxLevel ] != 0UL )
+			{
+				break;
+			}
+		}
+
+		if( uxLevel == ( UBaseType_t ) configTIMER_WHEEL_LEVELS )
+		{
+			xTimerWheelTime = xTimeNow;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* The lowest level whose 32 slots span the expiry time. */
+		xTicksToExpiry = xExpiryTime - xTimerWheelTime;
+
+		for( uxLevel = 0U; uxLevel < ( UBaseType_t ) ( configTIMER_WHEEL_LEVELS - 1 ); uxLevel++ )
+		{
+			if( xTicksToExpiry < tmrWHEEL_SPAN( uxLevel + 1U ) )
+			{
+				break;
+			}
+		}
+
+		if( xTicksToExpiry < tmrWHEEL_SPAN( uxLevel + 1U ) )
+		{
+			uxSlot = tmrWHEEL_SLOT( xExpiryTime, uxLevel );
+		}
+		else
+		{
+			/* The expiry time is beyond the reach of the wheel.  Park the timer
+			in the top level slot that is cascaded last, where it is filed
+			again. */
+			uxSlot = tmrWHEEL_SLOT( xTimerWheelTime, uxLevel );
+		}
+
+		vListInsertEnd( &( xTimerWheel[ uxLevel ][ uxSlot ] ), &( pxTimer->xTimerListItem ) );
+		ulTimerWheelSlotsInUse[ uxLevel ] |= ( ( uint32_t ) 1UL << uxSlot );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvAdvanceTimerWheel( const TickType_t xTime )
+	{
+	UBaseType_t uxLevel, uxTimersToMove;
+	List_t *pxSlot;
+	Timer_t *pxTimer;
+
+		xTimerWheelTime = xTime;
+
+		/* Cascade from the top level down, as a timer cascaded from one level
+		can land in the slot of the level below that starts at the same
+		time. */
+		for( uxLevel = ( UBaseType_t ) ( configTIMER_WHEEL_LEVELS - 1 ); uxLevel > 0U; uxLevel-- )
+		{
+			if( ( xTime & ( tmrWHEEL_SPAN( uxLevel ) - ( TickType_t ) 1U ) ) == ( TickType_t ) 0U )
+			{
+				/* Only move the timers in the slot now, as timers parked in the
+				top level are filed back into the same slot. */
+				pxSlot = &( xTimerWheel[ uxLevel ][ tmrWHEEL_SLOT( xTime, uxLevel ) ] );
+				uxTimersToMove = listCURRENT_LIST_LENGTH( pxSlot );
+
+				while( uxTimersToMove > 0U )
+				{
+					pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot );
+					prvRemoveTimerFromActiveList( pxTimer );
+					prvInsertTimerInWheel( pxTimer, xTime );
+					uxTimersToMove--;
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static UBaseType_t prvLowestBitSet( const uint32_t ulBits )
+	{
+	/* Indexed by the top 5 bits of the lowest bit set multiplied by a de
+	Bruijn sequence. */
+	static const uint8_t ucBitPositions[ 32 ] =
+	{
+		0U, 1U, 28U, 2U, 29U, 14U, 24U, 3U, 30U, 22U, 20U, 15U, 25U, 17U, 4U, 8U,
+		31U, 27U, 13U, 23U, 21U, 19U, 16U, 7U, 26U, 12U, 18U, 6U, 11U, 5U, 10U, 9U
+	};
+	const uint32_t ulLowestBit = ulBits & ( ~ulBits + 1UL );
+	const uint32_t ulIndex = ( uint32_t ) ( ulLowestBit * 0x077CB531UL );
+
+		return ( UBaseType_t ) ucBitPositions[ ulIndex >> 27 ];
+	}
+
+#endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReceiveCommand( DaemonTaskMessage_t * const pxMessage )
+{
+BaseType_t xReturn;
+
+	xReturn = xQueueReceive( xTimerQueue, pxMessage, tmrNO_DELAY );
+
+	#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+	{
+	Timer_t *pxTimer;
+
+		/* The messages that wake this task carry no command of their own. */
+		while( ( xReturn != pdFAIL ) && ( pxMessage->xMessageID == tmrCOMMAND_PROCESS_PENDING ) )
+		{
+			xReturn = xQueueReceive( xTimerQueue, pxMessage, tmrNO_DELAY );
+		}
+
+		if( xReturn == pdFAIL )
+		{
+			taskENTER_CRITICAL();
+			{
+				if( listLIST_IS_EMPTY( &xPendingCommandList ) == pdFALSE )
+				{
+					pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( &xPendingCommandList );
+					( void ) uxListRemove( &( pxTimer->xCommandListItem ) );
+
+					/* The timer is removed from the active list before the
+					command is processed, so a replaced change period can
+					take effect here. */
+					if( pxTimer->xPendingPeriod != ( TickType_t ) 0U )
+					{
+						pxTimer->xTimerPeriodInTicks = pxTimer->xPendingPeriod;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+
+					pxMessage->xMessageID = pxTimer->xPendingCommand;
+					pxMessage->u.xTimerParameters.xMessageValue = pxTimer->xPendingValue;
+					pxMessage->u.xTimerParameters.pxTimer = pxTimer;
+					xReturn = pdPASS;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			taskEXIT_CRITICAL();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif /* configUSE_TIMER_COMMAND_COALESCING */
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
 static void	prvProcessReceivedCommands( void )
 {
 DaemonTaskMessage_t xMessage;
@@ -692,7 +1352,7 @@ Timer_t *pxTimer;
 BaseType_t xTimerListsWereSwitched, xResult;
 TickType_t xTimeNow;
 
-	while( xQueueReceive( xTimerQueue, &xMessage, tmrNO_DELAY ) != pdFAIL ) /*lint !e603 xMessage does not have to be initialised as it is passed out, not in, and it is not used unless xQueueReceive() returns pdTRUE. */
+	while( prvReceiveCommand( &xMessage ) != pdFAIL ) /*lint !e603 xMessage does not have to be initialised as it is passed out, not in, and it is not used unless prvReceiveCommand() returns pdPASS. */
 	{
 		#if ( INCLUDE_xTimerPendFunctionCall == 1 )
 		{
@@ -727,7 +1387,7 @@ TickType_t xTimeNow;
 			if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE ) /*lint !e961. The cast is only redundant when NULL is passed into the macro. */
 			{
 				/* The timer is in a list, remove it. */
-				( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+				prvRemoveTimerFromActiveList( pxTimer );
 			}
 			else
 			{
@@ -797,6 +1457,27 @@ TickType_t xTimeNow;
 					break;
 
 				case tmrCOMMAND_DELETE :
+					#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+					{
+						/* A command sent before the delete can still be
+						pending, as pending commands are only collected once
+						the queue is empty.  It must not be left in the
+						pending list once the timer's memory is freed. */
+						taskENTER_CRITICAL();
+						{
+							if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xCommandListItem ) ) == pdFALSE ) /*lint !e961. The cast is only redundant when NULL is passed into the macro. */
+							{
+								( void ) uxListRemove( &( pxTimer->xCommandListItem ) );
+							}
+							else
+							{
+								mtCOVERAGE_TEST_MARKER();
+							}
+						}
+						taskEXIT_CRITICAL();
+					}
+					#endif /* configUSE_TIMER_COMMAND_COALESCING */
+
 					/* The timer has already been removed from the active list,
 					just free up the memory if the memory was dynamically
 					allocated. */
@@ -804,7 +1485,7 @@ TickType_t xTimeNow;
 					{
 						/* The timer can only have been allocated dynamically -
 						free it again. */
-						vPortFree( pxTimer );
+						prvFreeTimer( pxTimer );
 					}
 					#elif( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
 					{
@@ -813,7 +1494,7 @@ TickType_t xTimeNow;
 						memory. */
 						if( pxTimer->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
 						{
-							vPortFree( pxTimer );
+							prvFreeTimer( pxTimer );
 						}
 						else
 						{
@@ -832,6 +1513,8 @@ TickType_t xTimeNow;
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_WHEEL == 0 )
+
 static void prvSwitchTimerLists( void )
 {
 TickType_t xNextExpireTime, xReloadTime;
@@ -889,6 +1572,8 @@ BaseType_t xResult;
 	pxCurrentTimerList = pxOverflowTimerList;
 	pxOverflowTimerList = pxTemp;
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static void prvCheckForValidListAndQueue( void )
@@ -900,10 +1585,34 @@ static void prvCheckForValidListAndQueue( void )
 	{
 		if( xTimerQueue == NULL )
 		{
-			vListInitialise( &xActiveTimerList1 );
-			vListInitialise( &xActiveTimerList2 );
-			pxCurrentTimerList = &xActiveTimerList1;
-			pxOverflowTimerList = &xActiveTimerList2;
+			#if( configUSE_TIMER_WHEEL == 1 )
+			{
+			UBaseType_t uxLevel, uxSlot;
+
+				for( uxLevel = 0U; uxLevel < ( UBaseType_t ) configTIMER_WHEEL_LEVELS; uxLevel++ )
+				{
+					for( uxSlot = 0U; uxSlot < tmrWHEEL_SLOTS; uxSlot++ )
+					{
+						vListInitialise( &( xTimerWheel[ uxLevel ][ uxSlot ] ) );
+					}
+
+					ulTimerWheelSlotsInUse[ uxLevel ] = 0UL;
+				}
+			}
+			#else
+			{
+				vListInitialise( &xActiveTimerList1 );
+				vListInitialise( &xActiveTimerList2 );
+				pxCurrentTimerList = &xActiveTimerList1;
+				pxOverflowTimerList = &xActiveTimerList2;
+			}
+			#endif /* configUSE_TIMER_WHEEL */
+
+			#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+			{
+				vListInitialise( &xPendingCommandList );
+			}
+			#endif /* configUSE_TIMER_COMMAND_COALESCING */
 
 			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
 			{
@@ -0,0 +1,334 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+
+/**
+ * @file aws_bufferpool_static_lock_free.c
+ * @brief A lock free implementation of the BufferPool interface.
+ *
+ * A pool of statically allocated buffers is maintained. The number of buffers
+ * in the pool and the size of each buffer is controlled via macros
+ * bufferpoolconfigNUM_BUFFERS and bufferpoolconfigBUFFER_SIZE which must be
+ * defined in BufferPoolConfig.h.
+ *
+ * The free buffers are kept in a stack linked through the buffer metadata. The
+ * top of the stack is a 32 bit word holding the index of the first free buffer
+ * and a tag which changes on every update, and it is only ever updated with a
+ * compare and swap. Getting and returning a buffer therefore takes constant
+ * time, never blocks and never disables interrupts (unless
+ * bufferpoolconfigUSE_ATOMIC_BUILTINS is 0), and the tag prevents a task that
+ * was preempted in the middle of an update from corrupting the stack if other
+ * tasks took and returned the same buffer in the meantime.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* BufferPool includes. */
+#include "aws_bufferpool.h"
+#include "aws_bufferpool_config.h"
+#include "aws_bufferpool_config_defaults.h"
+
+/* Make sure that proper config options are defined. */
+#ifndef bufferpoolconfigNUM_BUFFERS
+    #error bufferpoolconfigNUM_BUFFERS must be defined in BufferPoolConfig.h
+#endif
+
+#ifndef bufferpoolconfigBUFFER_SIZE
+    #error bufferpoolconfigBUFFER_SIZE must be defined in BufferPoolConfig.h
+#endif
+
+#if ( bufferpoolconfigNUM_BUFFERS >= 0xFFFF )
+    #error bufferpoolconfigNUM_BUFFERS must be less than 0xFFFF
+#endif
+
+/**
+ * @brief The index stored in the top of the stack when no buffer is free.
+ */
+#define bufferpoollockfreeEMPTY                                       ( ( uint32_t ) 0xFFFF )
+
+/**
+ * @brief Extracts the buffer index from the top of the stack.
+ */
+#define bufferpoollockfreeINDEX( ulTop )                              ( ( ulTop ) & ( uint32_t ) 0xFFFF )
+
+/**
+ * @brief Makes a new top of the stack with the given index, changing the tag
+ * of the current top.
+ */
+#define bufferpoollockfreeNEW_TOP( ulTop, ulIndex )                   ( ( ( ( ulTop ) + ( uint32_t ) 0x10000 ) & ( uint32_t ) 0xFFFF0000 ) | ( ulIndex ) )
+
+/**
+ * @brief Rounds the given size up to a multiple of portBYTE_ALIGNMENT.
+ *
+ * @param[in] xSize The size to round up.
+ */
+#define bufferpoollockfreeALIGN_SIZE( xSize )                         ( ( ( size_t ) ( xSize ) + ( size_t ) portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/**
+ * @brief The space taken by the metadata in front of each buffer. It keeps
+ * the data location properly aligned.
+ */
+#define bufferpoollockfreeHEADER_SIZE                                 bufferpoollockfreeALIGN_SIZE( sizeof( BufferMetadata_t ) )
+
+/**
+ * @brief The distance between two consecutive buffers.
+ */
+#define bufferpoollockfreeSTRIDE                                      ( bufferpoollockfreeHEADER_SIZE + bufferpoollockfreeALIGN_SIZE( bufferpoolconfigBUFFER_SIZE ) )
+
+/**
+ * @brief Extracts the metadata of the buffer with the given index.
+ *
+ * @param[in] ulIndex The index of the buffer.
+ */
+#define bufferpoollockfreeMETADATA( ulIndex )                         ( ( BufferMetadata_t * ) &( pucBuffers[ ( size_t ) ( ulIndex ) * bufferpoollockfreeSTRIDE ] ) )
+
+/**
+ * @brief Extracts the data location of the buffer with the given index.
+ *
+ * @param[in] ulIndex The index of the buffer.
+ */
+#define bufferpoollockfreeDATA_LOCATION( ulIndex )                    ( &( pucBuffers[ ( ( size_t ) ( ulIndex ) * bufferpoollockfreeSTRIDE ) + bufferpoollockfreeHEADER_SIZE ] ) )
+
+/**
+ * @brief Extracts the index of the buffer from the data location given to
+ * the user.
+ *
+ * @param[in] pucDataLocation The data location given to the user.
+ */
+#define bufferpoollockfreeINDEX_FROM_DATA_LOCATION( pucDataLocation ) ( ( uint32_t ) ( ( size_t ) ( ( pucDataLocation ) - pucBuffers ) / bufferpoollockfreeSTRIDE ) )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Metadata added in the beginning of each buffer.
+ */
+typedef struct BufferMetadata
+{
+    volatile uint16_t usNextFree;   /**< The index of the next free buffer. Only meaningful while the buffer is free. */
+    volatile uint8_t ucBufferInUse; /**< Whether or not the buffer is in use. */
+} BufferMetadata_t;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The storage of the statically allocated buffers, including the space
+ * needed to align the first buffer.
+ */
+static uint8_t ucBufferPool[ ( bufferpoollockfreeSTRIDE * bufferpoolconfigNUM_BUFFERS ) + portBYTE_ALIGNMENT ];
+
+/**
+ * @brief The first buffer in ucBufferPool, properly aligned.
+ */
+static uint8_t * pucBuffers = NULL;
+
+/**
+ * @brief The top of the stack of free buffers.
+ */
+static volatile uint32_t ulFreeStackTop = bufferpoollockfreeEMPTY;
+
+/**
+ * @brief The number of buffers currently in use.
+ */
+static volatile uint32_t ulBuffersInUse = 0;
+
+/**
+ * @brief The maximum number of buffers that have been in use at the same time.
+ */
+static volatile uint32_t ulHighWaterMark = 0;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Atomically replaces the value of *pulDestination with ulNew if it is
+ * ulExpected.
+ *
+ * @param[in,out] pulDestination The word to update.
+ * @param[in] ulExpected The value *pulDestination must have to be updated.
+ * @param[in] ulNew The new value.
+ *
+ * @return pdTRUE if *pulDestination was updated, pdFALSE otherwise.
+ */
+static BaseType_t prvCompareAndSwap( volatile uint32_t * pulDestination,
+                                     uint32_t ulExpected,
+                                     uint32_t ulNew );
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCompareAndSwap( volatile uint32_t * pulDestination,
+                                     uint32_t ulExpected,
+                                     uint32_t ulNew )
+{
+    BaseType_t xSwapped = pdFALSE;
+
+    #if ( bufferpoolconfigUSE_ATOMIC_BUILTINS == 1 )
+        {
+            if( __atomic_compare_exchange_n( pulDestination, &ulExpected, ulNew, pdFALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) )
+            {
+                xSwapped = pdTRUE;
+            }
+        }
+    #else
+        {
+            taskENTER_CRITICAL();
+            {
+                if( *pulDestination == ulExpected )
+                {
+                    *pulDestination = ulNew;
+                    xSwapped = pdTRUE;
+                }
+            }
+            taskEXIT_CRITICAL();
+        }
+    #endif /* bufferpoolconfigUSE_ATOMIC_BUILTINS */
+
+    return xSwapped;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t BUFFERPOOL_Init( void )
+{
+    uint32_t x;
+
+    /* This function is supposed to be called exactly once
+     * and hence no thread safety is ensured. */
+    pucBuffers = ( uint8_t * ) bufferpoollockfreeALIGN_SIZE( ucBufferPool );
+
+    /* Link all the buffers in the stack of free buffers, the first
+     * buffer being on top. */
+    for( x = 0; x < bufferpoolconfigNUM_BUFFERS; x++ )
+    {
+        bufferpoollockfreeMETADATA( x )->ucBufferInUse = 0;
+        bufferpoollockfreeMETADATA( x )->usNextFree = ( uint16_t ) ( ( ( x + 1 ) < bufferpoolconfigNUM_BUFFERS ) ? ( x + 1 ) : bufferpoollockfreeEMPTY );
+    }
+
+    ulFreeStackTop = ( bufferpoolconfigNUM_BUFFERS > 0 ) ? 0 : bufferpoollockfreeEMPTY;
+    ulBuffersInUse = 0;
+    ulHighWaterMark = 0;
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+uint8_t * BUFFERPOOL_GetFreeBuffer( uint32_t * pulBufferLength )
+{
+    uint32_t ulTop, ulIndex, ulInUse, ulHighest;
+    uint8_t * pucFreeBuffer = NULL;
+
+    /* All the buffers in the pool are of size bufferpoolconfigBUFFER_SIZE,
+     * so we cannot provide any buffer larger than that. */
+    if( *pulBufferLength <= bufferpoolconfigBUFFER_SIZE )
+    {
+        /* Pop the top of the stack of free buffers. If another task
+         * changes the top in the meantime, the tag is different and the
+         * compare and swap fails, so start over. */
+        do
+        {
+            ulTop = ulFreeStackTop;
+            ulIndex = bufferpoollockfreeINDEX( ulTop );
+        } while( ( ulIndex != bufferpoollockfreeEMPTY ) &&
+                 ( prvCompareAndSwap( &ulFreeStackTop,
+                                      ulTop,
+                                      bufferpoollockfreeNEW_TOP( ulTop, ( uint32_t ) bufferpoollockfreeMETADATA( ulIndex )->usNextFree ) ) == pdFALSE ) );
+
+        if( ulIndex != bufferpoollockfreeEMPTY )
+        {
+            bufferpoollockfreeMETADATA( ulIndex )->ucBufferInUse = 1;
+
+            /* Update the statistics. */
+            do
+            {
+                ulInUse = ulBuffersInUse;
+            } while( prvCompareAndSwap( &ulBuffersInUse, ulInUse, ulInUse + 1 ) == pdFALSE );
+
+            do
+            {
+                ulHighest = ulHighWaterMark;
+            } while( ( ( ulInUse + 1 ) > ulHighest ) &&
+                     ( prvCompareAndSwap( &ulHighWaterMark, ulHighest, ulInUse + 1 ) == pdFALSE ) );
+
+            /* Return the actual buffer size (as configured by the
+             * bufferpoolconfigBUFFER_SIZE macro) to the user. */
+            *pulBufferLength = bufferpoolconfigBUFFER_SIZE;
+
+            /* Return the data location to the user. */
+            pucFreeBuffer = bufferpoollockfreeDATA_LOCATION( ulIndex );
+        }
+    }
+
+    return pucFreeBuffer;
+}
+/*-----------------------------------------------------------*/
+
+void BUFFERPOOL_ReturnBuffer( uint8_t * const pucBuffer )
+{
+    uint32_t ulTop, ulInUse;
+    const uint32_t ulIndex = bufferpoollockfreeINDEX_FROM_DATA_LOCATION( pucBuffer );
+
+    configASSERT( ulIndex < bufferpoolconfigNUM_BUFFERS );
+
+    /* A buffer must not be returned twice. */
+    configASSERT( bufferpoollockfreeMETADATA( ulIndex )->ucBufferInUse == 1 );
+    bufferpoollockfreeMETADATA( ulIndex )->ucBufferInUse = 0;
+
+    /* Update the statistics before the buffer is free again. Once it is on
+     * the stack, another task can take it and count it before it is
+     * uncounted here, and the count would go past the number of buffers. */
+    do
+    {
+        ulInUse = ulBuffersInUse;
+    } while( prvCompareAndSwap( &ulBuffersInUse, ulInUse, ulInUse - 1 ) == pdFALSE );
+
+    /* Push the buffer on the stack of free buffers. */
+    do
+    {
+        ulTop = ulFreeStackTop;
+        bufferpoollockfreeMETADATA( ulIndex )->usNextFree = ( uint16_t ) bufferpoollockfreeINDEX( ulTop );
+    } while( prvCompareAndSwap( &ulFreeStackTop, ulTop, bufferpoollockfreeNEW_TOP( ulTop, ulIndex ) ) == pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t BUFFERPOOL_GetNumClasses( void )
+{
+    /* All the buffers are of the same size. */
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t BUFFERPOOL_GetClassStats( uint32_t ulClass,
+                                     BufferPoolClassStats_t * const pxStats )
+{
+    BaseType_t xResult = pdFAIL;
+
+    if( ulClass == 0 )
+    {
+        pxStats->ulBufferSize = bufferpoolconfigBUFFER_SIZE;
+        pxStats->ulNumBuffers = bufferpoolconfigNUM_BUFFERS;
+        pxStats->ulBuffersInUse = ulBuffersInUse;
+        pxStats->ulHighWaterMark = ulHighWaterMark;
+
+        xResult = pdPASS;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,303 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+
+/**
+ * @file aws_bufferpool_static_size_classed.c
+ * @brief A thread safe implementation of the BufferPool interface with
+ * buffers of several sizes.
+ *
+ * The statically allocated buffers are split into up to four size classes,
+ * controlled via the bufferpoolconfigCLASSn_BUFFER_SIZE and
+ * bufferpoolconfigCLASSn_NUM_BUFFERS macros. Each class keeps its free
+ * buffers in a singly linked free list, so getting and returning a buffer
+ * takes constant time. A request is served from the smallest class whose
+ * buffers are large enough and which has a free buffer.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* BufferPool includes. */
+#include "aws_bufferpool.h"
+#include "aws_bufferpool_config.h"
+#include "aws_bufferpool_config_defaults.h"
+
+/* Make sure that the size classes are in the order of increasing size. */
+#if ( bufferpoolconfigCLASS1_BUFFER_SIZE <= bufferpoolconfigCLASS0_BUFFER_SIZE ) || \
+    ( bufferpoolconfigCLASS2_BUFFER_SIZE <= bufferpoolconfigCLASS1_BUFFER_SIZE ) || \
+    ( bufferpoolconfigCLASS3_BUFFER_SIZE <= bufferpoolconfigCLASS2_BUFFER_SIZE )
+    #error The buffer sizes of the buffer pool classes must increase with the class number
+#endif
+
+/**
+ * @brief The number of size classes.
+ */
+#define bufferpoolsizeclassedNUM_CLASSES    ( 4 )
+
+/**
+ * @brief Rounds the given size up to a multiple of portBYTE_ALIGNMENT.
+ *
+ * @param[in] xSize The size to round up.
+ */
+#define bufferpoolsizeclassedALIGN_SIZE( xSize )                                  ( ( ( size_t ) ( xSize ) + ( size_t ) portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/**
+ * @brief Moves the given pointer ahead by the number of bytes required to
+ * properly align it as specified by portBYTE_ALIGNMENT.
+ *
+ * @param[in] pucPtr The given pointer to be aligned.
+ */
+#define bufferpoolsizeclassedALIGN_POINTER( pucPtr )                              ( ( uint8_t * ) bufferpoolsizeclassedALIGN_SIZE( pucPtr ) )
+
+/**
+ * @brief The space taken by the metadata in front of each buffer. It keeps
+ * the data location properly aligned.
+ */
+#define bufferpoolsizeclassedHEADER_SIZE                                          bufferpoolsizeclassedALIGN_SIZE( sizeof( BufferHeader_t ) )
+
+/**
+ * @brief The distance between two consecutive buffers of a class.
+ *
+ * @param[in] ulBufferSize The buffer size of the class.
+ */
+#define bufferpoolsizeclassedSTRIDE( ulBufferSize )                               ( bufferpoolsizeclassedHEADER_SIZE + bufferpoolsizeclassedALIGN_SIZE( ulBufferSize ) )
+
+/**
+ * @brief The storage needed by a class, including the space needed to align
+ * the first buffer.
+ *
+ * @param[in] ulBufferSize The buffer size of the class.
+ * @param[in] ulNumBuffers The number of buffers of the class.
+ */
+#define bufferpoolsizeclassedSTORAGE_SIZE( ulBufferSize, ulNumBuffers )          ( ( bufferpoolsizeclassedSTRIDE( ulBufferSize ) * ( size_t ) ( ulNumBuffers ) ) + ( size_t ) portBYTE_ALIGNMENT )
+
+/**
+ * @brief Extracts the data location of the buffer from its metadata.
+ *
+ * @param[in] pxHeader The metadata of the buffer.
+ */
+#define bufferpoolsizeclassedDATA_LOCATION_FROM_HEADER( pxHeader )                ( ( ( uint8_t * ) ( pxHeader ) ) + bufferpoolsizeclassedHEADER_SIZE )
+
+/**
+ * @brief Extracts the metadata of the buffer from its data location.
+ *
+ * @param[in] pucDataLocation The data location given to the user.
+ */
+#define bufferpoolsizeclassedHEADER_FROM_DATA_LOCATION( pucDataLocation )         ( ( BufferHeader_t * ) ( ( pucDataLocation ) - bufferpoolsizeclassedHEADER_SIZE ) )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Metadata added in the beginning of each buffer.
+ */
+typedef struct BufferHeader
+{
+    struct BufferHeader * pxNextFree; /**< The next free buffer of the same class. Only meaningful while the buffer is free. */
+    uint16_t usClass;                 /**< The class the buffer belongs to. */
+    uint8_t ucBufferInUse;            /**< Whether or not the buffer is in use. */
+} BufferHeader_t;
+
+/**
+ * @brief A class of buffers of the same size.
+ */
+typedef struct BufferClass
+{
+    uint8_t * pucStorage;        /**< The storage of the buffers of the class. */
+    uint32_t ulBufferSize;       /**< The length of each buffer of the class. */
+    uint32_t ulNumBuffers;       /**< The number of buffers of the class. */
+    BufferHeader_t * pxFreeList; /**< The free buffers of the class. */
+    uint32_t ulBuffersInUse;     /**< The number of buffers of the class currently in use. */
+    uint32_t ulHighWaterMark;    /**< The maximum number of buffers of the class that have been in use at the same time. */
+} BufferClass_t;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The statically allocated storage of each class.
+ */
+/** @{ */
+static uint8_t ucClass0Storage[ bufferpoolsizeclassedSTORAGE_SIZE( bufferpoolconfigCLASS0_BUFFER_SIZE, bufferpoolconfigCLASS0_NUM_BUFFERS ) ];
+static uint8_t ucClass1Storage[ bufferpoolsizeclassedSTORAGE_SIZE( bufferpoolconfigCLASS1_BUFFER_SIZE, bufferpoolconfigCLASS1_NUM_BUFFERS ) ];
+static uint8_t ucClass2Storage[ bufferpoolsizeclassedSTORAGE_SIZE( bufferpoolconfigCLASS2_BUFFER_SIZE, bufferpoolconfigCLASS2_NUM_BUFFERS ) ];
+static uint8_t ucClass3Storage[ bufferpoolsizeclassedSTORAGE_SIZE( bufferpoolconfigCLASS3_BUFFER_SIZE, bufferpoolconfigCLASS3_NUM_BUFFERS ) ];
+/** @} */
+
+/**
+ * @brief The size classes, in the order of increasing buffer size.
+ */
+static BufferClass_t xClasses[ bufferpoolsizeclassedNUM_CLASSES ] =
+{
+    { ucClass0Storage, bufferpoolconfigCLASS0_BUFFER_SIZE, bufferpoolconfigCLASS0_NUM_BUFFERS, NULL, 0, 0 },
+    { ucClass1Storage, bufferpoolconfigCLASS1_BUFFER_SIZE, bufferpoolconfigCLASS1_NUM_BUFFERS, NULL, 0, 0 },
+    { ucClass2Storage, bufferpoolconfigCLASS2_BUFFER_SIZE, bufferpoolconfigCLASS2_NUM_BUFFERS, NULL, 0, 0 },
+    { ucClass3Storage, bufferpoolconfigCLASS3_BUFFER_SIZE, bufferpoolconfigCLASS3_NUM_BUFFERS, NULL, 0, 0 }
+};
+/*-----------------------------------------------------------*/
+
+BaseType_t BUFFERPOOL_Init( void )
+{
+    uint32_t x, y;
+    uint8_t * pucNextBuffer;
+    BufferHeader_t * pxHeader;
+    BufferClass_t * pxClass;
+
+    /* This function is supposed to be called exactly once
+     * and hence no thread safety is ensured. */
+    for( x = 0; x < bufferpoolsizeclassedNUM_CLASSES; x++ )
+    {
+        pxClass = &( xClasses[ x ] );
+        pxClass->pxFreeList = NULL;
+        pxClass->ulBuffersInUse = 0;
+        pxClass->ulHighWaterMark = 0;
+
+        /* Align the first buffer. */
+        pucNextBuffer = bufferpoolsizeclassedALIGN_POINTER( pxClass->pucStorage );
+
+        /* Put all the buffers of the class in its free list. They are
+         * pushed in reverse so that the list starts with the first one. */
+        pucNextBuffer += bufferpoolsizeclassedSTRIDE( pxClass->ulBufferSize ) * ( size_t ) pxClass->ulNumBuffers;
+
+        for( y = 0; y < pxClass->ulNumBuffers; y++ )
+        {
+            pucNextBuffer -= bufferpoolsizeclassedSTRIDE( pxClass->ulBufferSize );
+
+            pxHeader = ( BufferHeader_t * ) pucNextBuffer; /*lint !e9087 !e826 The storage is aligned for the header. */
+            pxHeader->usClass = ( uint16_t ) x;
+            pxHeader->ucBufferInUse = 0;
+            pxHeader->pxNextFree = pxClass->pxFreeList;
+            pxClass->pxFreeList = pxHeader;
+        }
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+uint8_t * BUFFERPOOL_GetFreeBuffer( uint32_t * pulBufferLength )
+{
+    uint32_t x;
+    BufferHeader_t * pxHeader = NULL;
+    BufferClass_t * pxClass = NULL;
+
+    /* Try the classes in the order of increasing buffer size, so that
+     * the smallest free buffer that is large enough is used. */
+    for( x = 0; ( x < bufferpoolsizeclassedNUM_CLASSES ) && ( pxHeader == NULL ); x++ )
+    {
+        pxClass = &( xClasses[ x ] );
+
+        if( pxClass->ulBufferSize >= *pulBufferLength )
+        {
+            /* Start critical section. */
+            taskENTER_CRITICAL();
+
+            /* Take the first free buffer of the class, if any. */
+            pxHeader = pxClass->pxFreeList;
+
+            if( pxHeader != NULL )
+            {
+                pxClass->pxFreeList = pxHeader->pxNextFree;
+                pxHeader->ucBufferInUse = 1;
+
+                /* Update the statistics. */
+                pxClass->ulBuffersInUse++;
+
+                if( pxClass->ulBuffersInUse > pxClass->ulHighWaterMark )
+                {
+                    pxClass->ulHighWaterMark = pxClass->ulBuffersInUse;
+                }
+            }
+
+            /* End critical section. */
+            taskEXIT_CRITICAL();
+        }
+    }
+
+    if( pxHeader != NULL )
+    {
+        /* Return the actual buffer size of the class to the user. */
+        *pulBufferLength = pxClass->ulBufferSize;
+    }
+
+    /* Return the data location to the user. */
+    return ( pxHeader != NULL ) ? bufferpoolsizeclassedDATA_LOCATION_FROM_HEADER( pxHeader ) : NULL;
+}
+/*-----------------------------------------------------------*/
+
+void BUFFERPOOL_ReturnBuffer( uint8_t * const pucBuffer )
+{
+    /* The returned buffer is the data location in the actual buffer
+     * (because we gave the data location to the user). */
+    BufferHeader_t * pxHeader = bufferpoolsizeclassedHEADER_FROM_DATA_LOCATION( pucBuffer );
+    BufferClass_t * pxClass;
+
+    configASSERT( pxHeader->usClass < bufferpoolsizeclassedNUM_CLASSES );
+    pxClass = &( xClasses[ pxHeader->usClass ] );
+
+    /* Start critical section. */
+    taskENTER_CRITICAL();
+
+    /* A buffer must not be returned twice. */
+    configASSERT( pxHeader->ucBufferInUse == 1 );
+
+    /* Put the buffer back in the free list of its class. */
+    pxHeader->ucBufferInUse = 0;
+    pxHeader->pxNextFree = pxClass->pxFreeList;
+    pxClass->pxFreeList = pxHeader;
+    pxClass->ulBuffersInUse--;
+
+    /* End critical section. */
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+uint32_t BUFFERPOOL_GetNumClasses( void )
+{
+    return bufferpoolsizeclassedNUM_CLASSES;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t BUFFERPOOL_GetClassStats( uint32_t ulClass,
+                                     BufferPoolClassStats_t * const pxStats )
+{
+    BaseType_t xResult = pdFAIL;
+
+    if( ulClass < bufferpoolsizeclassedNUM_CLASSES )
+    {
+        pxStats->ulBufferSize = xClasses[ ulClass ].ulBufferSize;
+        pxStats->ulNumBuffers = xClasses[ ulClass ].ulNumBuffers;
+
+        taskENTER_CRITICAL();
+        {
+            pxStats->ulBuffersInUse = xClasses[ ulClass ].ulBuffersInUse;
+            pxStats->ulHighWaterMark = xClasses[ ulClass ].ulHighWaterMark;
+        }
+        taskEXIT_CRITICAL();
+
+        xResult = pdPASS;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
@@ -112,6 +112,16 @@ typedef struct BufferMetadata
  * to store the metadata and to ensure alignment.
  */
 static uint8_t ucBufferPool[ bufferpoolconfigNUM_BUFFERS ][ sizeof( BufferMetadata_t ) + bufferpoolconfigBUFFER_SIZE + ( portBYTE_ALIGNMENT - 1 ) ];
+
+/**
+ * @brief The number of buffers currently in use.
+ */
+static uint32_t ulBuffersInUse = 0;
+
+/**
+ * @brief The maximum number of buffers that have been in use at the same time.
+ */
+static uint32_t ulHighWaterMark = 0;
 /*-----------------------------------------------------------*/
 
 BaseType_t BUFFERPOOL_Init( void )
@@ -151,6 +161,14 @@ uint8_t * BUFFERPOOL_GetFreeBuffer( uint32_t * pulBufferLength )
                 /* Mark the buffer as "in-use". */
                 bufferpoolstaticBUFFER_IN_USE( ucBufferPool[ x ] ) = 1;
 
+                /* Update the statistics. */
+                ulBuffersInUse++;
+
+                if( ulBuffersInUse > ulHighWaterMark )
+                {
+                    ulHighWaterMark = ulBuffersInUse;
+                }
+
                 /* End critical section. The further operations in this
                  * if branch do not modify the buffer and hence the critical
                  * section is not needed hereafter. */
@@ -187,8 +205,40 @@ void BUFFERPOOL_ReturnBuffer( uint8_t * const pucBuffer )
      * location in the actual buffer (because we gave the data location
      * to the user). */
     bufferpoolstaticBUFFER_IN_USE_FROM_DATA_LOCATION( pucBuffer ) = 0;
+    ulBuffersInUse--;
 
     /* End critical section. */
     taskEXIT_CRITICAL();
 }
 /*-----------------------------------------------------------*/
+
+uint32_t BUFFERPOOL_GetNumClasses( void )
+{
+    /* All the buffers are of the same size. */
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t BUFFERPOOL_GetClassStats( uint32_t ulClass,
+                                     BufferPoolClassStats_t * const pxStats )
+{
+    BaseType_t xResult = pdFAIL;
+
+    if( ulClass == 0 )
+    {
+        pxStats->ulBufferSize = bufferpoolconfigBUFFER_SIZE;
+        pxStats->ulNumBuffers = bufferpoolconfigNUM_BUFFERS;
+
+        taskENTER_CRITICAL();
+        {
+            pxStats->ulBuffersInUse = ulBuffersInUse;
+            pxStats->ulHighWaterMark = ulHighWaterMark;
+        }
+        taskEXIT_CRITICAL();
+
+        xResult = pdPASS;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
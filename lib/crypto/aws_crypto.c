@@ -27,7 +27,9 @@
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "FreeRTOSIPConfig.h"
+#include "task.h"
 #include "aws_crypto.h"
+#include "aws_crypto_config_defaults.h"
 
 /* mbedTLS includes. */
 #include "mbedtls/config.h"
@@ -35,6 +37,7 @@
 #include "mbedtls/sha256.h"
 #include "mbedtls/sha1.h"
 #include "mbedtls/pk.h"
+#include "mbedtls/ecdsa.h"
 #include "mbedtls/x509_crt.h"
 
 /* C runtime includes. */
@@ -51,6 +54,22 @@ typedef struct SignatureVerificationState
     mbedtls_sha256_context xSHA256Context;
 } SignatureVerificationState_t, * SignatureVerificationStatePtr_t;
 
+#if ( cryptoconfigCACHE_SIGNER_KEY == 1 )
+
+/**
+ * @brief Public key of the last signer certificate
+ */
+typedef struct SignerKeyCache
+{
+    BaseType_t xInUse;                                      /**< A verification is using the key. */
+    BaseType_t xValid;                                      /**< xPublicKey holds a key. */
+    uint8_t ucCertificateHash[ cryptoSHA256_DIGEST_BYTES ]; /**< SHA-256 of the certificate of the key. */
+    mbedtls_pk_context xPublicKey;
+} SignerKeyCache_t;
+
+static SignerKeyCache_t xSignerKeyCache;
+#endif /* if ( cryptoconfigCACHE_SIGNER_KEY == 1 ) */
+
 /*
  * Helper routines
  */
@@ -71,6 +90,45 @@ static void * prvCalloc( size_t xNmemb,
     return pvNew;
 }
 
+/**
+ * @brief Parses the public key out of the signer certificate.
+ */
+static BaseType_t prvParseSignerKey( char * pcSignerCertificate,
+                                     size_t xSignerCertificateLength,
+                                     mbedtls_pk_context * pxPublicKey )
+{
+    BaseType_t xResult = pdTRUE;
+    mbedtls_x509_crt xCertCtx;
+
+    /*
+     * Decode and create a certificate context
+     */
+    mbedtls_x509_crt_init( &xCertCtx );
+
+    if( 0 != mbedtls_x509_crt_parse(
+            &xCertCtx, ( const unsigned char * ) pcSignerCertificate, xSignerCertificateLength ) )
+    {
+        xResult = pdFALSE;
+    }
+
+    /*
+     * Take the public key out of the certificate, so that the rest of the
+     * certificate can be freed
+     */
+    if( pdTRUE == xResult )
+    {
+        *pxPublicKey = xCertCtx.pk;
+        mbedtls_pk_init( &xCertCtx.pk );
+    }
+
+    /*
+     * Clean-up
+     */
+    mbedtls_x509_crt_free( &xCertCtx );
+
+    return xResult;
+}
+
 /**
  * @brief Verifies a cryptographic signature based on the signer
  * certificate, hash algorithm, and the data that was signed.
@@ -84,11 +142,16 @@ static BaseType_t prvVerifySignature( char * pcSignerCertificate,
                                       size_t xSignatureLength )
 {
     BaseType_t xResult = pdTRUE;
-    mbedtls_x509_crt xCertCtx;
+    mbedtls_pk_context xPublicKey;
+    mbedtls_pk_context * pxPublicKey = &xPublicKey;
     mbedtls_md_type_t xMbedHashAlg = MBEDTLS_MD_SHA256;
 
+    #if ( cryptoconfigCACHE_SIGNER_KEY == 1 )
+        BaseType_t xUseCache = pdFALSE;
+        uint8_t ucCertificateHash[ cryptoSHA256_DIGEST_BYTES ];
+    #endif
 
-    memset( &xCertCtx, 0, sizeof( mbedtls_x509_crt ) );
+    mbedtls_pk_init( &xPublicKey );
 
     /*
      * Map the hash algorithm
@@ -98,15 +161,57 @@ static BaseType_t prvVerifySignature( char * pcSignerCertificate,
         xMbedHashAlg = MBEDTLS_MD_SHA1;
     }
 
-    /*
-     * Decode and create a certificate context
-     */
-    mbedtls_x509_crt_init( &xCertCtx );
+    #if ( cryptoconfigCACHE_SIGNER_KEY == 1 )
+        {
+            /*
+             * Use the key of the last certificate if it is the same one. A
+             * verification running at the same time in another task parses
+             * its own copy instead.
+             */
+            taskENTER_CRITICAL();
+            {
+                if( pdFALSE == xSignerKeyCache.xInUse )
+                {
+                    xSignerKeyCache.xInUse = pdTRUE;
+                    xUseCache = pdTRUE;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( pdTRUE == xUseCache )
+            {
+                ( void ) mbedtls_sha256_ret( ( const unsigned char * ) pcSignerCertificate,
+                                             xSignerCertificateLength,
+                                             ucCertificateHash,
+                                             0 );
+
+                if( ( pdTRUE == xSignerKeyCache.xValid ) &&
+                    ( 0 == memcmp( ucCertificateHash, xSignerKeyCache.ucCertificateHash, sizeof( ucCertificateHash ) ) ) )
+                {
+                    pxPublicKey = &xSignerKeyCache.xPublicKey;
+                }
+            }
+        }
+    #endif /* if ( cryptoconfigCACHE_SIGNER_KEY == 1 ) */
 
-    if( 0 != mbedtls_x509_crt_parse(
-            &xCertCtx, ( const unsigned char * ) pcSignerCertificate, xSignerCertificateLength ) )
+    if( pxPublicKey == &xPublicKey )
     {
-        xResult = pdFALSE;
+        xResult = prvParseSignerKey( pcSignerCertificate,
+                                     xSignerCertificateLength,
+                                     &xPublicKey );
+
+        #if ( cryptoconfigCACHE_SIGNER_KEY == 1 )
+            if( ( pdTRUE == xResult ) && ( pdTRUE == xUseCache ) )
+            {
+                /* Keep the key for the next verification. */
+                mbedtls_pk_free( &xSignerKeyCache.xPublicKey );
+                xSignerKeyCache.xPublicKey = xPublicKey;
+                memcpy( xSignerKeyCache.ucCertificateHash, ucCertificateHash, sizeof( ucCertificateHash ) );
+                xSignerKeyCache.xValid = pdTRUE;
+                mbedtls_pk_init( &xPublicKey );
+                pxPublicKey = &xSignerKeyCache.xPublicKey;
+            }
+        #endif
     }
 
     /*
@@ -114,13 +219,27 @@ static BaseType_t prvVerifySignature( char * pcSignerCertificate,
      */
     if( pdTRUE == xResult )
     {
-        if( 0 != mbedtls_pk_verify(
-                &xCertCtx.pk,
-                xMbedHashAlg,
-                pucHash,
-                xHashLength,
-                pucSignature,
-                xSignatureLength ) )
+        if( MBEDTLS_PK_ECKEY == mbedtls_pk_get_type( pxPublicKey ) )
+        {
+            /* mbedtls_pk_verify would verify with a copy of the key, which
+             * computes the comb table of the generator again every time. */
+            if( 0 != mbedtls_ecdsa_read_signature(
+                    mbedtls_pk_ec( *pxPublicKey ),
+                    pucHash,
+                    xHashLength,
+                    pucSignature,
+                    xSignatureLength ) )
+            {
+                xResult = pdFALSE;
+            }
+        }
+        else if( 0 != mbedtls_pk_verify(
+                     pxPublicKey,
+                     xMbedHashAlg,
+                     pucHash,
+                     xHashLength,
+                     pucSignature,
+                     xSignatureLength ) )
         {
             xResult = pdFALSE;
         }
@@ -129,7 +248,14 @@ static BaseType_t prvVerifySignature( char * pcSignerCertificate,
     /*
      * Clean-up
      */
-    mbedtls_x509_crt_free( &xCertCtx );
+    #if ( cryptoconfigCACHE_SIGNER_KEY == 1 )
+        if( pdTRUE == xUseCache )
+        {
+            xSignerKeyCache.xInUse = pdFALSE;
+        }
+    #endif
+
+    mbedtls_pk_free( &xPublicKey );
 
     return xResult;
 }
@@ -270,3 +396,55 @@ BaseType_t CRYPTO_SignatureVerificationFinal( void * pvContext,
 
     return xResult;
 }
+
+/**
+ * @brief Frees a signature verification context without verifying anything.
+ */
+void CRYPTO_SignatureVerificationAbort( void * pvContext )
+{
+    SignatureVerificationStatePtr_t pxCtx =
+        ( SignatureVerificationStatePtr_t ) pvContext; /*lint !e9087 Allow casting void* to other types. */
+
+    if( NULL != pxCtx )
+    {
+        /* The free functions also clear the partial hash. */
+        if( cryptoHASH_ALGORITHM_SHA1 == pxCtx->xHashAlgorithm )
+        {
+            mbedtls_sha1_free( &pxCtx->xSHA1Context );
+        }
+        else
+        {
+            mbedtls_sha256_free( &pxCtx->xSHA256Context );
+        }
+
+        vPortFree( pxCtx );
+    }
+}
+
+/**
+ * @brief Frees the public key kept from the last signer certificate.
+ */
+void CRYPTO_ClearSignerKeyCache( void )
+{
+    #if ( cryptoconfigCACHE_SIGNER_KEY == 1 )
+        BaseType_t xClear = pdFALSE;
+
+        taskENTER_CRITICAL();
+        {
+            if( pdFALSE == xSignerKeyCache.xInUse )
+            {
+                xSignerKeyCache.xInUse = pdTRUE;
+                xClear = pdTRUE;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        /* A key being used is left for the next call. */
+        if( pdTRUE == xClear )
+        {
+            mbedtls_pk_free( &xSignerKeyCache.xPublicKey );
+            xSignerKeyCache.xValid = pdFALSE;
+            xSignerKeyCache.xInUse = pdFALSE;
+        }
+    #endif
+}
@@ -0,0 +1,277 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_heap_trace.c
+ * @brief Records the allocations and frees of the FreeRTOS heap.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Heap trace includes. */
+#include "aws_heap_trace.h"
+#include "aws_heap_trace_config_defaults.h"
+
+/**
+ * @brief The name of a task that called the heap while recording.
+ */
+typedef struct HeapTraceTask
+{
+    TaskHandle_t xTask;                      /**< The task. */
+    char cName[ configMAX_TASK_NAME_LEN ];   /**< Its name when it was first recorded. */
+} HeapTraceTask_t;
+
+/*-----------------------------------------------------------*/
+
+/* The ring, and the number of calls recorded since the start. The next
+ * record is written at ulRecorded modulo the length of the ring. */
+static HeapTraceRecord_t xRing[ heaptraceconfigRING_LENGTH ];
+static uint32_t ulRecorded = 0;
+
+/* The tasks recorded, for their names. */
+static HeapTraceTask_t xTasks[ heaptraceconfigMAX_TASKS ];
+static UBaseType_t uxTaskCount = 0;
+
+/* Set while the hooks record. */
+static BaseType_t xRecording = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Records a call to the heap.
+ *
+ * Called with the scheduler suspended.
+ *
+ * @param[in] pvAddress The memory allocated or freed.
+ * @param[in] xSize The size of the block.
+ * @param[in] pvCaller The return address of the call to the heap.
+ * @param[in] xIsFree pdTRUE for a free.
+ */
+static void prvRecord( void * pvAddress,
+                       size_t xSize,
+                       void * pvCaller,
+                       BaseType_t xIsFree );
+
+/**
+ * @brief Keeps the name of a task the first time it is recorded.
+ *
+ * Called with the scheduler suspended.
+ *
+ * @param[in] xTask The task recorded.
+ */
+static void prvRememberTask( TaskHandle_t xTask );
+
+/*-----------------------------------------------------------*/
+
+static void prvRecord( void * pvAddress,
+                       size_t xSize,
+                       void * pvCaller,
+                       BaseType_t xIsFree )
+{
+    HeapTraceRecord_t * pxRecord = NULL;
+
+    if( ( pdTRUE == xRecording ) && ( NULL != pvAddress ) )
+    {
+        pxRecord = &xRing[ ulRecorded % heaptraceconfigRING_LENGTH ];
+        ulRecorded++;
+
+        pxRecord->pvAddress = pvAddress;
+        pxRecord->pvCaller = pvCaller;
+        pxRecord->xTask = NULL;
+        pxRecord->ulTime = heaptraceconfigGET_TIME();
+        pxRecord->ulSize = ( uint32_t ) xSize;
+        pxRecord->xIsFree = xIsFree;
+
+        if( taskSCHEDULER_NOT_STARTED != xTaskGetSchedulerState() )
+        {
+            pxRecord->xTask = xTaskGetCurrentTaskHandle();
+            prvRememberTask( pxRecord->xTask );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvRememberTask( TaskHandle_t xTask )
+{
+    UBaseType_t uxTask = 0;
+
+    for( uxTask = 0; uxTask < uxTaskCount; uxTask++ )
+    {
+        if( xTasks[ uxTask ].xTask == xTask )
+        {
+            break;
+        }
+    }
+
+    if( ( uxTask == uxTaskCount ) && ( uxTaskCount < heaptraceconfigMAX_TASKS ) )
+    {
+        xTasks[ uxTask ].xTask = xTask;
+        ( void ) strncpy( xTasks[ uxTask ].cName, pcTaskGetName( xTask ), configMAX_TASK_NAME_LEN - 1 );
+        xTasks[ uxTask ].cName[ configMAX_TASK_NAME_LEN - 1 ] = '\0';
+        uxTaskCount++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void HEAPTRACE_Start( void )
+{
+    vTaskSuspendAll();
+    {
+        ulRecorded = 0;
+        uxTaskCount = 0;
+        xRecording = pdTRUE;
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void HEAPTRACE_Stop( void )
+{
+    vTaskSuspendAll();
+    {
+        xRecording = pdFALSE;
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+size_t HEAPTRACE_Read( HeapTraceRecord_t * pxRecords,
+                       size_t xMaxRecords,
+                       uint32_t * pulRecorded )
+{
+    uint32_t ulFirst = 0;
+    size_t xCount = 0;
+
+    configASSERT( ( NULL != pxRecords ) || ( 0 == xMaxRecords ) );
+
+    vTaskSuspendAll();
+    {
+        /* The oldest record still in the ring. */
+        if( ulRecorded > heaptraceconfigRING_LENGTH )
+        {
+            ulFirst = ulRecorded - heaptraceconfigRING_LENGTH;
+        }
+
+        if( ( ulRecorded - ulFirst ) > xMaxRecords )
+        {
+            ulFirst = ulRecorded - ( uint32_t ) xMaxRecords;
+        }
+
+        for( ; ulFirst < ulRecorded; ulFirst++ )
+        {
+            pxRecords[ xCount++ ] = xRing[ ulFirst % heaptraceconfigRING_LENGTH ];
+        }
+
+        if( NULL != pulRecorded )
+        {
+            *pulRecorded = ulRecorded;
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return xCount;
+}
+/*-----------------------------------------------------------*/
+
+void HEAPTRACE_Dump( void )
+{
+    BaseType_t xWasRecording = pdFALSE;
+    uint32_t ulIndex = 0;
+    UBaseType_t uxTask = 0;
+    const HeapTraceRecord_t * pxRecord = NULL;
+
+    vTaskSuspendAll();
+    {
+        xWasRecording = xRecording;
+        xRecording = pdFALSE;
+    }
+    ( void ) xTaskResumeAll();
+
+    if( ulRecorded > heaptraceconfigRING_LENGTH )
+    {
+        ulIndex = ulRecorded - heaptraceconfigRING_LENGTH;
+    }
+
+    /* The address of this function lets the report find the call sites in
+     * the symbols of an image that was relocated when it was loaded. The
+     * addresses are printed as unsigned long, as the printf behind
+     * configPRINTF on many ports has no long long. */
+    configPRINTF( ( "HEAPTRACE,BEGIN,%lu,%lu,%lu,%lu,0x%lx\r\n",
+                    ( unsigned long ) ulRecorded,
+                    ( unsigned long ) ( ulRecorded - ulIndex ),
+                    ( unsigned long ) xPortGetFreeHeapSize(),
+                    ( unsigned long ) xPortGetMinimumEverFreeHeapSize(),
+                    ( unsigned long ) ( uintptr_t ) HEAPTRACE_Dump ) );
+
+    for( uxTask = 0; uxTask < uxTaskCount; uxTask++ )
+    {
+        configPRINTF( ( "HEAPTRACE,TASK,0x%lx,%s\r\n",
+                        ( unsigned long ) ( uintptr_t ) xTasks[ uxTask ].xTask,
+                        xTasks[ uxTask ].cName ) );
+    }
+
+    for( ; ulIndex < ulRecorded; ulIndex++ )
+    {
+        pxRecord = &xRing[ ulIndex % heaptraceconfigRING_LENGTH ];
+
+        configPRINTF( ( "HEAPTRACE,%c,%lu,0x%lx,0x%lx,0x%lx,%lu\r\n",
+                        ( pdTRUE == pxRecord->xIsFree ) ? 'F' : 'M',
+                        ( unsigned long ) pxRecord->ulTime,
+                        ( unsigned long ) ( uintptr_t ) pxRecord->xTask,
+                        ( unsigned long ) ( uintptr_t ) pxRecord->pvCaller,
+                        ( unsigned long ) ( uintptr_t ) pxRecord->pvAddress,
+                        ( unsigned long ) pxRecord->ulSize ) );
+    }
+
+    configPRINTF( ( "HEAPTRACE,END\r\n" ) );
+
+    vTaskSuspendAll();
+    {
+        xRecording = xWasRecording;
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void HEAPTRACE_Malloc( void * pvAddress,
+                       size_t xSize,
+                       void * pvCaller )
+{
+    prvRecord( pvAddress, xSize, pvCaller, pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+void HEAPTRACE_Free( void * pvAddress,
+                     size_t xSize,
+                     void * pvCaller )
+{
+    prvRecord( pvAddress, xSize, pvCaller, pdTRUE );
+}
+/*-----------------------------------------------------------*/
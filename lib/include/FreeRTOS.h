@@ -824,6 +824,59 @@ extern "C" {
 	#define configSUPPORT_DYNAMIC_ALLOCATION 1
 #endif
 
+#ifndef configSEMAPHORE_POOL_LENGTH
+	/* The number of semaphores and mutexes that xQueueGenericCreate() takes
+	from a pool of fixed size blocks in queue.c rather than from the heap.
+	Defaults to 0, all are allocated from the heap. */
+	#define configSEMAPHORE_POOL_LENGTH 0
+#endif
+
+#ifndef configQUEUE_POOL_LENGTH
+	/* The number of queues whose storage area is at most
+	configQUEUE_POOL_STORAGE_SIZE bytes that xQueueGenericCreate() takes from a
+	pool of fixed size blocks in queue.c rather than from the heap.  Defaults
+	to 0, all are allocated from the heap. */
+	#define configQUEUE_POOL_LENGTH 0
+#endif
+
+#ifndef configQUEUE_POOL_STORAGE_SIZE
+	#define configQUEUE_POOL_STORAGE_SIZE 0
+#endif
+
+#ifndef configTIMER_POOL_LENGTH
+	/* The number of software timers that xTimerCreate() takes from a pool of
+	fixed size blocks in timers.c rather than from the heap.  Defaults to 0,
+	all are allocated from the heap. */
+	#define configTIMER_POOL_LENGTH 0
+#endif
+
+#ifndef configUSE_TIMER_WHEEL
+	/* Set to 1 to keep the active software timers in a hierarchical timing
+	wheel in timers.c, on which starting, stopping and resetting a timer takes
+	the same time whatever the number of active timers.  Defaults to 0, active
+	timers are kept in lists sorted by expiry time. */
+	#define configUSE_TIMER_WHEEL 0
+#endif
+
+#ifndef configTIMER_WHEEL_LEVELS
+	/* The number of levels of the timing wheel.  Each level is 32 lists, and
+	the wheel reaches 32 ^ configTIMER_WHEEL_LEVELS ticks ahead.  Timers that
+	expire further ahead are filed again each time the top level comes round. */
+	#define configTIMER_WHEEL_LEVELS 4
+#endif
+
+#ifndef configUSE_TIMER_COMMAND_COALESCING
+	/* Set to 1 to leave start, reset, stop and change period commands in the
+	timer for the timer service task to collect, rather than queue a message
+	per command.  Commands sent to a timer before the timer service task runs
+	collapse into one, and a message is only queued to wake the timer service
+	task when no command is pending.  These commands then never block.  The
+	timer service task only collects them once its queue is empty, so they can
+	take effect after functions pended with xTimerPendFunctionCall() after
+	them, and after a delete is processed the pending command is dropped. */
+	#define configUSE_TIMER_COMMAND_COALESCING 0
+#endif
+
 #ifndef configSTACK_DEPTH_TYPE
 	/* Defaults to uint16_t for backward compatibility, but can be overridden
 	in FreeRTOSConfig.h if uint16_t is too restrictive. */
@@ -841,6 +894,10 @@ extern "C" {
 	#error configSUPPORT_STATIC_ALLOCATION and configSUPPORT_DYNAMIC_ALLOCATION cannot both be 0, but can both be 1.
 #endif
 
+#if( ( configQUEUE_POOL_LENGTH > 0 ) && ( configQUEUE_POOL_STORAGE_SIZE == 0 ) )
+	#error configQUEUE_POOL_STORAGE_SIZE must be set if configQUEUE_POOL_LENGTH is not 0.  Use configSEMAPHORE_POOL_LENGTH to pool queues without a storage area.
+#endif
+
 #if( ( configUSE_RECURSIVE_MUTEXES == 1 ) && ( configUSE_MUTEXES != 1 ) )
 	#error configUSE_MUTEXES must be set to 1 to use recursive mutexes
 #endif
@@ -1128,6 +1185,11 @@ typedef struct xSTATIC_TIMER
 	TickType_t			xDummy3;
 	UBaseType_t			uxDummy4;
 	void 				*pvDummy5[ 2 ];
+	#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+		StaticListItem_t	xDummy8;
+		TickType_t		xDummy9[ 2 ];
+		BaseType_t		xDummy10;
+	#endif
 	#if( configUSE_TRACE_FACILITY == 1 )
 		UBaseType_t		uxDummy6;
 	#endif
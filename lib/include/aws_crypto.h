@@ -92,4 +92,22 @@ BaseType_t CRYPTO_SignatureVerificationFinal( void * pvContext,
                                               uint8_t * pucSignature,
                                               size_t xSignatureLength );
 
+/**
+ * @brief Frees a signature verification context without verifying anything.
+ *
+ * For a verification that is abandoned, for example when a download is
+ * aborted, instead of CRYPTO_SignatureVerificationFinal().
+ *
+ * @param[in] pvContext Opaque context structure, or NULL.
+ */
+void CRYPTO_SignatureVerificationAbort( void * pvContext );
+
+/**
+ * @brief Frees the public key kept from the last signer certificate.
+ *
+ * Only does something if cryptoconfigCACHE_SIGNER_KEY is set to 1. The next
+ * signature verification parses its signer certificate again.
+ */
+void CRYPTO_ClearSignerKeyCache( void );
+
 #endif /* ifndef __AWS_CRYPTO__H__ */
@@ -0,0 +1,129 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_heap_trace.h
+ * @brief Records the allocations and frees of the FreeRTOS heap.
+ *
+ * While started, every pvPortMalloc and vPortFree is recorded in a ring of
+ * heaptraceconfigRING_LENGTH records with the address and size of the block,
+ * the address of the caller, the calling task and a time stamp. Once the
+ * ring is full the oldest records are overwritten. HEAPTRACE_Dump prints the
+ * ring, which demos/common/tools/heap_trace/heap_trace_report.py turns into
+ * the heap in use per task and per call site, and the holes between the
+ * blocks in use.
+ *
+ * Tracing is opt-in: the heap trace macros of the application must call the
+ * hooks, e.g. in FreeRTOSConfig.h:
+ * @code
+ * extern void HEAPTRACE_Malloc( void * pvAddress, size_t xSize, void * pvCaller );
+ * extern void HEAPTRACE_Free( void * pvAddress, size_t xSize, void * pvCaller );
+ * #define traceMALLOC( pvAddress, uiSize )    HEAPTRACE_Malloc( pvAddress, uiSize, __builtin_return_address( 0 ) )
+ * #define traceFREE( pvAddress, uiSize )      HEAPTRACE_Free( pvAddress, uiSize, __builtin_return_address( 0 ) )
+ * @endcode
+ *
+ * The trace macros expand in pvPortMalloc and vPortFree, so the return
+ * address is the function that called the heap. Allocations made through a
+ * wrapper, such as the calloc that mbedTLS is given by CRYPTO_ConfigureHeap,
+ * are all recorded at the wrapper; the task still tells them apart.
+ */
+
+#ifndef _AWS_HEAP_TRACE_H_
+#define _AWS_HEAP_TRACE_H_
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief A recorded allocation or free.
+ */
+typedef struct HeapTraceRecord
+{
+    void * pvAddress;   /**< The memory returned by pvPortMalloc or passed to vPortFree. */
+    void * pvCaller;    /**< The return address of the call to the heap. */
+    TaskHandle_t xTask; /**< The task that called the heap, or NULL before the scheduler started. */
+    uint32_t ulTime;    /**< The time stamp of heaptraceconfigGET_TIME(). */
+    uint32_t ulSize;    /**< The size of the block, header included, as reported by the heap. */
+    BaseType_t xIsFree; /**< pdTRUE for vPortFree, pdFALSE for pvPortMalloc. */
+} HeapTraceRecord_t;
+
+/**
+ * @brief Clear the ring and start recording.
+ */
+void HEAPTRACE_Start( void );
+
+/**
+ * @brief Stop recording. The records are kept until the next start.
+ */
+void HEAPTRACE_Stop( void );
+
+/**
+ * @brief Copy the records out of the ring, the oldest first.
+ *
+ * @param[out] pxRecords Array the records are copied to.
+ * @param[in] xMaxRecords The number of entries in pxRecords. The newest
+ * records are copied if there are more than this in the ring.
+ * @param[out] pulRecorded The number of calls recorded since the start,
+ * including the ones overwritten in the ring. Can be NULL.
+ *
+ * @return The number of records copied.
+ */
+size_t HEAPTRACE_Read( HeapTraceRecord_t * pxRecords,
+                       size_t xMaxRecords,
+                       uint32_t * pulRecorded );
+
+/**
+ * @brief Print the ring with configPRINTF, for heap_trace_report.py.
+ *
+ * Recording is paused while the ring is printed, so that the heap used to
+ * print it is not recorded. The lines start with "HEAPTRACE," and can be
+ * preceded by anything the logging adds.
+ */
+void HEAPTRACE_Dump( void );
+
+/**
+ * @brief Heap trace hooks, see the top of this file.
+ *
+ * Called by the heap with the scheduler suspended. Allocations that fail are
+ * not recorded.
+ *
+ * @param[in] pvAddress The memory returned by pvPortMalloc or passed to
+ * vPortFree.
+ * @param[in] xSize The size of the block, as reported by the heap.
+ * @param[in] pvCaller The return address of the call to the heap.
+ */
+void HEAPTRACE_Malloc( void * pvAddress,
+                       size_t xSize,
+                       void * pvCaller );
+void HEAPTRACE_Free( void * pvAddress,
+                     size_t xSize,
+                     void * pvCaller );
+
+#endif /* _AWS_HEAP_TRACE_H_ */
@@ -186,6 +186,21 @@ typedef struct MQTTAgentPublishParams
     uint32_t ulDataLength;    /**< Length of the data. */
 } MQTTAgentPublishParams_t;
 
+/**
+ * @brief Signature of the callback invoked when a publish initiated with
+ * MQTT_AGENT_PublishAsync completes.
+ *
+ * The callback is invoked in the context of the MQTT agent task and therefore
+ * must not call any MQTT agent API.
+ *
+ * @param[in] pvCompletionContext The context as provided to MQTT_AGENT_PublishAsync.
+ * @param[in] xResult eMQTTAgentSuccess if the message was sent (QoS0) or acknowledged
+ * by the broker (QoS1), eMQTTAgentTimeout if the PUBACK was not received in time and
+ * eMQTTAgentFailure if the client got disconnected before the PUBACK was received.
+ */
+typedef void ( * MQTTAgentPublishCallback_t ) ( void * pvCompletionContext,
+                                                MQTTAgentReturnCode_t xResult );
+
 /**
  * @brief MQTT library Init function.
  *
@@ -339,6 +354,79 @@ MQTTAgentReturnCode_t MQTT_AGENT_Publish( MQTTAgentHandle_t xMQTTHandle,
                                           const MQTTAgentPublishParams_t * const pxPublishParams,
                                           TickType_t xTimeoutTicks );
 
+/**
+ * @brief Publishes a message to a given topic without waiting for the PUBACK.
+ *
+ * Unlike MQTT_AGENT_Publish, this function returns as soon as the message has been
+ * sent to the broker, and the result of a QoS1 publish is reported later by calling
+ * pxCompletionCallback when the PUBACK is received. A task can therefore have many
+ * QoS1 messages waiting for PUBACK at the same time.
+ *
+ * At most mqttconfigMAX_INFLIGHT_PUBLISHES QoS1 messages per client can wait for
+ * PUBACK. If that many are already waiting, this function blocks until one of them
+ * completes or xTimeoutTicks expires.
+ *
+ * @note This function alters the calling task's notification state and value. If xTimeoutTicks
+ * is short the calling task's notification state and value may be updated after
+ * MQTT_AGENT_PublishAsync() has returned.
+ *
+ * @param[in] xMQTTHandle The opaque handle as returned from MQTT_AGENT_Create.
+ * @param[in] pxPublishParams Publish parameters.
+ * @param[in] pxCompletionCallback Callback invoked when the publish completes. It is only
+ * invoked if this function returns eMQTTAgentSuccess. Can be NULL.
+ * @param[in] pvCompletionContext Passed as it is to pxCompletionCallback.
+ * @param[in] xTimeoutTicks Maximum time in ticks to wait for the message to be sent, and
+ * then for the PUBACK to be received. Use pdMS_TO_TICKS macro to convert milliseconds to
+ * ticks.
+ *
+ * @return eMQTTAgentSuccess if the message was sent, otherwise an error code explaining the
+ * reason of the failure is returned.
+ */
+MQTTAgentReturnCode_t MQTT_AGENT_PublishAsync( MQTTAgentHandle_t xMQTTHandle,
+                                               const MQTTAgentPublishParams_t * const pxPublishParams,
+                                               MQTTAgentPublishCallback_t pxCompletionCallback,
+                                               void * pvCompletionContext,
+                                               TickType_t xTimeoutTicks );
+
+/**
+ * @brief Publishes several messages which are sent to the broker together.
+ *
+ * All the messages are serialized into one buffer and sent with a single send
+ * call, so that a burst of small messages shares one TLS record and TCP segment
+ * instead of taking one each. All the messages together must fit in one buffer
+ * from the buffer pool.
+ *
+ * Like MQTT_AGENT_PublishAsync, this function returns as soon as the messages have
+ * been sent, and pxCompletionCallback is invoked once for each message when it
+ * completes. The QoS1 messages take entries in the in-flight window and this
+ * function blocks until there is room for all of them or xTimeoutTicks expires.
+ *
+ * @note This function alters the calling task's notification state and value. If xTimeoutTicks
+ * is short the calling task's notification state and value may be updated after
+ * MQTT_AGENT_PublishBatch() has returned.
+ *
+ * @param[in] xMQTTHandle The opaque handle as returned from MQTT_AGENT_Create.
+ * @param[in] pxPublishParams Array of publish parameters, one per message.
+ * @param[in] ulPublishCount The number of messages in pxPublishParams. It must not be
+ * more than mqttconfigMAX_PUBLISH_BATCH, and the number of QoS1 messages must not be
+ * more than mqttconfigMAX_INFLIGHT_PUBLISHES.
+ * @param[in] pxCompletionCallback Callback invoked when each of the messages completes.
+ * It is only invoked if this function returns eMQTTAgentSuccess. Can be NULL.
+ * @param[in] pvCompletionContext Passed as it is to pxCompletionCallback.
+ * @param[in] xTimeoutTicks Maximum time in ticks to wait for the messages to be sent, and
+ * then for each PUBACK to be received. Use pdMS_TO_TICKS macro to convert milliseconds to
+ * ticks.
+ *
+ * @return eMQTTAgentSuccess if all the messages were sent, otherwise an error code explaining
+ * the reason of the failure is returned. In case of failure, none of the messages was sent.
+ */
+MQTTAgentReturnCode_t MQTT_AGENT_PublishBatch( MQTTAgentHandle_t xMQTTHandle,
+                                               const MQTTAgentPublishParams_t * const pxPublishParams,
+                                               uint32_t ulPublishCount,
+                                               MQTTAgentPublishCallback_t pxCompletionCallback,
+                                               void * pvCompletionContext,
+                                               TickType_t xTimeoutTicks );
+
 /**
  * @brief Returns the buffer provided in the publish callback.
  *
@@ -423,10 +423,39 @@ typedef void ( * MQTTReturnBuffer_t ) ( uint8_t * pucBuffer );
         MQTTPublishCallback_t pxPublishCallback;                                  /**< The callback associated with this subscription. */
         MQTTBool_t xInUse;                                                        /**< Tracks whether the subscription entry is in-use. */
         MQTTTopicFilterType_t xTopicFilterType;                                   /**< The type of the topic filter. */
+        #if ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+            uint16_t usTrieNode;                                                  /**< The trie node for the last level of the topic filter. */
+        #endif
     } MQTTSubscription_t;
 
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 
+/**
+ * @brief One topic level in the topic filter trie.
+ *
+ * The text of the level is not copied into the node. Instead, the node
+ * refers to the level in the topic filter of one of the subscriptions
+ * passing through it. All such subscriptions share the same prefix up to
+ * and including this level and therefore the level is found at the same
+ * offset in each of them.
+ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    typedef struct MQTTTopicTrieNode
+    {
+        uint16_t usParent;         /**< The node for the previous topic level. */
+        uint16_t usFirstChild;     /**< The first node for the next topic level. */
+        uint16_t usNextSibling;    /**< The next node with the same parent. Links the free nodes when the node is not in use. */
+        uint16_t usOwner;          /**< The subscription whose topic filter contains the text of this level. */
+        uint16_t usLevelOffset;    /**< The offset of this level in the topic filter of the owner subscription. */
+        uint16_t usLevelLength;    /**< The length of this level. */
+        uint16_t usSubscription;   /**< The subscription whose topic filter ends at this level, if any. */
+        uint16_t usReferenceCount; /**< The number of subscriptions passing through this node. */
+        uint8_t ucLevelType;       /**< Whether the level is a literal, '+' or '#'. */
+    } MQTTTopicTrieNode_t;
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+
 /**
  * @brief The subscription manager used to keep track of user subscriptions
  * and topic specific callbacks.
@@ -437,6 +466,11 @@ typedef void ( * MQTTReturnBuffer_t ) ( uint8_t * pucBuffer );
     {
         MQTTSubscription_t xSubscriptions[ mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS ]; /**< User subscriptions. */
         uint32_t ulInUseSubscriptions;                                                         /**< Number of subscription entries currently in use. */
+        #if ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+            MQTTTopicTrieNode_t xTrieNodes[ mqttconfigSUBSCRIPTION_MANAGER_MAX_TRIE_NODES ]; /**< Topic filter trie. Node 0 is the root. */
+            uint16_t usFreeTrieNode;                                                         /**< The first free node in the topic filter trie. */
+            uint16_t usFreeTrieNodes;                                                        /**< The number of free nodes in the topic filter trie. */
+        #endif
     } MQTTSubscriptionManager_t;
 
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
@@ -685,6 +719,28 @@ MQTTReturnCode_t MQTT_Unsubscribe( MQTTContext_t * pxMQTTContext,
 MQTTReturnCode_t MQTT_Publish( MQTTContext_t * pxMQTTContext,
                                const MQTTPublishParams_t * const pxPublishParams );
 
+/**
+ * @brief Initiates the Publish operation for several messages at once.
+ *
+ * Prepares all the publish messages one after the other in one buffer and
+ * transmits them with a single call to the send function, so that they can
+ * share one TLS record and TCP segment. All the messages together must fit in
+ * one buffer from the buffer pool. Like in MQTT_Publish, every non QoS0
+ * message waits for its PUBACK until it is received or the operation times
+ * out.
+ *
+ * Either all the messages are sent or none of them is.
+ *
+ * @param[in] pxMQTTContext The initialized MQTT context.
+ * @param[in] pxPublishParams Array of publish parameters, one per message.
+ * @param[in] ulPublishCount The number of messages in pxPublishParams.
+ *
+ * @return eMQTTSuccess if everything succeeds, otherwise an error code explaining the reason of failure.
+ */
+MQTTReturnCode_t MQTT_PublishV( MQTTContext_t * pxMQTTContext,
+                                const MQTTPublishParams_t * const pxPublishParams,
+                                uint32_t ulPublishCount );
+
 /**
  * @brief Decodes the incoming messages.
  *
@@ -702,6 +758,51 @@ MQTTReturnCode_t MQTT_ParseReceivedData( MQTTContext_t * pxMQTTContext,
                                          const uint8_t * pucReceivedData,
                                          size_t xReceivedDataLength );
 
+/**
+ * @brief Gets the location where the next incoming bytes should be received.
+ *
+ * Together with MQTT_ParseReceivedInPlace, this lets the user receive the
+ * incoming bytes directly into the buffer which holds the MQTT message
+ * (and which is later handed to the publish callback), instead of receiving
+ * them into an intermediate buffer which MQTT_ParseReceivedData then copies.
+ * The returned length never spans more than the rest of the current MQTT
+ * message, so that the message ends at a receive boundary. While the fixed
+ * header is being received, the location is inside the MQTT context and the
+ * length is at most 2 bytes.
+ *
+ * @param[in] pxMQTTContext The initialized MQTT context.
+ * @param[out] ppucLocation The location to receive the next bytes into. Set to
+ * NULL if the current message is being dropped.
+ * @param[out] pxLength The number of bytes to receive into *ppucLocation, or the
+ * number of bytes left to drop.
+ *
+ * @return eMQTTSuccess if the bytes should be received into *ppucLocation and then
+ * passed to MQTT_ParseReceivedInPlace. eMQTTNoFreeBuffer if the current message is
+ * being dropped because no free buffer was available to store it, in which case
+ * the bytes should be received into any buffer and passed to MQTT_ParseReceivedData.
+ * eMQTTClientNotConnected if the client is not connected.
+ */
+MQTTReturnCode_t MQTT_GetReceiveLocation( MQTTContext_t * pxMQTTContext,
+                                          uint8_t ** ppucLocation,
+                                          size_t * pxLength );
+
+/**
+ * @brief Decodes the bytes received into the location returned by
+ * MQTT_GetReceiveLocation.
+ *
+ * Same as MQTT_ParseReceivedData except that the bytes are not copied as they
+ * have already been received where they need to be.
+ *
+ * @param[in] pxMQTTContext The initialized MQTT context.
+ * @param[in] xReceivedDataLength Number of bytes received into the location
+ * returned by MQTT_GetReceiveLocation. Must not be more than the length
+ * returned by it.
+ *
+ * @return eMQTTSuccess if everything succeeds, otherwise an error code explaining the reason of failure.
+ */
+MQTTReturnCode_t MQTT_ParseReceivedInPlace( MQTTContext_t * pxMQTTContext,
+                                            size_t xReceivedDataLength );
+
 /**
  * @brief Returns the buffer provided in the publish callback.
  *
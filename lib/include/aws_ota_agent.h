@@ -38,6 +38,9 @@
 #include "FreeRTOS.h"
 #include "timers.h"
 
+/* Stream request window of an OTA file. */
+#include "aws_ota_window.h"
+
 /**
  * @brief Special OTA Agent printing definition.
  */
@@ -157,6 +160,9 @@ typedef struct {
 	u8		   *pacRxBlockBitmap;	/*!< Bitmap to track the blocks we've received (for de-duping). */
 	u8		   *pacCertFilepath;	/*!< Pathname of the certificate file used to validate the receive file. */
 	u32			ulUpdaterVersion;	/*!< Used by OTA self-test detection, the version of FW that did the update. */
+	void	   *pvSigVerifyContext;	/*!< Signature verification context hashing the file as it is received, or NULL. */
+	u32			ulBytesHashed;		/*!< Number of bytes from the start of the file already added to pvSigVerifyContext. */
+	OTA_RequestWindow_t xRequestWindow;	/*!< The stream requests waiting for their blocks. */
 
 } OTA_FileContext_t;
 
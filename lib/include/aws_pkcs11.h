@@ -64,4 +64,12 @@
 /* Bring in the public header. */
 #include "pkcs11.h"
 
+/**
+ * @brief ECDSA with SHA-256 mechanism.
+ * From PKCS#11 v2.40, which the public header predates.
+ */
+#ifndef CKM_ECDSA_SHA256
+    #define CKM_ECDSA_SHA256    0x00001044UL
+#endif
+
 #endif /* ifndef _AWS_PKCS11_H_ */
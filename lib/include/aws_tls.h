@@ -53,6 +53,22 @@ typedef BaseType_t ( * NetworkSend_t ) ( void * pvCallerContext,
                                          const unsigned char * pucData,
                                          size_t xDataLength );
 
+/**
+ * @defgroup CipherSuitePolicies The cipher suites TLS_Connect offers.
+ *
+ * The server chooses the cipher suite among the ones offered, so all the
+ * policies but tlsCIPHER_SUITE_POLICY_DEFAULT restrict the client to one kind
+ * of bulk encryption. The connection fails if the server supports none of the
+ * suites of the policy. All the suites use an ECDHE key exchange and 128-bit
+ * AES; the AES-CCM-8 suite also requires an ECDSA server certificate.
+ */
+/** @{ */
+#define tlsCIPHER_SUITE_POLICY_DEFAULT    ( 1 ) /**< The mbedTLS default list, strongest suites first. */
+#define tlsCIPHER_SUITE_POLICY_AES_GCM    ( 2 ) /**< AES-GCM, fastest where AES and carry-less multiplication are accelerated. */
+#define tlsCIPHER_SUITE_POLICY_AES_CCM_8  ( 3 ) /**< AES-CCM-8, which only needs the AES block function. */
+#define tlsCIPHER_SUITE_POLICY_AES_CBC    ( 4 ) /**< AES-CBC with HMAC-SHA256. */
+/** @} */
+
 /**
  * @brief Defines parameter structure for initializing the TLS interface.
  *
@@ -65,6 +81,12 @@ typedef BaseType_t ( * NetworkSend_t ) ( void * pvCallerContext,
  * @param[in] pxNetworkSend Caller-defined network send function pointer.
  * @param[in] pvCallerContext Caller-defined context handle to be used with callback
  * functions.
+ * @param[in] ulMaxFragmentLength Largest record, in bytes, that the server is
+ * asked to send with the Max Fragment Length extension (RFC 6066): 512, 1024,
+ * 2048 or 4096. Zero uses tlsconfigMAX_FRAGMENT_LENGTH. Only read if ulSize
+ * includes it.
+ * @param[in] ulCipherSuitePolicy One of the tlsCIPHER_SUITE_POLICY_ values.
+ * Zero uses tlsconfigCIPHER_SUITE_POLICY. Only read if ulSize includes it.
  */
 typedef struct xTLS_PARAMS
 {
@@ -78,8 +100,23 @@ typedef struct xTLS_PARAMS
     NetworkRecv_t pxNetworkRecv;
     NetworkSend_t pxNetworkSend;
     void * pvCallerContext;
+
+    uint32_t ulMaxFragmentLength;
+    uint32_t ulCipherSuitePolicy;
 } TLSParams_t;
 
+/**
+ * @brief Describes one of the buffers of a scatter-gather transfer.
+ *
+ * @param[in] pvData Start of the buffer.
+ * @param[in] xLength Length of the buffer in bytes.
+ */
+typedef struct xTLS_IO_VECTOR
+{
+    void * pvData;
+    size_t xLength;
+} TLSIoVector_t;
+
 /**
  * @brief Initializes the TLS context.
  *
@@ -100,6 +137,41 @@ BaseType_t TLS_Init( void ** ppvContext,
  */
 BaseType_t TLS_Connect( void * pvContext );
 
+/**
+ * @defgroup ConnectStepResults Values TLS_ConnectStep returns while the
+ * handshake is in progress.
+ */
+/** @{ */
+#define tlsCONNECT_WANT_READ      ( 1 ) /**< The handshake waits for data from the server. */
+#define tlsCONNECT_WANT_WRITE     ( 2 ) /**< The handshake waits to send data to the server. */
+#define tlsCONNECT_IN_PROGRESS    ( 3 ) /**< The handshake can go on without waiting. */
+/** @} */
+
+/**
+ * @brief Runs one step of the TLS handshake without blocking.
+ *
+ * The first call starts the handshake that TLS_Connect would run. Every call
+ * processes at most one handshake message, and returns as soon as the
+ * handshake has to wait for the network, so that the calling task can do
+ * other work, or run the handshakes of other connections, in between. The
+ * caller calls it again right away after tlsCONNECT_IN_PROGRESS, and once the
+ * network can make progress after tlsCONNECT_WANT_READ or
+ * tlsCONNECT_WANT_WRITE, e.g. when the socket becomes readable, or
+ * periodically.
+ *
+ * While the handshake runs, the network callbacks must not block: they
+ * return zero when there is nothing to receive or no room to send. Once
+ * the handshake is over, they are used the way TLS_Connect uses them, and
+ * zero means that the connection is closed again.
+ *
+ * @param pvContext Opaque context handle for TLS library.
+ *
+ * @return Zero once connected, tlsCONNECT_IN_PROGRESS, tlsCONNECT_WANT_READ
+ * or tlsCONNECT_WANT_WRITE while the handshake is in progress. Error return codes have the high bit
+ * set. Must not be called again once it has returned zero or an error.
+ */
+BaseType_t TLS_ConnectStep( void * pvContext );
+
 /**
  * @brief Reads the requested number of bytes from the secure connection
  *
@@ -127,6 +199,47 @@ BaseType_t TLS_Send( void * pvContext,
                      const unsigned char * pucMsg,
                      size_t xMsgLength );
 
+/**
+ * @brief Reads from the secure connection into several buffers, one after
+ * the other.
+ *
+ * The data is decrypted in the receive buffer of the connection and copied
+ * straight into the buffers of the caller, so that a message can be read
+ * into separate buffers for its header and its payload without copying it
+ * again. Every buffer is filled before the next one is used.
+ *
+ * @param pvContext Opaque context handle for TLS library.
+ * @param pxVectors Buffers to read into.
+ * @param xVectorCount Number of buffers in pxVectors.
+ *
+ * @return Number of bytes read, which is less than the total length of the
+ * buffers if the connection was closed. Error return codes have the high bit
+ * set.
+ */
+BaseType_t TLS_RecvInto( void * pvContext,
+                         const TLSIoVector_t * pxVectors,
+                         size_t xVectorCount );
+
+/**
+ * @brief Writes the content of several buffers, one after the other, to the
+ * secure connection.
+ *
+ * The buffers are copied straight into the records being encrypted, so that a
+ * message held in separate buffers, e.g. its header, topic and payload, is
+ * sent without first being copied into one buffer. Data from consecutive
+ * buffers shares records, so a message is not split into more records than
+ * with TLS_Send.
+ *
+ * @param pvContext Opaque context handle for TLS library.
+ * @param pxVectors Buffers to send. They are not modified.
+ * @param xVectorCount Number of buffers in pxVectors.
+ *
+ * @return Number of bytes sent. Error return codes have the high bit set.
+ */
+BaseType_t TLS_SendV( void * pvContext,
+                      const TLSIoVector_t * pxVectors,
+                      size_t xVectorCount );
+
 /**
  * @brief Frees resources consumed by the TLS context.
  *
@@ -134,4 +247,24 @@ BaseType_t TLS_Send( void * pvContext,
  */
 void TLS_Cleanup( void * pvContext );
 
+/**
+ * @brief Discards the sessions cached for resumption.
+ *
+ * Must be called when the client certificate or private key change. Does
+ * nothing unless tlsconfigENABLE_SESSION_RESUMPTION is set to 1.
+ */
+void TLS_ClearSessionCache( void );
+
+/**
+ * @brief Discards the credentials shared by the TLS contexts.
+ *
+ * The default root certificates, the client certificate chain and the
+ * PKCS#11 session of the client private key are loaded by the first
+ * TLS_Connect and shared by all the contexts after it. Must be called when
+ * the client certificate or private key change, so that the next
+ * TLS_Connect loads them again. Contexts that are already connected keep
+ * using the old credentials until TLS_Cleanup.
+ */
+void TLS_ReleaseCredentials( void );
+
 #endif /* ifndef __AWS__TLS__H__ */
@@ -70,4 +70,38 @@ uint8_t * BUFFERPOOL_GetFreeBuffer( uint32_t * pulBufferLength );
  */
 void BUFFERPOOL_ReturnBuffer( uint8_t * const pucBuffer );
 
+/**
+ * @brief Usage statistics of one size class of the central buffer pool.
+ */
+typedef struct BufferPoolClassStats
+{
+    uint32_t ulBufferSize;    /**< The length of each buffer of the class. */
+    uint32_t ulNumBuffers;    /**< The number of buffers of the class. */
+    uint32_t ulBuffersInUse;  /**< The number of buffers of the class currently in use. */
+    uint32_t ulHighWaterMark; /**< The maximum number of buffers of the class that have been in use at the same time. */
+} BufferPoolClassStats_t;
+
+/**
+ * @brief Returns the number of size classes in the central buffer pool.
+ *
+ * Implementations in which all the buffers are of the same length have a
+ * single class.
+ *
+ * @return The number of size classes.
+ */
+uint32_t BUFFERPOOL_GetNumClasses( void );
+
+/**
+ * @brief Gets the usage statistics of a size class of the central buffer pool.
+ *
+ * Classes are numbered from 0 in the order of increasing buffer length.
+ *
+ * @param[in] ulClass The class to get the statistics of.
+ * @param[out] pxStats The statistics of the class.
+ *
+ * @return pdPASS if ulClass is a valid class, pdFAIL otherwise.
+ */
+BaseType_t BUFFERPOOL_GetClassStats( uint32_t ulClass,
+                                     BufferPoolClassStats_t * const pxStats );
+
 #endif /* _AWS_BUFFER_POOL_H_ */
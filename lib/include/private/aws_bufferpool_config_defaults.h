@@ -0,0 +1,106 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+
+/**
+ * @file aws_bufferpool_config_defaults.h
+ * @brief Buffer pool default config options.
+ *
+ * Ensures that the config options for the size classed and the lock free
+ * buffer pools are set to sensible default values if the user does not
+ * provide one.
+ */
+
+#ifndef _AWS_BUFFER_POOL_CONFIG_DEFAULTS_H_
+#define _AWS_BUFFER_POOL_CONFIG_DEFAULTS_H_
+
+/**
+ * @defgroup SizeClasses The size classes of the size classed buffer pool.
+ *
+ * The size classed buffer pool (aws_bufferpool_static_size_classed.c) keeps up
+ * to four classes of buffers. bufferpoolconfigCLASSn_BUFFER_SIZE is the length
+ * of each buffer of class n and bufferpoolconfigCLASSn_NUM_BUFFERS the number
+ * of buffers in it. The buffer sizes must increase with the class number. A
+ * class with no buffers is not used.
+ *
+ * A request is served from the smallest class whose buffers are large enough,
+ * or from the next larger class if that one has no free buffer, so that short
+ * messages such as PINGREQ or PUBACK do not take a buffer sized for the largest
+ * message. The defaults hold 4.5 KB of buffers where eight 1 KB buffers would
+ * hold 8 KB.
+ */
+/** @{ */
+#ifndef bufferpoolconfigCLASS0_BUFFER_SIZE
+    #define bufferpoolconfigCLASS0_BUFFER_SIZE    ( 64 )
+#endif
+
+#ifndef bufferpoolconfigCLASS0_NUM_BUFFERS
+    #define bufferpoolconfigCLASS0_NUM_BUFFERS    ( 8 )
+#endif
+
+#ifndef bufferpoolconfigCLASS1_BUFFER_SIZE
+    #define bufferpoolconfigCLASS1_BUFFER_SIZE    ( 256 )
+#endif
+
+#ifndef bufferpoolconfigCLASS1_NUM_BUFFERS
+    #define bufferpoolconfigCLASS1_NUM_BUFFERS    ( 8 )
+#endif
+
+#ifndef bufferpoolconfigCLASS2_BUFFER_SIZE
+    #define bufferpoolconfigCLASS2_BUFFER_SIZE    ( 1024 )
+#endif
+
+#ifndef bufferpoolconfigCLASS2_NUM_BUFFERS
+    #define bufferpoolconfigCLASS2_NUM_BUFFERS    ( 2 )
+#endif
+
+#ifndef bufferpoolconfigCLASS3_BUFFER_SIZE
+    #define bufferpoolconfigCLASS3_BUFFER_SIZE    ( 4096 )
+#endif
+
+#ifndef bufferpoolconfigCLASS3_NUM_BUFFERS
+    #define bufferpoolconfigCLASS3_NUM_BUFFERS    ( 0 )
+#endif
+/** @} */
+
+/**
+ * @brief Use the compiler's atomic builtins in the lock free buffer pool.
+ *
+ * The lock free buffer pool (aws_bufferpool_static_lock_free.c) updates its
+ * free list with a 32 bit compare and swap. If this macro is set to 1, the
+ * GCC __atomic builtins are used for it, which compile to exclusive load and
+ * store instructions on cores that have them. Set it to 0 on cores without
+ * them, such as the Cortex-M0, or with compilers without the builtins; each
+ * compare and swap is then done in a critical section of a few instructions.
+ */
+#ifndef bufferpoolconfigUSE_ATOMIC_BUILTINS
+    #if defined( __GNUC__ )
+        #define bufferpoolconfigUSE_ATOMIC_BUILTINS    ( 1 )
+    #else
+        #define bufferpoolconfigUSE_ATOMIC_BUILTINS    ( 0 )
+    #endif
+#endif
+
+#endif /* _AWS_BUFFER_POOL_CONFIG_DEFAULTS_H_ */
@@ -0,0 +1,54 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_crypto_config_defaults.h
+ * @brief Crypto default config options.
+ *
+ * Ensures that the config options for the crypto library are set to sensible
+ * default values if the user does not provide one. They can be overridden in
+ * FreeRTOSConfig.h.
+ */
+
+#ifndef _AWS_CRYPTO_CONFIG_DEFAULTS_H_
+#define _AWS_CRYPTO_CONFIG_DEFAULTS_H_
+
+/**
+ * @brief Keep the public key of the last signer certificate parsed between
+ * signature verifications.
+ *
+ * If this macro is set to 1, CRYPTO_SignatureVerificationFinal keeps the
+ * public key of the signer certificate it was given, and uses it again as
+ * long as it is given the same certificate, e.g. the OTA code signing
+ * certificate. This saves parsing the certificate and, for ECDSA keys,
+ * computing the comb table of the generator of the curve, which stays with
+ * the key. The key stays allocated on the heap until
+ * CRYPTO_ClearSignerKeyCache is called.
+ */
+#ifndef cryptoconfigCACHE_SIGNER_KEY
+    #define cryptoconfigCACHE_SIGNER_KEY    ( 1 )
+#endif
+
+#endif /* _AWS_CRYPTO_CONFIG_DEFAULTS_H_ */
@@ -0,0 +1,70 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+
+/**
+ * @file aws_heap_trace_config_defaults.h
+ * @brief Heap trace default config options.
+ *
+ * Ensures that the config options for the heap trace are set to sensible
+ * default values if the user does not provide one in FreeRTOSConfig.h.
+ */
+
+#ifndef _AWS_HEAP_TRACE_CONFIG_DEFAULTS_H_
+#define _AWS_HEAP_TRACE_CONFIG_DEFAULTS_H_
+
+/**
+ * @brief Number of records kept in the ring.
+ *
+ * Each record takes 24 bytes on a 32-bit target. Once the ring is full, the
+ * oldest records are overwritten, and the blocks they allocated are missing
+ * from the reports.
+ */
+#ifndef heaptraceconfigRING_LENGTH
+    #define heaptraceconfigRING_LENGTH    ( 1024 )
+#endif
+
+/**
+ * @brief Number of tasks whose names are kept for HEAPTRACE_Dump.
+ *
+ * The name of a task is kept the first time it calls the heap while the ring
+ * is recording. The tasks after the first heaptraceconfigMAX_TASKS are
+ * reported by their handle only.
+ */
+#ifndef heaptraceconfigMAX_TASKS
+    #define heaptraceconfigMAX_TASKS    ( 16 )
+#endif
+
+/**
+ * @brief Returns the time stamp of a record.
+ *
+ * Called with the scheduler suspended. The default is the tick count; a
+ * platform with a free running timer can use it instead.
+ */
+#ifndef heaptraceconfigGET_TIME
+    #define heaptraceconfigGET_TIME()    ( ( uint32_t ) xTaskGetTickCount() )
+#endif
+
+#endif /* _AWS_HEAP_TRACE_CONFIG_DEFAULTS_H_ */
@@ -144,6 +144,29 @@
     #define mqttconfigMAX_PARALLEL_OPS    ( 5 )
 #endif
 
+/**
+ * @brief Maximum number of QoS1 messages published with MQTT_AGENT_PublishAsync
+ * which can wait for PUBACK at the same time per client.
+ *
+ * MQTT_AGENT_PublishAsync blocks while this many messages are waiting for
+ * PUBACK. Each of them holds a buffer from the buffer pool until its PUBACK
+ * is received, so the buffer pool must have enough buffers for this window.
+ */
+#ifndef mqttconfigMAX_INFLIGHT_PUBLISHES
+    #define mqttconfigMAX_INFLIGHT_PUBLISHES    ( 8 )
+#endif
+
+/**
+ * @brief Maximum number of messages which can be published together with
+ * MQTT_AGENT_PublishBatch.
+ *
+ * MQTT_AGENT_PublishBatch keeps an array of this many MQTTPublishParams_t on
+ * the stack of the calling task.
+ */
+#ifndef mqttconfigMAX_PUBLISH_BATCH
+    #define mqttconfigMAX_PUBLISH_BATCH    ( 8 )
+#endif
+
 /**
  * @brief Time in milliseconds after which the TCP send operation should timeout.
  */
@@ -158,6 +181,22 @@
     #define mqttconfigRX_BUFFER_SIZE    ( 1024 )
 #endif
 
+/**
+ * @brief Receive incoming messages directly into the buffers handed to the
+ * publish callbacks.
+ *
+ * By default, the MQTT task receives up to mqttconfigRX_BUFFER_SIZE bytes at a
+ * time into the connection's receive buffer, and the core library then copies
+ * every message into a buffer taken from the buffer pool. If this macro is set
+ * to 1, the MQTT task asks the core library where the next bytes belong and
+ * receives the messages straight into the buffer pool buffers, which removes
+ * that copy. The fixed header of each message is received separately, so small
+ * messages take more receive calls.
+ */
+#ifndef mqttconfigENABLE_ZERO_COPY_RECEIVE
+    #define mqttconfigENABLE_ZERO_COPY_RECEIVE    ( 0 )
+#endif
+
 /**
  * @defgroup BufferPoolInterface The functions used by the MQTT client to get and return buffers.
  *
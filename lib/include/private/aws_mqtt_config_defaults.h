@@ -73,6 +73,47 @@
     #define mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS    ( 8 )
 #endif
 
+/**
+ * @brief Store subscriptions in a topic filter trie.
+ *
+ * By default, the subscription manager compares the topic of every incoming
+ * publish message against every stored topic filter. If this macro is set to
+ * 1, the topic filters are additionally split at the '/' separators and
+ * stored in a trie of topic levels ('+' and '#' levels being nodes of their
+ * own), so that the cost of finding the matching subscriptions depends on the
+ * depth of the topic rather than on the number of subscriptions.
+ *
+ * The trie is built in the MQTT context and does not use dynamic memory.
+ */
+#ifndef mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE
+    #define mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE       ( 0 )
+#endif
+
+/**
+ * @brief Maximum number of topic levels in a topic filter stored in the
+ * topic filter trie.
+ *
+ * Only used if mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE is set to 1. The
+ * subscribe operation will fail if the user tries to subscribe to a topic
+ * filter with more levels than the maximum specified here.
+ */
+#ifndef mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS
+    #define mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS     ( 8 )
+#endif
+
+/**
+ * @brief Number of nodes in the topic filter trie.
+ *
+ * Only used if mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE is set to 1. One
+ * node is needed for every distinct topic level prefix among the stored topic
+ * filters, plus one for the root. The default is large enough for the worst
+ * case where no two topic filters share a prefix.
+ */
+#ifndef mqttconfigSUBSCRIPTION_MANAGER_MAX_TRIE_NODES
+    #define mqttconfigSUBSCRIPTION_MANAGER_MAX_TRIE_NODES \
+    ( ( mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS * mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS ) + 1 )
+#endif
+
 /**
  * @brief Define mqttconfigASSERT to enable asserts.
  *
@@ -96,6 +137,23 @@
     #define mqttconfigASSERT( x )
 #endif
 
+/**
+ * @brief Called with the number of bytes every time the library copies
+ * message data from one buffer to another.
+ *
+ * This covers the topic and payload written into outgoing messages and the
+ * received bytes copied into the buffers handed to the callbacks. It does
+ * nothing by default. Benchmarks can define it to count the bytes copied per
+ * message:
+ * @code
+ * extern uint32_t ulBytesCopied;
+ * #define mqttconfigTRACE_BYTES_COPIED( ulByteCount ) ( ulBytesCopied += ( ulByteCount ) )
+ * @endcode
+ */
+#ifndef mqttconfigTRACE_BYTES_COPIED
+    #define mqttconfigTRACE_BYTES_COPIED( ulByteCount )
+#endif
+
 /**
  * @brief Define mqttconfigENABLE_DEBUG_LOGS macro to 1 for enabling debug logs.
  *
@@ -0,0 +1,61 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_ota_agent_config_defaults.h
+ * @brief OTA agent default config options.
+ *
+ * Ensures that the config options for the OTA agent are set to sensible
+ * default values if the user does not provide one. They can be overridden
+ * in FreeRTOSConfig.h.
+ */
+
+#ifndef _AWS_OTA_AGENT_CONFIG_DEFAULTS_H_
+#define _AWS_OTA_AGENT_CONFIG_DEFAULTS_H_
+
+/**
+ * @brief Maximum number of stream requests waiting for their blocks at the
+ * same time.
+ *
+ * The OTA agent requests the file in ranges of otaconfigBLOCKS_PER_REQUEST
+ * blocks and sends the request for the next range as soon as there is room
+ * in the window, instead of waiting for the previous range to complete. A
+ * larger window hides more of the round trip time to the stream service.
+ */
+#ifndef otaconfigREQUEST_WINDOW_SIZE
+    #define otaconfigREQUEST_WINDOW_SIZE    ( 4 )
+#endif
+
+/**
+ * @brief Number of blocks requested in one stream request.
+ *
+ * Must be a multiple of 8 because each request carries whole bytes of the
+ * block bitmap.
+ */
+#ifndef otaconfigBLOCKS_PER_REQUEST
+    #define otaconfigBLOCKS_PER_REQUEST    ( 32 )
+#endif
+
+#endif /* _AWS_OTA_AGENT_CONFIG_DEFAULTS_H_ */
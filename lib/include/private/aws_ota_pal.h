@@ -47,6 +47,12 @@ static OTA_Err_t prvAbort(OTA_FileContext_t * const C);
  * 
  * @note Opens the file indicated in the OTA file context in the MCU file system.
  * 
+ * Platforms that verify the file signature in software should also start a signature
+ * verification context in C->pvSigVerifyContext here. The OTA agent then adds each block
+ * received in order to it as the block is written, so that prvCheckFileSignature only has
+ * to read back the part of the file that could not be hashed on the fly. Platforms that
+ * verify the signature elsewhere leave C->pvSigVerifyContext set to NULL.
+ * 
  * @param[in] C OTA file context information.
  * 
  * @return pdTRUE if succeeded, pdFALSE otherwise.
@@ -67,6 +73,9 @@ static OTA_Err_t prvCloseFile(OTA_FileContext_t * const C);
  * 
  * @note Optional on some platforms.
  * 
+ * If C->pvSigVerifyContext is not NULL, the first C->ulBytesHashed bytes of the file have
+ * already been hashed into it and only the rest of the file needs to be read back.
+ * 
  * @param[in] C OTA file context information.
  * 
  * @return The OTA PAL layer error code combined with the MCU specific error code. See OTA Agent 
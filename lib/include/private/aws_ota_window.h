@@ -0,0 +1,106 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_ota_window.h
+ * @brief Sliding window of the stream requests of an OTA file.
+ *
+ * The file is requested in ranges of blocks. Up to a configured number of
+ * ranges are in flight at the same time, and a new range is requested every
+ * time the blocks received make room for it. Only the blocks still missing
+ * in the block bitmap of the file are requested, so after a timeout the
+ * window is reset and the gaps are requested again from the start of the file.
+ */
+
+#ifndef _AWS_OTA_WINDOW_H_
+#define _AWS_OTA_WINDOW_H_
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/**
+ * @brief State of the request window of one OTA file.
+ */
+typedef struct OTA_RequestWindow
+{
+    uint32_t ulWindowSize;       /**< Maximum number of requests in flight. */
+    uint32_t ulBlocksPerRequest; /**< Number of blocks covered by one request, a multiple of 8. */
+    uint32_t ulNextByte;         /**< Block bitmap byte at which the next request starts. */
+    uint32_t ulBlocksInFlight;   /**< Number of blocks requested and not received yet. */
+} OTA_RequestWindow_t;
+
+/**
+ * @brief Initializes the request window.
+ *
+ * @param[out] pxWindow The request window.
+ * @param[in] ulWindowSize Maximum number of requests in flight.
+ * @param[in] ulBlocksPerRequest Number of blocks covered by one request. Must
+ * be a multiple of 8.
+ */
+void OTA_WINDOW_Init( OTA_RequestWindow_t * const pxWindow,
+                      uint32_t ulWindowSize,
+                      uint32_t ulBlocksPerRequest );
+
+/**
+ * @brief Forgets all the requests in flight.
+ *
+ * Called when the blocks stopped arriving. The next requests start again at
+ * the beginning of the file and cover only the blocks not received yet.
+ *
+ * @param[in] pxWindow The request window.
+ */
+void OTA_WINDOW_Reset( OTA_RequestWindow_t * const pxWindow );
+
+/**
+ * @brief Gets the next range of blocks to request, if there is room for it.
+ *
+ * The blocks of the range are counted as in flight from now on. Call it until
+ * it returns pdFALSE to fill the window.
+ *
+ * @param[in] pxWindow The request window.
+ * @param[in] pucRxBlockBitmap Bitmap of the blocks of the file. A set bit is a
+ * block which has not been received yet.
+ * @param[in] ulBitmapLen Length of the bitmap in bytes.
+ * @param[out] pulByteOffset Offset in the bitmap of the first byte of the range.
+ * The range starts at block ( *pulByteOffset * 8 ).
+ * @param[out] pulByteCount Number of bitmap bytes covered by the range.
+ *
+ * @return pdTRUE if a request for the range should be sent, pdFALSE if the
+ * window is full or all the missing blocks have been requested.
+ */
+BaseType_t OTA_WINDOW_GetNextRequest( OTA_RequestWindow_t * const pxWindow,
+                                      const uint8_t * const pucRxBlockBitmap,
+                                      uint32_t ulBitmapLen,
+                                      uint32_t * const pulByteOffset,
+                                      uint32_t * const pulByteCount );
+
+/**
+ * @brief Records that a block which had not been received before arrived.
+ *
+ * @param[in] pxWindow The request window.
+ */
+void OTA_WINDOW_BlockReceived( OTA_RequestWindow_t * const pxWindow );
+
+#endif /* _AWS_OTA_WINDOW_H_ */
@@ -0,0 +1,132 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_tls_config_defaults.h
+ * @brief TLS default config options.
+ *
+ * Ensures that the config options for TLS are set to sensible default
+ * values if the user does not provide one. They can be overridden in
+ * FreeRTOSConfig.h.
+ */
+
+#ifndef _AWS_TLS_CONFIG_DEFAULTS_H_
+#define _AWS_TLS_CONFIG_DEFAULTS_H_
+
+/**
+ * @brief Largest record, in bytes, that servers are asked to send.
+ *
+ * If this macro is not 0, TLS_Connect asks the server for records of at most
+ * this many bytes with the Max Fragment Length extension (RFC 6066), unless
+ * the connection sets ulMaxFragmentLength in TLSParams_t. It must be 512,
+ * 1024, 2048 or 4096, and not larger than the mbedTLS input and output
+ * buffers.
+ *
+ * The records sent by the client are never larger than the length
+ * negotiated. The records sent by a server that supports the extension are
+ * not either, so the mbedTLS input buffer (MBEDTLS_SSL_IN_CONTENT_LEN) can be
+ * made as small as the length negotiated, as long as the largest handshake
+ * message of the server (usually its certificate chain) still fits: mbedTLS
+ * does not reassemble handshake messages split across records. Servers that
+ * do not support the extension ignore it.
+ */
+#ifndef tlsconfigMAX_FRAGMENT_LENGTH
+    #define tlsconfigMAX_FRAGMENT_LENGTH    ( 0 )
+#endif
+
+/**
+ * @brief Cipher suites offered to servers.
+ *
+ * One of the tlsCIPHER_SUITE_POLICY_ values of aws_tls.h, used unless the
+ * connection sets ulCipherSuitePolicy in TLSParams_t. On a microcontroller
+ * without AES acceleration, tlsCIPHER_SUITE_POLICY_AES_CCM_8 is usually the
+ * cheapest per byte, as it does not compute the GHASH of AES-GCM in software;
+ * the bulk encryption cases of the TLS benchmark compare the policies.
+ */
+#ifndef tlsconfigCIPHER_SUITE_POLICY
+    #define tlsconfigCIPHER_SUITE_POLICY    ( tlsCIPHER_SUITE_POLICY_DEFAULT )
+#endif
+
+/**
+ * @brief Resume the previous TLS session when reconnecting to a server.
+ *
+ * If this macro is set to 1, the session negotiated with each server is
+ * kept in a cache, and the next TLS_Connect to the same destination offers
+ * it to the server, both as a session ticket (RFC 5077) and as a session ID.
+ * If the server accepts it, the abbreviated handshake skips the key exchange
+ * and the client certificate signature, and exchanges far fewer bytes.
+ *
+ * TLS_ClearSessionCache must be called when the client credentials change,
+ * so that no session established with the old credentials is resumed.
+ */
+#ifndef tlsconfigENABLE_SESSION_RESUMPTION
+    #define tlsconfigENABLE_SESSION_RESUMPTION    ( 0 )
+#endif
+
+/**
+ * @brief Number of servers for which a session is cached.
+ *
+ * Only used if tlsconfigENABLE_SESSION_RESUMPTION is set to 1. When the
+ * cache is full, the session used least recently is replaced.
+ */
+#ifndef tlsconfigSESSION_CACHE_SIZE
+    #define tlsconfigSESSION_CACHE_SIZE    ( 2 )
+#endif
+
+/**
+ * @brief Maximum length of the destination of a cached session.
+ *
+ * Only used if tlsconfigENABLE_SESSION_RESUMPTION is set to 1. Sessions with
+ * servers whose name is longer than this are not cached.
+ */
+#ifndef tlsconfigSESSION_CACHE_MAX_DESTINATION_LENGTH
+    #define tlsconfigSESSION_CACHE_MAX_DESTINATION_LENGTH    ( 128 )
+#endif
+
+/**
+ * @brief Keep the most recent session in the PKCS#11 PAL storage.
+ *
+ * Only used if tlsconfigENABLE_SESSION_RESUMPTION is set to 1. If this macro
+ * is set to 1, the session is also written with PKCS11_PAL_SaveFile, so that
+ * it can be resumed after a reset. It is only written after a full
+ * handshake, not when a session is resumed. The file holds the session
+ * master secret, so the storage must be as well protected as the device
+ * private key.
+ */
+#ifndef tlsconfigSESSION_CACHE_USE_PAL
+    #define tlsconfigSESSION_CACHE_USE_PAL    ( 0 )
+#endif
+
+/**
+ * @brief Name of the file the session is kept in.
+ *
+ * Only used if tlsconfigSESSION_CACHE_USE_PAL is set to 1. The PAL of the
+ * platform must support this file name.
+ */
+#ifndef tlsconfigSESSION_CACHE_FILE_NAME
+    #define tlsconfigSESSION_CACHE_FILE_NAME    "FreeRTOS_TLS_Session.dat"
+#endif
+
+#endif /* _AWS_TLS_CONFIG_DEFAULTS_H_ */
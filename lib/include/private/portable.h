@@ -102,7 +102,7 @@ extern "C" {
 	StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters ) PRIVILEGED_FUNCTION;
 #endif
 
-/* Used by heap_5.c. */
+/* Used by heap_5.c and heap_6.c. */
 typedef struct HeapRegion
 {
 	uint8_t *pucStartAddress;
@@ -110,7 +110,7 @@ typedef struct HeapRegion
 } HeapRegion_t;
 
 /*
- * Used to define multiple heap regions for use by heap_5.c.  This function
+ * Used to define multiple heap regions for use by heap_5.c and heap_6.c.  This function
  * must be called before any calls to pvPortMalloc() - not creating a task,
  * queue, semaphore, mutex, software timer, event group, etc. will result in
  * pvPortMalloc being called.
@@ -122,6 +122,22 @@ typedef struct HeapRegion
  */
 void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions ) PRIVILEGED_FUNCTION;
 
+/* Used by heap_6.c to report the use of one of its size classes. */
+typedef struct HeapClassStats
+{
+	size_t xMinimumBlockSize;	/* Smallest block in the class, block header included. */
+	size_t xFreeBlocks;			/* Number of free blocks in the class. */
+	size_t xFreeBytes;			/* Total size of the free blocks in the class. */
+	size_t xAllocations;		/* Number of blocks of the class returned by pvPortMalloc() so far. */
+} HeapClassStats_t;
+
+/*
+ * Fills pxStats with the statistics of the size classes of heap_6.c, smallest
+ * blocks first, and returns the number of classes filled in.  At most
+ * uxMaxClasses structures are written.
+ */
+UBaseType_t uxPortGetHeapClassStats( HeapClassStats_t *pxStats, UBaseType_t uxMaxClasses ) PRIVILEGED_FUNCTION;
+
 
 /*
  * Map to the memory management routines required for the port.
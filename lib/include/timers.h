@@ -66,6 +66,10 @@ or interrupt version of the queue send function should be used. */
 #define tmrCOMMAND_STOP_FROM_ISR				( ( BaseType_t ) 8 )
 #define tmrCOMMAND_CHANGE_PERIOD_FROM_ISR		( ( BaseType_t ) 9 )
 
+/* Sent to wake the timer service task when commands are left pending in the
+timers rather than queued, see configUSE_TIMER_COMMAND_COALESCING. */
+#define tmrCOMMAND_PROCESS_PENDING				( ( BaseType_t ) 10 )
+
 
 /**
  * Type by which software timers are referenced.  For example, a call to
@@ -1128,6 +1132,11 @@ TaskHandle_t xTimerGetTimerDaemonTaskHandle( void ) PRIVILEGED_FUNCTION;
  *
  * @param ulParameter2 The value of the callback function's second parameter.
  *
+ * If configUSE_TIMER_COMMAND_COALESCING is set to 1, the start, reset, stop and
+ * change period commands are not queued, and the timer service task collects
+ * them once its queue is empty.  A function pended after such a command can
+ * therefore run before the command takes effect.
+ *
  * @param pxHigherPriorityTaskWoken As mentioned above, calling this function
  * will result in a message being sent to the timer daemon task.  If the
  * priority of the timer daemon task (which is set using
@@ -1213,6 +1222,10 @@ BaseType_t xTimerPendFunctionCallFromISR( PendedFunction_t xFunctionToPend, void
   * processing time) for space to become available on the timer queue if the
   * queue is found to be full.
   *
+  * As with xTimerPendFunctionCallFromISR(), a function pended after a timer
+  * command can run before the command takes effect if
+  * configUSE_TIMER_COMMAND_COALESCING is set to 1.
+  *
   * @return pdPASS is returned if the message was successfully sent to the
   * timer daemon task, otherwise pdFALSE is returned.
   *
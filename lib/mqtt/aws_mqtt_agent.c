@@ -137,7 +137,9 @@ typedef enum
     eMQTTDisconnectRequest,  /**< Disconnect the connection to an MQTT broker. */
     eMQTTSubscribeRequest,   /**< Initiate a subscribe to a topic.  _TODO_ Currently limited to one topic per subscribe message. */
     eMQTTUnsubscribeRequest, /**< Initiate unsubscribe from a topic.  _TODO_ Currently limited to one topic per unsubscribe message. */
-    eMQTTPublishRequest      /**< Initiate a publish to a topic.  _TODO_ Currently limited to one topic per publish message. */
+    eMQTTPublishRequest,     /**< Initiate a publish to a topic.  _TODO_ Currently limited to one topic per publish message. */
+    eMQTTPublishAsyncRequest, /**< Initiate a publish to a topic without waiting for the PUBACK. */
+    eMQTTPublishBatchRequest  /**< Initiate a publish of several messages sent together without waiting for the PUBACKs. */
 } MQTTAction_t;
 
 /**
@@ -177,6 +179,40 @@ typedef struct MQTTNotificationData
     uint32_t ulMessageIdentifier; /**< Used to match a request going from application task to MQTT task with response going the other way. */
 } MQTTNotificationData_t;
 
+/**
+ * @brief Parameters passed from MQTT_AGENT_PublishAsync to the MQTT task.
+ */
+typedef struct MQTTAsyncPublishData
+{
+    const MQTTAgentPublishParams_t * pxPublishParams; /**< Publish Parameters. */
+    MQTTAgentPublishCallback_t pxCallback;            /**< The callback to invoke when the publish completes. Can be NULL. */
+    void * pvCallbackContext;                         /**< Passed as it is to pxCallback. */
+    TickType_t xAckTimeoutTicks;                      /**< Time in ticks within which the PUBACK must be received. */
+} MQTTAsyncPublishData_t;
+
+/**
+ * @brief Parameters passed from MQTT_AGENT_PublishBatch to the MQTT task.
+ */
+typedef struct MQTTBatchPublishData
+{
+    MQTTPublishParams_t * pxPublishParams; /**< Core library publish parameters, one per message. The MQTT task fills in the packet identifiers. */
+    uint32_t ulPublishCount;               /**< The number of messages in pxPublishParams. */
+    MQTTAgentPublishCallback_t pxCallback; /**< The callback to invoke when each of the messages completes. Can be NULL. */
+    void * pvCallbackContext;              /**< Passed as it is to pxCallback. */
+} MQTTBatchPublishData_t;
+
+/**
+ * @brief Stores the information required to complete a QoS1 publish initiated
+ * with MQTT_AGENT_PublishAsync when its PUBACK is received.
+ */
+typedef struct MQTTInflightPublish
+{
+    MQTTAgentPublishCallback_t pxCallback; /**< The callback to invoke when the publish completes. Can be NULL. */
+    void * pvCallbackContext;              /**< Passed as it is to pxCallback. */
+    uint16_t usPacketIdentifier;           /**< Packet identifier of the PUBLISH message. */
+    BaseType_t xInUse;                     /**< Tracks whether or not the entry is waiting for a PUBACK. */
+} MQTTInflightPublish_t;
+
 /**
  * @brief Contents of the message sent from an application task to the MQTT task to
  * initiate an MQTT operation.
@@ -198,6 +234,8 @@ typedef struct MQTTEventData
         const MQTTAgentSubscribeParams_t * pxSubscribeParams;     /**< Subscribe Parameters. */
         const MQTTAgentUnsubscribeParams_t * pxUnsubscribeParams; /**< Unsubscribe Parameters. */
         const MQTTAgentPublishParams_t * pxPublishParams;         /**< Publish Parameters. */
+        const MQTTAsyncPublishData_t * pxAsyncPublishData;        /**< Asynchronous Publish Parameters. */
+        const MQTTBatchPublishData_t * pxBatchPublishData;        /**< Batch Publish Parameters. */
     } u;
 } MQTTEventData_t;
 
@@ -213,6 +251,9 @@ typedef struct MQTTBrokerConnection
     Socket_t xSocket;                                                   /**< TCP socket connected to the broker. */
     MQTTContext_t xMQTTContext;                                         /**< MQTT Core library context. */
     MQTTNotificationData_t xWaitingTasks[ mqttconfigMAX_PARALLEL_OPS ]; /**< Notification data to notify tasks which have sent commands to MQTT command queue and are waiting for results. */
+    MQTTInflightPublish_t xInflightPublishes[ mqttconfigMAX_INFLIGHT_PUBLISHES ]; /**< QoS1 messages published with MQTT_AGENT_PublishAsync which are waiting for PUBACK. */
+    SemaphoreHandle_t xInflightWindow;                                  /**< Counts the free entries in xInflightPublishes. Taken by application tasks before sending a QoS1 asynchronous publish and given back by the MQTT task when the publish completes. */
+    StaticSemaphore_t xInflightWindowBuffer;                            /**< The variable used to hold the xInflightWindow semaphore's data structure. */
     void * pvUserData;                                                  /**< User data to be supplied back in the callback as it is. */
     MQTTAgentCallback_t pxCallback;                                     /**< The callback to notify user of various events including the Publish messages received from the broker. */
     UBaseType_t uxFlags;                                                /**< Various properties of the connection - secured etc. */
@@ -370,6 +411,39 @@ static MQTTNotificationData_t * prvStoreNotificationData( MQTTBrokerConnection_t
 static MQTTNotificationData_t * prvRetrieveNotificationData( MQTTBrokerConnection_t * const pxConnection,
                                                              uint16_t usPacketIdentifier );
 
+/**
+ * @brief Stores the information required to complete an asynchronous QoS1
+ * publish when its PUBACK is received.
+ *
+ * @param[in] pxConnection The connection on which the message is published.
+ * @param[in] pxCallback The callback to invoke when the publish completes.
+ * @param[in] pvCallbackContext Passed as it is to pxCallback.
+ * @param[in] usPacketIdentifier The packet identifier of the PUBLISH message.
+ *
+ * @return Pointer to the stored entry if a free entry was available, NULL otherwise.
+ */
+static MQTTInflightPublish_t * prvStoreInflightPublish( MQTTBrokerConnection_t * const pxConnection,
+                                                        MQTTAgentPublishCallback_t pxCallback,
+                                                        void * pvCallbackContext,
+                                                        uint16_t usPacketIdentifier );
+
+/**
+ * @brief Completes an asynchronous QoS1 publish.
+ *
+ * Invokes the completion callback registered for the publish message with the
+ * given packet identifier, if any, and frees its entry in the in-flight window.
+ *
+ * @param[in] pxConnection The connection on which the message was published.
+ * @param[in] usPacketIdentifier The packet identifier of the PUBLISH message.
+ * @param[in] xResult The result passed to the completion callback.
+ *
+ * @return pdTRUE if an asynchronous publish with the given packet identifier was
+ * waiting for PUBACK, pdFALSE otherwise.
+ */
+static BaseType_t prvCompleteInflightPublish( MQTTBrokerConnection_t * const pxConnection,
+                                              uint16_t usPacketIdentifier,
+                                              MQTTAgentReturnCode_t xResult );
+
 /**
  * @brief Sets up the connection as per the parameters in event data.
  *
@@ -506,6 +580,20 @@ static void prvNotifyRequestingTask( MQTTNotificationData_t * const pxNotificati
                                      MQTTNotifyCodes_t xNotificationCode,
                                      UBaseType_t uxStatus );
 
+/**
+ * @brief Reads the available data from the socket and passes it to the MQTT
+ * Core library.
+ *
+ * If mqttconfigENABLE_ZERO_COPY_RECEIVE is 1, the data is received at the
+ * location returned by MQTT_GetReceiveLocation whenever possible. Otherwise,
+ * it is received into the connection's receive buffer.
+ *
+ * @param[in] pxConnection The connection to read the data for.
+ *
+ * @return The return value of SOCKETS_Recv.
+ */
+static int32_t prvReceiveData( MQTTBrokerConnection_t * const pxConnection );
+
 /**
  * @brief Called on each iteration of the MQTT task to service connected sockets.
  *
@@ -586,6 +674,47 @@ static void prvInitiateMQTTUnSubscribe( MQTTEventData_t * const pxEventData );
  */
 static void prvInitiateMQTTPublish( MQTTEventData_t * const pxEventData );
 
+/**
+ * @brief Sends the PUBLISH message by calling the Core library publish function.
+ *
+ * @param[in] pxConnection The connection on which to publish.
+ * @param[in] pxPublishParams The publish parameters supplied by the user.
+ * @param[in] usPacketIdentifier The packet identifier of the PUBLISH message.
+ * @param[in] xTimeoutTicks Time in ticks within which the PUBACK must be received.
+ *
+ * @return pdPASS if the message was sent, pdFAIL otherwise.
+ */
+static BaseType_t prvSendPublish( MQTTBrokerConnection_t * const pxConnection,
+                                  const MQTTAgentPublishParams_t * const pxPublishParams,
+                                  uint16_t usPacketIdentifier,
+                                  TickType_t xTimeoutTicks );
+
+/**
+ * @brief Initiates an asynchronous publish operation.
+ *
+ * The task that initiated the operation is informed as soon as the PUBLISH
+ * message is sent. In case of QoS1, the completion callback is invoked later
+ * when the PUBACK is received, the operation times out or the client gets
+ * disconnected.
+ *
+ * @param[in] pxEventData The event data containing the asynchronous publish
+ * parameters.
+ */
+static void prvInitiateMQTTPublishAsync( MQTTEventData_t * const pxEventData );
+
+/**
+ * @brief Initiates a batch publish operation.
+ *
+ * All the messages of the batch are sent with one call to MQTT_PublishV. The
+ * task that initiated the operation is informed as soon as they are sent, and
+ * the completion callback is invoked for each of them like in case of an
+ * asynchronous publish.
+ *
+ * @param[in] pxEventData The event data containing the batch publish
+ * parameters.
+ */
+static void prvInitiateMQTTPublishBatch( MQTTEventData_t * const pxEventData );
+
 /*
  * @brief Posts the event to the command queue and waits for the notification from the MQTT task.
  *
@@ -850,6 +979,67 @@ static MQTTNotificationData_t * prvRetrieveNotificationData( MQTTBrokerConnectio
 }
 /*-----------------------------------------------------------*/
 
+static MQTTInflightPublish_t * prvStoreInflightPublish( MQTTBrokerConnection_t * const pxConnection,
+                                                        MQTTAgentPublishCallback_t pxCallback,
+                                                        void * pvCallbackContext,
+                                                        uint16_t usPacketIdentifier )
+{
+    UBaseType_t x;
+    MQTTInflightPublish_t * pxInflightPublish = NULL;
+
+    /* Iterate over all the entries to find an unused one. */
+    for( x = 0; x < ( UBaseType_t ) mqttconfigMAX_INFLIGHT_PUBLISHES; x++ )
+    {
+        if( pxConnection->xInflightPublishes[ x ].xInUse == pdFALSE )
+        {
+            /* We found one unused entry - store the completion
+             * callback and return. */
+            pxInflightPublish = &( pxConnection->xInflightPublishes[ x ] );
+            pxInflightPublish->pxCallback = pxCallback;
+            pxInflightPublish->pvCallbackContext = pvCallbackContext;
+            pxInflightPublish->usPacketIdentifier = usPacketIdentifier;
+            pxInflightPublish->xInUse = pdTRUE;
+            break;
+        }
+    }
+
+    return pxInflightPublish;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCompleteInflightPublish( MQTTBrokerConnection_t * const pxConnection,
+                                              uint16_t usPacketIdentifier,
+                                              MQTTAgentReturnCode_t xResult )
+{
+    UBaseType_t x;
+    BaseType_t xFound = pdFALSE;
+    MQTTInflightPublish_t * pxInflightPublish;
+
+    for( x = 0; x < ( UBaseType_t ) mqttconfigMAX_INFLIGHT_PUBLISHES; x++ )
+    {
+        pxInflightPublish = &( pxConnection->xInflightPublishes[ x ] );
+
+        if( ( pxInflightPublish->xInUse == pdTRUE ) && ( pxInflightPublish->usPacketIdentifier == usPacketIdentifier ) )
+        {
+            /* Free up the entry before invoking the callback and make
+             * room in the in-flight window for the next publish. */
+            pxInflightPublish->xInUse = pdFALSE;
+            ( void ) xSemaphoreGive( pxConnection->xInflightWindow );
+
+            if( pxInflightPublish->pxCallback != NULL )
+            {
+                pxInflightPublish->pxCallback( pxInflightPublish->pvCallbackContext, xResult );
+            }
+
+            xFound = pdTRUE;
+            break;
+        }
+    }
+
+    return xFound;
+}
+/*-----------------------------------------------------------*/
+
 static BaseType_t prvSetupConnection( const MQTTEventData_t * const pxEventData )
 {
     SocketsSockaddr_t xMQTTServerAddress = { 0 };
@@ -1141,13 +1331,17 @@ static void prvProcessReceivedPUBACK( MQTTBrokerConnection_t * const pxConnectio
     /* Retrieve the notification data for the task which initiated the Publish operation.*/
     pxNotificationData = prvRetrieveNotificationData( pxConnection, pxParams->u.xMQTTPubACKData.usPacketIdentifier );
 
-    /* If there is no task waiting for it, ignore it. */
+    /* If there is no task waiting for it, it may be an asynchronous
+     * publish. Otherwise inform the task. */
     if( pxNotificationData != NULL )
     {
-        /* Otherwise inform the task. */
         mqttconfigDEBUG_LOG( ( "MQTT Publish was successful.\r\n" ) );
         prvNotifyRequestingTask( pxNotificationData, eMQTTPUBACKReceived, pdPASS );
     }
+    else
+    {
+        ( void ) prvCompleteInflightPublish( pxConnection, pxParams->u.xMQTTPubACKData.usPacketIdentifier, eMQTTAgentSuccess );
+    }
 }
 /*-----------------------------------------------------------*/
 
@@ -1182,13 +1376,18 @@ static void prvProcessReceivedTimeout( MQTTBrokerConnection_t * const pxConnecti
     /* Try to see if there is a task waiting for the operation which just timed out. */
     pxNotificationData = prvRetrieveNotificationData( pxConnection, pxParams->u.xTimeoutData.usPacketIdentifier );
 
-    /* If there is no task waiting, just ignore. Otherwise
-     * inform the task about the timeout. */
+    /* If there is no task waiting, it may be an asynchronous publish
+     * which did not receive the PUBACK in time. Otherwise inform the
+     * task about the timeout. */
     if( pxNotificationData != NULL )
     {
         mqttconfigDEBUG_LOG( ( "MQTT Timeout.\r\n" ) );
         prvNotifyRequestingTask( pxNotificationData, eMQTTOperationTimedOut, pdFAIL );
     }
+    else
+    {
+        ( void ) prvCompleteInflightPublish( pxConnection, pxParams->u.xTimeoutData.usPacketIdentifier, eMQTTAgentTimeout );
+    }
 }
 /*-----------------------------------------------------------*/
 
@@ -1232,6 +1431,18 @@ static void prvProcessReceivedDisconnect( MQTTBrokerConnection_t * const pxConne
                                      pdFAIL );
         }
     }
+
+    /* Similarly, fail all the asynchronous publishes which are
+     * waiting for PUBACKs. */
+    for( x = 0; x < ( UBaseType_t ) mqttconfigMAX_INFLIGHT_PUBLISHES; x++ )
+    {
+        if( pxConnection->xInflightPublishes[ x ].xInUse == pdTRUE )
+        {
+            ( void ) prvCompleteInflightPublish( pxConnection,
+                                                 pxConnection->xInflightPublishes[ x ].usPacketIdentifier,
+                                                 eMQTTAgentFailure );
+        }
+    }
 }
 /*-----------------------------------------------------------*/
 
@@ -1259,6 +1470,46 @@ static void prvNotifyRequestingTask( MQTTNotificationData_t * const pxNotificati
 }
 /*-----------------------------------------------------------*/
 
+static int32_t prvReceiveData( MQTTBrokerConnection_t * const pxConnection )
+{
+    int32_t lBytesReceived = 0;
+    BaseType_t xReceivedInPlace = pdFALSE;
+
+    #if ( mqttconfigENABLE_ZERO_COPY_RECEIVE == 1 )
+        uint8_t * pucLocation;
+        size_t xLength;
+
+        /* Receive the data where the core library stores it, so that
+         * it does not have to be copied. If the core library is dropping
+         * the current message, fall back to the receive buffer. */
+        if( MQTT_GetReceiveLocation( &( pxConnection->xMQTTContext ), &( pucLocation ), &( xLength ) ) == eMQTTSuccess )
+        {
+            xReceivedInPlace = pdTRUE;
+            lBytesReceived = SOCKETS_Recv( pxConnection->xSocket, pucLocation, xLength, 0 );
+
+            if( lBytesReceived > 0 )
+            {
+                ( void ) MQTT_ParseReceivedInPlace( &( pxConnection->xMQTTContext ), ( size_t ) lBytesReceived );
+            }
+        }
+    #endif /* mqttconfigENABLE_ZERO_COPY_RECEIVE */
+
+    if( xReceivedInPlace == pdFALSE )
+    {
+        /* Read data from the socket. */
+        lBytesReceived = SOCKETS_Recv( pxConnection->xSocket, pxConnection->ucRxBuffer, mqttconfigRX_BUFFER_SIZE, 0 );
+
+        /* If data was read, pass it to the MQTT Core library. */
+        if( lBytesReceived > 0 )
+        {
+            ( void ) MQTT_ParseReceivedData( &( pxConnection->xMQTTContext ), pxConnection->ucRxBuffer, ( size_t ) lBytesReceived );
+        }
+    }
+
+    return lBytesReceived;
+}
+/*-----------------------------------------------------------*/
+
 static TickType_t prvManageConnections( void )
 {
     UBaseType_t uxBrokerNumber;
@@ -1276,14 +1527,12 @@ static TickType_t prvManageConnections( void )
         /* Process only the connected clients. */
         if( pxConnection->xSocket != SOCKETS_INVALID_SOCKET )
         {
-            /* Read data from the socket. */
-            lBytesReceived = SOCKETS_Recv( pxConnection->xSocket, pxConnection->ucRxBuffer, mqttconfigRX_BUFFER_SIZE, 0 );
+            /* Read data from the socket and pass it to the MQTT
+             * Core library. */
+            lBytesReceived = prvReceiveData( pxConnection );
 
-            /* If data was read, pass it to the MQTT Core library. */
             if( lBytesReceived > 0 )
             {
-                ( void ) MQTT_ParseReceivedData( &( pxConnection->xMQTTContext ), pxConnection->ucRxBuffer, ( size_t ) lBytesReceived );
-
                 /* Some data was received on this socket and we do not
                  * know if there is more data available. Therefore we
                  * set xNextTimeoutTicks to zero which ensures that we
@@ -1563,7 +1812,6 @@ static void prvInitiateMQTTPublish( MQTTEventData_t * const pxEventData )
 {
     BaseType_t xStatus = pdFAIL;
     MQTTNotificationData_t * pxNotificationData = NULL;
-    MQTTPublishParams_t xPublishParams;
     MQTTBrokerConnection_t * pxConnection = &( xMQTTConnections[ pxEventData->uxBrokerNumber ] );
 
     /* No need to store  notification data in case of QoS0 because
@@ -1579,23 +1827,10 @@ static void prvInitiateMQTTPublish( MQTTEventData_t * const pxEventData )
      * proceed anyways. */
     if( ( pxNotificationData != NULL ) || ( pxEventData->u.pxPublishParams->xQoS == eMQTTQoS0 ) )
     {
-        /* Setup publish parameters and call the Core library publish function. */
-        xPublishParams.pucTopic = pxEventData->u.pxPublishParams->pucTopic;
-        xPublishParams.usTopicLength = pxEventData->u.pxPublishParams->usTopicLength;
-        xPublishParams.xQos = pxEventData->u.pxPublishParams->xQoS;
-        xPublishParams.pvData = pxEventData->u.pxPublishParams->pvData;
-        xPublishParams.ulDataLength = pxEventData->u.pxPublishParams->ulDataLength;
-        xPublishParams.usPacketIdentifier = ( uint16_t ) ( mqttMESSAGE_IDENTIFIER_EXTRACT( pxEventData->xNotificationData.ulMessageIdentifier ) );
-        xPublishParams.ulTimeoutTicks = pxEventData->xTicksToWait;
-
-        if( MQTT_Publish( &( pxConnection->xMQTTContext ), &( xPublishParams ) ) == eMQTTSuccess )
-        {
-            xStatus = pdPASS;
-        }
-        else
-        {
-            mqttconfigDEBUG_LOG( ( "MQTT_Publish failed!\r\n" ) );
-        }
+        xStatus = prvSendPublish( pxConnection,
+                                  pxEventData->u.pxPublishParams,
+                                  ( uint16_t ) ( mqttMESSAGE_IDENTIFIER_EXTRACT( pxEventData->xNotificationData.ulMessageIdentifier ) ),
+                                  pxEventData->xTicksToWait );
     }
     else
     {
@@ -1624,11 +1859,189 @@ static void prvInitiateMQTTPublish( MQTTEventData_t * const pxEventData )
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvSendPublish( MQTTBrokerConnection_t * const pxConnection,
+                                  const MQTTAgentPublishParams_t * const pxPublishParams,
+                                  uint16_t usPacketIdentifier,
+                                  TickType_t xTimeoutTicks )
+{
+    BaseType_t xStatus = pdFAIL;
+    MQTTPublishParams_t xPublishParams;
+
+    /* Setup publish parameters and call the Core library publish function. */
+    xPublishParams.pucTopic = pxPublishParams->pucTopic;
+    xPublishParams.usTopicLength = pxPublishParams->usTopicLength;
+    xPublishParams.xQos = pxPublishParams->xQoS;
+    xPublishParams.pvData = pxPublishParams->pvData;
+    xPublishParams.ulDataLength = pxPublishParams->ulDataLength;
+    xPublishParams.usPacketIdentifier = usPacketIdentifier;
+    xPublishParams.ulTimeoutTicks = xTimeoutTicks;
+
+    if( MQTT_Publish( &( pxConnection->xMQTTContext ), &( xPublishParams ) ) == eMQTTSuccess )
+    {
+        xStatus = pdPASS;
+    }
+    else
+    {
+        mqttconfigDEBUG_LOG( ( "MQTT_Publish failed!\r\n" ) );
+    }
+
+    return xStatus;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitiateMQTTPublishAsync( MQTTEventData_t * const pxEventData )
+{
+    BaseType_t xStatus = pdFAIL;
+    MQTTInflightPublish_t * pxInflightPublish = NULL;
+    MQTTAgentPublishCallback_t pxCallback = NULL;
+    void * pvCallbackContext = NULL;
+    const MQTTAsyncPublishData_t * const pxAsyncPublishData = pxEventData->u.pxAsyncPublishData;
+    const uint16_t usPacketIdentifier = ( uint16_t ) ( mqttMESSAGE_IDENTIFIER_EXTRACT( pxEventData->xNotificationData.ulMessageIdentifier ) );
+    MQTTBrokerConnection_t * pxConnection = &( xMQTTConnections[ pxEventData->uxBrokerNumber ] );
+
+    /* No need to store the completion callback in case of QoS0
+     * because there will not be any ACK. */
+    if( pxAsyncPublishData->pxPublishParams->xQoS != eMQTTQoS0 )
+    {
+        /* The requesting task has taken the in-flight window semaphore
+         * before sending the command, so a free entry must be available. */
+        pxInflightPublish = prvStoreInflightPublish( pxConnection,
+                                                     pxAsyncPublishData->pxCallback,
+                                                     pxAsyncPublishData->pvCallbackContext,
+                                                     usPacketIdentifier );
+        configASSERT( pxInflightPublish != NULL );
+    }
+
+    if( ( pxInflightPublish != NULL ) || ( pxAsyncPublishData->pxPublishParams->xQoS == eMQTTQoS0 ) )
+    {
+        xStatus = prvSendPublish( pxConnection,
+                                  pxAsyncPublishData->pxPublishParams,
+                                  usPacketIdentifier,
+                                  pxAsyncPublishData->xAckTimeoutTicks );
+    }
+
+    if( xStatus == pdPASS )
+    {
+        /* A QoS0 publish is complete as soon as it is sent. Note that
+         * pxAsyncPublishData lives on the stack of the requesting task
+         * and must not be accessed once that task is notified. */
+        if( pxInflightPublish == NULL )
+        {
+            pxCallback = pxAsyncPublishData->pxCallback;
+            pvCallbackContext = pxAsyncPublishData->pvCallbackContext;
+        }
+
+        /* The message has been copied to an MQTT buffer and sent, so
+         * unblock the task that initiated the publish operation. */
+        prvNotifyRequestingTask( &( pxEventData->xNotificationData ), eMQTTPUBSent, pdPASS );
+
+        if( pxCallback != NULL )
+        {
+            pxCallback( pvCallbackContext, eMQTTAgentSuccess );
+        }
+    }
+    else
+    {
+        /* The Publish was not successful.  Inform the task that initiated
+         * the Publish operation. The task gives back the in-flight window
+         * semaphore, so only the entry is freed here. */
+        prvNotifyRequestingTask( &( pxEventData->xNotificationData ), eMQTTPUBCouldNotBeSent, pdFAIL );
+
+        if( pxInflightPublish != NULL )
+        {
+            pxInflightPublish->xInUse = pdFALSE;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitiateMQTTPublishBatch( MQTTEventData_t * const pxEventData )
+{
+    uint32_t x, ulQoS0Count = 0;
+    UBaseType_t y;
+    MQTTInflightPublish_t * pxInflightPublish;
+    MQTTAgentPublishCallback_t pxCallback;
+    void * pvCallbackContext;
+    const MQTTBatchPublishData_t * const pxBatchPublishData = pxEventData->u.pxBatchPublishData;
+    const uint16_t usFirstPacketIdentifier = ( uint16_t ) ( mqttMESSAGE_IDENTIFIER_EXTRACT( pxEventData->xNotificationData.ulMessageIdentifier ) );
+    MQTTBrokerConnection_t * pxConnection = &( xMQTTConnections[ pxEventData->uxBrokerNumber ] );
+
+    /* prvSendCommandToMQTTTask reserved one message identifier for each
+     * message of the batch. */
+    for( x = 0; x < pxBatchPublishData->ulPublishCount; x++ )
+    {
+        pxBatchPublishData->pxPublishParams[ x ].usPacketIdentifier = ( uint16_t ) ( usFirstPacketIdentifier + ( uint16_t ) x );
+
+        if( pxBatchPublishData->pxPublishParams[ x ].xQos == eMQTTQoS0 )
+        {
+            ulQoS0Count++;
+        }
+        else
+        {
+            /* The requesting task has taken the in-flight window semaphore
+             * once for every QoS1 message, so a free entry must be available. */
+            pxInflightPublish = prvStoreInflightPublish( pxConnection,
+                                                         pxBatchPublishData->pxCallback,
+                                                         pxBatchPublishData->pvCallbackContext,
+                                                         pxBatchPublishData->pxPublishParams[ x ].usPacketIdentifier );
+            configASSERT( pxInflightPublish != NULL );
+        }
+    }
+
+    if( MQTT_PublishV( &( pxConnection->xMQTTContext ), pxBatchPublishData->pxPublishParams, pxBatchPublishData->ulPublishCount ) == eMQTTSuccess )
+    {
+        /* pxBatchPublishData lives on the stack of the requesting task
+         * and must not be accessed once that task is notified. */
+        pxCallback = pxBatchPublishData->pxCallback;
+        pvCallbackContext = pxBatchPublishData->pvCallbackContext;
+
+        /* The messages have been sent, so unblock the task that
+         * initiated the publish operation. */
+        prvNotifyRequestingTask( &( pxEventData->xNotificationData ), eMQTTPUBSent, pdPASS );
+
+        /* The QoS0 messages are complete as soon as they are sent. */
+        if( pxCallback != NULL )
+        {
+            for( x = 0; x < ulQoS0Count; x++ )
+            {
+                pxCallback( pvCallbackContext, eMQTTAgentSuccess );
+            }
+        }
+    }
+    else
+    {
+        mqttconfigDEBUG_LOG( ( "MQTT_PublishV failed!\r\n" ) );
+
+        /* Free the entries stored for the QoS1 messages of this batch.
+         * The requesting task gives back the in-flight window semaphore. */
+        for( y = 0; y < ( UBaseType_t ) mqttconfigMAX_INFLIGHT_PUBLISHES; y++ )
+        {
+            pxInflightPublish = &( pxConnection->xInflightPublishes[ y ] );
+
+            if( ( pxInflightPublish->xInUse == pdTRUE ) &&
+                ( ( uint16_t ) ( pxInflightPublish->usPacketIdentifier - usFirstPacketIdentifier ) < ( uint16_t ) pxBatchPublishData->ulPublishCount ) )
+            {
+                pxInflightPublish->xInUse = pdFALSE;
+            }
+        }
+
+        prvNotifyRequestingTask( &( pxEventData->xNotificationData ), eMQTTPUBCouldNotBeSent, pdFAIL );
+    }
+}
+/*-----------------------------------------------------------*/
+
 static MQTTAgentReturnCode_t prvSendCommandToMQTTTask( MQTTEventData_t * pxEventData )
 {
     BaseType_t xReturn;
     MQTTAgentReturnCode_t xReturnCode = eMQTTAgentFailure;
     uint32_t ulReceivedMessageIdentifier;
+    uint32_t ulMessageIdentifiers = mqttMESSAGE_IDENTIFIER_MIN;
+
+    /* A batch publish uses one message identifier per message. */
+    if( pxEventData->xEventType == eMQTTPublishBatchRequest )
+    {
+        ulMessageIdentifiers *= pxEventData->u.pxBatchPublishData->ulPublishCount;
+    }
 
     /* Should not try to send commands until after the MQTT task has been
      * initialized, in which case the command queue will have been created. */
@@ -1649,9 +2062,15 @@ static MQTTAgentReturnCode_t prvSendCommandToMQTTTask( MQTTEventData_t * pxEvent
              * acknowledged.  A critical region is used as a single message identifier
              * variable is used by all connections. The identifier uses the top 16-bits
              * of the 32-bit word, leaving the lowest 16-bits free for use by the MQTT
-             * task to return a status code. */
+             * task to return a status code. The identifiers reserved for
+             * a batch publish must not wrap around. */
+            if( ulQueueMessageIdentifier > ( mqttMESSAGE_IDENTIFIER_MAX - ulMessageIdentifiers ) )
+            {
+                ulQueueMessageIdentifier = mqttMESSAGE_IDENTIFIER_MIN;
+            }
+
             pxEventData->xNotificationData.ulMessageIdentifier = ulQueueMessageIdentifier;
-            ulQueueMessageIdentifier += mqttMESSAGE_IDENTIFIER_MIN;
+            ulQueueMessageIdentifier += ulMessageIdentifiers;
 
             if( ulQueueMessageIdentifier >= mqttMESSAGE_IDENTIFIER_MAX )
             {
@@ -1802,6 +2221,14 @@ static void prvMQTTTask( void * pvParameters )
                         prvInitiateMQTTPublish( &( xMQTTCommand ) );
                         break;
 
+                    case eMQTTPublishAsyncRequest:
+                        prvInitiateMQTTPublishAsync( &( xMQTTCommand ) );
+                        break;
+
+                    case eMQTTPublishBatchRequest:
+                        prvInitiateMQTTPublishBatch( &( xMQTTCommand ) );
+                        break;
+
                     default:
                         /* Anything else is illegal. */
                         mqttconfigDEBUG_LOG( ( "Unknown request received on command queue.\r\n" ) );
@@ -1879,6 +2306,17 @@ BaseType_t MQTT_AGENT_Init( void )
                 xMQTTConnections[ x ].xWaitingTasks[ y ].xTaskToNotify = NULL;
                 xMQTTConnections[ x ].xWaitingTasks[ y ].ulMessageIdentifier = 0;
             }
+
+            /* Initialize the in-flight window. All the entries are free. */
+            for( y = 0; y < ( UBaseType_t ) mqttconfigMAX_INFLIGHT_PUBLISHES; y++ )
+            {
+                xMQTTConnections[ x ].xInflightPublishes[ y ].xInUse = pdFALSE;
+            }
+
+            xMQTTConnections[ x ].xInflightWindow = xSemaphoreCreateCountingStatic( mqttconfigMAX_INFLIGHT_PUBLISHES,
+                                                                                   mqttconfigMAX_INFLIGHT_PUBLISHES,
+                                                                                   &( xMQTTConnections[ x ].xInflightWindowBuffer ) );
+            configASSERT( xMQTTConnections[ x ].xInflightWindow );
         }
 
         /* ulQueueMessageIdentifier uses the top 16-bits of a 32-bit value, so
@@ -2049,6 +2487,188 @@ MQTTAgentReturnCode_t MQTT_AGENT_Publish( MQTTAgentHandle_t xMQTTHandle,
 }
 /*-----------------------------------------------------------*/
 
+MQTTAgentReturnCode_t MQTT_AGENT_PublishAsync( MQTTAgentHandle_t xMQTTHandle,
+                                               const MQTTAgentPublishParams_t * const pxPublishParams,
+                                               MQTTAgentPublishCallback_t pxCompletionCallback,
+                                               void * pvCompletionContext,
+                                               TickType_t xTimeoutTicks )
+{
+    MQTTEventData_t xEventData;
+    MQTTAsyncPublishData_t xAsyncPublishData;
+    MQTTAgentReturnCode_t xReturnCode = eMQTTAgentSuccess;
+    TimeOut_t xTimeOut;
+    TickType_t xTicksToWait = xTimeoutTicks;
+    const UBaseType_t uxBrokerNumber = ( UBaseType_t ) mqttDECODE_BROKER_NUMBER( xMQTTHandle ); /*lint !e923 Opaque pointer. */
+    MQTTBrokerConnection_t * pxConnection = &( xMQTTConnections[ uxBrokerNumber ] );
+
+    /* Record the time at which this function was called. */
+    vTaskSetTimeOutState( &( xTimeOut ) );
+
+    if( pxPublishParams->xQoS != eMQTTQoS0 )
+    {
+        /* The in-flight window is freed by the MQTT task and therefore
+         * the MQTT task must not wait for it. */
+        if( xTaskGetCurrentTaskHandle() == xMQTTTaskHandle )
+        {
+            mqttconfigDEBUG_LOG( ( "MQTT Agent API called from MQTT task ( possibly from callback ) !!.\r\n" ) );
+            xReturnCode = eMQTTAgentAPICalledFromCallback;
+        }
+        else if( xSemaphoreTake( pxConnection->xInflightWindow, xTicksToWait ) == pdFALSE )
+        {
+            /* mqttconfigMAX_INFLIGHT_PUBLISHES messages are still
+             * waiting for PUBACK. */
+            mqttconfigDEBUG_LOG( ( "Timed out waiting for room in the MQTT in-flight window.\r\n" ) );
+            xReturnCode = eMQTTAgentTimeout;
+        }
+        else
+        {
+            /* Only the remaining time is left to send the message. */
+            ( void ) xTaskCheckForTimeOut( &( xTimeOut ), &( xTicksToWait ) );
+        }
+    }
+
+    if( xReturnCode == eMQTTAgentSuccess )
+    {
+        /* Setup the asynchronous publish parameters. */
+        xAsyncPublishData.pxPublishParams = pxPublishParams;
+        xAsyncPublishData.pxCallback = pxCompletionCallback;
+        xAsyncPublishData.pvCallbackContext = pvCompletionContext;
+        xAsyncPublishData.xAckTimeoutTicks = xTimeoutTicks;
+
+        /* Setup the event to be sent to the command queue. */
+        xEventData.uxBrokerNumber = uxBrokerNumber;
+        xEventData.xEventType = eMQTTPublishAsyncRequest;
+        xEventData.xTicksToWait = xTicksToWait;
+        xEventData.u.pxAsyncPublishData = &( xAsyncPublishData );
+
+        /* Note that the notification data part of xEventData and
+         * xEventCreationTimestamp are set in the following call. */
+        xReturnCode = prvSendCommandToMQTTTask( &xEventData );
+
+        /* If the message was not sent, the MQTT task does not wait for
+         * a PUBACK and the entry in the in-flight window is free again. */
+        if( ( xReturnCode != eMQTTAgentSuccess ) && ( pxPublishParams->xQoS != eMQTTQoS0 ) )
+        {
+            ( void ) xSemaphoreGive( pxConnection->xInflightWindow );
+        }
+    }
+
+    /* Return the code to the user. */
+    return xReturnCode;
+}
+/*-----------------------------------------------------------*/
+
+MQTTAgentReturnCode_t MQTT_AGENT_PublishBatch( MQTTAgentHandle_t xMQTTHandle,
+                                               const MQTTAgentPublishParams_t * const pxPublishParams,
+                                               uint32_t ulPublishCount,
+                                               MQTTAgentPublishCallback_t pxCompletionCallback,
+                                               void * pvCompletionContext,
+                                               TickType_t xTimeoutTicks )
+{
+    MQTTEventData_t xEventData;
+    MQTTBatchPublishData_t xBatchPublishData;
+    MQTTPublishParams_t xPublishParams[ mqttconfigMAX_PUBLISH_BATCH ];
+    MQTTAgentReturnCode_t xReturnCode = eMQTTAgentSuccess;
+    TimeOut_t xTimeOut;
+    TickType_t xTicksToWait = xTimeoutTicks;
+    uint32_t x, ulQoS1Count = 0, ulWindowSlotsTaken = 0;
+    const UBaseType_t uxBrokerNumber = ( UBaseType_t ) mqttDECODE_BROKER_NUMBER( xMQTTHandle ); /*lint !e923 Opaque pointer. */
+    MQTTBrokerConnection_t * pxConnection = &( xMQTTConnections[ uxBrokerNumber ] );
+
+    /* Record the time at which this function was called. */
+    vTaskSetTimeOutState( &( xTimeOut ) );
+
+    if( ( ulPublishCount == 0 ) || ( ulPublishCount > ( uint32_t ) mqttconfigMAX_PUBLISH_BATCH ) )
+    {
+        mqttconfigDEBUG_LOG( ( "Invalid number of messages in MQTT batch publish.\r\n" ) );
+        xReturnCode = eMQTTAgentFailure;
+    }
+    else if( xTaskGetCurrentTaskHandle() == xMQTTTaskHandle )
+    {
+        /* The in-flight window is freed by the MQTT task and therefore
+         * the MQTT task must not wait for it. */
+        mqttconfigDEBUG_LOG( ( "MQTT Agent API called from MQTT task ( possibly from callback ) !!.\r\n" ) );
+        xReturnCode = eMQTTAgentAPICalledFromCallback;
+    }
+    else
+    {
+        /* Setup the Core library publish parameters. The packet
+         * identifiers are filled in by the MQTT task. */
+        for( x = 0; x < ulPublishCount; x++ )
+        {
+            xPublishParams[ x ].pucTopic = pxPublishParams[ x ].pucTopic;
+            xPublishParams[ x ].usTopicLength = pxPublishParams[ x ].usTopicLength;
+            xPublishParams[ x ].xQos = pxPublishParams[ x ].xQoS;
+            xPublishParams[ x ].pvData = pxPublishParams[ x ].pvData;
+            xPublishParams[ x ].ulDataLength = pxPublishParams[ x ].ulDataLength;
+            xPublishParams[ x ].usPacketIdentifier = 0;
+            xPublishParams[ x ].ulTimeoutTicks = xTimeoutTicks;
+
+            if( pxPublishParams[ x ].xQoS != eMQTTQoS0 )
+            {
+                ulQoS1Count++;
+            }
+        }
+
+        /* The whole batch must fit in the in-flight window. */
+        if( ulQoS1Count > ( uint32_t ) mqttconfigMAX_INFLIGHT_PUBLISHES )
+        {
+            mqttconfigDEBUG_LOG( ( "Too many QoS1 messages in MQTT batch publish.\r\n" ) );
+            xReturnCode = eMQTTAgentFailure;
+        }
+
+        /* Wait for room in the in-flight window for every QoS1 message. */
+        while( ( xReturnCode == eMQTTAgentSuccess ) && ( ulWindowSlotsTaken < ulQoS1Count ) )
+        {
+            if( xSemaphoreTake( pxConnection->xInflightWindow, xTicksToWait ) == pdFALSE )
+            {
+                mqttconfigDEBUG_LOG( ( "Timed out waiting for room in the MQTT in-flight window.\r\n" ) );
+                xReturnCode = eMQTTAgentTimeout;
+            }
+            else
+            {
+                ulWindowSlotsTaken++;
+
+                /* Only the remaining time is left for the rest. */
+                ( void ) xTaskCheckForTimeOut( &( xTimeOut ), &( xTicksToWait ) );
+            }
+        }
+    }
+
+    if( xReturnCode == eMQTTAgentSuccess )
+    {
+        /* Setup the batch publish parameters. */
+        xBatchPublishData.pxPublishParams = xPublishParams;
+        xBatchPublishData.ulPublishCount = ulPublishCount;
+        xBatchPublishData.pxCallback = pxCompletionCallback;
+        xBatchPublishData.pvCallbackContext = pvCompletionContext;
+
+        /* Setup the event to be sent to the command queue. */
+        xEventData.uxBrokerNumber = uxBrokerNumber;
+        xEventData.xEventType = eMQTTPublishBatchRequest;
+        xEventData.xTicksToWait = xTicksToWait;
+        xEventData.u.pxBatchPublishData = &( xBatchPublishData );
+
+        /* Note that the notification data part of xEventData and
+         * xEventCreationTimestamp are set in the following call. */
+        xReturnCode = prvSendCommandToMQTTTask( &xEventData );
+    }
+
+    /* If the messages were not sent, the MQTT task does not wait for
+     * any PUBACK and the entries in the in-flight window are free again. */
+    if( xReturnCode != eMQTTAgentSuccess )
+    {
+        for( x = 0; x < ulWindowSlotsTaken; x++ )
+        {
+            ( void ) xSemaphoreGive( pxConnection->xInflightWindow );
+        }
+    }
+
+    /* Return the code to the user. */
+    return xReturnCode;
+}
+/*-----------------------------------------------------------*/
+
 MQTTAgentReturnCode_t MQTT_AGENT_ReturnBuffer( MQTTAgentHandle_t xMQTTHandle,
                                                MQTTBufferHandle_t xBufferHandle )
 {
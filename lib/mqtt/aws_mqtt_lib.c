@@ -323,9 +323,55 @@
 #define mqttCOPY_BYTES( srcBuffer, srcIndex, dstBuffer, dstIndex, byteCount )                            \
     {                                                                                                    \
         memcpy( &( ( dstBuffer )[ ( dstIndex ) ] ), &( ( srcBuffer )[ ( srcIndex ) ] ), ( byteCount ) ); \
+        mqttconfigTRACE_BYTES_COPIED( ( uint32_t ) ( byteCount ) );                                      \
         ( srcIndex ) = ( uint32_t ) ( srcIndex ) + ( uint32_t ) ( byteCount );                           \
         ( dstIndex ) = ( uint32_t ) ( dstIndex ) + ( uint32_t ) ( byteCount );                           \
     }
+
+/**
+ * @brief Same as mqttCOPY_BYTES except that no bytes are copied if the
+ * received bytes are already in place.
+ *
+ * @param[in] xInPlace eMQTTTrue if the bytes were received directly into the
+ * destination buffer.
+ * @param[in] srcBuffer The source buffer to copy from.
+ * @param[in,out] srcIndex The index in the source buffer from where to start
+ * copying from. It is incremented by the number of bytes consumed.
+ * @param[out] dstBuffer The destination buffer to copy to.
+ * @param[in,out] dstIndex The index in the destination buffer where to start
+ * copying to. It is incremented by the number of bytes consumed.
+ * @param[in] byteCount The number of bytes to consume.
+ */
+#define mqttCONSUME_BYTES( xInPlace, srcBuffer, srcIndex, dstBuffer, dstIndex, byteCount )     \
+    {                                                                                         \
+        if( ( xInPlace ) == eMQTTTrue )                                                       \
+        {                                                                                     \
+            ( srcIndex ) = ( uint32_t ) ( srcIndex ) + ( uint32_t ) ( byteCount );            \
+            ( dstIndex ) = ( uint32_t ) ( dstIndex ) + ( uint32_t ) ( byteCount );            \
+        }                                                                                     \
+        else                                                                                  \
+        {                                                                                     \
+            mqttCOPY_BYTES( srcBuffer, srcIndex, dstBuffer, dstIndex, byteCount );            \
+        }                                                                                     \
+    }
+
+/**
+ * @defgroup TopicTrie Topic filter trie constants.
+ */
+/** @{ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+    #if ( mqttconfigSUBSCRIPTION_MANAGER_MAX_TRIE_NODES >= 0xFFFF ) || ( mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS >= 0xFFFF )
+        #error "mqttconfigSUBSCRIPTION_MANAGER_MAX_TRIE_NODES and mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS must be less than 0xFFFF."
+    #endif
+
+    #define mqttTRIE_ROOT_NODE              ( ( uint16_t ) 0 )                                                     /**< The root node. It does not represent any topic level. */
+    #define mqttTRIE_NONE                   ( ( uint16_t ) 0xFFFF )                                                /**< Marks the absence of a node or subscription. */
+    #define mqttTRIE_LEVEL_LITERAL          ( ( uint8_t ) 0 )                                                      /**< A topic level without wild-cards. */
+    #define mqttTRIE_LEVEL_SINGLE_WILDCARD  ( ( uint8_t ) 1 )                                                      /**< The '+' topic level. */
+    #define mqttTRIE_LEVEL_MULTI_WILDCARD   ( ( uint8_t ) 2 )                                                      /**< The '#' topic level. */
+    #define mqttTRIE_MAX_PENDING_NODES      ( ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS + ( uint32_t ) 1 ) /**< Depth of the stack used to walk the wild-card branches of the trie. */
+#endif
+/** @} */
 /*-----------------------------------------------------------*/
 
 /**
@@ -589,6 +635,54 @@ static void prvProcessReceivedPINGRESP( MQTTContext_t * pxMQTTContext );
  */
 static void prvProcessReceivedPublish( MQTTContext_t * pxMQTTContext );
 
+/**
+ * @brief Calculates the "Remaining Length" of a publish message.
+ *
+ * @param[in] pxPublishParams Publish parameters.
+ *
+ * @return The "Remaining Length" of the publish message i.e. the length of
+ * the message excluding the fixed header.
+ */
+static uint32_t prvGetPublishRemainingLength( const MQTTPublishParams_t * const pxPublishParams );
+
+/**
+ * @brief Writes a publish message into the given buffer.
+ *
+ * The buffer must be large enough to hold the complete message i.e. the
+ * fixed header followed by ulRemainingLength bytes.
+ *
+ * @param[out] pucBuffer The buffer to write the message to.
+ * @param[in] pucLastByteInBuffer Pointer to the last byte in the buffer.
+ * @param[in] pxPublishParams Publish parameters.
+ * @param[in] ulRemainingLength The "Remaining Length" of the message as
+ * returned by prvGetPublishRemainingLength.
+ */
+static void prvWritePublish( uint8_t * pucBuffer,
+                             const uint8_t * const pucLastByteInBuffer,
+                             const MQTTPublishParams_t * const pxPublishParams,
+                             uint32_t ulRemainingLength );
+
+/**
+ * @brief Decodes the incoming bytes.
+ *
+ * Implements MQTT_ParseReceivedData and MQTT_ParseReceivedInPlace. The
+ * incoming bytes are buffered until a complete MQTT message has been
+ * received after which the message is processed.
+ *
+ * @param[in] pxMQTTContext The MQTT context for which the bytes were received.
+ * @param[in] pucReceivedData Received bytes.
+ * @param[in] xReceivedDataLength Number of received bytes.
+ * @param[in] xReceivedInPlace eMQTTTrue if the bytes were received into the
+ * location returned by MQTT_GetReceiveLocation, in which case they are not
+ * copied.
+ *
+ * @return eMQTTSuccess if everything succeeds, otherwise an error code explaining the reason of failure.
+ */
+static MQTTReturnCode_t prvParseReceivedData( MQTTContext_t * pxMQTTContext,
+                                              const uint8_t * pucReceivedData,
+                                              size_t xReceivedDataLength,
+                                              MQTTBool_t xReceivedInPlace );
+
 /**
  * @brief Invokes the user supplied callback.
  *
@@ -838,6 +932,160 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
                                                     uint16_t usTopicFilterLength );
 
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+
+/**
+ * @brief Returns the length of the topic level starting at the given offset.
+ *
+ * The topic level ends at the next '/' character or at the end of the topic.
+ *
+ * @param[in] pucTopic The topic or topic filter.
+ * @param[in] usTopicLength The length of the topic or topic filter.
+ * @param[in] ulLevelOffset The offset of the first character of the topic level.
+ *
+ * @return The length of the topic level.
+ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    static uint16_t prvGetTopicLevelLength( const uint8_t * const pucTopic,
+                                            uint16_t usTopicLength,
+                                            uint32_t ulLevelOffset );
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+
+/**
+ * @brief Finds the child of the given trie node whose topic level is the
+ * given one.
+ *
+ * The topic levels are compared as strings, so a '+' or '#' level only
+ * matches the node created for the same wild-card.
+ *
+ * @param[in] pxSubscriptionManager The subscription manager containing the trie.
+ * @param[in] usParent The node whose children to search.
+ * @param[in] pucLevel The topic level to find.
+ * @param[in] usLevelLength The length of the topic level.
+ *
+ * @return The child node if found, mqttTRIE_NONE otherwise.
+ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    static uint16_t prvFindTopicTrieChild( const MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                           uint16_t usParent,
+                                           const uint8_t * const pucLevel,
+                                           uint16_t usLevelLength );
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+
+/**
+ * @brief Finds the subscription for the given topic filter in the trie.
+ *
+ * @param[in] pxSubscriptionManager The subscription manager containing the trie.
+ * @param[in] pucTopicFilter The topic filter to find.
+ * @param[in] usTopicFilterLength The length of the topic filter.
+ *
+ * @return The index of the subscription if found, mqttTRIE_NONE otherwise.
+ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    static uint16_t prvFindTopicTrieSubscription( const MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                                  const uint8_t * const pucTopicFilter,
+                                                  uint16_t usTopicFilterLength );
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+
+/**
+ * @brief Adds the topic filter of the given subscription entry to the trie.
+ *
+ * The nodes for the topic levels already present in the trie are shared,
+ * and new nodes are taken from the free list for the rest.
+ *
+ * @param[in] pxSubscriptionManager The subscription manager containing the trie.
+ * @param[in] usSubscription The index of the subscription entry. The topic
+ * filter must already be stored in the entry.
+ *
+ * @return eMQTTTrue if the topic filter was added, eMQTTFalse if it has more
+ * than mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS levels or there are not
+ * enough free nodes in the trie.
+ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    static MQTTBool_t prvInsertTopicTrieSubscription( MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                                      uint16_t usSubscription );
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+
+/**
+ * @brief Removes the topic filter of the given subscription entry from the
+ * trie.
+ *
+ * Nodes no longer used by any subscription are returned to the free list.
+ * Nodes still in use which take their topic level text from the removed
+ * subscription are handed over to another subscription sharing them.
+ *
+ * @param[in] pxSubscriptionManager The subscription manager containing the trie.
+ * @param[in] usSubscription The index of the subscription entry.
+ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    static void prvRemoveTopicTrieSubscription( MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                                uint16_t usSubscription );
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+
+/**
+ * @brief Invokes the subscription callbacks for the given publish message
+ * by walking the trie.
+ *
+ * Follows the same sequence as prvInvokeSubscriptionCallbacks - the topic
+ * filter without wild-cards matching the topic first, then the topic filters
+ * with wild-cards. Only the branches of the trie matching the topic are
+ * visited, so the cost depends on the number of levels in the topic and not
+ * on the number of subscriptions.
+ *
+ * @param[in] pxSubscriptionManager The subscription manager containing the trie.
+ * @param[in] pxPublishData The publish data containing the topic and the received message.
+ * @param[out] pxSubscriptionCallbackInvoked Set to eMQTTTrue if any callback was invoked.
+ *
+ * @return eMQTTTrue if the user took the ownership of the MQTT buffer, eMQTTFalse otherwise.
+ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    static MQTTBool_t prvInvokeTopicTrieCallbacks( MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                                   const MQTTPublishData_t * pxPublishData,
+                                                   MQTTBool_t * pxSubscriptionCallbackInvoked );
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+
+/**
+ * @brief Invokes the callback of the subscription ending at the given trie
+ * node, if any.
+ *
+ * @param[in] pxSubscriptionManager The subscription manager containing the trie.
+ * @param[in] usNode The trie node.
+ * @param[in] pxPublishData The publish data containing the topic and the received message.
+ * @param[out] pxSubscriptionCallbackInvoked Set to eMQTTTrue if the callback was invoked.
+ *
+ * @return eMQTTTrue if the user took the ownership of the MQTT buffer, eMQTTFalse otherwise.
+ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    static MQTTBool_t prvInvokeTopicTrieNodeCallback( const MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                                      uint16_t usNode,
+                                                      const MQTTPublishData_t * pxPublishData,
+                                                      MQTTBool_t * pxSubscriptionCallbackInvoked );
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+
+/**
+ * @brief Empties the trie and links all the nodes other than the root into
+ * the free list.
+ *
+ * @param[in] pxSubscriptionManager The subscription manager containing the trie.
+ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    static void prvResetTopicTrie( MQTTSubscriptionManager_t * pxSubscriptionManager );
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
 /*-----------------------------------------------------------*/
 
 static MQTTBufferHandle_t prvGetFreeBuffer( MQTTContext_t * pxMQTTContext,
@@ -1037,6 +1285,11 @@ static void prvResetMQTTContext( MQTTContext_t * pxMQTTContext )
 
         /* Set the number of in-use subscription entries to zero. */
         pxMQTTContext->xSubscriptionManager.ulInUseSubscriptions = 0;
+
+        #if ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+            /* Empty the topic filter trie. */
+            prvResetTopicTrie( &( pxMQTTContext->xSubscriptionManager ) );
+        #endif
     #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 }
 /*-----------------------------------------------------------*/
@@ -1832,6 +2085,7 @@ static uint8_t * prvWriteString( uint8_t * pucDestination,
         *pucDestination = ( uint8_t ) usStringLength;
         pucDestination++;
         memcpy( pucDestination, pucString, usStringLength );
+        mqttconfigTRACE_BYTES_COPIED( ( uint32_t ) usStringLength );
     }
     else
     {
@@ -2022,6 +2276,17 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
                             pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].pxPublishCallback = pxPublishCallback;
                             pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xTopicFilterType = xTopicFilterType;
 
+                            #if ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+                                /* Add the topic filter to the trie. Free the entry
+                                 * again if it does not fit. */
+                                if( prvInsertTopicTrieSubscription( &( pxMQTTContext->xSubscriptionManager ), ( uint16_t ) x ) == eMQTTFalse )
+                                {
+                                    pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xInUse = eMQTTFalse;
+                                    mqttconfigDEBUG_LOG( ( "WARN: Topic filter has too many levels or the topic filter trie is full. Consider increasing mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS or mqttconfigSUBSCRIPTION_MANAGER_MAX_TRIE_NODES.\r\n" ) );
+                                    break;
+                                }
+                            #endif /* mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+
                             /* Increase the in-use subscription entries count. */
                             pxMQTTContext->xSubscriptionManager.ulInUseSubscriptions += ( uint32_t ) 1;
 
@@ -2064,30 +2329,49 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
                                        const uint8_t * const pucTopic,
                                        uint16_t usTopicLength )
     {
-        uint32_t x;
+        #if ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+            uint16_t usSubscription;
 
-        /* Iterate over all the subscription entries in
-         * the subscription manager and try to find the
-         * matching one. */
-        for( x = 0; x < ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS; x++ )
-        {
-            if( ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xInUse == eMQTTTrue ) &&
-                ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].usTopicFilterLength == usTopicLength ) )
+            /* Look the topic filter up in the trie. */
+            usSubscription = prvFindTopicTrieSubscription( &( pxMQTTContext->xSubscriptionManager ), pucTopic, usTopicLength );
+
+            if( usSubscription != mqttTRIE_NONE )
             {
-                if( memcmp( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].ucTopicFilter, pucTopic, usTopicLength ) == 0 )
+                /* Found a matching subscription, remove it from the
+                 * trie and mark it as free. */
+                prvRemoveTopicTrieSubscription( &( pxMQTTContext->xSubscriptionManager ), usSubscription );
+                pxMQTTContext->xSubscriptionManager.xSubscriptions[ usSubscription ].xInUse = eMQTTFalse;
+
+                /* Reduce the count of in-use subscription entries
+                 * in the subscription manager. */
+                pxMQTTContext->xSubscriptionManager.ulInUseSubscriptions -= ( uint32_t ) 1;
+            }
+        #else
+            uint32_t x;
+
+            /* Iterate over all the subscription entries in
+             * the subscription manager and try to find the
+             * matching one. */
+            for( x = 0; x < ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS; x++ )
+            {
+                if( ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xInUse == eMQTTTrue ) &&
+                    ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].usTopicFilterLength == usTopicLength ) )
                 {
-                    /* Found a matching subscription, mark it as free. */
-                    pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xInUse = eMQTTFalse;
+                    if( memcmp( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].ucTopicFilter, pucTopic, usTopicLength ) == 0 )
+                    {
+                        /* Found a matching subscription, mark it as free. */
+                        pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xInUse = eMQTTFalse;
 
-                    /* Reduce the count of in-use subscription entries
-                     * in the subscription manager. */
-                    pxMQTTContext->xSubscriptionManager.ulInUseSubscriptions -= ( uint32_t ) 1;
+                        /* Reduce the count of in-use subscription entries
+                         * in the subscription manager. */
+                        pxMQTTContext->xSubscriptionManager.ulInUseSubscriptions -= ( uint32_t ) 1;
 
-                    /* Done. */
-                    break;
+                        /* Done. */
+                        break;
+                    }
                 }
             }
-        }
+        #endif /* mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
     }
 
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
@@ -2135,64 +2419,28 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
                                                       MQTTBool_t * pxSubscriptionCallbackInvoked )
     {
         MQTTBool_t xBufferOwnershipTaken = eMQTTFalse;
-        MQTTSubscription_t * pxSubscription;
-        uint32_t x;
-
-        /* Set the output parameter to eMQTTFalse. It will
-         * be set to eMQTTTrue if any callback is invoked. */
-        *pxSubscriptionCallbackInvoked = eMQTTFalse;
-
-        /* Iterate over the subscription entries containing topic filters
-         * without any wild-cards and invoke the registered callbacks. */
-        for( x = 0; x < ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS; x++ )
-        {
-            if( ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xInUse == eMQTTTrue ) &&
-                ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xTopicFilterType == eMQTTTopicFilterTypeSimple ) &&
-                ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].usTopicFilterLength == pxPublishData->usTopicLength ) )
-            {
-                if( memcmp( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].ucTopicFilter, pxPublishData->pucTopic, pxPublishData->usTopicLength ) == 0 )
-                {
-                    /* Found a matching subscription. */
-                    pxSubscription = &( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ] );
 
-                    /* If a callback is registered with the subscription,
-                     * invoke it. */
-                    if( pxSubscription->pxPublishCallback != NULL )
-                    {
-                        /* Note that a callback was invoked. */
-                        *pxSubscriptionCallbackInvoked = eMQTTTrue;
-
-                        /* Invoke callback. */
-                        xBufferOwnershipTaken = pxSubscription->pxPublishCallback( pxSubscription->pvPublishCallbackContext, pxPublishData );
+        #if ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+            xBufferOwnershipTaken = prvInvokeTopicTrieCallbacks( &( pxMQTTContext->xSubscriptionManager ),
+                                                                 pxPublishData,
+                                                                 pxSubscriptionCallbackInvoked );
+        #else
+            MQTTSubscription_t * pxSubscription;
+            uint32_t x;
 
-                        /* If the user takes the buffer ownership, do
-                         * not invoke any other callbacks. */
-                        if( xBufferOwnershipTaken == eMQTTTrue )
-                        {
-                            break;
-                        }
-                    }
-                }
-            }
-        }
+            /* Set the output parameter to eMQTTFalse. It will
+             * be set to eMQTTTrue if any callback is invoked. */
+            *pxSubscriptionCallbackInvoked = eMQTTFalse;
 
-        /* If the user has not taken the buffer ownership yet (which can
-         * happen if there is no exact matching entry in the subscription
-         * manager or the user does not take the ownership in the callback),
-         * iterate over the subscription entries containing topic filters
-         * with wild-cards and invoke the registered callbacks for the ones
-         * which match the topic. */
-        if( xBufferOwnershipTaken == eMQTTFalse )
-        {
+            /* Iterate over the subscription entries containing topic filters
+             * without any wild-cards and invoke the registered callbacks. */
             for( x = 0; x < ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS; x++ )
             {
                 if( ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xInUse == eMQTTTrue ) &&
-                    ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xTopicFilterType == eMQTTTopicFilterTypeWildCard ) )
+                    ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xTopicFilterType == eMQTTTopicFilterTypeSimple ) &&
+                    ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].usTopicFilterLength == pxPublishData->usTopicLength ) )
                 {
-                    if( prvDoesTopicMatchTopicFilter( pxPublishData->pucTopic,
-                                                      pxPublishData->usTopicLength,
-                                                      pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].ucTopicFilter,
-                                                      pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].usTopicFilterLength ) == eMQTTTrue )
+                    if( memcmp( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].ucTopicFilter, pxPublishData->pucTopic, pxPublishData->usTopicLength ) == 0 )
                     {
                         /* Found a matching subscription. */
                         pxSubscription = &( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ] );
@@ -2217,7 +2465,50 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
                     }
                 }
             }
-        }
+
+            /* If the user has not taken the buffer ownership yet (which can
+             * happen if there is no exact matching entry in the subscription
+             * manager or the user does not take the ownership in the callback),
+             * iterate over the subscription entries containing topic filters
+             * with wild-cards and invoke the registered callbacks for the ones
+             * which match the topic. */
+            if( xBufferOwnershipTaken == eMQTTFalse )
+            {
+                for( x = 0; x < ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS; x++ )
+                {
+                    if( ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xInUse == eMQTTTrue ) &&
+                        ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xTopicFilterType == eMQTTTopicFilterTypeWildCard ) )
+                    {
+                        if( prvDoesTopicMatchTopicFilter( pxPublishData->pucTopic,
+                                                          pxPublishData->usTopicLength,
+                                                          pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].ucTopicFilter,
+                                                          pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].usTopicFilterLength ) == eMQTTTrue )
+                        {
+                            /* Found a matching subscription. */
+                            pxSubscription = &( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ] );
+
+                            /* If a callback is registered with the subscription,
+                             * invoke it. */
+                            if( pxSubscription->pxPublishCallback != NULL )
+                            {
+                                /* Note that a callback was invoked. */
+                                *pxSubscriptionCallbackInvoked = eMQTTTrue;
+
+                                /* Invoke callback. */
+                                xBufferOwnershipTaken = pxSubscription->pxPublishCallback( pxSubscription->pvPublishCallbackContext, pxPublishData );
+
+                                /* If the user takes the buffer ownership, do
+                                 * not invoke any other callbacks. */
+                                if( xBufferOwnershipTaken == eMQTTTrue )
+                                {
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        #endif /* mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
 
         /* Return whether or not the user has taken the
          * ownership of the MQTT buffer. */
@@ -2412,6 +2703,17 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
             xTopicMatchesTopicFilter = eMQTTTrue;
         }
 
+        /* Filter of type "sport/#" also matches "sport/" since #
+         * matches the empty last level. In this case the topic is
+         * consumed and only the '#' remains in the topic filter. */
+        if( ( xTopicMatchesTopicFilter == eMQTTFalse ) &&
+            ( ( usTopicIndex > ( uint16_t ) 0 ) && ( usTopicIndex >= usTopicLength ) ) &&
+            ( usTopicFilterIndex == usTopicFilterLength - ( uint16_t ) 1 ) &&
+            ( pucTopicFilter[ usTopicFilterIndex ] == ( uint8_t ) '#' ) )
+        {
+            xTopicMatchesTopicFilter = eMQTTTrue;
+        }
+
         /* Return the result. */
         return xTopicMatchesTopicFilter;
     }
@@ -2419,6 +2721,432 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 /*-----------------------------------------------------------*/
 
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    static uint16_t prvGetTopicLevelLength( const uint8_t * const pucTopic,
+                                            uint16_t usTopicLength,
+                                            uint32_t ulLevelOffset )
+    {
+        uint32_t x = ulLevelOffset;
+
+        /* Consume the characters until the next separator or the end
+         * of the topic. */
+        while( ( x < ( uint32_t ) usTopicLength ) && ( pucTopic[ x ] != ( uint8_t ) '/' ) )
+        {
+            x++;
+        }
+
+        return ( uint16_t ) ( x - ulLevelOffset );
+    }
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    static uint16_t prvFindTopicTrieChild( const MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                           uint16_t usParent,
+                                           const uint8_t * const pucLevel,
+                                           uint16_t usLevelLength )
+    {
+        const MQTTTopicTrieNode_t * pxChild;
+        uint16_t usChild;
+
+        for( usChild = pxSubscriptionManager->xTrieNodes[ usParent ].usFirstChild;
+             usChild != mqttTRIE_NONE;
+             usChild = pxChild->usNextSibling )
+        {
+            pxChild = &( pxSubscriptionManager->xTrieNodes[ usChild ] );
+
+            /* The text of the level is stored in the topic filter of
+             * the owner subscription. */
+            if( ( pxChild->usLevelLength == usLevelLength ) &&
+                ( memcmp( &( pxSubscriptionManager->xSubscriptions[ pxChild->usOwner ].ucTopicFilter[ pxChild->usLevelOffset ] ),
+                          pucLevel,
+                          usLevelLength ) == 0 ) )
+            {
+                break;
+            }
+        }
+
+        return usChild;
+    }
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    static uint16_t prvFindTopicTrieSubscription( const MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                                  const uint8_t * const pucTopicFilter,
+                                                  uint16_t usTopicFilterLength )
+    {
+        uint16_t usNode = mqttTRIE_ROOT_NODE, usLevelLength;
+        uint32_t ulLevelOffset = 0;
+
+        /* Follow the nodes for each level of the topic filter. */
+        while( ( usNode != mqttTRIE_NONE ) && ( ulLevelOffset <= ( uint32_t ) usTopicFilterLength ) )
+        {
+            usLevelLength = prvGetTopicLevelLength( pucTopicFilter, usTopicFilterLength, ulLevelOffset );
+            usNode = prvFindTopicTrieChild( pxSubscriptionManager, usNode, &( pucTopicFilter[ ulLevelOffset ] ), usLevelLength );
+
+            /* Skip the level and the separator following it. */
+            ulLevelOffset += ( uint32_t ) usLevelLength + ( uint32_t ) 1;
+        }
+
+        return ( usNode == mqttTRIE_NONE ) ? mqttTRIE_NONE : pxSubscriptionManager->xTrieNodes[ usNode ].usSubscription;
+    }
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    static MQTTBool_t prvInsertTopicTrieSubscription( MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                                      uint16_t usSubscription )
+    {
+        MQTTSubscription_t * pxSubscription = &( pxSubscriptionManager->xSubscriptions[ usSubscription ] );
+        MQTTTopicTrieNode_t * pxNode;
+        MQTTBool_t xInserted = eMQTTFalse;
+        uint16_t usNode = mqttTRIE_ROOT_NODE, usChild, usLevelLength;
+        uint32_t ulLevelOffset = 0, ulLevels = 0, ulNewNodes = 0;
+
+        /* Count the levels of the topic filter and the number of them
+         * which are not in the trie yet. */
+        while( ulLevelOffset <= ( uint32_t ) pxSubscription->usTopicFilterLength )
+        {
+            usLevelLength = prvGetTopicLevelLength( pxSubscription->ucTopicFilter, pxSubscription->usTopicFilterLength, ulLevelOffset );
+
+            if( usNode != mqttTRIE_NONE )
+            {
+                usNode = prvFindTopicTrieChild( pxSubscriptionManager, usNode, &( pxSubscription->ucTopicFilter[ ulLevelOffset ] ), usLevelLength );
+            }
+
+            if( usNode == mqttTRIE_NONE )
+            {
+                ulNewNodes++;
+            }
+
+            ulLevels++;
+            ulLevelOffset += ( uint32_t ) usLevelLength + ( uint32_t ) 1;
+        }
+
+        if( ( ulLevels <= ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS ) &&
+            ( ulNewNodes <= ( uint32_t ) pxSubscriptionManager->usFreeTrieNodes ) )
+        {
+            usNode = mqttTRIE_ROOT_NODE;
+            ulLevelOffset = 0;
+
+            while( ulLevelOffset <= ( uint32_t ) pxSubscription->usTopicFilterLength )
+            {
+                usLevelLength = prvGetTopicLevelLength( pxSubscription->ucTopicFilter, pxSubscription->usTopicFilterLength, ulLevelOffset );
+                usChild = prvFindTopicTrieChild( pxSubscriptionManager, usNode, &( pxSubscription->ucTopicFilter[ ulLevelOffset ] ), usLevelLength );
+
+                if( usChild == mqttTRIE_NONE )
+                {
+                    /* Take a node from the free list. */
+                    usChild = pxSubscriptionManager->usFreeTrieNode;
+                    pxNode = &( pxSubscriptionManager->xTrieNodes[ usChild ] );
+                    pxSubscriptionManager->usFreeTrieNode = pxNode->usNextSibling;
+                    pxSubscriptionManager->usFreeTrieNodes--;
+
+                    /* The level text is at the same offset in the topic
+                     * filter of this subscription. */
+                    pxNode->usParent = usNode;
+                    pxNode->usFirstChild = mqttTRIE_NONE;
+                    pxNode->usOwner = usSubscription;
+                    pxNode->usLevelOffset = ( uint16_t ) ulLevelOffset;
+                    pxNode->usLevelLength = usLevelLength;
+                    pxNode->usSubscription = mqttTRIE_NONE;
+                    pxNode->usReferenceCount = 0;
+                    pxNode->ucLevelType = mqttTRIE_LEVEL_LITERAL;
+
+                    if( usLevelLength == ( uint16_t ) 1 )
+                    {
+                        if( pxSubscription->ucTopicFilter[ ulLevelOffset ] == ( uint8_t ) '+' )
+                        {
+                            pxNode->ucLevelType = mqttTRIE_LEVEL_SINGLE_WILDCARD;
+                        }
+                        else if( pxSubscription->ucTopicFilter[ ulLevelOffset ] == ( uint8_t ) '#' )
+                        {
+                            pxNode->ucLevelType = mqttTRIE_LEVEL_MULTI_WILDCARD;
+                        }
+                        else
+                        {
+                            /* Any other single character level is a literal. */
+                        }
+                    }
+
+                    /* Link the node as the first child of its parent. */
+                    pxNode->usNextSibling = pxSubscriptionManager->xTrieNodes[ usNode ].usFirstChild;
+                    pxSubscriptionManager->xTrieNodes[ usNode ].usFirstChild = usChild;
+                }
+
+                pxSubscriptionManager->xTrieNodes[ usChild ].usReferenceCount++;
+
+                usNode = usChild;
+                ulLevelOffset += ( uint32_t ) usLevelLength + ( uint32_t ) 1;
+            }
+
+            /* The topic filter ends at the last node. */
+            pxSubscriptionManager->xTrieNodes[ usNode ].usSubscription = usSubscription;
+            pxSubscription->usTrieNode = usNode;
+
+            xInserted = eMQTTTrue;
+        }
+
+        return xInserted;
+    }
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    static void prvRemoveTopicTrieSubscription( MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                                uint16_t usSubscription )
+    {
+        MQTTTopicTrieNode_t * pxNode;
+        uint16_t usNode, usDescendant, * pusLink;
+
+        usNode = pxSubscriptionManager->xSubscriptions[ usSubscription ].usTrieNode;
+        pxSubscriptionManager->xTrieNodes[ usNode ].usSubscription = mqttTRIE_NONE;
+
+        /* Walk back to the root, releasing this subscription's reference
+         * on each node. */
+        while( usNode != mqttTRIE_ROOT_NODE )
+        {
+            pxNode = &( pxSubscriptionManager->xTrieNodes[ usNode ] );
+            pxNode->usReferenceCount--;
+
+            if( pxNode->usReferenceCount == ( uint16_t ) 0 )
+            {
+                /* Unlink the node from its parent. */
+                pusLink = &( pxSubscriptionManager->xTrieNodes[ pxNode->usParent ].usFirstChild );
+
+                while( *pusLink != usNode )
+                {
+                    pusLink = &( pxSubscriptionManager->xTrieNodes[ *pusLink ].usNextSibling );
+                }
+
+                *pusLink = pxNode->usNextSibling;
+
+                /* Return it to the free list. */
+                pxNode->usNextSibling = pxSubscriptionManager->usFreeTrieNode;
+                pxSubscriptionManager->usFreeTrieNode = usNode;
+                pxSubscriptionManager->usFreeTrieNodes++;
+            }
+            else if( pxNode->usOwner == usSubscription )
+            {
+                /* Other subscriptions still pass through this node, so
+                 * one of them ends in its sub-tree. Every node without a
+                 * subscription has children, so following the first
+                 * children leads to such a subscription. Its topic filter
+                 * has the same prefix and therefore contains this level at
+                 * the same offset. */
+                usDescendant = usNode;
+
+                while( pxSubscriptionManager->xTrieNodes[ usDescendant ].usSubscription == mqttTRIE_NONE )
+                {
+                    usDescendant = pxSubscriptionManager->xTrieNodes[ usDescendant ].usFirstChild;
+                }
+
+                pxNode->usOwner = pxSubscriptionManager->xTrieNodes[ usDescendant ].usSubscription;
+            }
+            else
+            {
+                /* The node is still in use and its text is owned by
+                 * another subscription. */
+            }
+
+            usNode = pxNode->usParent;
+        }
+    }
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    static MQTTBool_t prvInvokeTopicTrieCallbacks( MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                                   const MQTTPublishData_t * pxPublishData,
+                                                   MQTTBool_t * pxSubscriptionCallbackInvoked )
+    {
+        MQTTBool_t xBufferOwnershipTaken = eMQTTFalse;
+        const MQTTTopicTrieNode_t * pxChild;
+        uint16_t usSubscription, usNode, usChild, usLevelLength;
+        uint32_t ulLevelOffset, ulPendingCount = 0;
+        uint16_t usPendingNodes[ mqttTRIE_MAX_PENDING_NODES ];
+        uint32_t ulPendingOffsets[ mqttTRIE_MAX_PENDING_NODES ];
+        MQTTBool_t xPendingWildCard[ mqttTRIE_MAX_PENDING_NODES ], xWildCard;
+
+        /* Set the output parameter to eMQTTFalse. It will
+         * be set to eMQTTTrue if any callback is invoked. */
+        *pxSubscriptionCallbackInvoked = eMQTTFalse;
+
+        /* Follow the literal levels matching the topic to find the topic
+         * filter without wild-cards which is identical to the topic. */
+        usSubscription = prvFindTopicTrieSubscription( pxSubscriptionManager, pxPublishData->pucTopic, pxPublishData->usTopicLength );
+
+        if( ( usSubscription != mqttTRIE_NONE ) &&
+            ( pxSubscriptionManager->xSubscriptions[ usSubscription ].xTopicFilterType == eMQTTTopicFilterTypeSimple ) )
+        {
+            xBufferOwnershipTaken = prvInvokeTopicTrieNodeCallback( pxSubscriptionManager,
+                                                                    pxSubscriptionManager->xSubscriptions[ usSubscription ].usTrieNode,
+                                                                    pxPublishData,
+                                                                    pxSubscriptionCallbackInvoked );
+        }
+
+        /* If the user has not taken the buffer ownership yet, walk all the
+         * branches of the trie which match the topic and invoke the
+         * callbacks of the topic filters with wild-cards found on them.
+         * Each pending entry is a node whose level matched the topic, the
+         * offset of the next topic level (one past the end of the topic
+         * once all the levels are consumed), and whether a wild-card was
+         * used to reach the node. */
+        if( ( xBufferOwnershipTaken == eMQTTFalse ) && ( pxPublishData->usTopicLength > ( uint16_t ) 0 ) )
+        {
+            usPendingNodes[ 0 ] = mqttTRIE_ROOT_NODE;
+            ulPendingOffsets[ 0 ] = 0;
+            xPendingWildCard[ 0 ] = eMQTTFalse;
+            ulPendingCount = 1;
+        }
+
+        while( ( ulPendingCount > ( uint32_t ) 0 ) && ( xBufferOwnershipTaken == eMQTTFalse ) )
+        {
+            ulPendingCount--;
+            usNode = usPendingNodes[ ulPendingCount ];
+            ulLevelOffset = ulPendingOffsets[ ulPendingCount ];
+            xWildCard = xPendingWildCard[ ulPendingCount ];
+
+            if( ulLevelOffset > ( uint32_t ) pxPublishData->usTopicLength )
+            {
+                /* All the topic levels are consumed, so the topic filter
+                 * ending at this node matches. */
+                if( xWildCard == eMQTTTrue )
+                {
+                    xBufferOwnershipTaken = prvInvokeTopicTrieNodeCallback( pxSubscriptionManager, usNode, pxPublishData, pxSubscriptionCallbackInvoked );
+                }
+
+                /* Filter of type "sport/#" also matches the singular
+                 * "sport" since # includes the parent level. */
+                for( usChild = pxSubscriptionManager->xTrieNodes[ usNode ].usFirstChild;
+                     ( usChild != mqttTRIE_NONE ) && ( xBufferOwnershipTaken == eMQTTFalse );
+                     usChild = pxSubscriptionManager->xTrieNodes[ usChild ].usNextSibling )
+                {
+                    if( pxSubscriptionManager->xTrieNodes[ usChild ].ucLevelType == mqttTRIE_LEVEL_MULTI_WILDCARD )
+                    {
+                        xBufferOwnershipTaken = prvInvokeTopicTrieNodeCallback( pxSubscriptionManager, usChild, pxPublishData, pxSubscriptionCallbackInvoked );
+                    }
+                }
+            }
+            else
+            {
+                usLevelLength = prvGetTopicLevelLength( pxPublishData->pucTopic, pxPublishData->usTopicLength, ulLevelOffset );
+
+                for( usChild = pxSubscriptionManager->xTrieNodes[ usNode ].usFirstChild;
+                     ( usChild != mqttTRIE_NONE ) && ( xBufferOwnershipTaken == eMQTTFalse );
+                     usChild = pxChild->usNextSibling )
+                {
+                    pxChild = &( pxSubscriptionManager->xTrieNodes[ usChild ] );
+
+                    if( pxChild->ucLevelType == mqttTRIE_LEVEL_MULTI_WILDCARD )
+                    {
+                        /* '#' matches the rest of the topic. */
+                        xBufferOwnershipTaken = prvInvokeTopicTrieNodeCallback( pxSubscriptionManager, usChild, pxPublishData, pxSubscriptionCallbackInvoked );
+                    }
+                    else if( ( pxChild->ucLevelType == mqttTRIE_LEVEL_SINGLE_WILDCARD ) ||
+                             ( ( pxChild->usLevelLength == usLevelLength ) &&
+                               ( memcmp( &( pxSubscriptionManager->xSubscriptions[ pxChild->usOwner ].ucTopicFilter[ pxChild->usLevelOffset ] ),
+                                         &( pxPublishData->pucTopic[ ulLevelOffset ] ),
+                                         usLevelLength ) == 0 ) ) )
+                    {
+                        /* At most one literal child and one '+' child match
+                         * a level, and the trie is at most
+                         * mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS deep,
+                         * so the pending entries never exceed the depth plus
+                         * one. */
+                        mqttconfigASSERT( ulPendingCount < mqttTRIE_MAX_PENDING_NODES );
+
+                        usPendingNodes[ ulPendingCount ] = usChild;
+                        ulPendingOffsets[ ulPendingCount ] = ulLevelOffset + ( uint32_t ) usLevelLength + ( uint32_t ) 1;
+                        xPendingWildCard[ ulPendingCount ] = ( pxChild->ucLevelType == mqttTRIE_LEVEL_SINGLE_WILDCARD ) ? eMQTTTrue : xWildCard;
+                        ulPendingCount++;
+                    }
+                    else
+                    {
+                        /* The level does not match. */
+                    }
+                }
+            }
+        }
+
+        /* Return whether or not the user has taken the
+         * ownership of the MQTT buffer. */
+        return xBufferOwnershipTaken;
+    }
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    static MQTTBool_t prvInvokeTopicTrieNodeCallback( const MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                                      uint16_t usNode,
+                                                      const MQTTPublishData_t * pxPublishData,
+                                                      MQTTBool_t * pxSubscriptionCallbackInvoked )
+    {
+        MQTTBool_t xBufferOwnershipTaken = eMQTTFalse;
+        const MQTTSubscription_t * pxSubscription;
+        uint16_t usSubscription = pxSubscriptionManager->xTrieNodes[ usNode ].usSubscription;
+
+        if( usSubscription != mqttTRIE_NONE )
+        {
+            pxSubscription = &( pxSubscriptionManager->xSubscriptions[ usSubscription ] );
+
+            /* If a callback is registered with the subscription,
+             * invoke it. */
+            if( pxSubscription->pxPublishCallback != NULL )
+            {
+                /* Note that a callback was invoked. */
+                *pxSubscriptionCallbackInvoked = eMQTTTrue;
+
+                /* Invoke callback. */
+                xBufferOwnershipTaken = pxSubscription->pxPublishCallback( pxSubscription->pvPublishCallbackContext, pxPublishData );
+            }
+        }
+
+        return xBufferOwnershipTaken;
+    }
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 ) && ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+    static void prvResetTopicTrie( MQTTSubscriptionManager_t * pxSubscriptionManager )
+    {
+        uint16_t x;
+
+        pxSubscriptionManager->xTrieNodes[ mqttTRIE_ROOT_NODE ].usParent = mqttTRIE_NONE;
+        pxSubscriptionManager->xTrieNodes[ mqttTRIE_ROOT_NODE ].usFirstChild = mqttTRIE_NONE;
+        pxSubscriptionManager->xTrieNodes[ mqttTRIE_ROOT_NODE ].usNextSibling = mqttTRIE_NONE;
+        pxSubscriptionManager->xTrieNodes[ mqttTRIE_ROOT_NODE ].usSubscription = mqttTRIE_NONE;
+
+        /* Link all the other nodes into the free list. */
+        for( x = 1; x < ( uint16_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_TRIE_NODES; x++ )
+        {
+            pxSubscriptionManager->xTrieNodes[ x ].usNextSibling = ( uint16_t ) ( x + ( uint16_t ) 1 );
+        }
+
+        pxSubscriptionManager->xTrieNodes[ mqttconfigSUBSCRIPTION_MANAGER_MAX_TRIE_NODES - 1 ].usNextSibling = mqttTRIE_NONE;
+        pxSubscriptionManager->usFreeTrieNode = ( uint16_t ) 1;
+        pxSubscriptionManager->usFreeTrieNodes = ( uint16_t ) ( mqttconfigSUBSCRIPTION_MANAGER_MAX_TRIE_NODES - 1 );
+    }
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT && mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE */
+/*-----------------------------------------------------------*/
+
 MQTTReturnCode_t MQTT_Init( MQTTContext_t * pxMQTTContext,
                             const MQTTInitParams_t * const pxInitParams )
 {
@@ -2468,6 +3196,11 @@ MQTTReturnCode_t MQTT_Init( MQTTContext_t * pxMQTTContext,
 
         /* Set the number of in-use subscription entries to zero. */
         pxMQTTContext->xSubscriptionManager.ulInUseSubscriptions = 0;
+
+        #if ( mqttconfigSUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+            /* Empty the topic filter trie. */
+            prvResetTopicTrie( &( pxMQTTContext->xSubscriptionManager ) );
+        #endif
     #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 
     return eMQTTSuccess;
@@ -2959,12 +3692,66 @@ MQTTReturnCode_t MQTT_Unsubscribe( MQTTContext_t * pxMQTTContext,
 }
 /*-----------------------------------------------------------*/
 
+static uint32_t prvGetPublishRemainingLength( const MQTTPublishParams_t * const pxPublishParams )
+{
+    /* Topic (prefixed with its length), packet identifier (only
+     * present in non QoS0 messages) and payload. */
+    return ( uint32_t ) mqttSTRLEN( pxPublishParams->usTopicLength ) +
+           ( pxPublishParams->xQos == eMQTTQoS0 ? ( uint32_t ) mqttPUBLISH_QOS0_PACKET_IDENTIFER_LENGTH : ( uint32_t ) mqttPUBLISH_QOS1_PACKET_IDENTIFER_LENGTH ) +
+           pxPublishParams->ulDataLength;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWritePublish( uint8_t * pucBuffer,
+                             const uint8_t * const pucLastByteInBuffer,
+                             const MQTTPublishParams_t * const pxPublishParams,
+                             uint32_t ulRemainingLength )
+{
+    uint8_t * pucNextByte, ucRemainingLengthFieldBytes;
+
+    /* Write Control Packet Type. */
+    /*_TODO_ Note!  DUP and RETAIN are all currently all set to 0. */
+    pucBuffer[ mqttFIXED_HEADER_CONTROL_BYTE_OFFSET ] = mqttCONTROL_PUBLISH;
+
+    /* Set QoS. QoS2 is not supported.*/
+    mqttconfigASSERT( pxPublishParams->xQos == eMQTTQoS0 || pxPublishParams->xQos == eMQTTQoS1 );
+    pucBuffer[ mqttFIXED_HEADER_CONTROL_BYTE_OFFSET ] |= ( ( ( uint8_t ) ( pxPublishParams->xQos ) ) << 1 );
+
+    /* Write encoded "Remaining Length" in the fixed header. */
+    pucNextByte = &( pucBuffer[ mqttFIXED_HEADER_REMAINING_LENGTH_OFFSET ] );
+    ucRemainingLengthFieldBytes = prvEncodeRemainingLength( ulRemainingLength, pucNextByte, pucLastByteInBuffer );
+
+    /* We should have successfully encoded the remaining length field
+     * as we already have a large enough buffer. */
+    mqttconfigASSERT( ucRemainingLengthFieldBytes == prvSizeOfRemainingLength( ulRemainingLength ) );
+
+    /* Write the topic into the message (part of variable header). */
+    pucNextByte = &( pucBuffer[ mqttADJUST_OFFSET( mqttPUBLISH_TOPIC_OFFSET, ucRemainingLengthFieldBytes ) ] );
+    pucNextByte = prvWriteString( pucNextByte, pucLastByteInBuffer, pxPublishParams->pucTopic, pxPublishParams->usTopicLength );
+
+    /* Write packet identifier into the message, if it is not QoS0. */
+    if( pxPublishParams->xQos != eMQTTQoS0 )
+    {
+        /* Write MSB. */
+        *pucNextByte = ( uint8_t ) ( ( pxPublishParams->usPacketIdentifier ) >> mqttBITS_PER_BYTE );
+        pucNextByte++;
+
+        /* Write LSB. */
+        *pucNextByte = ( uint8_t ) ( pxPublishParams->usPacketIdentifier );
+        pucNextByte++;
+    }
+
+    /* Write the payload into the message. */
+    memcpy( pucNextByte, pxPublishParams->pvData, ( size_t ) pxPublishParams->ulDataLength );
+    mqttconfigTRACE_BYTES_COPIED( pxPublishParams->ulDataLength );
+}
+/*-----------------------------------------------------------*/
+
 MQTTReturnCode_t MQTT_Publish( MQTTContext_t * pxMQTTContext,
                                const MQTTPublishParams_t * const pxPublishParams )
 {
-    uint8_t * pucNextByte, * pucLastByteInBuffer, ucRemainingLengthFieldBytes;
+    uint8_t * pucLastByteInBuffer, ucRemainingLengthFieldBytes;
     uint32_t ulRemainingLength, ulTotalMessageLength;
-    uint16_t usTopicLength;
     MQTTBufferHandle_t xBuffer = NULL;
     MQTTReturnCode_t xReturnCode = eMQTTFailure;
 
@@ -2986,13 +3773,8 @@ MQTTReturnCode_t MQTT_Publish( MQTTContext_t * pxMQTTContext,
     }
     else
     {
-        /* Length of the topic in the actual MQTT message. */
-        usTopicLength = mqttSTRLEN( pxPublishParams->usTopicLength );
-
         /* Calculate the "Remaining Length" i.e. length of the packet excluding Fixed Header. */
-        ulRemainingLength = ( uint32_t ) usTopicLength +
-                            ( pxPublishParams->xQos == eMQTTQoS0 ? ( uint32_t ) mqttPUBLISH_QOS0_PACKET_IDENTIFER_LENGTH : ( uint32_t ) mqttPUBLISH_QOS1_PACKET_IDENTIFER_LENGTH ) +
-                            pxPublishParams->ulDataLength;
+        ulRemainingLength = prvGetPublishRemainingLength( pxPublishParams );
 
         /* Calculate the number of bytes occupied by the "Remaining Length" field. */
         ucRemainingLengthFieldBytes = prvSizeOfRemainingLength( ulRemainingLength );
@@ -3025,41 +3807,9 @@ MQTTReturnCode_t MQTT_Publish( MQTTContext_t * pxMQTTContext,
                 mqttbufferGET_PACKET_RECORDED_TICK_COUNT( xBuffer ) = prvGetCurrentTickCount( pxMQTTContext );
                 mqttbufferGET_PACKET_TIMEOUT_TICKS( xBuffer ) = pxPublishParams->ulTimeoutTicks;
 
-                /* Write Control Packet Type. */
-                /*_TODO_ Note!  DUP and RETAIN are all currently all set to 0. */
-                mqttbufferGET_DATA( xBuffer )[ mqttFIXED_HEADER_CONTROL_BYTE_OFFSET ] = mqttCONTROL_PUBLISH;
-
-                /* Set QoS. QoS2 is not supported.*/
-                mqttconfigASSERT( pxPublishParams->xQos == eMQTTQoS0 || pxPublishParams->xQos == eMQTTQoS1 );
-                mqttbufferGET_DATA( xBuffer )[ mqttFIXED_HEADER_CONTROL_BYTE_OFFSET ] |= ( ( ( uint8_t ) ( pxPublishParams->xQos ) ) << 1 );
-
-                /* Write encoded "Remaining Length" in the fixed header. */
-                pucNextByte = &( mqttbufferGET_DATA( xBuffer )[ mqttFIXED_HEADER_REMAINING_LENGTH_OFFSET ] );
+                /* Write the message. */
                 pucLastByteInBuffer = &( mqttbufferGET_DATA( xBuffer )[ mqttbufferGET_EFFECTIVE_BUFFER_LENGTH( xBuffer ) - ( uint32_t ) 1 ] );
-                ucRemainingLengthFieldBytes = prvEncodeRemainingLength( ulRemainingLength, pucNextByte, pucLastByteInBuffer );
-
-                /* We should have successfully encoded the remaining length field
-                 * as we already have a large enough buffer. */
-                mqttconfigASSERT( ucRemainingLengthFieldBytes == prvSizeOfRemainingLength( ulRemainingLength ) );
-
-                /* Write the topic into the message (part of variable header). */
-                pucNextByte = &( mqttbufferGET_DATA( xBuffer )[ mqttADJUST_OFFSET( mqttPUBLISH_TOPIC_OFFSET, ucRemainingLengthFieldBytes ) ] );
-                pucNextByte = prvWriteString( pucNextByte, pucLastByteInBuffer, pxPublishParams->pucTopic, pxPublishParams->usTopicLength );
-
-                /* Write packet identifier into the message, if it is not QoS0. */
-                if( pxPublishParams->xQos != eMQTTQoS0 )
-                {
-                    /* Write MSB. */
-                    *pucNextByte = ( uint8_t ) ( ( pxPublishParams->usPacketIdentifier ) >> mqttBITS_PER_BYTE );
-                    pucNextByte++;
-
-                    /* Write LSB. */
-                    *pucNextByte = ( uint8_t ) ( pxPublishParams->usPacketIdentifier );
-                    pucNextByte++;
-                }
-
-                /* Write the payload into the message. */
-                memcpy( pucNextByte, pxPublishParams->pvData, ( size_t ) pxPublishParams->ulDataLength );
+                prvWritePublish( mqttbufferGET_DATA( xBuffer ), pucLastByteInBuffer, pxPublishParams, ulRemainingLength );
 
                 /* Store the packet identifier in TxBuffer also for matching
                  * ACK later. */
@@ -3093,20 +3843,148 @@ MQTTReturnCode_t MQTT_Publish( MQTTContext_t * pxMQTTContext,
 }
 /*-----------------------------------------------------------*/
 
-MQTTReturnCode_t MQTT_ParseReceivedData( MQTTContext_t * pxMQTTContext,
-                                         const uint8_t * pucReceivedData,
-                                         size_t xReceivedDataLength )
+MQTTReturnCode_t MQTT_PublishV( MQTTContext_t * pxMQTTContext,
+                                const MQTTPublishParams_t * const pxPublishParams,
+                                uint32_t ulPublishCount )
 {
+    uint8_t * pucNextByte, * pucLastByteInBuffer, ucRemainingLengthFieldBytes;
+    uint32_t ulRemainingLength, ulTotalBatchLength = 0, x;
+    MQTTBufferHandle_t xBatchBuffer = NULL, xBuffer;
+    Link_t xWaitingAckListHead;
     MQTTReturnCode_t xReturnCode = eMQTTSuccess;
-    MQTTEventCallbackParams_t xEventCallbackParams;
-    size_t xProcessedBytes = 0, xExpectedBytes, xUnprocessedBytes;
 
     /* These are checked here once and are later used without
      * NULL checks. */
     mqttconfigASSERT( pxMQTTContext != NULL );
+    mqttconfigASSERT( pxMQTTContext->pxMQTTSendFxn != NULL );
     mqttconfigASSERT( pxMQTTContext->xBufferPoolInterface.pxGetBufferFxn != NULL );
     mqttconfigASSERT( pxMQTTContext->xBufferPoolInterface.pxReturnBufferFxn != NULL );
-    mqttconfigASSERT( pucReceivedData != NULL );
+    mqttconfigASSERT( pxPublishParams != NULL );
+
+    mqttconfigDEBUG_LOG( ( "Initiating MQTT batch publish.\r\n" ) );
+
+    /* Buffers tracking the non QoS0 messages are collected here and
+     * moved to the Tx buffer list only if the batch is sent. */
+    listINIT_HEAD( &( xWaitingAckListHead ) );
+
+    if( pxMQTTContext->xConnectionState != eMQTTConnected )
+    {
+        /* Fail the publish operation immediately, if
+         * MQTT client is not connected. */
+        xReturnCode = eMQTTClientNotConnected;
+    }
+    else
+    {
+        /* Calculate the length of all the messages together. */
+        for( x = 0; x < ulPublishCount; x++ )
+        {
+            ulRemainingLength = prvGetPublishRemainingLength( &( pxPublishParams[ x ] ) );
+            ucRemainingLengthFieldBytes = prvSizeOfRemainingLength( ulRemainingLength );
+
+            /* Make sure that "Remaining Length" is within the permissible limits. */
+            if( ucRemainingLengthFieldBytes == ( uint8_t ) 0 )
+            {
+                xReturnCode = eMQTTFailure;
+                break;
+            }
+
+            ulTotalBatchLength += mqttTOTAL_MESSAGE_LENGTH( ucRemainingLengthFieldBytes, ulRemainingLength );
+        }
+    }
+
+    if( xReturnCode == eMQTTSuccess )
+    {
+        /* All the messages are written one after the other into
+         * one buffer so that they can be sent in one go. */
+        xBatchBuffer = prvGetFreeBuffer( pxMQTTContext, ulTotalBatchLength );
+
+        if( xBatchBuffer == NULL )
+        {
+            mqttconfigDEBUG_LOG( ( "No free buffer is available to carry out the operation. \r\n" ) );
+            xReturnCode = eMQTTNoFreeBuffer;
+        }
+    }
+
+    if( xReturnCode == eMQTTSuccess )
+    {
+        pucNextByte = mqttbufferGET_DATA( xBatchBuffer );
+        pucLastByteInBuffer = &( mqttbufferGET_DATA( xBatchBuffer )[ mqttbufferGET_EFFECTIVE_BUFFER_LENGTH( xBatchBuffer ) - ( uint32_t ) 1 ] );
+
+        for( x = 0; x < ulPublishCount; x++ )
+        {
+            ulRemainingLength = prvGetPublishRemainingLength( &( pxPublishParams[ x ] ) );
+            prvWritePublish( pucNextByte, pucLastByteInBuffer, &( pxPublishParams[ x ] ), ulRemainingLength );
+
+            /* A non QoS0 message waits for its PUBACK on the Tx buffer
+             * list. Only the control byte and the packet identifier
+             * are needed to match the PUBACK, so a buffer holding just
+             * the control byte is used instead of a copy of the whole
+             * message. */
+            if( pxPublishParams[ x ].xQos != eMQTTQoS0 )
+            {
+                xBuffer = prvGetFreeBuffer( pxMQTTContext, ( uint32_t ) 1 );
+
+                if( xBuffer == NULL )
+                {
+                    mqttconfigDEBUG_LOG( ( "No free buffer is available to carry out the operation. \r\n" ) );
+                    xReturnCode = eMQTTNoFreeBuffer;
+                    break;
+                }
+
+                mqttbufferLIST_ADD( &( xWaitingAckListHead ), xBuffer );
+
+                /* Record time-stamp, timeout and packet identifier. */
+                mqttbufferGET_PACKET_RECORDED_TICK_COUNT( xBuffer ) = prvGetCurrentTickCount( pxMQTTContext );
+                mqttbufferGET_PACKET_TIMEOUT_TICKS( xBuffer ) = pxPublishParams[ x ].ulTimeoutTicks;
+                mqttbufferGET_PACKET_IDENTIFIER( xBuffer ) = pxPublishParams[ x ].usPacketIdentifier;
+
+                mqttbufferGET_DATA( xBuffer )[ mqttFIXED_HEADER_CONTROL_BYTE_OFFSET ] = pucNextByte[ mqttFIXED_HEADER_CONTROL_BYTE_OFFSET ];
+                mqttbufferGET_DATA_LENGTH( xBuffer ) = ( uint32_t ) 1;
+            }
+
+            pucNextByte += mqttTOTAL_MESSAGE_LENGTH( prvSizeOfRemainingLength( ulRemainingLength ), ulRemainingLength );
+        }
+    }
+
+    /* If all the packets were successfully constructed, transmit them. */
+    if( xReturnCode == eMQTTSuccess )
+    {
+        xReturnCode = prvSendData( pxMQTTContext, mqttbufferGET_DATA( xBatchBuffer ), ulTotalBatchLength );
+    }
+
+    /* The non QoS0 messages wait for their PUBACKs only if the
+     * batch was sent. Otherwise their buffers are returned. */
+    mqttbufferLIST_POP( &( xWaitingAckListHead ), xBuffer );
+
+    while( xBuffer != NULL )
+    {
+        if( xReturnCode == eMQTTSuccess )
+        {
+            mqttbufferLIST_ADD( &( pxMQTTContext->xTxBufferListHead ), xBuffer );
+        }
+        else
+        {
+            prvReturnBuffer( pxMQTTContext, xBuffer );
+        }
+
+        mqttbufferLIST_POP( &( xWaitingAckListHead ), xBuffer );
+    }
+
+    /* The batch buffer is not needed after the send. */
+    prvReturnBuffer( pxMQTTContext, xBatchBuffer );
+
+    return xReturnCode;
+}
+/*-----------------------------------------------------------*/
+
+static MQTTReturnCode_t prvParseReceivedData( MQTTContext_t * pxMQTTContext,
+                                              const uint8_t * pucReceivedData,
+                                              size_t xReceivedDataLength,
+                                              MQTTBool_t xReceivedInPlace )
+{
+    MQTTReturnCode_t xReturnCode = eMQTTSuccess;
+    MQTTEventCallbackParams_t xEventCallbackParams;
+    size_t xProcessedBytes = 0, xExpectedBytes, xUnprocessedBytes;
 
     /* Keep processing until all the supplied bytes are over. */
     while( xProcessedBytes < xReceivedDataLength )
@@ -3138,7 +4016,7 @@ MQTTReturnCode_t MQTT_ParseReceivedData( MQTTContext_t * pxMQTTContext,
              * the next packet starts. */
 
             /* Copy one byte containing packet type and flags. */
-            mqttCOPY_BYTES( pucReceivedData, xProcessedBytes, pxMQTTContext->ucRxFixedHeaderBuffer, pxMQTTContext->ulRxMessageReceivedLength, 1 );
+            mqttCONSUME_BYTES( xReceivedInPlace, pucReceivedData, xProcessedBytes, pxMQTTContext->ucRxFixedHeaderBuffer, pxMQTTContext->ulRxMessageReceivedLength, 1 );
 
             /* Next bytes will contain "Remaining Length" field. */
             pxMQTTContext->xRxMessageState.xRxNextByte = eMQTTRxNextBytePacketLength;
@@ -3148,7 +4026,7 @@ MQTTReturnCode_t MQTT_ParseReceivedData( MQTTContext_t * pxMQTTContext,
             /* Receiving "Remaining Length" field which is part of fixed header. */
             mqttconfigASSERT( pxMQTTContext->ulRxMessageReceivedLength < mqttFIXED_HEADER_MAX_SIZE );
 
-            mqttCOPY_BYTES( pucReceivedData, xProcessedBytes, pxMQTTContext->ucRxFixedHeaderBuffer, pxMQTTContext->ulRxMessageReceivedLength, 1 );
+            mqttCONSUME_BYTES( xReceivedInPlace, pucReceivedData, xProcessedBytes, pxMQTTContext->ucRxFixedHeaderBuffer, pxMQTTContext->ulRxMessageReceivedLength, 1 );
 
             /* Are there more bytes containing packet length i.e. is the "continuation bit"
              * set in the received length byte? */
@@ -3203,6 +4081,7 @@ MQTTReturnCode_t MQTT_ParseReceivedData( MQTTContext_t * pxMQTTContext,
                     {
                         /* Copy the fixed header in the Rx buffer. */
                         memcpy( mqttbufferGET_DATA( pxMQTTContext->xRxBuffer ), pxMQTTContext->ucRxFixedHeaderBuffer, pxMQTTContext->ulRxMessageReceivedLength );
+                        mqttconfigTRACE_BYTES_COPIED( pxMQTTContext->ulRxMessageReceivedLength );
                         mqttbufferGET_DATA_LENGTH( pxMQTTContext->xRxBuffer ) = pxMQTTContext->ulRxMessageReceivedLength;
 
                         pxMQTTContext->xRxMessageState.xRxNextByte = eMQTTRxNextByteMessage;
@@ -3232,12 +4111,12 @@ MQTTReturnCode_t MQTT_ParseReceivedData( MQTTContext_t * pxMQTTContext,
              * and keep waiting for the remaining ones. */
             if( xUnprocessedBytes < xExpectedBytes )
             {
-                mqttCOPY_BYTES( pucReceivedData, xProcessedBytes, mqttbufferGET_DATA( pxMQTTContext->xRxBuffer ), mqttbufferGET_DATA_LENGTH( pxMQTTContext->xRxBuffer ), xUnprocessedBytes );
+                mqttCONSUME_BYTES( xReceivedInPlace, pucReceivedData, xProcessedBytes, mqttbufferGET_DATA( pxMQTTContext->xRxBuffer ), mqttbufferGET_DATA_LENGTH( pxMQTTContext->xRxBuffer ), xUnprocessedBytes );
             }
             else
             {
                 /* Sufficient bytes to form a complete packet have been received. */
-                mqttCOPY_BYTES( pucReceivedData, xProcessedBytes, mqttbufferGET_DATA( pxMQTTContext->xRxBuffer ), mqttbufferGET_DATA_LENGTH( pxMQTTContext->xRxBuffer ), xExpectedBytes );
+                mqttCONSUME_BYTES( xReceivedInPlace, pucReceivedData, xProcessedBytes, mqttbufferGET_DATA( pxMQTTContext->xRxBuffer ), mqttbufferGET_DATA_LENGTH( pxMQTTContext->xRxBuffer ), xExpectedBytes );
 
                 /* Process the received packet. */
                 prvProcessReceivedMQTTPacket( pxMQTTContext );
@@ -3282,6 +4161,101 @@ MQTTReturnCode_t MQTT_ParseReceivedData( MQTTContext_t * pxMQTTContext,
 }
 /*-----------------------------------------------------------*/
 
+MQTTReturnCode_t MQTT_ParseReceivedData( MQTTContext_t * pxMQTTContext,
+                                         const uint8_t * pucReceivedData,
+                                         size_t xReceivedDataLength )
+{
+    /* These are checked here once and are later used without
+     * NULL checks. */
+    mqttconfigASSERT( pxMQTTContext != NULL );
+    mqttconfigASSERT( pxMQTTContext->xBufferPoolInterface.pxGetBufferFxn != NULL );
+    mqttconfigASSERT( pxMQTTContext->xBufferPoolInterface.pxReturnBufferFxn != NULL );
+    mqttconfigASSERT( pucReceivedData != NULL );
+
+    return prvParseReceivedData( pxMQTTContext, pucReceivedData, xReceivedDataLength, eMQTTFalse );
+}
+/*-----------------------------------------------------------*/
+
+MQTTReturnCode_t MQTT_GetReceiveLocation( MQTTContext_t * pxMQTTContext,
+                                          uint8_t ** ppucLocation,
+                                          size_t * pxLength )
+{
+    MQTTReturnCode_t xReturnCode = eMQTTSuccess;
+
+    /* These are checked here once and are later used without
+     * NULL checks. */
+    mqttconfigASSERT( pxMQTTContext != NULL );
+    mqttconfigASSERT( ppucLocation != NULL );
+    mqttconfigASSERT( pxLength != NULL );
+
+    *ppucLocation = NULL;
+    *pxLength = 0;
+
+    if( pxMQTTContext->xConnectionState == eMQTTNotConnected )
+    {
+        xReturnCode = eMQTTClientNotConnected;
+    }
+    else if( pxMQTTContext->xRxMessageState.xRxNextByte == eMQTTRxNextBytePacketType )
+    {
+        /* Every MQTT message starts with at least 2 bytes of fixed
+         * header - the packet type and the first byte of "Remaining
+         * Length". */
+        *ppucLocation = &( pxMQTTContext->ucRxFixedHeaderBuffer[ pxMQTTContext->ulRxMessageReceivedLength ] );
+        *pxLength = ( size_t ) mqttFIXED_HEADER_MIN_SIZE;
+    }
+    else if( pxMQTTContext->xRxMessageState.xRxNextByte == eMQTTRxNextBytePacketLength )
+    {
+        /* Whether more bytes of "Remaining Length" follow is only
+         * known once this one has been received. */
+        *ppucLocation = &( pxMQTTContext->ucRxFixedHeaderBuffer[ pxMQTTContext->ulRxMessageReceivedLength ] );
+        *pxLength = 1;
+    }
+    else if( pxMQTTContext->xRxMessageState.xRxMessageAction == eMQTTRxMessageStore )
+    {
+        /* Receive the rest of the message directly into the Rx buffer. */
+        *ppucLocation = &( mqttbufferGET_DATA( pxMQTTContext->xRxBuffer )[ mqttbufferGET_DATA_LENGTH( pxMQTTContext->xRxBuffer ) ] );
+        *pxLength = ( size_t ) ( pxMQTTContext->xRxMessageState.ulTotalMessageLength - mqttbufferGET_DATA_LENGTH( pxMQTTContext->xRxBuffer ) );
+    }
+    else
+    {
+        /* The message is being dropped, so there is nowhere to
+         * receive it. */
+        *pxLength = ( size_t ) ( pxMQTTContext->xRxMessageState.ulTotalMessageLength - pxMQTTContext->ulRxMessageReceivedLength );
+        xReturnCode = eMQTTNoFreeBuffer;
+    }
+
+    return xReturnCode;
+}
+/*-----------------------------------------------------------*/
+
+MQTTReturnCode_t MQTT_ParseReceivedInPlace( MQTTContext_t * pxMQTTContext,
+                                            size_t xReceivedDataLength )
+{
+    uint8_t * pucLocation;
+    size_t xLength;
+    MQTTReturnCode_t xReturnCode;
+
+    /* These are checked here once and are later used without
+     * NULL checks. */
+    mqttconfigASSERT( pxMQTTContext != NULL );
+    mqttconfigASSERT( pxMQTTContext->xBufferPoolInterface.pxGetBufferFxn != NULL );
+    mqttconfigASSERT( pxMQTTContext->xBufferPoolInterface.pxReturnBufferFxn != NULL );
+
+    /* The bytes must have been received where MQTT_GetReceiveLocation
+     * asked for them. */
+    xReturnCode = MQTT_GetReceiveLocation( pxMQTTContext, &( pucLocation ), &( xLength ) );
+
+    if( xReturnCode == eMQTTSuccess )
+    {
+        mqttconfigASSERT( xReceivedDataLength <= xLength );
+
+        xReturnCode = prvParseReceivedData( pxMQTTContext, pucLocation, xReceivedDataLength, eMQTTTrue );
+    }
+
+    return xReturnCode;
+}
+/*-----------------------------------------------------------*/
+
 MQTTReturnCode_t MQTT_ReturnBuffer( MQTTContext_t * pxMQTTContext,
                                     MQTTBufferHandle_t xBufferHandle )
 {
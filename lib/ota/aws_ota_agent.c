@@ -34,7 +34,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <string.h>
 #include <stdlib.h>
 #include "aws_ota_cbor.h"
+#include "aws_ota_agent_config_defaults.h"
 #include "aws_application_version.h"
+#include "aws_crypto.h"
 
 /* FreeRTOS includes. */
 #include "FreeRTOSConfig.h"
@@ -332,7 +334,8 @@ static uint32_t prvBuildDataStreamTopicName (char *pcNameBuffer, uint32_t ulBufS
 
 static void prvUpdateJobStatus (OTA_FileContext_t *C, char *pcOTA_DynamicTopic, OTA_JobStatus_t eStatus, int32_t lReason);
 
-/* Construct the "Get Stream" message and publish it to the stream service request topic. */
+/* Construct "Get Stream" messages for the next ranges of missing blocks that fit in the request
+ * window and publish them to the stream service request topic. */
 
 static OTA_Err_t prvPublishGetStreamMessage (OTA_FileContext_t *C, char *pcOTA_DynamicTopic);
 
@@ -709,13 +712,15 @@ static void prvUpdateJobStatus (OTA_FileContext_t *C, char *pcOTA_DynamicTopic,
 }
 
 
-/* Construct the "Get Stream" message and publish it to the stream service request topic. */
+/* Construct "Get Stream" messages for the next ranges of missing blocks that fit in the request
+ * window and publish them to the stream service request topic. */
 
 static OTA_Err_t prvPublishGetStreamMessage(OTA_FileContext_t *C, char *pcOTA_DynamicTopic)
 {
 	size_t iMsgSize;
-	uint32_t iNumBlocks, iBitmapLen, ulRequestTopicLen;
+	uint32_t iNumBlocks, iBitmapLen, ulRequestTopicLen, ulByteOffset, ulByteCount;
 	int16_t iResult;
+	bool_t xRequested = pdFALSE;
 	OTA_Err_t eErr = kOTA_Err_None;
 	char acMsg[kOTA_RequestMsg_MaxSize];
 
@@ -725,49 +730,60 @@ static OTA_Err_t prvPublishGetStreamMessage(OTA_FileContext_t *C, char *pcOTA_Dy
 		{
 			iNumBlocks = (C->iFileSize + (kOTA_FileBlockSize - 1)) >> LOG2_16BIT (kOTA_FileBlockSize);
 			iBitmapLen = (iNumBlocks + (kBitsPerByte - 1)) >> LOG2_8BIT (kBitsPerByte);
-			iResult = -1;	/* Start by assuming error code. */
-
-			if (pdTRUE == OTA_CBOR_Encode_GetStreamRequestMessage (
-				(uint8_t *)acMsg,
-				sizeof (acMsg),
-				&iMsgSize,
-				kOTA_Client_Token,
-				C->ulServerFileID,
-				kOTA_FileBlockSize,
-				0,
-				C->pacRxBlockBitmap,
-				iBitmapLen))
-			{
-				/* Bump the request momentum counter for all publish attempts. */
-				C->ulRequestMomentum++;
 
-				/* Try to build the dynamic data REQUEST topic and subscribe to it. */
-				ulRequestTopicLen = prvBuildDataRequestTopicName (pcOTA_DynamicTopic, kOTA_MaxDynamicTopicNameLen, C);
-				if (ulRequestTopicLen > 0)
+			/* Keep requesting ranges of the missing blocks until the window is full. */
+			while ( (eErr == kOTA_Err_None) &&
+				(OTA_WINDOW_GetNextRequest (&C->xRequestWindow, C->pacRxBlockBitmap, iBitmapLen, &ulByteOffset, &ulByteCount) == pdTRUE) )
+			{
+				iResult = -1;	/* Start by assuming error code. */
+
+				if (pdTRUE == OTA_CBOR_Encode_GetStreamRequestMessage (
+					(uint8_t *)acMsg,
+					sizeof (acMsg),
+					&iMsgSize,
+					kOTA_Client_Token,
+					C->ulServerFileID,
+					kOTA_FileBlockSize,
+					ulByteOffset * kBitsPerByte,
+					&C->pacRxBlockBitmap[ulByteOffset],
+					ulByteCount))
 				{
-					iResult = prvPublishMessage (
-						pvPubSubClient,
-						pcOTA_DynamicTopic,
-						ulRequestTopicLen,
-						&acMsg[0],
-						iMsgSize,
-						eMQTTQoS0);
-				}
-				if (iResult < 0) {
-					OTA_PRINT ("[OTA] Failed to publish message on request topic.\r\n");
-					/* Don't return an error. Let max momentum catch it since this may be intermittent. */
+					/* Bump the request momentum counter once for all the publish attempts of this call. */
+					if (xRequested == pdFALSE)
+					{
+						C->ulRequestMomentum++;
+						xRequested = pdTRUE;
+					}
+
+					/* Try to build the dynamic data REQUEST topic and subscribe to it. */
+					ulRequestTopicLen = prvBuildDataRequestTopicName (pcOTA_DynamicTopic, kOTA_MaxDynamicTopicNameLen, C);
+					if (ulRequestTopicLen > 0)
+					{
+						iResult = prvPublishMessage (
+							pvPubSubClient,
+							pcOTA_DynamicTopic,
+							ulRequestTopicLen,
+							&acMsg[0],
+							iMsgSize,
+							eMQTTQoS0);
+					}
+					if (iResult < 0) {
+						OTA_PRINT ("[OTA] Failed to publish message on request topic.\r\n");
+						/* Don't return an error. Let the request timer and max momentum catch it since this may be intermittent. */
+						break;
+					}
+					else {
+						OTA_PRINT ("[OTA] Published file request for block %u to %s\r\n", ulByteOffset * kBitsPerByte, pcOTA_DynamicTopic);
+						/* Restart the request timer to retry if we don't complete the update. */
+						prvStartRequestTimer (C);
+					}
 				}
-				else {
-					OTA_PRINT ("[OTA] Published file request to %s\r\n", pcOTA_DynamicTopic);
-					/* Restart the request timer to retry if we don't complete the update. */
-					prvStartRequestTimer (C);
+				else
+				{
+					OTA_PRINT ("[OTA] Failed to CBOR encode GetStream message.\r\n");
+					eErr = kOTA_Err_SoftwareBug;
 				}
 			}
-			else
-			{
-				OTA_PRINT ("[OTA] Failed to CBOR encode GetStream message.\r\n");
-				eErr = kOTA_Err_SoftwareBug;
-			}
 		}
 		else
 		{
@@ -885,9 +901,10 @@ static void prvOTAUpdateTask( MQTTAgentHandle_t xPubSubClientHandle )
 					prvAgentShutdown();		/* Free up all resources. */
 					break;					/* Break, so we stop all OTA processing. */
 				}
-				/* On OTA request timer timeout, publish the stream request if we have context. */
+				/* On OTA request timer timeout, request the missing blocks again if we have context. */
 				if ( ( uxBits & kmOTA_EvtReqTimeout) && ( C != NULL ) )
 				{
+					OTA_WINDOW_Reset (&C->xRequestWindow);
 					eErr = prvPublishGetStreamMessage (C, &acOTA_DynamicTopic[0]);
 					if (eErr != kOTA_Err_None)
 					{	/* Abort the current OTA. */
@@ -963,6 +980,14 @@ static void prvOTAUpdateTask( MQTTAgentHandle_t xPubSubClientHandle )
 											/* First reset the momentum counter since we received a good block. */
 											C->ulRequestMomentum = 0;
 											prvUpdateJobStatus (C, &acOTA_DynamicTopic[0], eJobStatus_InProgress, eJobReason_Receiving);
+
+											/* Request the next range of blocks if the window has room for it. */
+											if (prvPublishGetStreamMessage (C, &acOTA_DynamicTopic[0]) != kOTA_Err_None)
+											{
+												OTA_SetImageState( eOTA_ImageState_Aborted );
+												prvOTA_Close(C);
+												C = NULL;
+											}
 										}
 									}
 								}
@@ -1552,6 +1577,7 @@ OTA_FileContext_t* prvProcessOTAJobMsg(const char *pacRawMsg, u32 iMsgLen) {
 					bit >>= 1;
 				}
 				pstUpdateFile->iBlocksRemaining = iNumBlocks;		/* Initialize our blocks remaining counter. */
+				OTA_WINDOW_Init(&pstUpdateFile->xRequestWindow, otaconfigREQUEST_WINDOW_SIZE, otaconfigBLOCKS_PER_REQUEST);
 				prvStartRequestTimer(pstUpdateFile);
 
 				/* Create/Open the OTA file on the file system. */
@@ -1582,9 +1608,10 @@ OTA_FileContext_t* prvProcessOTAJobMsg(const char *pacRawMsg, u32 iMsgLen) {
 /* prvIngestDataBlock
  *
  * A block of file data was received by the application via some configured communication protocol.
- * If it looks like it is in range, write it to persistent storage. If it's the last block we're
- * expecting, perform the final signature check on the overall file and prepare it for use if the
- * signature check passes. If the signature check fails, abort that file transfer.
+ * If it looks like it is in range, write it to persistent storage. Blocks received in order are
+ * also added to the running signature hash of the file, if the PAL started one. If it's the last
+ * block we're expecting, perform the final signature check on the overall file and prepare it for
+ * use if the signature check passes. If the signature check fails, abort that file transfer.
  */
 IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
                                    const char * pacRawMsg,
@@ -1652,6 +1679,17 @@ IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
                             {
                                 C->pacRxBlockBitmap[byte] &= ~mBit; /* Mark this block as received in our bitmap. */
                                 C->iBlocksRemaining--;
+                                OTA_WINDOW_BlockReceived( &C->xRequestWindow );
+
+                                /* If this is the next block of the file, add it to the running signature hash
+                                 * so the file doesn't have to be read back for the signature check. Blocks
+                                 * received out of order are hashed by prvCheckFileSignature when the file is closed. */
+                                if( ( C->pvSigVerifyContext != NULL ) &&
+                                    ( ( u32 )( lBlockIndex * kOTA_FileBlockSize ) == C->ulBytesHashed ) )
+                                {
+                                    CRYPTO_SignatureVerificationUpdate( C->pvSigVerifyContext, pucPayload, ( size_t )lBlockSize );
+                                    C->ulBytesHashed += ( u32 )lBlockSize;
+                                }
                             }
                         }
                         else
@@ -0,0 +1,150 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_ota_window.c
+ * @brief Sliding window of the stream requests of an OTA file.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* OTA includes. */
+#include "aws_ota_window.h"
+
+/**
+ * @brief Number of blocks tracked by one byte of the block bitmap.
+ */
+#define otawindowBLOCKS_PER_BYTE    ( 8U )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Counts the blocks not received yet in a range of the block bitmap.
+ *
+ * @param[in] pucBitmap The first byte of the range.
+ * @param[in] ulByteCount Number of bytes in the range.
+ *
+ * @return The number of set bits in the range.
+ */
+static uint32_t prvCountMissingBlocks( const uint8_t * pucBitmap,
+                                       uint32_t ulByteCount );
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvCountMissingBlocks( const uint8_t * pucBitmap,
+                                       uint32_t ulByteCount )
+{
+    uint32_t ulCount = 0;
+    uint8_t ucByte;
+
+    while( ulByteCount > 0 )
+    {
+        /* Clear the lowest set bit until none are left. */
+        for( ucByte = *pucBitmap; ucByte != 0U; ucByte &= ( uint8_t ) ( ucByte - 1U ) )
+        {
+            ulCount++;
+        }
+
+        pucBitmap++;
+        ulByteCount--;
+    }
+
+    return ulCount;
+}
+/*-----------------------------------------------------------*/
+
+void OTA_WINDOW_Init( OTA_RequestWindow_t * const pxWindow,
+                      uint32_t ulWindowSize,
+                      uint32_t ulBlocksPerRequest )
+{
+    configASSERT( ulWindowSize > 0 );
+    configASSERT( ( ulBlocksPerRequest > 0 ) && ( ( ulBlocksPerRequest % otawindowBLOCKS_PER_BYTE ) == 0 ) );
+
+    memset( pxWindow, 0x00, sizeof( OTA_RequestWindow_t ) );
+    pxWindow->ulWindowSize = ulWindowSize;
+    pxWindow->ulBlocksPerRequest = ulBlocksPerRequest;
+}
+/*-----------------------------------------------------------*/
+
+void OTA_WINDOW_Reset( OTA_RequestWindow_t * const pxWindow )
+{
+    pxWindow->ulNextByte = 0;
+    pxWindow->ulBlocksInFlight = 0;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t OTA_WINDOW_GetNextRequest( OTA_RequestWindow_t * const pxWindow,
+                                      const uint8_t * const pucRxBlockBitmap,
+                                      uint32_t ulBitmapLen,
+                                      uint32_t * const pulByteOffset,
+                                      uint32_t * const pulByteCount )
+{
+    BaseType_t xResult = pdFALSE;
+    uint32_t ulByteCount = pxWindow->ulBlocksPerRequest / otawindowBLOCKS_PER_BYTE;
+
+    /* There is room for another request once the blocks in flight fit in
+     * one request less than the window. */
+    if( pxWindow->ulBlocksInFlight <= ( ( pxWindow->ulWindowSize - 1U ) * pxWindow->ulBlocksPerRequest ) )
+    {
+        /* Skip the part of the file which has been received completely. */
+        while( ( pxWindow->ulNextByte < ulBitmapLen ) && ( pucRxBlockBitmap[ pxWindow->ulNextByte ] == 0U ) )
+        {
+            pxWindow->ulNextByte++;
+        }
+
+        if( pxWindow->ulNextByte < ulBitmapLen )
+        {
+            if( ulByteCount > ( ulBitmapLen - pxWindow->ulNextByte ) )
+            {
+                ulByteCount = ulBitmapLen - pxWindow->ulNextByte;
+            }
+
+            *pulByteOffset = pxWindow->ulNextByte;
+            *pulByteCount = ulByteCount;
+
+            pxWindow->ulBlocksInFlight += prvCountMissingBlocks( &pucRxBlockBitmap[ pxWindow->ulNextByte ], ulByteCount );
+            pxWindow->ulNextByte += ulByteCount;
+            xResult = pdTRUE;
+        }
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+void OTA_WINDOW_BlockReceived( OTA_RequestWindow_t * const pxWindow )
+{
+    /* Blocks of the requests forgotten by OTA_WINDOW_Reset() may still
+     * arrive. */
+    if( pxWindow->ulBlocksInFlight > 0U )
+    {
+        pxWindow->ulBlocksInFlight--;
+    }
+}
+/*-----------------------------------------------------------*/
@@ -114,6 +114,9 @@ static __inline__ bool OTA_ContextValidate(OTA_FileContext_t *C)
 
 static __inline__ void OTA_ContextClose(OTA_FileContext_t *C)
 {
+    CRYPTO_SignatureVerificationAbort(C->pvSigVerifyContext);
+    C->pvSigVerifyContext = 0;
+    C->ulBytesHashed = 0;
     C->pucFile = 0;
     aws_ota_dcpt.currOtaFile = 0;
     pOtaDcpt = 0;
@@ -178,6 +181,13 @@ static bool_t prvCreateFileForRx(OTA_FileContext_t *C)
     pOtaDcpt->high_image_offset = 0;
 
     C->pucFile = (u8*)pOtaDcpt;
+
+    // hash the image as the blocks come in; if this fails the whole image is hashed on close
+    C->ulBytesHashed = 0;
+    if(CRYPTO_SignatureVerificationStart(&C->pvSigVerifyContext, cryptoASYMMETRIC_ALGORITHM_ECDSA, cryptoHASH_ALGORITHM_SHA256) == pdFALSE)
+    {
+        C->pvSigVerifyContext = 0;
+    }
     
     OTA_PRINT("[OTA-MCHP] Create - Erased the flash OK\r\n");
 
@@ -291,12 +301,15 @@ static OTA_Err_t prvCheckFileSignature(OTA_FileContext_t * const C)
     s32		lSignerCertSize;
     void	*pvSigVerifyContext;
     u8		*pucSignerCert = 0;
+    uint32_t start_offset;
 
     while(true)
     {
-        /* Verify an ECDSA-SHA256 signature. */
-        if (CRYPTO_SignatureVerificationStart( &pvSigVerifyContext, cryptoASYMMETRIC_ALGORITHM_ECDSA, cryptoHASH_ALGORITHM_SHA256) == pdFALSE)
+        /* Continue the running hash of the blocks received in order, or verify an ECDSA-SHA256 signature over the whole image. */
+        if (C->pvSigVerifyContext == 0 &&
+            CRYPTO_SignatureVerificationStart( &C->pvSigVerifyContext, cryptoASYMMETRIC_ALGORITHM_ECDSA, cryptoHASH_ALGORITHM_SHA256) == pdFALSE)
         {
+            C->pvSigVerifyContext = 0;
             result = kOTA_Err_SignatureCheckFailed;
             break;
         }
@@ -310,8 +323,18 @@ static OTA_Err_t prvCheckFileSignature(OTA_FileContext_t * const C)
         }
 
 
-        uint8_t* flash_address = (uint8_t*)KVA0_TO_KVA1(AWS_FLASH_IMAGE_START + pOtaDcpt->low_image_offset);
-        CRYPTO_SignatureVerificationUpdate(pvSigVerifyContext, flash_address, pOtaDcpt->high_image_offset - pOtaDcpt->low_image_offset);
+        // hash only the part of the image that wasn't hashed while it was received
+        start_offset = pOtaDcpt->low_image_offset;
+        if(C->ulBytesHashed > start_offset)
+        {
+            start_offset = C->ulBytesHashed;
+        }
+
+        pvSigVerifyContext = C->pvSigVerifyContext;
+        C->pvSigVerifyContext = 0;  // freed by CRYPTO_SignatureVerificationFinal()
+
+        uint8_t* flash_address = (uint8_t*)KVA0_TO_KVA1(AWS_FLASH_IMAGE_START + start_offset);
+        CRYPTO_SignatureVerificationUpdate(pvSigVerifyContext, flash_address, pOtaDcpt->high_image_offset - start_offset);
 
         if (CRYPTO_SignatureVerificationFinal(pvSigVerifyContext, (char*)pucSignerCert, lSignerCertSize, C->pacSignature, C->usSigSize) == pdFALSE)
         {
@@ -33,6 +33,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 /* Specify the OTA signature algorithm we support on this platform. */
 static const char acOTA_JSON_FileSignatureKey[] = "sig-sha256-rsa";
 
+/* Free the running signature hash of the receive file, if there is one. */
+
+static void prvFreeFileHash(OTA_FileContext_t * const C)
+{
+	CRYPTO_SignatureVerificationAbort(C->pvSigVerifyContext);
+	C->pvSigVerifyContext = NULL;
+	C->ulBytesHashed = 0;
+}
+
+
 /* Abort receiving the specified OTA update by closing the file. */
 
 static OTA_Err_t prvAbort(OTA_FileContext_t * const C)
@@ -45,6 +55,7 @@ static OTA_Err_t prvAbort(OTA_FileContext_t * const C)
 		iStatus = fclose(C->pstFile);
 		C->pstFile = NULL;
 	}
+	prvFreeFileHash(C);
 	return iStatus;
 }
 
@@ -60,6 +71,14 @@ static bool_t prvCreateFileForRx(OTA_FileContext_t * const C)
 	{
 		xStatus = pdTRUE;
 		OTA_PRINT("[OTA] file handle: %08x\r\n", (u32)C->pstFile );
+
+		/* Start hashing the file for the signature check as the blocks come in. If this fails,
+		 * the whole file is read back and hashed when it is closed. */
+		C->ulBytesHashed = 0;
+		if (pdFALSE == CRYPTO_SignatureVerificationStart(&C->pvSigVerifyContext, cryptoASYMMETRIC_ALGORITHM_RSA, cryptoHASH_ALGORITHM_SHA256))
+		{
+			C->pvSigVerifyContext = NULL;
+		}
 	}
 	else {
 		xStatus = pdFALSE;
@@ -89,6 +108,7 @@ static OTA_Err_t prvCloseFile(OTA_FileContext_t * const C)
 		fclose(C->pstFile);
 		C->pstFile = NULL;
 	}
+	prvFreeFileHash(C);
 	if (result == kOTA_Err_None)
 	{
 		OTA_PRINT ("[OTA] %s signature verification passed.\r\n", acOTA_JSON_FileSignatureKey);
@@ -130,14 +150,19 @@ static OTA_Err_t prvCheckFileSignature(OTA_FileContext_t * const C)
 	u8		*pucBuf, *pucSignerCert;
 	void	*pvSigVerifyContext;
 
-	/* Verify an RSA-SHA256 signature. */
-	if (pdFALSE == CRYPTO_SignatureVerificationStart( &pvSigVerifyContext, cryptoASYMMETRIC_ALGORITHM_RSA, cryptoHASH_ALGORITHM_SHA256))
+	/* Continue the running hash of the blocks received in order if there is one. Otherwise
+	 * verify an RSA-SHA256 signature over the whole file. */
+	if ((C->pvSigVerifyContext == NULL) &&
+		(pdFALSE == CRYPTO_SignatureVerificationStart( &C->pvSigVerifyContext, cryptoASYMMETRIC_ALGORITHM_RSA, cryptoHASH_ALGORITHM_SHA256)))
 	{
+		C->pvSigVerifyContext = NULL;
 		err = kOTA_Err_SignatureCheckFailed;
 	}
 	else
 	{
-		OTA_PRINT("[OTA] Started %s signature verification\r\n", acOTA_JSON_FileSignatureKey);
+		pvSigVerifyContext = C->pvSigVerifyContext;
+		ulTotalBytes = C->ulBytesHashed;
+		OTA_PRINT("[OTA] Started %s signature verification at offset %u\r\n", acOTA_JSON_FileSignatureKey, ulTotalBytes);
 		pucSignerCert = prvReadAndAssumeCertificate((const u8* const)C->pacCertFilepath, &lSignerCertSize);
 		if (pucSignerCert != NULL)
 		{
@@ -145,8 +170,8 @@ static OTA_Err_t prvCheckFileSignature(OTA_FileContext_t * const C)
 			if ((pucSignerCert != NULL) && (pucBuf != NULL))
 			{
 				if (C->pstFile != NULL) {
-					/* Rewind the received file to the beginning. */
-					if (fseek(C->pstFile, 0L, SEEK_SET) == 0)
+					/* Seek to the first byte of the received file that isn't hashed yet. */
+					if (fseek(C->pstFile, (long)ulTotalBytes, SEEK_SET) == 0)
 					{
 						do
 						{
@@ -156,6 +181,7 @@ static OTA_Err_t prvCheckFileSignature(OTA_FileContext_t * const C)
 							CRYPTO_SignatureVerificationUpdate(pvSigVerifyContext, pucBuf, ulBytesRead);
 
 						} while (ulBytesRead > 0);
+						C->pvSigVerifyContext = NULL;	/* The context is freed by CRYPTO_SignatureVerificationFinal(). */
 						if (pdFALSE == CRYPTO_SignatureVerificationFinal(pvSigVerifyContext, (char*)pucSignerCert, lSignerCertSize, C->pacSignature, C->usSigSize))
 						{
 							err = kOTA_Err_SignatureCheckFailed;
@@ -36,12 +36,14 @@
 #include "FreeRTOSIPConfig.h"
 #include "aws_pkcs11_config.h"
 #include "task.h"
+#include "semphr.h"
 #include "aws_crypto.h"
 #include "aws_pkcs11.h"
 
 /* mbedTLS includes. */
 #include "mbedtls/pk.h"
 #include "mbedtls/pk_internal.h"
+#include "mbedtls/ecdsa.h"
 #include "mbedtls/x509_crt.h"
 #include "mbedtls/ctr_drbg.h"
 #include "mbedtls/entropy.h"
@@ -64,13 +66,29 @@ typedef int ( * pfnMbedTlsSign )( void * ctx,
 
 #define pkcs11NO_OPERATION    ( ( CK_MECHANISM_TYPE ) 0xFFFFFFFFF )
 
+/**
+ * @brief Parsed private key and certificate objects shared by all sessions.
+ *
+ * The objects are read from storage and parsed by the first session that
+ * looks for them, and then kept until C_CreateObject or C_DestroyObject
+ * changes them. Sessions that still use the objects keep a reference, so an
+ * invalidated entry is freed when the last of them is closed.
+ */
+typedef struct P11ObjectCache
+{
+    UBaseType_t uxReferences;
+    SemaphoreHandle_t xKeyMutex; /**< Serializes the operations with the shared private key. */
+    mbedtls_pk_context xMbedPkCtx;
+    mbedtls_x509_crt xMbedX509Cli;
+} P11ObjectCache_t, * P11ObjectCachePtr_t;
+
 /**
  * @brief Key structure.
  */
 typedef struct P11Key
 {
     mbedtls_pk_context xMbedPkCtx;
-    mbedtls_x509_crt xMbedX509Cli;
+    P11ObjectCachePtr_t pxObjects; /**< The shared objects, or NULL if the key belongs to the session. */
     mbedtls_pk_info_t xMbedPkInfo;
     pfnMbedTlsSign pfnSavedMbedSign;
     void * pvSavedMbedPkCtx;
@@ -92,6 +110,10 @@ typedef struct P11Session
     mbedtls_entropy_context xMbedEntropyContext;
     mbedtls_pk_context xPublicKey;
     mbedtls_sha256_context xSHA256Context;
+    CK_MECHANISM_TYPE xSignMechanism;   /**< Hashing mechanism of the signature in progress. */
+    mbedtls_sha256_context xSignSHA256Context;
+    CK_MECHANISM_TYPE xVerifyMechanism; /**< Hashing mechanism of the verification in progress. */
+    mbedtls_sha256_context xVerifySHA256Context;
 } P11Session_t, * P11SessionPtr_t;
 
 /**
@@ -141,6 +163,12 @@ extern BaseType_t PKCS11_PAL_ReadFile( char * pcFileName,
  */
 extern void PKCS11_PAL_ReleaseFileData( uint8_t * pucBuffer,
                                         uint32_t ulBufferSize );
+
+/**
+ * @brief The objects loaded from storage, or NULL if they have to be loaded
+ * again.
+ */
+static P11ObjectCachePtr_t pxObjectCache = NULL;
 /*-----------------------------------------------------------*/
 
 /**
@@ -232,71 +260,257 @@ static CK_RV prvSetupPkcs11SigningForMbedTls( P11SessionPtr_t pxSessionObj,
 /*-----------------------------------------------------------*/
 
 /**
- * @brief Initializes a key structure.
+ * @brief Parses the private key and certificate into a new object cache
+ * entry, referenced once by the caller.
  */
-static CK_RV prvInitializeKey( P11SessionPtr_t pxSessionObj,
-                               const char * pcEncodedKey,
-                               const uint32_t ulEncodedKeyLength,
-                               const char * pcEncodedCertificate,
-                               const uint32_t ulEncodedCertificateLength )
+static CK_RV prvParseObjects( const uint8_t * pucEncodedKey,
+                              const uint32_t ulEncodedKeyLength,
+                              const uint8_t * pucEncodedCertificate,
+                              const uint32_t ulEncodedCertificateLength,
+                              P11ObjectCachePtr_t * ppxObjects )
 {
-    CK_RV xResult = 0;
+    CK_RV xResult = CKR_OK;
+    P11ObjectCachePtr_t pxObjects = NULL;
 
-    /*
-     * Create the key structure, but allow an existing one to be used.
-     */
+    pxObjects = ( P11ObjectCachePtr_t ) pvPortMalloc( sizeof( P11ObjectCache_t ) ); /*lint !e9087 Allow casting void* to other types. */
 
-    if( NULL == pxSessionObj->pxCurrentKey )
+    if( NULL == pxObjects )
+    {
+        xResult = CKR_HOST_MEMORY;
+    }
+    else
     {
-        if( NULL == ( pxSessionObj->pxCurrentKey = ( P11KeyPtr_t ) pvPortMalloc(
-                          sizeof( P11Key_t ) ) ) ) /*lint !e9087 Allow casting void* to other types. */
+        memset( pxObjects, 0, sizeof( P11ObjectCache_t ) );
+        pxObjects->uxReferences = 1;
+        mbedtls_pk_init( &pxObjects->xMbedPkCtx );
+        mbedtls_x509_crt_init( &pxObjects->xMbedX509Cli );
+
+        pxObjects->xKeyMutex = xSemaphoreCreateMutex();
+
+        if( NULL == pxObjects->xKeyMutex )
         {
             xResult = CKR_HOST_MEMORY;
         }
     }
 
-    /*
-     * Initialize the key field, if requested.
-     */
-
-    if( ( CKR_OK == xResult ) && ( NULL != pcEncodedKey ) )
+    if( CKR_OK == xResult )
     {
-        memset( pxSessionObj->pxCurrentKey, 0, sizeof( P11Key_t ) );
-        mbedtls_pk_init( &pxSessionObj->pxCurrentKey->xMbedPkCtx );
-
         if( 0 != mbedtls_pk_parse_key(
-                &pxSessionObj->pxCurrentKey->xMbedPkCtx,
-                ( const unsigned char * ) pcEncodedKey,
+                &pxObjects->xMbedPkCtx,
+                pucEncodedKey,
                 ulEncodedKeyLength,
                 NULL,
                 0 ) )
         {
             xResult = CKR_FUNCTION_FAILED;
         }
+    }
 
-        if( CKR_OK == xResult )
+    if( CKR_OK == xResult )
+    {
+        if( 0 != mbedtls_x509_crt_parse(
+                &pxObjects->xMbedX509Cli,
+                pucEncodedCertificate,
+                ulEncodedCertificateLength ) )
         {
-            xResult = prvSetupPkcs11SigningForMbedTls( pxSessionObj, 
-                                                       pxSessionObj->pxCurrentKey );
+            xResult = CKR_FUNCTION_FAILED;
         }
     }
 
-    /*
-     * Initialize the certificate field, if requested.
-     */
+    if( CKR_OK == xResult )
+    {
+        *ppxObjects = pxObjects;
+    }
+    else if( NULL != pxObjects )
+    {
+        if( NULL != pxObjects->xKeyMutex )
+        {
+            vSemaphoreDelete( pxObjects->xKeyMutex );
+        }
 
-    if( ( CKR_OK == xResult ) && ( NULL != pcEncodedCertificate ) )
+        mbedtls_pk_free( &pxObjects->xMbedPkCtx );
+        mbedtls_x509_crt_free( &pxObjects->xMbedX509Cli );
+        vPortFree( pxObjects );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Drops a reference to an object cache entry, and frees the entry
+ * if it was the last one.
+ */
+static void prvReleaseObjects( P11ObjectCachePtr_t pxObjects )
+{
+    BaseType_t xFree = pdFALSE;
+
+    taskENTER_CRITICAL();
     {
-        mbedtls_x509_crt_init( &pxSessionObj->pxCurrentKey->xMbedX509Cli );
+        pxObjects->uxReferences--;
 
-        if( 0 != mbedtls_x509_crt_parse(
-                &pxSessionObj->pxCurrentKey->xMbedX509Cli,
-                ( const unsigned char * ) pcEncodedCertificate,
-                ulEncodedCertificateLength ) )
+        if( 0u == pxObjects->uxReferences )
         {
-            xResult = CKR_FUNCTION_FAILED;
+            xFree = pdTRUE;
         }
     }
+    taskEXIT_CRITICAL();
+
+    if( pdTRUE == xFree )
+    {
+        vSemaphoreDelete( pxObjects->xKeyMutex );
+        mbedtls_pk_free( &pxObjects->xMbedPkCtx );
+        mbedtls_x509_crt_free( &pxObjects->xMbedX509Cli );
+        vPortFree( pxObjects );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Takes a reference to the cached objects.
+ *
+ * @return The cached objects, or NULL if they have to be loaded.
+ */
+static P11ObjectCachePtr_t prvGetCachedObjects( void )
+{
+    P11ObjectCachePtr_t pxObjects;
+
+    taskENTER_CRITICAL();
+    {
+        pxObjects = pxObjectCache;
+
+        if( NULL != pxObjects )
+        {
+            pxObjects->uxReferences++;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return pxObjects;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Stores newly loaded objects in the cache.
+ *
+ * If another session loaded the objects in the meantime, its objects are
+ * kept and returned instead of the ones passed in.
+ */
+static P11ObjectCachePtr_t prvCacheObjects( P11ObjectCachePtr_t pxObjects )
+{
+    P11ObjectCachePtr_t pxCachedObjects;
+
+    taskENTER_CRITICAL();
+    {
+        if( NULL == pxObjectCache )
+        {
+            pxObjectCache = pxObjects;
+        }
+
+        /* Reference held by the cache, or by the caller if the objects of
+         * another session were cached first. */
+        pxCachedObjects = pxObjectCache;
+        pxCachedObjects->uxReferences++;
+    }
+    taskEXIT_CRITICAL();
+
+    /* The objects passed in are not used if others were cached first. */
+    if( pxCachedObjects != pxObjects )
+    {
+        prvReleaseObjects( pxObjects );
+    }
+
+    return pxCachedObjects;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Makes the next session that looks for the private key or the
+ * certificate load them from storage again.
+ */
+static void prvInvalidateObjectCache( void )
+{
+    P11ObjectCachePtr_t pxObjects;
+
+    taskENTER_CRITICAL();
+    {
+        pxObjects = pxObjectCache;
+        pxObjectCache = NULL;
+    }
+    taskEXIT_CRITICAL();
+
+    if( NULL != pxObjects )
+    {
+        prvReleaseObjects( pxObjects );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Serializes the operations with the private key if it is shared
+ * with other sessions.
+ *
+ * mbedTLS keeps state in the key contexts during private key operations
+ * (the RSA blinding values, and the comb table of an EC group the first time
+ * it is used), so they must not run in two sessions at the same time.
+ */
+static void prvLockKey( P11KeyPtr_t pxKey )
+{
+    if( NULL != pxKey->pxObjects )
+    {
+        ( void ) xSemaphoreTake( pxKey->pxObjects->xKeyMutex, portMAX_DELAY );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Ends an operation started with prvLockKey.
+ */
+static void prvUnlockKey( P11KeyPtr_t pxKey )
+{
+    if( NULL != pxKey->pxObjects )
+    {
+        ( void ) xSemaphoreGive( pxKey->pxObjects->xKeyMutex );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Initializes a key structure that uses the cached objects.
+ *
+ * The reference to the objects is handed over to the key.
+ */
+static CK_RV prvInitializeKey( P11SessionPtr_t pxSessionObj,
+                               P11ObjectCachePtr_t pxObjects )
+{
+    CK_RV xResult = CKR_OK;
+    P11KeyPtr_t pxKey = NULL;
+
+    pxKey = ( P11KeyPtr_t ) pvPortMalloc( sizeof( P11Key_t ) ); /*lint !e9087 Allow casting void* to other types. */
+
+    if( NULL == pxKey )
+    {
+        xResult = CKR_HOST_MEMORY;
+        prvReleaseObjects( pxObjects );
+    }
+    else
+    {
+        /* The key refers to the shared key context, and only the signing
+         * function and context it hands to mbedTLS belong to the session. */
+        memset( pxKey, 0, sizeof( P11Key_t ) );
+        pxKey->pxObjects = pxObjects;
+        pxKey->xMbedPkCtx = pxObjects->xMbedPkCtx;
+
+        xResult = prvSetupPkcs11SigningForMbedTls( pxSessionObj, pxKey );
+        pxSessionObj->pxCurrentKey = pxKey;
+    }
 
     return xResult;
 }
@@ -304,11 +518,13 @@ static CK_RV prvInitializeKey( P11SessionPtr_t pxSessionObj,
 /*-----------------------------------------------------------*/
 
 /**
- * @brief Load the default key and certificate from storage.
+ * @brief Load the default key and certificate from storage, unless another
+ * session has loaded them already.
  */
 static CK_RV prvLoadAndInitializeDefaultCertificateAndKey( P11SessionPtr_t pxSession )
 {
-    CK_RV xResult = 0;
+    CK_RV xResult = CKR_OK;
+    P11ObjectCachePtr_t pxObjects = NULL;
     uint8_t * pucCertificateData = NULL;
     uint32_t ulCertificateDataLength = 0;
     BaseType_t xFreeCertificate = pdFALSE;
@@ -316,78 +532,292 @@ static CK_RV prvLoadAndInitializeDefaultCertificateAndKey( P11SessionPtr_t pxSes
     uint32_t ulKeyDataLength = 0;
     BaseType_t xFreeKey = pdFALSE;
 
-    /* Read the certificate from storage. */
-    if( pdFALSE == PKCS11_PAL_ReadFile( pkcs11configFILE_NAME_CLIENT_CERTIFICATE,
-                                        &pucCertificateData,
-                                        &ulCertificateDataLength ) )
+    pxObjects = prvGetCachedObjects();
+
+    if( NULL == pxObjects )
     {
-        pucCertificateData = ( uint8_t * ) clientcredentialCLIENT_CERTIFICATE_PEM;
-        ulCertificateDataLength = clientcredentialCLIENT_CERTIFICATE_LENGTH;
+        /* Read the certificate from storage. */
+        if( pdFALSE == PKCS11_PAL_ReadFile( pkcs11configFILE_NAME_CLIENT_CERTIFICATE,
+                                            &pucCertificateData,
+                                            &ulCertificateDataLength ) )
+        {
+            pucCertificateData = ( uint8_t * ) clientcredentialCLIENT_CERTIFICATE_PEM;
+            ulCertificateDataLength = clientcredentialCLIENT_CERTIFICATE_LENGTH;
+        }
+        else
+        {
+            xFreeCertificate = pdTRUE;
+        }
+
+        /* Read the private key from storage. */
+        if( pdFALSE == PKCS11_PAL_ReadFile( pkcs11configFILE_NAME_KEY,
+                                            &pucKeyData,
+                                            &ulKeyDataLength ) )
+        {
+            pucKeyData = ( uint8_t * ) clientcredentialCLIENT_PRIVATE_KEY_PEM;
+            ulKeyDataLength = clientcredentialCLIENT_PRIVATE_KEY_LENGTH;
+        }
+        else
+        {
+            xFreeKey = pdTRUE;
+        }
+
+        xResult = prvParseObjects( pucKeyData,
+                                   ulKeyDataLength,
+                                   pucCertificateData,
+                                   ulCertificateDataLength,
+                                   &pxObjects );
+
+        /* Stir the random pot. */
+        mbedtls_entropy_update_manual( &pxSession->xMbedEntropyContext,
+                                       pucKeyData,
+                                       ulKeyDataLength );
+        mbedtls_entropy_update_manual( &pxSession->xMbedEntropyContext,
+                                       pucCertificateData,
+                                       ulCertificateDataLength );
+
+        /* Clean-up. */
+        if( ( NULL != pucCertificateData ) && ( pdTRUE == xFreeCertificate ) )
+        {
+            PKCS11_PAL_ReleaseFileData( pucCertificateData, ulCertificateDataLength );
+        }
+
+        if( ( NULL != pucKeyData ) && ( pdTRUE == xFreeKey ) )
+        {
+            PKCS11_PAL_ReleaseFileData( pucKeyData, ulKeyDataLength );
+        }
+
+        if( CKR_OK == xResult )
+        {
+            pxObjects = prvCacheObjects( pxObjects );
+        }
     }
-    else
+
+    /* Attach the certificate and key to the session. */
+    if( CKR_OK == xResult )
     {
-        xFreeCertificate = pdTRUE;
+        xResult = prvInitializeKey( pxSession, pxObjects );
     }
 
-    /* Read the private key from storage. */
-    if( pdFALSE == PKCS11_PAL_ReadFile( pkcs11configFILE_NAME_KEY,
-                                        &pucKeyData,
-                                        &ulKeyDataLength ) )
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Cleans up a key structure.
+ */
+static void prvFreeKey( P11KeyPtr_t pxKey )
+{
+    if( NULL != pxKey )
     {
-        pucKeyData = ( uint8_t * ) clientcredentialCLIENT_PRIVATE_KEY_PEM;
-        ulKeyDataLength = clientcredentialCLIENT_PRIVATE_KEY_LENGTH;
+        if( NULL != pxKey->pxObjects )
+        {
+            /* The key context belongs to the object cache. */
+            prvReleaseObjects( pxKey->pxObjects );
+        }
+        else
+        {
+            /* Restore the internal key context. */
+            pxKey->xMbedPkCtx.pk_ctx = pxKey->pvSavedMbedPkCtx;
+
+            /* Clean-up. */
+            mbedtls_pk_free( &pxKey->xMbedPkCtx );
+        }
+
+        vPortFree( pxKey );
     }
-    else
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Checks whether the module hashes the data for a signature
+ * mechanism.
+ *
+ * CKM_SHA256_RSA_PKCS is not one of them, as the callers of this module
+ * use it to sign hashes they computed themselves.
+ */
+static BaseType_t prvIsHashingMechanism( CK_MECHANISM_TYPE xMechanism )
+{
+    BaseType_t xResult = pdFALSE;
+
+    if( CKM_ECDSA_SHA256 == xMechanism )
     {
-        xFreeKey = pdTRUE;
+        xResult = pdTRUE;
     }
 
-    /* Attach the certificate and key to the session. */
-    xResult = prvInitializeKey( pxSession,
-                                ( const char * ) pucKeyData,
-                                ulKeyDataLength,
-                                ( const char * ) pucCertificateData,
-                                ulCertificateDataLength );
-
-    /* Stir the random pot. */
-    mbedtls_entropy_update_manual( &pxSession->xMbedEntropyContext,
-                                   pucKeyData,
-                                   ulKeyDataLength );
-    mbedtls_entropy_update_manual( &pxSession->xMbedEntropyContext,
-                                   pucCertificateData,
-                                   ulCertificateDataLength );
+    return xResult;
+}
 
-    /* Clean-up. */
-    if( ( NULL != pucCertificateData ) && ( pdTRUE == xFreeCertificate ) )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Checks that a key can be used with a hashing signature mechanism.
+ */
+static CK_RV prvCheckMechanismKey( CK_MECHANISM_TYPE xMechanism,
+                                   const mbedtls_pk_context * pxPkCtx )
+{
+    CK_RV xResult = CKR_OK;
+
+    /* CKM_ECDSA_SHA256 is the only hashing mechanism. */
+    ( void ) xMechanism;
+
+    if( 0 == mbedtls_pk_can_do( pxPkCtx, MBEDTLS_PK_ECDSA ) )
     {
-        PKCS11_PAL_ReleaseFileData( pucCertificateData, ulCertificateDataLength );
+        xResult = CKR_KEY_TYPE_INCONSISTENT;
     }
 
-    if( ( NULL != pucKeyData ) && ( pdTRUE == xFreeKey ) )
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Ends a signature started with a hashing mechanism.
+ */
+static void prvEndSign( P11SessionPtr_t pxSessionObj )
+{
+    mbedtls_sha256_free( &pxSessionObj->xSignSHA256Context );
+    pxSessionObj->xSignMechanism = pkcs11NO_OPERATION;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Ends a verification started with a hashing mechanism.
+ */
+static void prvEndVerify( P11SessionPtr_t pxSessionObj )
+{
+    mbedtls_sha256_free( &pxSessionObj->xVerifySHA256Context );
+    pxSessionObj->xVerifyMechanism = pkcs11NO_OPERATION;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Signs a SHA-256 hash with the private key of the session.
+ */
+static CK_RV prvSignHash( P11SessionPtr_t pxSessionObj,
+                          const uint8_t * pucHash,
+                          CK_ULONG ulHashLen,
+                          CK_BYTE_PTR pucSignature,
+                          CK_ULONG_PTR pulSignatureLen )
+{
+    CK_RV xResult = CKR_OK;
+
+    prvLockKey( pxSessionObj->pxCurrentKey );
+
+    if( MBEDTLS_PK_ECKEY == pxSessionObj->pxCurrentKey->xMbedPkInfo.type )
+    {
+        /* The mbedTLS signing function would sign with a copy of
+         * the key, which computes the comb table of the
+         * generator again for every signature. */
+        if( 0 != mbedtls_ecdsa_write_signature(
+                ( mbedtls_ecdsa_context * ) pxSessionObj->pxCurrentKey->pvSavedMbedPkCtx,
+                MBEDTLS_MD_SHA256,
+                pucHash,
+                ulHashLen,
+                pucSignature,
+                ( size_t * ) pulSignatureLen,
+                mbedtls_ctr_drbg_random,
+                &pxSessionObj->xMbedDrbgCtx ) )
+        {
+            xResult = CKR_FUNCTION_FAILED;
+        }
+    }
+    else if( 0 != pxSessionObj->pxCurrentKey->pfnSavedMbedSign(
+                 pxSessionObj->pxCurrentKey->pvSavedMbedPkCtx,
+                 MBEDTLS_MD_SHA256,
+                 pucHash,
+                 ulHashLen,
+                 pucSignature,
+                 ( size_t * ) pulSignatureLen,
+                 mbedtls_ctr_drbg_random,
+                 &pxSessionObj->xMbedDrbgCtx ) )
     {
-        PKCS11_PAL_ReleaseFileData( pucKeyData, ulKeyDataLength );
+        xResult = CKR_FUNCTION_FAILED;
     }
 
+    prvUnlockKey( pxSessionObj->pxCurrentKey );
+
     return xResult;
 }
 
 /*-----------------------------------------------------------*/
 
 /**
- * @brief Cleans up a key structure.
+ * @brief Verifies the signature of a SHA-256 hash with the public key of the
+ * session if there is one, or else with its private key.
  */
-static void prvFreeKey( P11KeyPtr_t pxKey )
+static CK_RV prvVerifyHash( P11SessionPtr_t pxSessionObj,
+                            const uint8_t * pucHash,
+                            CK_ULONG ulHashLen,
+                            const uint8_t * pucSignature,
+                            CK_ULONG ulSignatureLen )
 {
-    if( NULL != pxKey )
+    CK_RV xResult = CKR_OK;
+
+    /* ECDSA keys are used directly rather than through mbedtls_pk, which
+     * would verify with a copy of the key and compute the comb table of the
+     * generator again every time. */
+    if( NULL != pxSessionObj->xPublicKey.pk_ctx )
+    {
+        if( MBEDTLS_PK_ECKEY == mbedtls_pk_get_type( &pxSessionObj->xPublicKey ) )
+        {
+            if( 0 != mbedtls_ecdsa_read_signature( mbedtls_pk_ec( pxSessionObj->xPublicKey ),
+                                                   pucHash,
+                                                   ulHashLen,
+                                                   pucSignature,
+                                                   ulSignatureLen ) )
+            {
+                xResult = CKR_SIGNATURE_INVALID;
+            }
+        }
+        else if( 0 != mbedtls_pk_verify( &pxSessionObj->xPublicKey,
+                                         MBEDTLS_MD_SHA256,
+                                         pucHash,
+                                         ulHashLen,
+                                         pucSignature,
+                                         ulSignatureLen ) )
+        {
+            xResult = CKR_SIGNATURE_INVALID;
+        }
+    }
+    else
     {
-        /* Restore the internal key context. */
-        pxKey->xMbedPkCtx.pk_ctx = pxKey->pvSavedMbedPkCtx;
+        prvLockKey( pxSessionObj->pxCurrentKey );
 
-        /* Clean-up. */
-        mbedtls_pk_free( &pxKey->xMbedPkCtx );
-        mbedtls_x509_crt_free( &pxKey->xMbedX509Cli );
-        vPortFree( pxKey );
+        if( MBEDTLS_PK_ECKEY == pxSessionObj->pxCurrentKey->xMbedPkInfo.type )
+        {
+            if( 0 != mbedtls_ecdsa_read_signature(
+                    ( mbedtls_ecdsa_context * ) pxSessionObj->pxCurrentKey->pvSavedMbedPkCtx,
+                    pucHash,
+                    ulHashLen,
+                    pucSignature,
+                    ulSignatureLen ) )
+            {
+                xResult = CKR_SIGNATURE_INVALID;
+            }
+        }
+        else
+        {
+            if( 0 != pxSessionObj->pxCurrentKey->xMbedPkInfo.verify_func(
+                    pxSessionObj->pxCurrentKey->pvSavedMbedPkCtx,
+                    MBEDTLS_MD_SHA256,
+                    pucHash,
+                    ulHashLen,
+                    pucSignature,
+                    ulSignatureLen ) )
+            {
+                xResult = CKR_SIGNATURE_INVALID;
+            }
+        }
+
+        prvUnlockKey( pxSessionObj->pxCurrentKey );
     }
+
+    return xResult;
 }
 
 /*
@@ -444,14 +874,14 @@ static CK_FUNCTION_LIST prvP11FunctionList =
     C_DigestFinal,
     C_SignInit,
     C_Sign,
-    NULL, /*C_SignUpdate*/
-    NULL, /*C_SignFinal*/
+    C_SignUpdate,
+    C_SignFinal,
     NULL, /*C_SignRecoverInit*/
     NULL, /*C_SignRecover*/
     C_VerifyInit,
     C_Verify,
-    NULL, /*C_VerifyUpdate*/
-    NULL, /*C_VerifyFinal*/
+    C_VerifyUpdate,
+    C_VerifyFinal,
     NULL, /*C_VerifyRecoverInit*/
     NULL, /*C_VerifyRecover*/
     NULL, /*C_DigestEncryptUpdate*/
@@ -640,6 +1070,8 @@ CK_DEFINE_FUNCTION( CK_RV, C_OpenSession )( CK_SLOT_ID xSlotID,
     if( CKR_OK == xResult )
     {
         pxSessionObj->xOperationInProgress = pkcs11NO_OPERATION;
+        pxSessionObj->xSignMechanism = pkcs11NO_OPERATION;
+        pxSessionObj->xVerifyMechanism = pkcs11NO_OPERATION;
     }
 
     if( ( NULL != pxSessionObj ) && ( CKR_OK != xResult ) )
@@ -782,6 +1214,9 @@ CK_DEFINE_FUNCTION( CK_RV, C_CreateObject )( CK_SESSION_HANDLE xSession,
                     {
                         /* If successful, set object handle to certificate. */
                         *pxObject = pkcs11OBJECT_HANDLE_CERTIFICATE;
+
+                        /* Sessions opened from now on use the new certificate. */
+                        prvInvalidateObjectCache();
                     }
                 }
                 else if( *( ( uint32_t * ) pxTemplate[ pkcs11CREATE_OBJECT_CERTIFICATE_TYPE_ATTRIBUTE_INDEX ].pValue )
@@ -883,6 +1318,9 @@ CK_DEFINE_FUNCTION( CK_RV, C_CreateObject )( CK_SESSION_HANDLE xSession,
                 {
                     /* If successful, set object handle to private key. */
                     *pxObject = pkcs11OBJECT_HANDLE_PRIVATE_KEY;
+
+                    /* Sessions opened from now on use the new key. */
+                    prvInvalidateObjectCache();
                 }
 
                 break;
@@ -916,8 +1354,14 @@ CK_DEFINE_FUNCTION( CK_RV, C_DestroyObject )( CK_SESSION_HANDLE xSession,
     {
         /*
          * This implementation uses virtual handles, and the certificate and
-         * private key data are attached to the session, so nothing to do here.
+         * private key data are attached to the session. Only make the next
+         * sessions load them from storage again.
          */
+        if( ( pkcs11OBJECT_HANDLE_PRIVATE_KEY == xObject ) ||
+            ( pkcs11OBJECT_HANDLE_CERTIFICATE == xObject ) )
+        {
+            prvInvalidateObjectCache();
+        }
     }
 
     return CKR_OK;
@@ -995,8 +1439,14 @@ CK_DEFINE_FUNCTION( CK_RV, C_GetAttributeValue )( CK_SESSION_HANDLE xSession,
                     switch( xObject )
                     {
                         case pkcs11OBJECT_HANDLE_CERTIFICATE:
-                            pvAttr = ( CK_VOID_PTR ) pxSession->pxCurrentKey->xMbedX509Cli.raw.p; /*lint !e9005 !e9087 Allow casting other types to void*. */
-                            ulAttrLength = pxSession->pxCurrentKey->xMbedX509Cli.raw.len;
+
+                            /* Generated keys have no certificate. */
+                            if( NULL != pxSession->pxCurrentKey->pxObjects )
+                            {
+                                pvAttr = ( CK_VOID_PTR ) pxSession->pxCurrentKey->pxObjects->xMbedX509Cli.raw.p; /*lint !e9005 !e9087 Allow casting other types to void*. */
+                                ulAttrLength = pxSession->pxCurrentKey->pxObjects->xMbedX509Cli.raw.len;
+                            }
+
                             break;
 
                         case pkcs11OBJECT_HANDLE_PUBLIC_KEY:
@@ -1329,27 +1779,66 @@ CK_DEFINE_FUNCTION( CK_RV, C_DigestFinal )( CK_SESSION_HANDLE xSession,
 
 /**
  * @brief Begin a digital signature generation session.
+ *
+ * With CKM_ECDSA_SHA256, the module hashes the data, which can then be given
+ * in parts with C_SignUpdate and C_SignFinal. With any other mechanism,
+ * C_Sign signs a SHA-256 hash computed by the caller.
  */
 CK_DEFINE_FUNCTION( CK_RV, C_SignInit )( CK_SESSION_HANDLE xSession,
                                          CK_MECHANISM_PTR pxMechanism,
                                          CK_OBJECT_HANDLE xKey )
 {
     CK_RV xResult = CKR_OK;
+    P11SessionPtr_t pxSessionObj = prvSessionPointerFromHandle( xSession );
 
     /*lint !e9072 It's OK to have different parameter name. */
-    ( void ) ( xSession );
     ( void ) ( xKey );
 
-    if( NULL == pxMechanism )
+    if( NULL == pxSessionObj )
+    {
+        xResult = CKR_SESSION_HANDLE_INVALID;
+    }
+    else if( NULL == pxMechanism )
     {
         xResult = CKR_ARGUMENTS_BAD;
     }
+    else if( pkcs11NO_OPERATION != pxSessionObj->xSignMechanism )
+    {
+        xResult = CKR_OPERATION_ACTIVE;
+    }
+    else if( pdTRUE == prvIsHashingMechanism( pxMechanism->mechanism ) )
+    {
+        if( NULL == pxSessionObj->pxCurrentKey )
+        {
+            xResult = CKR_KEY_HANDLE_INVALID;
+        }
+        else
+        {
+            xResult = prvCheckMechanismKey( pxMechanism->mechanism,
+                                            &pxSessionObj->pxCurrentKey->xMbedPkCtx );
+        }
+
+        if( CKR_OK == xResult )
+        {
+            mbedtls_sha256_init( &pxSessionObj->xSignSHA256Context );
+
+            if( 0 != mbedtls_sha256_starts_ret( &pxSessionObj->xSignSHA256Context, 0 ) )
+            {
+                xResult = CKR_FUNCTION_FAILED;
+            }
+            else
+            {
+                pxSessionObj->xSignMechanism = pxMechanism->mechanism;
+            }
+        }
+    }
 
     return xResult;
 }
 
 /**
- * @brief Digitally sign the indicated cryptographic hash bytes.
+ * @brief Digitally sign the indicated cryptographic hash bytes, or the data
+ * if the operation was started with a hashing mechanism.
  */
 CK_DEFINE_FUNCTION( CK_RV, C_Sign )( CK_SESSION_HANDLE xSession,
                                      CK_BYTE_PTR pucData,
@@ -1359,8 +1848,13 @@ CK_DEFINE_FUNCTION( CK_RV, C_Sign )( CK_SESSION_HANDLE xSession,
 {   /*lint !e9072 It's OK to have different parameter name. */
     CK_RV xResult = CKR_OK;
     P11SessionPtr_t pxSessionObj = prvSessionPointerFromHandle( xSession );
+    uint8_t ucHash[ pcks11SHA256_DIGEST_LENGTH ];
 
-    if( NULL == pulSignatureLen )
+    if( NULL == pxSessionObj )
+    {
+        xResult = CKR_SESSION_HANDLE_INVALID;
+    }
+    else if( NULL == pulSignatureLen )
     {
         xResult = CKR_ARGUMENTS_BAD;
     }
@@ -1371,17 +1865,34 @@ CK_DEFINE_FUNCTION( CK_RV, C_Sign )( CK_SESSION_HANDLE xSession,
         {
             *pulSignatureLen = pkcs11SUPPORTED_KEY_BITS / 8;
         }
+        else if( pkcs11NO_OPERATION != pxSessionObj->xSignMechanism )
+        {
+            /* Hash the data, and end the operation. */
+            if( ( 0 != mbedtls_sha256_update_ret( &pxSessionObj->xSignSHA256Context, pucData, ulDataLen ) ) ||
+                ( 0 != mbedtls_sha256_finish_ret( &pxSessionObj->xSignSHA256Context, ucHash ) ) )
+            {
+                xResult = CKR_FUNCTION_FAILED;
+            }
+
+            prvEndSign( pxSessionObj );
+
+            if( CKR_OK == xResult )
+            {
+                xResult = prvSignHash( pxSessionObj,
+                                       ucHash,
+                                       sizeof( ucHash ),
+                                       pucSignature,
+                                       pulSignatureLen );
+            }
+        }
         else
         {
             /*
              * Check algorithm support.
              */
-            if( CKR_OK == xResult )
+            if( ( CK_ULONG ) cryptoSHA256_DIGEST_BYTES != ulDataLen )
             {
-                if( ( CK_ULONG ) cryptoSHA256_DIGEST_BYTES != ulDataLen )
-                {
-                    xResult = CKR_DATA_LEN_RANGE;
-                }
+                xResult = CKR_DATA_LEN_RANGE;
             }
 
             /*
@@ -1390,18 +1901,11 @@ CK_DEFINE_FUNCTION( CK_RV, C_Sign )( CK_SESSION_HANDLE xSession,
 
             if( CKR_OK == xResult )
             {
-                if( 0 != pxSessionObj->pxCurrentKey->pfnSavedMbedSign(
-                        pxSessionObj->pxCurrentKey->pvSavedMbedPkCtx,
-                        MBEDTLS_MD_SHA256,
-                        pucData,
-                        ulDataLen,
-                        pucSignature,
-                        ( size_t * ) pulSignatureLen,
-                        mbedtls_ctr_drbg_random,
-                        &pxSessionObj->xMbedDrbgCtx ) )
-                {
-                    xResult = CKR_FUNCTION_FAILED;
-                }
+                xResult = prvSignHash( pxSessionObj,
+                                       pucData,
+                                       ulDataLen,
+                                       pucSignature,
+                                       pulSignatureLen );
             }
         }
     }
@@ -1409,23 +1913,162 @@ CK_DEFINE_FUNCTION( CK_RV, C_Sign )( CK_SESSION_HANDLE xSession,
     return xResult;
 }
 
+/**
+ * @brief Add a part of the data to the signature started with a hashing
+ * mechanism.
+ */
+CK_DEFINE_FUNCTION( CK_RV, C_SignUpdate )( CK_SESSION_HANDLE xSession,
+                                           CK_BYTE_PTR pucPart,
+                                           CK_ULONG ulPartLen )
+{   /*lint !e9072 It's OK to have different parameter name. */
+    CK_RV xResult = CKR_OK;
+    P11SessionPtr_t pxSessionObj = prvSessionPointerFromHandle( xSession );
+
+    if( NULL == pxSessionObj )
+    {
+        xResult = CKR_SESSION_HANDLE_INVALID;
+    }
+    else if( pkcs11NO_OPERATION == pxSessionObj->xSignMechanism )
+    {
+        xResult = CKR_OPERATION_NOT_INITIALIZED;
+    }
+    else
+    {
+        if( ( NULL == pucPart ) && ( 0u != ulPartLen ) )
+        {
+            xResult = CKR_ARGUMENTS_BAD;
+        }
+        else if( 0 != mbedtls_sha256_update_ret( &pxSessionObj->xSignSHA256Context, pucPart, ulPartLen ) )
+        {
+            xResult = CKR_FUNCTION_FAILED;
+        }
+
+        /* A failed part ends the operation. */
+        if( CKR_OK != xResult )
+        {
+            prvEndSign( pxSessionObj );
+        }
+    }
+
+    return xResult;
+}
+
+/**
+ * @brief Sign the data given with C_SignUpdate.
+ *
+ * If pucSignature is NULL, only the signature length is returned and the
+ * operation goes on.
+ */
+CK_DEFINE_FUNCTION( CK_RV, C_SignFinal )( CK_SESSION_HANDLE xSession,
+                                          CK_BYTE_PTR pucSignature,
+                                          CK_ULONG_PTR pulSignatureLen )
+{   /*lint !e9072 It's OK to have different parameter name. */
+    CK_RV xResult = CKR_OK;
+    P11SessionPtr_t pxSessionObj = prvSessionPointerFromHandle( xSession );
+    uint8_t ucHash[ pcks11SHA256_DIGEST_LENGTH ];
+
+    if( NULL == pxSessionObj )
+    {
+        xResult = CKR_SESSION_HANDLE_INVALID;
+    }
+    else if( NULL == pulSignatureLen )
+    {
+        xResult = CKR_ARGUMENTS_BAD;
+    }
+    else if( pkcs11NO_OPERATION == pxSessionObj->xSignMechanism )
+    {
+        xResult = CKR_OPERATION_NOT_INITIALIZED;
+    }
+    else if( NULL == pucSignature )
+    {
+        *pulSignatureLen = pkcs11SUPPORTED_KEY_BITS / 8;
+    }
+    else
+    {
+        if( 0 != mbedtls_sha256_finish_ret( &pxSessionObj->xSignSHA256Context, ucHash ) )
+        {
+            xResult = CKR_FUNCTION_FAILED;
+        }
+
+        prvEndSign( pxSessionObj );
+
+        if( CKR_OK == xResult )
+        {
+            xResult = prvSignHash( pxSessionObj,
+                                   ucHash,
+                                   sizeof( ucHash ),
+                                   pucSignature,
+                                   pulSignatureLen );
+        }
+    }
+
+    return xResult;
+}
+
 /**
  * @brief Begin a digital signature verification session.
+ *
+ * The mechanisms are handled as in C_SignInit, with C_VerifyUpdate and
+ * C_VerifyFinal for data given in parts.
  */
 CK_DEFINE_FUNCTION( CK_RV, C_VerifyInit )( CK_SESSION_HANDLE xSession,
                                            CK_MECHANISM_PTR pxMechanism,
                                            CK_OBJECT_HANDLE xKey )
 {
     CK_RV xResult = CKR_OK;
+    P11SessionPtr_t pxSessionObj = prvSessionPointerFromHandle( xSession );
+    mbedtls_pk_context * pxPkCtx = NULL;
 
     /*lint !e9072 It's OK to have different parameter name. */
-    ( void ) ( xSession );
     ( void ) ( xKey );
 
-    if( NULL == pxMechanism )
+    if( NULL == pxSessionObj )
+    {
+        xResult = CKR_SESSION_HANDLE_INVALID;
+    }
+    else if( NULL == pxMechanism )
     {
         xResult = CKR_ARGUMENTS_BAD;
     }
+    else if( pkcs11NO_OPERATION != pxSessionObj->xVerifyMechanism )
+    {
+        xResult = CKR_OPERATION_ACTIVE;
+    }
+    else if( pdTRUE == prvIsHashingMechanism( pxMechanism->mechanism ) )
+    {
+        /* Check the key that C_Verify would use. */
+        if( NULL != pxSessionObj->xPublicKey.pk_ctx )
+        {
+            pxPkCtx = &pxSessionObj->xPublicKey;
+        }
+        else if( NULL != pxSessionObj->pxCurrentKey )
+        {
+            pxPkCtx = &pxSessionObj->pxCurrentKey->xMbedPkCtx;
+        }
+        else
+        {
+            xResult = CKR_KEY_HANDLE_INVALID;
+        }
+
+        if( CKR_OK == xResult )
+        {
+            xResult = prvCheckMechanismKey( pxMechanism->mechanism, pxPkCtx );
+        }
+
+        if( CKR_OK == xResult )
+        {
+            mbedtls_sha256_init( &pxSessionObj->xVerifySHA256Context );
+
+            if( 0 != mbedtls_sha256_starts_ret( &pxSessionObj->xVerifySHA256Context, 0 ) )
+            {
+                xResult = CKR_FUNCTION_FAILED;
+            }
+            else
+            {
+                pxSessionObj->xVerifyMechanism = pxMechanism->mechanism;
+            }
+        }
+    }
 
     return xResult;
 }
@@ -1433,6 +2076,9 @@ CK_DEFINE_FUNCTION( CK_RV, C_VerifyInit )( CK_SESSION_HANDLE xSession,
 /**
  * @brief Verify the digital signature of the specified data using the public
  * key attached to this session.
+ *
+ * The data is a SHA-256 hash computed by the caller, unless the operation
+ * was started with a hashing mechanism.
  */
 CK_DEFINE_FUNCTION( CK_RV, C_Verify )( CK_SESSION_HANDLE xSession,
                                        CK_BYTE_PTR pucData,
@@ -1442,6 +2088,7 @@ CK_DEFINE_FUNCTION( CK_RV, C_Verify )( CK_SESSION_HANDLE xSession,
 {
     CK_RV xResult = CKR_OK;
     P11SessionPtr_t pxSessionObj;
+    uint8_t ucHash[ pcks11SHA256_DIGEST_LENGTH ];
 
     /*
      * Check parameters.
@@ -1455,31 +2102,37 @@ CK_DEFINE_FUNCTION( CK_RV, C_Verify )( CK_SESSION_HANDLE xSession,
     {
         pxSessionObj = prvSessionPointerFromHandle( xSession ); /*lint !e9072 It's OK to have different parameter name. */
 
-        /* Verify the signature. If a public key is present, use it. */
-        if( NULL != pxSessionObj->xPublicKey.pk_ctx )
+        if( NULL == pxSessionObj )
+        {
+            xResult = CKR_SESSION_HANDLE_INVALID;
+        }
+        else if( pkcs11NO_OPERATION != pxSessionObj->xVerifyMechanism )
         {
-            if( 0 != mbedtls_pk_verify( &pxSessionObj->xPublicKey,
-                                        MBEDTLS_MD_SHA256,
-                                        pucData,
-                                        ulDataLen,
-                                        pucSignature,
-                                        ulSignatureLen ) )
+            /* Hash the data, and end the operation. */
+            if( ( 0 != mbedtls_sha256_update_ret( &pxSessionObj->xVerifySHA256Context, pucData, ulDataLen ) ) ||
+                ( 0 != mbedtls_sha256_finish_ret( &pxSessionObj->xVerifySHA256Context, ucHash ) ) )
             {
-                xResult = CKR_SIGNATURE_INVALID;
+                xResult = CKR_FUNCTION_FAILED;
+            }
+
+            prvEndVerify( pxSessionObj );
+
+            if( CKR_OK == xResult )
+            {
+                xResult = prvVerifyHash( pxSessionObj,
+                                         ucHash,
+                                         sizeof( ucHash ),
+                                         pucSignature,
+                                         ulSignatureLen );
             }
         }
         else
         {
-            if( 0 != pxSessionObj->pxCurrentKey->xMbedPkInfo.verify_func(
-                    pxSessionObj->pxCurrentKey->pvSavedMbedPkCtx,
-                    MBEDTLS_MD_SHA256,
-                    pucData,
-                    ulDataLen,
-                    pucSignature,
-                    ulSignatureLen ) )
-            {
-                xResult = CKR_SIGNATURE_INVALID;
-            }
+            xResult = prvVerifyHash( pxSessionObj,
+                                     pucData,
+                                     ulDataLen,
+                                     pucSignature,
+                                     ulSignatureLen );
         }
     }
 
@@ -1487,6 +2140,92 @@ CK_DEFINE_FUNCTION( CK_RV, C_Verify )( CK_SESSION_HANDLE xSession,
     return xResult;
 }
 
+/**
+ * @brief Add a part of the data to the verification started with a hashing
+ * mechanism.
+ */
+CK_DEFINE_FUNCTION( CK_RV, C_VerifyUpdate )( CK_SESSION_HANDLE xSession,
+                                             CK_BYTE_PTR pucPart,
+                                             CK_ULONG ulPartLen )
+{   /*lint !e9072 It's OK to have different parameter name. */
+    CK_RV xResult = CKR_OK;
+    P11SessionPtr_t pxSessionObj = prvSessionPointerFromHandle( xSession );
+
+    if( NULL == pxSessionObj )
+    {
+        xResult = CKR_SESSION_HANDLE_INVALID;
+    }
+    else if( pkcs11NO_OPERATION == pxSessionObj->xVerifyMechanism )
+    {
+        xResult = CKR_OPERATION_NOT_INITIALIZED;
+    }
+    else
+    {
+        if( ( NULL == pucPart ) && ( 0u != ulPartLen ) )
+        {
+            xResult = CKR_ARGUMENTS_BAD;
+        }
+        else if( 0 != mbedtls_sha256_update_ret( &pxSessionObj->xVerifySHA256Context, pucPart, ulPartLen ) )
+        {
+            xResult = CKR_FUNCTION_FAILED;
+        }
+
+        /* A failed part ends the operation. */
+        if( CKR_OK != xResult )
+        {
+            prvEndVerify( pxSessionObj );
+        }
+    }
+
+    return xResult;
+}
+
+/**
+ * @brief Verify the digital signature of the data given with
+ * C_VerifyUpdate.
+ */
+CK_DEFINE_FUNCTION( CK_RV, C_VerifyFinal )( CK_SESSION_HANDLE xSession,
+                                            CK_BYTE_PTR pucSignature,
+                                            CK_ULONG ulSignatureLen )
+{   /*lint !e9072 It's OK to have different parameter name. */
+    CK_RV xResult = CKR_OK;
+    P11SessionPtr_t pxSessionObj = prvSessionPointerFromHandle( xSession );
+    uint8_t ucHash[ pcks11SHA256_DIGEST_LENGTH ];
+
+    if( NULL == pxSessionObj )
+    {
+        xResult = CKR_SESSION_HANDLE_INVALID;
+    }
+    else if( pkcs11NO_OPERATION == pxSessionObj->xVerifyMechanism )
+    {
+        xResult = CKR_OPERATION_NOT_INITIALIZED;
+    }
+    else
+    {
+        if( NULL == pucSignature )
+        {
+            xResult = CKR_ARGUMENTS_BAD;
+        }
+        else if( 0 != mbedtls_sha256_finish_ret( &pxSessionObj->xVerifySHA256Context, ucHash ) )
+        {
+            xResult = CKR_FUNCTION_FAILED;
+        }
+
+        prvEndVerify( pxSessionObj );
+
+        if( CKR_OK == xResult )
+        {
+            xResult = prvVerifyHash( pxSessionObj,
+                                     ucHash,
+                                     sizeof( ucHash ),
+                                     pucSignature,
+                                     ulSignatureLen );
+        }
+    }
+
+    return xResult;
+}
+
 /**
  * @brief Generate a new assymetric keyset.
  */
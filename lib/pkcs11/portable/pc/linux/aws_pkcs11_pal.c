@@ -0,0 +1,286 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+
+/**
+ * @file aws_pkcs11_pal.c
+ * @brief Linux simulator file save and read implementation
+ * for PKCS#11 based on mbedTLS with for software keys. This
+ * file deviates from the FreeRTOS style standard for some function names and
+ * data types in order to maintain compliance with the PKCS#11 standard.
+ *
+ * Files are written to a temporary file that is then renamed over the
+ * original, so a reader sees either the old or the new contents and never a
+ * partially written file. Files are read by mapping them into memory, so the
+ * data handed to the PKCS#11 module is not copied.
+ */
+
+/*-----------------------------------------------------------*/
+
+
+#include "FreeRTOS.h"
+#include "FreeRTOSIPConfig.h"
+#include "aws_pkcs11.h"
+
+
+/* C runtime includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* POSIX includes. */
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Suffix of the temporary file a file is written to before it is
+ * renamed.
+ */
+#define pkcs11palTEMP_FILE_SUFFIX    ".tmp"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Writes a whole buffer to a file descriptor.
+ *
+ * @return pdTRUE if all the data was written, pdFALSE otherwise.
+ */
+static BaseType_t prvWriteAll( int lFile,
+                               const uint8_t * pucData,
+                               uint32_t ulDataSize )
+{
+    BaseType_t xResult = pdTRUE;
+    ssize_t xWritten = 0;
+
+    while( ( pdTRUE == xResult ) && ( 0u < ulDataSize ) )
+    {
+        xWritten = write( lFile, pucData, ( size_t ) ulDataSize );
+
+        if( 0 < xWritten )
+        {
+            pucData += xWritten;
+            ulDataSize -= ( uint32_t ) xWritten;
+        }
+        else if( ( 0 > xWritten ) && ( EINTR == errno ) )
+        {
+            /* The tick signal of the port interrupted the write. */
+        }
+        else
+        {
+            xResult = pdFALSE;
+        }
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Flushes the directory holding a file, so that a rename in it is
+ * not lost.
+ *
+ * @param[in] pcFileName The name of the file.
+ */
+static void prvSyncDirectory( const char * pcFileName )
+{
+    const char * pcSeparator = strrchr( pcFileName, '/' );
+    char * pcDirectory = NULL;
+    size_t xLength = 0;
+    int lDirectory = -1;
+
+    if( NULL == pcSeparator )
+    {
+        lDirectory = open( ".", O_RDONLY );
+    }
+    else
+    {
+        xLength = ( pcSeparator == pcFileName ) ? 1 : ( size_t ) ( pcSeparator - pcFileName );
+        pcDirectory = pvPortMalloc( xLength + 1 );
+
+        if( NULL != pcDirectory )
+        {
+            memcpy( pcDirectory, pcFileName, xLength );
+            pcDirectory[ xLength ] = '\0';
+            lDirectory = open( pcDirectory, O_RDONLY );
+            vPortFree( pcDirectory );
+        }
+    }
+
+    if( 0 <= lDirectory )
+    {
+        ( void ) fsync( lDirectory );
+        ( void ) close( lDirectory );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Writes a file to local storage.
+ *
+ * Port-specific file write for crytographic information. The data is
+ * written to a temporary file next to the file, which then replaces it.
+ *
+ * @param[in] pcFileName    The name of the file to be written to.
+ * @param[in] pucData       Data buffer to be written to file
+ * @param[in] pulDataSize   Size (in bytes) of file data.
+ *
+ * @return pdTRUE if data was saved successfully to file,
+ * pdFALSE otherwise.
+ */
+BaseType_t PKCS11_PAL_SaveFile( char * pcFileName,
+                                uint8_t * pucData,
+                                uint32_t ulDataSize )
+{
+    BaseType_t xResult = pdFALSE;
+    char * pcTempFileName = NULL;
+    size_t xNameLength = strlen( pcFileName );
+    int lFile = -1;
+
+    /* Name the temporary file. */
+    pcTempFileName = pvPortMalloc( xNameLength + sizeof( pkcs11palTEMP_FILE_SUFFIX ) );
+
+    if( NULL != pcTempFileName )
+    {
+        memcpy( pcTempFileName, pcFileName, xNameLength );
+        memcpy( &pcTempFileName[ xNameLength ], pkcs11palTEMP_FILE_SUFFIX, sizeof( pkcs11palTEMP_FILE_SUFFIX ) );
+
+        /* Write the data to it. */
+        lFile = open( pcTempFileName, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR );
+    }
+
+    if( 0 <= lFile )
+    {
+        xResult = prvWriteAll( lFile, pucData, ulDataSize );
+
+        /* The data must be on the disk before the file is renamed, or a
+         * crash could leave an empty file in place of the old one. */
+        if( ( pdTRUE == xResult ) && ( 0 != fsync( lFile ) ) )
+        {
+            xResult = pdFALSE;
+        }
+
+        if( 0 != close( lFile ) )
+        {
+            xResult = pdFALSE;
+        }
+
+        /* Replace the file. */
+        if( ( pdTRUE == xResult ) && ( 0 != rename( pcTempFileName, pcFileName ) ) )
+        {
+            xResult = pdFALSE;
+        }
+
+        if( pdTRUE == xResult )
+        {
+            prvSyncDirectory( pcFileName );
+        }
+        else
+        {
+            ( void ) unlink( pcTempFileName );
+        }
+    }
+
+    if( NULL != pcTempFileName )
+    {
+        vPortFree( pcTempFileName );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Reads a file from local storage.
+ *
+ * Port-specific file access for crytographic information. The file is
+ * mapped into memory read-only, and stays mapped until
+ * PKCS11_PAL_ReleaseFileData is called. As files are replaced rather than
+ * written in place, the data does not change while it is mapped.
+ *
+ * @sa PKCS11_ReleaseFileData
+ *
+ * @param[in] pcFileName    The name of the file to be read.
+ * @param[out] ppucData     Pointer to buffer for file data.
+ * @param[out] pulDataSize  Size (in bytes) of data located in file.
+ *
+ * @return pdTRUE if data was retrieved successfully from files,
+ * pdFALSE otherwise.
+ */
+BaseType_t PKCS11_PAL_ReadFile( char * pcFileName,
+                                uint8_t ** ppucData,
+                                uint32_t * pulDataSize )
+{
+    BaseType_t xResult = pdFALSE;
+    int lFile = -1;
+    struct stat xStat;
+    void * pvData = MAP_FAILED;
+
+    *ppucData = NULL;
+
+    /* Open the file. */
+    lFile = open( pcFileName, O_RDONLY );
+
+    if( 0 <= lFile )
+    {
+        /* Map the file. An empty file is the same as no file. */
+        if( ( 0 == fstat( lFile, &xStat ) ) &&
+            ( 0 < xStat.st_size ) &&
+            ( ( uint64_t ) xStat.st_size <= UINT32_MAX ) )
+        {
+            pvData = mmap( NULL, ( size_t ) xStat.st_size, PROT_READ, MAP_PRIVATE, lFile, 0 );
+        }
+
+        if( MAP_FAILED != pvData )
+        {
+            *ppucData = ( uint8_t * ) pvData;
+            *pulDataSize = ( uint32_t ) xStat.st_size;
+            xResult = pdTRUE;
+        }
+
+        /* The mapping stays valid after the file is closed. */
+        ( void ) close( lFile );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Cleanup after PKCS11_ReadFile().
+ *
+ * @param[in] pucBuffer The buffer to unmap.
+ * @param[in] ulBufferSize The length of the above buffer.
+ */
+void PKCS11_PAL_ReleaseFileData( uint8_t * pucBuffer,
+                                 uint32_t ulBufferSize )
+{
+    ( void ) munmap( pucBuffer, ( size_t ) ulBufferSize );
+}
@@ -107,6 +107,13 @@
 #error "MBEDTLS_ECDSA_DETERMINISTIC defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_ECP_FIXED_POINT_TABLES) &&                             \
+    ( ( defined(MBEDTLS_ECP_FIXED_POINT_OPTIM) &&                           \
+        MBEDTLS_ECP_FIXED_POINT_OPTIM != 1 ) ||                             \
+      ( defined(MBEDTLS_ECP_WINDOW_SIZE) && MBEDTLS_ECP_WINDOW_SIZE < 5 ) )
+#error "MBEDTLS_ECP_FIXED_POINT_TABLES defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_ECP_C) && ( !defined(MBEDTLS_BIGNUM_C) || (   \
     !defined(MBEDTLS_ECP_DP_SECP192R1_ENABLED) &&                  \
     !defined(MBEDTLS_ECP_DP_SECP224R1_ENABLED) &&                  \
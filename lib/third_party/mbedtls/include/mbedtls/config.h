@@ -622,6 +622,24 @@
  */
 #define MBEDTLS_ECP_NIST_OPTIM
 
+/**
+ * \def MBEDTLS_ECP_FIXED_POINT_TABLES
+ *
+ * Use comb tables of the generator that are computed at build time.
+ *
+ * Without this option, the table used to multiply the generator is computed
+ * the first time a group is used and freed with the group, so every newly
+ * parsed key pays for it again. With it, the groups of the curves that have
+ * such a table (currently secp256r1) use it from the start and never
+ * allocate one. The table of secp256r1 takes about 1.5 KiB on 32-bit platforms.
+ *
+ * Requires: MBEDTLS_ECP_FIXED_POINT_OPTIM == 1, MBEDTLS_ECP_WINDOW_SIZE >= 5
+ *
+ * Uncomment this macro to use the precomputed tables. See
+ * MBEDTLS_ECP_FIXED_POINT_TABLES_QUALIFIER for where they are stored.
+ */
+//#define MBEDTLS_ECP_FIXED_POINT_TABLES
+
 /**
  * \def MBEDTLS_ECDSA_DETERMINISTIC
  *
@@ -1414,7 +1432,7 @@
  *
  * Comment this macro to disable support for SSL session tickets
  */
-//#define MBEDTLS_SSL_SESSION_TICKETS
+#define MBEDTLS_SSL_SESSION_TICKETS
 
 /**
  * \def MBEDTLS_SSL_EXPORT_KEYS
@@ -1847,7 +1865,7 @@
  * This module enables the AES-CCM ciphersuites, if other requisites are
  * enabled as well.
  */
-//#define MBEDTLS_CCM_C
+#define MBEDTLS_CCM_C
 
 /**
  * \def MBEDTLS_CERTS_C
@@ -2754,6 +2772,7 @@
 //#define MBEDTLS_ECP_MAX_BITS             521 /**< Maximum bit size of groups */
 //#define MBEDTLS_ECP_WINDOW_SIZE            6 /**< Maximum window size used */
 //#define MBEDTLS_ECP_FIXED_POINT_OPTIM      1 /**< Enable fixed-point speed-up */
+//#define MBEDTLS_ECP_FIXED_POINT_TABLES_QUALIFIER const /**< const keeps the precomputed tables in flash, empty copies them to RAM */
 
 /* Entropy options */
 //#define MBEDTLS_ENTROPY_MAX_SOURCES                20 /**< Maximum number of sources supported */
@@ -2799,6 +2818,8 @@
 
 /* SSL options */
 #define MBEDTLS_SSL_MAX_CONTENT_LEN             8192 /**< Maxium fragment length in bytes, determines the size of each of the two internal I/O buffers */
+//#define MBEDTLS_SSL_IN_CONTENT_LEN              8192 /**< Maximum incoming fragment length in bytes, determines the size of the input buffer (default: MBEDTLS_SSL_MAX_CONTENT_LEN) */
+//#define MBEDTLS_SSL_OUT_CONTENT_LEN             8192 /**< Maximum outgoing fragment length in bytes, determines the size of the output buffer (default: MBEDTLS_SSL_MAX_CONTENT_LEN) */
 //#define MBEDTLS_SSL_DEFAULT_TICKET_LIFETIME     86400 /**< Lifetime of session tickets (if enabled) */
 //#define MBEDTLS_PSK_MAX_LEN               32 /**< Max size of TLS pre-shared keys, in bytes (default 256 bits) */
 //#define MBEDTLS_SSL_COOKIE_TIMEOUT        60 /**< Default expiration delay of DTLS cookies, in seconds if HAVE_TIME, or in number of cookies issued */
@@ -154,7 +154,7 @@ typedef struct
     int (*t_post)(mbedtls_ecp_point *, void *); /*!< unused                         */
     void *t_data;                       /*!< unused                         */
     mbedtls_ecp_point *T;       /*!<  pre-computed points for ecp_mul_comb()        */
-    size_t T_size;      /*!<  number for pre-computed points                */
+    size_t T_size;      /*!<  number for pre-computed points, 0 if T is static */
 }
 mbedtls_ecp_group;
 
@@ -230,6 +230,17 @@ mbedtls_ecp_keypair;
 #define MBEDTLS_ECP_FIXED_POINT_OPTIM  1   /**< Enable fixed-point speed-up */
 #endif /* MBEDTLS_ECP_FIXED_POINT_OPTIM */
 
+#if !defined(MBEDTLS_ECP_FIXED_POINT_TABLES_QUALIFIER)
+/*
+ * Qualifier of the tables used with MBEDTLS_ECP_FIXED_POINT_TABLES.
+ *
+ * With the default, const, the tables stay in flash. Define it to nothing
+ * to have them copied to RAM at start-up instead, which is faster on parts
+ * where flash has wait states.
+ */
+#define MBEDTLS_ECP_FIXED_POINT_TABLES_QUALIFIER const /**< Qualifier of the precomputed tables */
+#endif /* MBEDTLS_ECP_FIXED_POINT_TABLES_QUALIFIER */
+
 /* \} name SECTION: Module settings */
 
 /*
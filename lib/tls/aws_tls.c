@@ -30,8 +30,10 @@
 #include "aws_crypto.h"
 #include "aws_pkcs11.h"
 #include "task.h"
+#include "semphr.h"
 #include "aws_clientcredential.h"
 #include "aws_default_root_certificates.h"
+#include "aws_tls_config_defaults.h"
 
 /* mbedTLS includes. */
 #include "mbedtls/platform.h"
@@ -40,16 +42,63 @@
 #include "mbedtls/entropy.h"
 #include "mbedtls/sha256.h"
 #include "mbedtls/pk.h"
+#include "mbedtls/pk_internal.h"
+#include "mbedtls/ssl_internal.h"
 #include "mbedtls/debug.h"
+#include "mbedtls/version.h"
 #ifdef MBEDTLS_DEBUG_C
     #define tlsDEBUG_VERBOSE    4
 #endif
 
 /* C runtime includes. */
+#include <stddef.h>
 #include <string.h>
 #include <time.h>
 #include <stdio.h>
 
+/**
+ * @brief Credentials shared by all TLS contexts.
+ *
+ * The default root certificates and the client certificate chain are parsed
+ * once, and the client private key is used through a single PKCS#11
+ * session. The structure is not modified after it is created, except for the
+ * reference count. The PKCS#11 session is only used with xP11Mutex held.
+ *
+ * @param[out] uxReferenceCount Number of TLS contexts using the credentials,
+ * plus one while they are the current credentials.
+ * @param[out] mbedX509CA Default root certificates for mbedTLS.
+ * @param[out] mbedX509Cli Client certificate chain for mbedTLS.
+ * @param[out] mbedPkCtx Client private key context for mbedTLS.
+ * @param[out] mbedPkInfo Copy of the PKCS#11 key functions, with the signing
+ * function replaced by one that holds xP11Mutex.
+ * @param[out] pxP11PkInfo Key functions of the PKCS#11 key context.
+ * @param[out] pvP11PkCtx PKCS#11 key context.
+ * @param[out] xP11Mutex Serializes the use of the PKCS#11 session.
+ * @param[out] pxP11FunctionList PKCS#11 function list structure.
+ * @param[out] xP11Session PKCS#11 session context.
+ * @param[out] xP11PrivateKey PKCS#11 private key context.
+ * @param[out] ulP11ModulusBytes Number of bytes in the client private key modulus.
+ */
+typedef struct TLSCredentials
+{
+    UBaseType_t uxReferenceCount;
+
+    /* mbedTLS. */
+    mbedtls_x509_crt mbedX509CA;
+    mbedtls_x509_crt mbedX509Cli;
+    mbedtls_pk_context mbedPkCtx;
+    mbedtls_pk_info_t mbedPkInfo;
+    const mbedtls_pk_info_t * pxP11PkInfo;
+    void * pvP11PkCtx;
+
+    /* PKCS#11. */
+    SemaphoreHandle_t xP11Mutex;
+    CK_FUNCTION_LIST_PTR pxP11FunctionList;
+    CK_SESSION_HANDLE xP11Session;
+    CK_OBJECT_HANDLE xP11PrivateKey;
+    CK_ULONG ulP11ModulusBytes;
+} TLSCredentials_t;
+
 /**
  * @brief Internal context structure.
  *
@@ -59,15 +108,19 @@
  * @param[in] pxNetworkRecv Callback for receiving data on an open TCP socket.
  * @param[in] pxNetworkSend Callback for sending data on an open TCP socket.
  * @param[in] pvCallerContext Opaque pointer provided by caller for above callbacks.
+ * @param[in] ulMaxFragmentLength Largest record the server is asked to send, or
+ * zero.
+ * @param[in] ulCipherSuitePolicy Cipher suites offered to the server.
+ * @param[out] xHandshakeStarted Set once TLS_ConnectStep has started the
+ * handshake.
+ * @param[out] xNonBlocking Set while TLS_ConnectStep runs the handshake. A
+ * network callback that returns zero then means that it would block.
  * @param[out] mbedSslCtx Connection context for mbedTLS.
  * @param[out] mbedSslConfig Configuration context for mbedTLS.
- * @param[out] mbedX509CA Server certificate context for mbedTLS.
- * @param[out] mbedX509Cli Client certificate context for mbedTLS.
- * @param[out] mbedPkAltCtx RSA crypto implementation context for mbedTLS.
- * @param[out] pxP11FunctionList PKCS#11 function list structure.
- * @param[out] xP11Session PKCS#11 session context.
- * @param[out] xP11PrivateKey PKCS#11 private key context.
- * @param[out] ulP11ModulusBytes Number of bytes in the client private key modulus.
+ * @param[out] mbedX509CA Server certificate context for mbedTLS, only used
+ * when pcServerCertificate overrides the default root certificates.
+ * @param[out] pxCredentials Shared credentials used by this context.
+ * @param[out] xSessionOffered Set if a cached session was offered to the server.
  */
 typedef struct TLSContext
 {
@@ -80,21 +133,30 @@ typedef struct TLSContext
     NetworkRecv_t pxNetworkRecv;
     NetworkSend_t pxNetworkSend;
     void * pvCallerContext;
+    uint32_t ulMaxFragmentLength;
+    uint32_t ulCipherSuitePolicy;
+    BaseType_t xHandshakeStarted;
+    BaseType_t xNonBlocking;
 
     /* mbedTLS. */
     mbedtls_ssl_context mbedSslCtx;
     mbedtls_ssl_config mbedSslConfig;
     mbedtls_x509_crt mbedX509CA;
-    mbedtls_x509_crt mbedX509Cli;
-    mbedtls_pk_context mbedPkCtx;
 
-    /* PKCS#11. */
-    CK_FUNCTION_LIST_PTR pxP11FunctionList;
-    CK_SESSION_HANDLE xP11Session;
-    CK_OBJECT_HANDLE xP11PrivateKey;
-    CK_ULONG ulP11ModulusBytes;
+    /* Credentials. */
+    TLSCredentials_t * pxCredentials;
+
+    #if ( tlsconfigENABLE_SESSION_RESUMPTION == 1 )
+        BaseType_t xSessionOffered;
+    #endif
 } TLSContext_t;
 
+/**
+ * @brief The credentials used by the next TLS_Connect, or NULL if they have
+ * not been loaded yet.
+ */
+static TLSCredentials_t * pxCurrentCredentials = NULL;
+
 /*
  * Helper routines.
  */
@@ -106,15 +168,22 @@ typedef struct TLSContext
  * @param[in] pucData Byte buffer to send.
  * @param[in] xDataLength Length of byte buffer to send.
  *
- * @return Number of bytes sent, or a negative value on error.
+ * @return Number of bytes sent, or a negative value on error. Zero becomes
+ * MBEDTLS_ERR_SSL_WANT_WRITE while the handshake is run by TLS_ConnectStep.
  */
 static int prvNetworkSend( void * pvContext,
                            const unsigned char * pucData,
                            size_t xDataLength )
 {
     TLSContext_t * pCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+    int lResult = ( int ) pCtx->pxNetworkSend( pCtx->pvCallerContext, pucData, xDataLength );
+
+    if( ( 0 == lResult ) && ( pdTRUE == pCtx->xNonBlocking ) )
+    {
+        lResult = MBEDTLS_ERR_SSL_WANT_WRITE;
+    }
 
-    return ( int ) pCtx->pxNetworkSend( pCtx->pvCallerContext, pucData, xDataLength );
+    return lResult;
 }
 
 /**
@@ -124,15 +193,23 @@ static int prvNetworkSend( void * pvContext,
  * @param[out] pucReceiveBuffer Byte buffer to receive into.
  * @param[in] xReceiveLength Length of byte buffer for receive.
  *
- * @return Number of bytes received, or a negative value on error.
+ * @return Number of bytes received, or a negative value on error. Zero
+ * becomes MBEDTLS_ERR_SSL_WANT_READ while the handshake is run by
+ * TLS_ConnectStep.
  */
 static int prvNetworkRecv( void * pvContext,
                            unsigned char * pucReceiveBuffer,
                            size_t xReceiveLength )
 {
     TLSContext_t * pCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+    int lResult = ( int ) pCtx->pxNetworkRecv( pCtx->pvCallerContext, pucReceiveBuffer, xReceiveLength );
 
-    return ( int ) pCtx->pxNetworkRecv( pCtx->pvCallerContext, pucReceiveBuffer, xReceiveLength );
+    if( ( 0 == lResult ) && ( pdTRUE == pCtx->xNonBlocking ) )
+    {
+        lResult = MBEDTLS_ERR_SSL_WANT_READ;
+    }
+
+    return lResult;
 }
 
 /**
@@ -149,8 +226,16 @@ static int prvGenerateRandomBytes( void * pvCtx,
                                    size_t xRandomLength )
 {
     TLSContext_t * pCtx = ( TLSContext_t * ) pvCtx; /*lint !e9087 !e9079 Allow casting void* to other types. */
+    TLSCredentials_t * pxCredentials = pCtx->pxCredentials;
+    int lResult = 0;
+
+    ( void ) xSemaphoreTake( pxCredentials->xP11Mutex, portMAX_DELAY );
+    lResult = ( int ) pxCredentials->pxP11FunctionList->C_GenerateRandom( pxCredentials->xP11Session,
+                                                                           pucRandom,
+                                                                           xRandomLength );
+    ( void ) xSemaphoreGive( pxCredentials->xP11Mutex );
 
-    return ( int ) pCtx->pxP11FunctionList->C_GenerateRandom( pCtx->xP11Session, pucRandom, xRandomLength );
+    return lResult;
 }
 
 /**
@@ -219,15 +304,51 @@ static int prvCheckCertificate( void * pvCtx,
     return 0;
 }
 
+/**
+ * @brief Signing callback that serializes the use of the shared PKCS#11
+ * session.
+ *
+ * @note The PKCS#11 signing function draws its random numbers from the
+ * session, so f_rng (which would take the mutex again) is not called while
+ * the mutex is held.
+ *
+ * @return Zero on success.
+ */
+static int prvSharedKeySigningCallback( void * pvContext,
+                                        mbedtls_md_type_t xMdAlg,
+                                        const unsigned char * pucHash,
+                                        size_t xHashLen,
+                                        unsigned char * pucSig,
+                                        size_t * pxSigLen,
+                                        int ( * piRng )( void *, unsigned char *, size_t ),
+                                        void * pvRng )
+{
+    TLSCredentials_t * pxCredentials = ( TLSCredentials_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+    int lResult = 0;
+
+    ( void ) xSemaphoreTake( pxCredentials->xP11Mutex, portMAX_DELAY );
+    lResult = pxCredentials->pxP11PkInfo->sign_func( pxCredentials->pvP11PkCtx,
+                                                     xMdAlg,
+                                                     pucHash,
+                                                     xHashLen,
+                                                     pucSig,
+                                                     pxSigLen,
+                                                     piRng,
+                                                     pvRng );
+    ( void ) xSemaphoreGive( pxCredentials->xP11Mutex );
+
+    return lResult;
+}
+
 /**
  * @brief Helper for setting up potentially hardware-based cryptographic context
  * for the client TLS certificate and private key.
  *
- * @param Caller context.
+ * @param[in] pxCredentials Credentials being created.
  *
  * @return Zero on success.
  */
-static int prvInitializeClientCredential( TLSContext_t * pCtx )
+static int prvInitializeClientCredential( TLSCredentials_t * pxCredentials )
 {
     BaseType_t xResult = 0;
     CK_C_GetFunctionList pxCkGetFunctionList = NULL;
@@ -238,35 +359,32 @@ static int prvInitializeClientCredential( TLSContext_t * pCtx )
     CK_OBJECT_HANDLE xCertObj = 0;
     CK_BYTE * pucCertificate = NULL;
 
-    /* Initialize the mbed contexts. */
-    mbedtls_x509_crt_init( &pCtx->mbedX509Cli );
-
     /* Ensure that the PKCS#11 module is initialized. */
     if( 0 == xResult )
     {
         pxCkGetFunctionList = C_GetFunctionList;
-        xResult = ( BaseType_t ) pxCkGetFunctionList( &pCtx->pxP11FunctionList );
+        xResult = ( BaseType_t ) pxCkGetFunctionList( &pxCredentials->pxP11FunctionList );
     }
 
     if( 0 == xResult )
     {
-        xResult = ( BaseType_t ) pCtx->pxP11FunctionList->C_Initialize( NULL );
+        xResult = ( BaseType_t ) pxCredentials->pxP11FunctionList->C_Initialize( NULL );
     }
 
     /* Get the default private key storage ID. */
     if( 0 == xResult )
     {
-        xResult = ( BaseType_t ) pCtx->pxP11FunctionList->C_GetSlotList( CK_TRUE, &xSlotId, &ulCount );
+        xResult = ( BaseType_t ) pxCredentials->pxP11FunctionList->C_GetSlotList( CK_TRUE, &xSlotId, &ulCount );
     }
 
     /* Start a private session with the P#11 module. */
     if( 0 == xResult )
     {
-        xResult = ( BaseType_t ) pCtx->pxP11FunctionList->C_OpenSession( xSlotId,
+        xResult = ( BaseType_t ) pxCredentials->pxP11FunctionList->C_OpenSession( xSlotId,
                                                                          CKF_SERIAL_SESSION,
                                                                          NULL,
                                                                          NULL,
-                                                                         &pCtx->xP11Session );
+                                                                         &pxCredentials->xP11Session );
     }
 
     /* Enumerate the first private key. */
@@ -276,59 +394,59 @@ static int prvInitializeClientCredential( TLSContext_t * pCtx )
         xTemplate.ulValueLen = sizeof( CKA_CLASS );
         xTemplate.pValue = &xObjClass;
         xObjClass = CKO_PRIVATE_KEY;
-        xResult = ( BaseType_t ) pCtx->pxP11FunctionList->C_FindObjectsInit( pCtx->xP11Session, &xTemplate, 1 );
+        xResult = ( BaseType_t ) pxCredentials->pxP11FunctionList->C_FindObjectsInit( pxCredentials->xP11Session, &xTemplate, 1 );
     }
 
     if( 0 == xResult )
     {
-        xResult = ( BaseType_t ) pCtx->pxP11FunctionList->C_FindObjects( pCtx->xP11Session, &pCtx->xP11PrivateKey, 1, &ulCount );
+        xResult = ( BaseType_t ) pxCredentials->pxP11FunctionList->C_FindObjects( pxCredentials->xP11Session, &pxCredentials->xP11PrivateKey, 1, &ulCount );
     }
 
     if( 0 == xResult )
     {
-        xResult = ( BaseType_t ) pCtx->pxP11FunctionList->C_FindObjectsFinal( pCtx->xP11Session );
+        xResult = ( BaseType_t ) pxCredentials->pxP11FunctionList->C_FindObjectsFinal( pxCredentials->xP11Session );
     }
 
     /* Get the internal key context. */
     if( 0 == xResult )
     {
         xTemplate.type = CKA_VENDOR_DEFINED;
-        xTemplate.ulValueLen = sizeof( pCtx->mbedPkCtx );
-        xTemplate.pValue = &pCtx->mbedPkCtx;
-        xResult = ( BaseType_t ) pCtx->pxP11FunctionList->C_GetAttributeValue(
-            pCtx->xP11Session, pCtx->xP11PrivateKey, &xTemplate, 1 );
+        xTemplate.ulValueLen = sizeof( pxCredentials->mbedPkCtx );
+        xTemplate.pValue = &pxCredentials->mbedPkCtx;
+        xResult = ( BaseType_t ) pxCredentials->pxP11FunctionList->C_GetAttributeValue(
+            pxCredentials->xP11Session, pxCredentials->xP11PrivateKey, &xTemplate, 1 );
     }
 
     /* Get the key size. */
     if( 0 == xResult )
     {
         xTemplate.type = CKA_MODULUS_BITS;
-        xTemplate.ulValueLen = sizeof( pCtx->ulP11ModulusBytes );
-        xTemplate.pValue = &pCtx->ulP11ModulusBytes;
-        xResult = ( BaseType_t ) pCtx->pxP11FunctionList->C_GetAttributeValue(
-            pCtx->xP11Session, pCtx->xP11PrivateKey, &xTemplate, 1 );
+        xTemplate.ulValueLen = sizeof( pxCredentials->ulP11ModulusBytes );
+        xTemplate.pValue = &pxCredentials->ulP11ModulusBytes;
+        xResult = ( BaseType_t ) pxCredentials->pxP11FunctionList->C_GetAttributeValue(
+            pxCredentials->xP11Session, pxCredentials->xP11PrivateKey, &xTemplate, 1 );
     }
 
     if( 0 == xResult )
     {
-        pCtx->ulP11ModulusBytes /= 8;
+        pxCredentials->ulP11ModulusBytes /= 8;
 
         /* Enumerate the first client certificate. */
         xTemplate.type = CKA_CLASS;
         xTemplate.ulValueLen = sizeof( CKA_CLASS );
         xTemplate.pValue = &xObjClass;
         xObjClass = CKO_CERTIFICATE;
-        xResult = ( BaseType_t ) pCtx->pxP11FunctionList->C_FindObjectsInit( pCtx->xP11Session, &xTemplate, 1 );
+        xResult = ( BaseType_t ) pxCredentials->pxP11FunctionList->C_FindObjectsInit( pxCredentials->xP11Session, &xTemplate, 1 );
     }
 
     if( 0 == xResult )
     {
-        xResult = ( BaseType_t ) pCtx->pxP11FunctionList->C_FindObjects( pCtx->xP11Session, &xCertObj, 1, &ulCount );
+        xResult = ( BaseType_t ) pxCredentials->pxP11FunctionList->C_FindObjects( pxCredentials->xP11Session, &xCertObj, 1, &ulCount );
     }
 
     if( 0 == xResult )
     {
-        xResult = ( BaseType_t ) pCtx->pxP11FunctionList->C_FindObjectsFinal( pCtx->xP11Session );
+        xResult = ( BaseType_t ) pxCredentials->pxP11FunctionList->C_FindObjectsFinal( pxCredentials->xP11Session );
     }
 
     if( 0 == xResult )
@@ -337,7 +455,7 @@ static int prvInitializeClientCredential( TLSContext_t * pCtx )
         xTemplate.type = CKA_VALUE;
         xTemplate.ulValueLen = 0;
         xTemplate.pValue = NULL;
-        xResult = ( BaseType_t ) pCtx->pxP11FunctionList->C_GetAttributeValue( pCtx->xP11Session, xCertObj, &xTemplate, 1 );
+        xResult = ( BaseType_t ) pxCredentials->pxP11FunctionList->C_GetAttributeValue( pxCredentials->xP11Session, xCertObj, &xTemplate, 1 );
     }
 
     if( 0 == xResult )
@@ -355,14 +473,14 @@ static int prvInitializeClientCredential( TLSContext_t * pCtx )
     {
         /* Export the certificate. */
         xTemplate.pValue = pucCertificate;
-        xResult = ( BaseType_t ) pCtx->pxP11FunctionList->C_GetAttributeValue(
-            pCtx->xP11Session, xCertObj, &xTemplate, 1 );
+        xResult = ( BaseType_t ) pxCredentials->pxP11FunctionList->C_GetAttributeValue(
+            pxCredentials->xP11Session, xCertObj, &xTemplate, 1 );
     }
 
     /* Decode the client certificate. */
     if( 0 == xResult )
     {
-        xResult = mbedtls_x509_crt_parse( &pCtx->mbedX509Cli,
+        xResult = mbedtls_x509_crt_parse( &pxCredentials->mbedX509Cli,
                                           ( const unsigned char * ) pucCertificate,
                                           xTemplate.ulValueLen );
     }
@@ -376,18 +494,23 @@ static int prvInitializeClientCredential( TLSContext_t * pCtx )
         /* Decode the JITR issuer. The device client certificate will get
          * inserted as the first certificate in this chain below. */
         xResult = mbedtls_x509_crt_parse(
-            &pCtx->mbedX509Cli,
+            &pxCredentials->mbedX509Cli,
             ( const unsigned char * ) clientcredentialJITR_DEVICE_CERTIFICATE_AUTHORITY_PEM,
             1 + strlen( clientcredentialJITR_DEVICE_CERTIFICATE_AUTHORITY_PEM ) );
     }
 
     /*
-     * Attach the client certificate and private key to the TLS configuration.
+     * Route the private key operations of all TLS contexts through the
+     * mutex of the shared session.
      */
     if( 0 == xResult )
     {
-        xResult = mbedtls_ssl_conf_own_cert(
-            &pCtx->mbedSslConfig, &pCtx->mbedX509Cli, &pCtx->mbedPkCtx );
+        pxCredentials->pxP11PkInfo = pxCredentials->mbedPkCtx.pk_info;
+        pxCredentials->pvP11PkCtx = pxCredentials->mbedPkCtx.pk_ctx;
+        memcpy( &pxCredentials->mbedPkInfo, pxCredentials->pxP11PkInfo, sizeof( pxCredentials->mbedPkInfo ) );
+        pxCredentials->mbedPkInfo.sign_func = prvSharedKeySigningCallback;
+        pxCredentials->mbedPkCtx.pk_info = &pxCredentials->mbedPkInfo;
+        pxCredentials->mbedPkCtx.pk_ctx = pxCredentials;
     }
 
     if( NULL != pucCertificate )
@@ -398,241 +521,1150 @@ static int prvInitializeClientCredential( TLSContext_t * pCtx )
     return xResult;
 }
 
-/*
- * Interface routines.
+/**
+ * @brief Frees credentials that are no longer used by any TLS context.
+ *
+ * @param[in] pxCredentials Credentials to free.
  */
-
-BaseType_t TLS_Init( void ** ppvContext,
-                     TLSParams_t * pxParams )
+static void prvFreeCredentials( TLSCredentials_t * pxCredentials )
 {
-    BaseType_t xResult = 0;
-    TLSContext_t * pCtx = NULL;
-
-    /* Allocate an internal context. */
-    pCtx = ( TLSContext_t * ) pvPortMalloc( sizeof( TLSContext_t ) ); /*lint !e9087 !e9079 Allow casting void* to other types. */
-
-    if( NULL != pCtx )
-    {
-        memset( pCtx, 0, sizeof( TLSContext_t ) );
-        *ppvContext = pCtx;
+    /* The private key context is owned by the PKCS#11 session, so it is not
+     * freed with mbedtls_pk_free. */
+    mbedtls_x509_crt_free( &pxCredentials->mbedX509CA );
+    mbedtls_x509_crt_free( &pxCredentials->mbedX509Cli );
 
-        /* Initialize the context. */
-        pCtx->pcDestination = pxParams->pcDestination;
-        pCtx->pcServerCertificate = pxParams->pcServerCertificate;
-        pCtx->ulServerCertificateLength = pxParams->ulServerCertificateLength;
-        pCtx->ppcAlpnProtocols = pxParams->ppcAlpnProtocols;
-        pCtx->ulAlpnProtocolsCount = pxParams->ulAlpnProtocolsCount;
-        pCtx->pxNetworkRecv = pxParams->pxNetworkRecv;
-        pCtx->pxNetworkSend = pxParams->pxNetworkSend;
-        pCtx->pvCallerContext = pxParams->pvCallerContext;
-    }
-    else
+    if( ( NULL != pxCredentials->pxP11FunctionList ) &&
+        ( NULL != pxCredentials->pxP11FunctionList->C_CloseSession ) )
     {
-        xResult = ( BaseType_t ) CKR_HOST_MEMORY;
+        pxCredentials->pxP11FunctionList->C_CloseSession( pxCredentials->xP11Session ); /*lint !e534 This function always return CKR_OK. */
+        pxCredentials->pxP11FunctionList->C_Finalize( NULL );                           /*lint !e534 This function always return CKR_OK. */
     }
 
-    return xResult;
-}
-
-/*-----------------------------------------------------------*/
-
-#ifdef MBEDTLS_DEBUG_C
-    static void prvTlsDebugPrint( void * ctx,
-                                  int level,
-                                  const char * file,
-                                  int line,
-                                  const char * str )
+    if( NULL != pxCredentials->xP11Mutex )
     {
-        /* Unused parameters. */
-        ( void ) ctx;
-        ( void ) file;
-        ( void ) line;
-
-        /* Send the debug string to the portable logger. */
-        vLoggingPrintf( "mbedTLS: |%d| %s", level, str );
+        vSemaphoreDelete( pxCredentials->xP11Mutex );
     }
-#endif /* ifdef MBEDTLS_DEBUG_C */
 
-/*-----------------------------------------------------------*/
+    vPortFree( pxCredentials );
+}
 
-BaseType_t TLS_Connect( void * pvContext )
+/**
+ * @brief Parses the default root certificates and the client certificate
+ * chain, and opens the PKCS#11 session of the client private key.
+ *
+ * @param[out] ppxCredentials Receives the credentials, with a reference count
+ * of one.
+ *
+ * @return Zero on success.
+ */
+static int prvCreateCredentials( TLSCredentials_t ** ppxCredentials )
 {
     BaseType_t xResult = 0;
-    TLSContext_t * pCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
-
-    /* Ensure that the FreeRTOS heap is used. */
-    CRYPTO_ConfigureHeap();
+    TLSCredentials_t * pxCredentials = NULL;
 
-    /* Initialize mbedTLS structures. */
-    mbedtls_ssl_init( &pCtx->mbedSslCtx );
-    mbedtls_ssl_config_init( &pCtx->mbedSslConfig );
-    mbedtls_x509_crt_init( &pCtx->mbedX509CA );
+    pxCredentials = ( TLSCredentials_t * ) pvPortMalloc( sizeof( TLSCredentials_t ) ); /*lint !e9087 !e9079 Allow casting void* to other types. */
 
-    /* Decode the root certificate: either the default or the override. */
-    if( NULL != pCtx->pcServerCertificate )
+    if( NULL == pxCredentials )
     {
-        xResult = mbedtls_x509_crt_parse( &pCtx->mbedX509CA,
-                                          ( const unsigned char * ) pCtx->pcServerCertificate,
-                                          pCtx->ulServerCertificateLength );
+        xResult = ( BaseType_t ) CKR_HOST_MEMORY;
     }
     else
     {
-        xResult = mbedtls_x509_crt_parse( &pCtx->mbedX509CA,
-                                          ( const unsigned char * ) tlsVERISIGN_ROOT_CERTIFICATE_PEM,
-                                          tlsVERISIGN_ROOT_CERTIFICATE_LENGTH );
+        memset( pxCredentials, 0, sizeof( TLSCredentials_t ) );
+        pxCredentials->uxReferenceCount = 1;
+        mbedtls_x509_crt_init( &pxCredentials->mbedX509CA );
+        mbedtls_x509_crt_init( &pxCredentials->mbedX509Cli );
 
-        if( 0 == xResult )
+        pxCredentials->xP11Mutex = xSemaphoreCreateMutex();
+
+        if( NULL == pxCredentials->xP11Mutex )
         {
-            xResult = mbedtls_x509_crt_parse( &pCtx->mbedX509CA,
-                                              ( const unsigned char * ) tlsATS1_ROOT_CERTIFICATE_PEM,
-                                              tlsATS1_ROOT_CERTIFICATE_LENGTH );
+            xResult = ( BaseType_t ) CKR_HOST_MEMORY;
         }
     }
 
-    /* Start with protocol defaults. */
+    /* Decode the default root certificates. */
     if( 0 == xResult )
     {
-        xResult = mbedtls_ssl_config_defaults( &pCtx->mbedSslConfig,
-                                               MBEDTLS_SSL_IS_CLIENT,
-                                               MBEDTLS_SSL_TRANSPORT_STREAM,
-                                               MBEDTLS_SSL_PRESET_DEFAULT );
+        xResult = mbedtls_x509_crt_parse( &pxCredentials->mbedX509CA,
+                                          ( const unsigned char * ) tlsVERISIGN_ROOT_CERTIFICATE_PEM,
+                                          tlsVERISIGN_ROOT_CERTIFICATE_LENGTH );
     }
 
     if( 0 == xResult )
     {
-        /* Use a callback for additional server certificate validation. */
-        mbedtls_ssl_conf_verify( &pCtx->mbedSslConfig,
-                                 &prvCheckCertificate,
-                                 pCtx );
-
-        /* Server certificate validation is mandatory. */
-        mbedtls_ssl_conf_authmode( &pCtx->mbedSslConfig, MBEDTLS_SSL_VERIFY_REQUIRED );
-
-        /* Set the RNG callback. */
-        mbedtls_ssl_conf_rng( &pCtx->mbedSslConfig, &prvGenerateRandomBytes, pCtx ); /*lint !e546 Nothing wrong here. */
-
-        /* Set issuer certificate. */
-        mbedtls_ssl_conf_ca_chain( &pCtx->mbedSslConfig, &pCtx->mbedX509CA, NULL );
-
-        /* Setup the client credential. */
-        xResult = prvInitializeClientCredential( pCtx );
+        xResult = mbedtls_x509_crt_parse( &pxCredentials->mbedX509CA,
+                                          ( const unsigned char * ) tlsATS1_ROOT_CERTIFICATE_PEM,
+                                          tlsATS1_ROOT_CERTIFICATE_LENGTH );
     }
 
-    if( ( 0 == xResult ) && ( NULL != pCtx->ppcAlpnProtocols ) )
+    /* Setup the client credential. */
+    if( 0 == xResult )
     {
-        /* Include an application protocol list in the TLS ClientHello
-         * message. */
-        xResult = mbedtls_ssl_conf_alpn_protocols(
-            &pCtx->mbedSslConfig,
-            pCtx->ppcAlpnProtocols );
+        xResult = prvInitializeClientCredential( pxCredentials );
     }
 
-    #ifdef MBEDTLS_DEBUG_C
-
-        /* If mbedTLS is being compiled with debug support, assume that the
-         * runtime configuration should use verbose output. */
-        mbedtls_ssl_conf_dbg( &pCtx->mbedSslConfig, prvTlsDebugPrint, NULL );
-        mbedtls_debug_set_threshold( tlsDEBUG_VERBOSE );
-    #endif
-
     if( 0 == xResult )
     {
-        /* Set the resulting protocol configuration. */
-        xResult = mbedtls_ssl_setup( &pCtx->mbedSslCtx, &pCtx->mbedSslConfig );
+        *ppxCredentials = pxCredentials;
     }
-
-    /* Set the hostname, if requested. */
-    if( ( 0 == xResult ) && ( NULL != pCtx->pcDestination ) )
+    else if( NULL != pxCredentials )
     {
-        xResult = mbedtls_ssl_set_hostname( &pCtx->mbedSslCtx, pCtx->pcDestination );
+        prvFreeCredentials( pxCredentials );
     }
 
-    /* Set the socket callbacks. */
-    if( 0 == xResult )
-    {
-        mbedtls_ssl_set_bio( &pCtx->mbedSslCtx,
-                             pCtx,
-                             prvNetworkSend,
-                             prvNetworkRecv,
-                             NULL );
+    return xResult;
+}
 
-        /* Negotiate. */
-        while( 0 != ( xResult = mbedtls_ssl_handshake( &pCtx->mbedSslCtx ) ) )
-        {
-            if( ( MBEDTLS_ERR_SSL_WANT_READ != xResult ) &&
-                ( MBEDTLS_ERR_SSL_WANT_WRITE != xResult ) )
-            {
-                break;
-            }
-        }
-    }
+/**
+ * @brief Drops a reference to the credentials, and frees them when it was
+ * the last one.
+ *
+ * @param[in] pxCredentials Credentials to release.
+ */
+static void prvReleaseCredentials( TLSCredentials_t * pxCredentials )
+{
+    UBaseType_t uxReferenceCount = 0;
 
-    /* Free up allocated memory. */
-    mbedtls_x509_crt_free( &pCtx->mbedX509CA );
-    mbedtls_x509_crt_free( &pCtx->mbedX509Cli );
+    vTaskSuspendAll();
+    {
+        pxCredentials->uxReferenceCount--;
+        uxReferenceCount = pxCredentials->uxReferenceCount;
+    }
+    ( void ) xTaskResumeAll();
 
-    return xResult;
+    if( 0 == uxReferenceCount )
+    {
+        prvFreeCredentials( pxCredentials );
+    }
 }
 
-/*-----------------------------------------------------------*/
-
-BaseType_t TLS_Recv( void * pvContext,
-                     unsigned char * pucReadBuffer,
-                     size_t xReadLength )
+/**
+ * @brief Takes a reference to the current credentials, loading them first
+ * if needed.
+ *
+ * @param[out] ppxCredentials Receives the credentials.
+ *
+ * @return Zero on success.
+ */
+static int prvAcquireCredentials( TLSCredentials_t ** ppxCredentials )
 {
     BaseType_t xResult = 0;
-    TLSContext_t * pCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
-    size_t xRead = 0;
+    TLSCredentials_t * pxCredentials = NULL;
+    TLSCredentials_t * pxCreated = NULL;
 
-    if( NULL != pCtx )
+    vTaskSuspendAll();
     {
-        while( xRead < xReadLength )
+        pxCredentials = pxCurrentCredentials;
+
+        if( NULL != pxCredentials )
         {
-            xResult = mbedtls_ssl_read( &pCtx->mbedSslCtx,
-                                        pucReadBuffer + xRead,
-                                        xReadLength - xRead );
+            pxCredentials->uxReferenceCount++;
+        }
+    }
+    ( void ) xTaskResumeAll();
 
-            if( 0 < xResult )
-            {
-                /* Got data, so update the tally and keep looping. */
-                xRead += ( size_t ) xResult;
-            }
-            else
+    if( NULL == pxCredentials )
+    {
+        /* Loading the credentials takes long, so it is done without the
+         * scheduler suspended. If another task loaded them meanwhile, its
+         * credentials are used, and these are freed. */
+        xResult = prvCreateCredentials( &pxCreated );
+
+        if( 0 == xResult )
+        {
+            vTaskSuspendAll();
             {
-                if( ( 0 == xResult ) || ( MBEDTLS_ERR_SSL_WANT_READ != xResult ) )
+                if( NULL == pxCurrentCredentials )
                 {
-                    /* No data and no error or call read again, if indicated, otherwise return error. */
-                    break;
+                    /* The reference taken when creating them is the one
+                     * of pxCurrentCredentials. */
+                    pxCurrentCredentials = pxCreated;
+                    pxCreated = NULL;
                 }
+
+                pxCredentials = pxCurrentCredentials;
+                pxCredentials->uxReferenceCount++;
+            }
+            ( void ) xTaskResumeAll();
+
+            if( NULL != pxCreated )
+            {
+                prvReleaseCredentials( pxCreated );
             }
         }
     }
 
-    if( 0 <= xResult )
+    if( 0 == xResult )
     {
-        xResult = ( BaseType_t ) xRead;
+        *ppxCredentials = pxCredentials;
     }
 
     return xResult;
 }
 
-/*-----------------------------------------------------------*/
+#if defined( MBEDTLS_SSL_MAX_FRAGMENT_LENGTH )
 
-BaseType_t TLS_Send( void * pvContext,
-                     const unsigned char * pucMsg,
-                     size_t xMsgLength )
+/**
+ * @brief Configures the Max Fragment Length extension of the connection.
+ *
+ * @param[in] pCtx Caller context.
+ *
+ * @return Zero on success.
+ */
+static int prvSetMaxFragmentLength( TLSContext_t * pCtx )
 {
-    BaseType_t xResult = 0;
-    TLSContext_t * pCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
-    size_t xWritten = 0;
+    int lResult = 0;
+    unsigned char ucCode = MBEDTLS_SSL_MAX_FRAG_LEN_NONE;
 
-    if( NULL != pCtx )
+    switch( pCtx->ulMaxFragmentLength )
     {
-        while( xWritten < xMsgLength )
-        {
-            xResult = mbedtls_ssl_write( &pCtx->mbedSslCtx,
-                                         pucMsg + xWritten,
-                                         xMsgLength - xWritten );
+        case 512:
+            ucCode = MBEDTLS_SSL_MAX_FRAG_LEN_512;
+            break;
+
+        case 1024:
+            ucCode = MBEDTLS_SSL_MAX_FRAG_LEN_1024;
+            break;
+
+        case 2048:
+            ucCode = MBEDTLS_SSL_MAX_FRAG_LEN_2048;
+            break;
+
+        case 4096:
+            ucCode = MBEDTLS_SSL_MAX_FRAG_LEN_4096;
+            break;
+
+        default:
+            lResult = MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+            break;
+    }
+
+    /* Fails if the length is larger than the mbedTLS buffers. */
+    if( 0 == lResult )
+    {
+        lResult = mbedtls_ssl_conf_max_frag_len( &pCtx->mbedSslConfig, ucCode );
+    }
+
+    return lResult;
+}
+
+#endif /* if defined( MBEDTLS_SSL_MAX_FRAGMENT_LENGTH ) */
+
+/**
+ * @brief Cipher suites of tlsCIPHER_SUITE_POLICY_AES_GCM.
+ */
+static const int lAesGcmCipherSuites[] =
+{
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256,
+    MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256,
+    0
+};
+
+/**
+ * @brief Cipher suites of tlsCIPHER_SUITE_POLICY_AES_CCM_8.
+ *
+ * AES-CCM with the 16-byte tag is not offered, as servers would choose it
+ * over AES-CCM-8 and its records are longer.
+ */
+static const int lAesCcm8CipherSuites[] =
+{
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_CCM_8,
+    0
+};
+
+/**
+ * @brief Cipher suites of tlsCIPHER_SUITE_POLICY_AES_CBC.
+ */
+static const int lAesCbcCipherSuites[] =
+{
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_CBC_SHA256,
+    MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_CBC_SHA256,
+    0
+};
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Configures the cipher suites offered to the server.
+ *
+ * The suites that mbedTLS was built without are not offered.
+ *
+ * @param[in] pCtx Caller context.
+ *
+ * @return Zero on success.
+ */
+static int prvSetCipherSuites( TLSContext_t * pCtx )
+{
+    int lResult = 0;
+    const int * plCipherSuites = NULL;
+
+    switch( pCtx->ulCipherSuitePolicy )
+    {
+        case tlsCIPHER_SUITE_POLICY_DEFAULT:
+            /* Keep the list set by mbedtls_ssl_config_defaults. */
+            break;
+
+        case tlsCIPHER_SUITE_POLICY_AES_GCM:
+            plCipherSuites = lAesGcmCipherSuites;
+            break;
+
+        case tlsCIPHER_SUITE_POLICY_AES_CCM_8:
+            plCipherSuites = lAesCcm8CipherSuites;
+            break;
+
+        case tlsCIPHER_SUITE_POLICY_AES_CBC:
+            plCipherSuites = lAesCbcCipherSuites;
+            break;
+
+        default:
+            lResult = MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+            break;
+    }
+
+    if( NULL != plCipherSuites )
+    {
+        mbedtls_ssl_conf_ciphersuites( &pCtx->mbedSslConfig, plCipherSuites );
+    }
+
+    return lResult;
+}
+
+#if ( tlsconfigENABLE_SESSION_RESUMPTION == 1 )
+
+/*
+ * Session cache.
+ */
+
+/**
+ * @brief A session in the session cache.
+ *
+ * @param[in] cDestination Server the session was negotiated with, empty if
+ * the entry is free.
+ * @param[in] ulLastUsed Value of ulSessionCacheClock when the session was
+ * last stored or offered to the server.
+ * @param[in] xSession The session. The server certificate chain is not kept,
+ * it is not needed to resume the session.
+ */
+typedef struct TLSSessionCacheEntry
+{
+    char cDestination[ tlsconfigSESSION_CACHE_MAX_DESTINATION_LENGTH + 1 ];
+    uint32_t ulLastUsed;
+    mbedtls_ssl_session xSession;
+} TLSSessionCacheEntry_t;
+
+/**
+ * @brief The session cache.
+ *
+ * Accessed with the scheduler suspended, as TLS contexts can be connected
+ * from different tasks.
+ */
+static TLSSessionCacheEntry_t xSessionCache[ tlsconfigSESSION_CACHE_SIZE ];
+
+/**
+ * @brief Incremented every time a session is stored or offered, to find
+ * the session used least recently.
+ */
+static uint32_t ulSessionCacheClock = 0;
+
+/**
+ * @brief Wipe a copy of a session, or a session file, which hold the master
+ * secret.
+ *
+ * The writes go through a volatile pointer so that they are not optimized
+ * away, as in mbedtls_zeroize.
+ *
+ * @param[in] pvBuffer The memory to wipe.
+ * @param[in] xLength Its size in bytes.
+ */
+static void prvZeroize( void * pvBuffer,
+                        size_t xLength )
+{
+    volatile uint8_t * pucBuffer = ( volatile uint8_t * ) pvBuffer; /*lint !e9079 Allow casting void* to other types. */
+
+    while( xLength > 0 )
+    {
+        *pucBuffer = 0;
+        pucBuffer++;
+        xLength--;
+    }
+}
+
+/**
+ * @brief Find the cached session of a server.
+ *
+ * Must be called with the scheduler suspended.
+ *
+ * @param[in] pcDestination The server.
+ *
+ * @return The cache entry, or NULL if there is no session for the server.
+ */
+static TLSSessionCacheEntry_t * prvFindSession( const char * pcDestination )
+{
+    TLSSessionCacheEntry_t * pxEntry = NULL;
+    uint32_t ulIndex = 0;
+
+    for( ulIndex = 0; ulIndex < tlsconfigSESSION_CACHE_SIZE; ulIndex++ )
+    {
+        if( ( '\0' != xSessionCache[ ulIndex ].cDestination[ 0 ] ) &&
+            ( 0 == strcmp( xSessionCache[ ulIndex ].cDestination, pcDestination ) ) )
+        {
+            pxEntry = &xSessionCache[ ulIndex ];
+            break;
+        }
+    }
+
+    return pxEntry;
+}
+
+/**
+ * @brief Store the session of a server, replacing its previous session or,
+ * if the cache is full, the session used least recently.
+ *
+ * Must be called with the scheduler suspended.
+ *
+ * @param[in] pcDestination The server. Its length has been checked.
+ * @param[in] pxSession The session. The cache takes ownership of the memory
+ * it refers to.
+ */
+static void prvStoreSession( const char * pcDestination,
+                             const mbedtls_ssl_session * pxSession )
+{
+    TLSSessionCacheEntry_t * pxEntry = prvFindSession( pcDestination );
+    uint32_t ulIndex = 0;
+
+    if( NULL == pxEntry )
+    {
+        pxEntry = &xSessionCache[ 0 ];
+
+        for( ulIndex = 0; ulIndex < tlsconfigSESSION_CACHE_SIZE; ulIndex++ )
+        {
+            if( '\0' == xSessionCache[ ulIndex ].cDestination[ 0 ] )
+            {
+                pxEntry = &xSessionCache[ ulIndex ];
+                break;
+            }
+
+            if( xSessionCache[ ulIndex ].ulLastUsed < pxEntry->ulLastUsed )
+            {
+                pxEntry = &xSessionCache[ ulIndex ];
+            }
+        }
+    }
+
+    /* Freeing a zeroed session is harmless. */
+    mbedtls_ssl_session_free( &pxEntry->xSession );
+
+    strcpy( pxEntry->cDestination, pcDestination );
+    pxEntry->ulLastUsed = ++ulSessionCacheClock;
+    memcpy( &pxEntry->xSession, pxSession, sizeof( mbedtls_ssl_session ) );
+}
+
+/**
+ * @brief Remove the cached session of a server, if any.
+ *
+ * @param[in] pcDestination The server.
+ */
+static void prvForgetSession( const char * pcDestination )
+{
+    TLSSessionCacheEntry_t * pxEntry = NULL;
+
+    vTaskSuspendAll();
+    {
+        pxEntry = prvFindSession( pcDestination );
+
+        if( NULL != pxEntry )
+        {
+            mbedtls_ssl_session_free( &pxEntry->xSession );
+            pxEntry->cDestination[ 0 ] = '\0';
+        }
+    }
+    ( void ) xTaskResumeAll();
+}
+
+    #if ( tlsconfigSESSION_CACHE_USE_PAL == 1 )
+
+/**
+ * @brief Write file to filesystem (see PAL).
+ */
+        extern BaseType_t PKCS11_PAL_SaveFile( char * pcFileName,
+                                               uint8_t * pucData,
+                                               uint32_t ulDataSize );
+
+/**
+ * @brief Read file from filesystem (see PAL).
+ */
+        extern BaseType_t PKCS11_PAL_ReadFile( char * pcFileName,
+                                               uint8_t ** ppucData,
+                                               uint32_t * pulDataSize );
+
+/**
+ * @brief Free the buffer allocated in PKCS11_PAL_ReadFile (see PAL).
+ */
+        extern void PKCS11_PAL_ReleaseFileData( uint8_t * pucBuffer,
+                                                uint32_t ulBufferSize );
+
+/**
+ * @brief Start of the session file.
+ *
+ * The header is followed by the session, with its pointers cleared, and by
+ * the session ticket. The session is only read back by the firmware that
+ * wrote it, which ulVersion and ulSessionSize check.
+ *
+ * @param[in] ulVersion Version of mbedTLS that wrote the session.
+ * @param[in] ulSessionSize Size of the session structure, zero if the file
+ * holds no session.
+ * @param[in] cDestination Server the session was negotiated with.
+ */
+        typedef struct TLSSessionFileHeader
+        {
+            uint32_t ulVersion;
+            uint32_t ulSessionSize;
+            char cDestination[ tlsconfigSESSION_CACHE_MAX_DESTINATION_LENGTH + 1 ];
+        } TLSSessionFileHeader_t;
+
+/**
+ * @brief Set once the session file has been read, so that it is read at
+ * most once after a reset.
+ */
+        static BaseType_t xSessionFileLoaded = pdFALSE;
+
+/**
+ * @brief Encode a session in the session file format.
+ *
+ * @param[in] pcDestination The server. Its length has been checked.
+ * @param[in] pxSession The session.
+ * @param[out] pulFileSize Size of the file.
+ *
+ * @return The file, to be wiped with prvZeroize and freed with vPortFree,
+ * or NULL if out of memory.
+ */
+        static uint8_t * prvEncodeSessionFile( const char * pcDestination,
+                                               const mbedtls_ssl_session * pxSession,
+                                               uint32_t * pulFileSize )
+        {
+            TLSSessionFileHeader_t * pxHeader = NULL;
+            mbedtls_ssl_session xFileSession;
+            uint8_t * pucFile = NULL;
+            size_t xTicketLength = 0;
+
+            #if defined( MBEDTLS_SSL_SESSION_TICKETS )
+                xTicketLength = pxSession->ticket_len;
+            #endif
+
+            *pulFileSize = ( uint32_t ) ( sizeof( TLSSessionFileHeader_t ) +
+                                          sizeof( mbedtls_ssl_session ) +
+                                          xTicketLength );
+            pucFile = ( uint8_t * ) pvPortMalloc( *pulFileSize ); /*lint !e9079 Allow casting void* to other types. */
+
+            if( NULL != pucFile )
+            {
+                memset( pucFile, 0, sizeof( TLSSessionFileHeader_t ) );
+                pxHeader = ( TLSSessionFileHeader_t * ) pucFile; /*lint !e9087 !e826 The buffer is large enough. */
+                pxHeader->ulVersion = MBEDTLS_VERSION_NUMBER;
+                pxHeader->ulSessionSize = sizeof( mbedtls_ssl_session );
+                strcpy( pxHeader->cDestination, pcDestination );
+
+                /* The session is not necessarily aligned in the file. */
+                memcpy( &xFileSession, pxSession, sizeof( mbedtls_ssl_session ) );
+                xFileSession.peer_cert = NULL;
+
+                #if defined( MBEDTLS_SSL_SESSION_TICKETS )
+                    xFileSession.ticket = NULL;
+                    memcpy( pucFile + sizeof( TLSSessionFileHeader_t ) + sizeof( mbedtls_ssl_session ),
+                            pxSession->ticket,
+                            xTicketLength );
+                #endif
+
+                memcpy( pucFile + sizeof( TLSSessionFileHeader_t ), &xFileSession, sizeof( mbedtls_ssl_session ) );
+                prvZeroize( &xFileSession, sizeof( mbedtls_ssl_session ) );
+            }
+
+            return pucFile;
+        }
+
+/**
+ * @brief Add the session in the session file to the cache, the first time
+ * it is called after a reset.
+ */
+        static void prvLoadSessionFile( void )
+        {
+            BaseType_t xLoad = pdFALSE;
+            uint8_t * pucFile = NULL;
+            uint32_t ulFileSize = 0;
+            const TLSSessionFileHeader_t * pxHeader = NULL;
+            mbedtls_ssl_session xSession;
+            size_t xTicketLength = 0;
+
+            vTaskSuspendAll();
+            {
+                xLoad = ( pdFALSE == xSessionFileLoaded ) ? pdTRUE : pdFALSE;
+                xSessionFileLoaded = pdTRUE;
+            }
+            ( void ) xTaskResumeAll();
+
+            if( ( pdTRUE == xLoad ) &&
+                ( pdTRUE == PKCS11_PAL_ReadFile( tlsconfigSESSION_CACHE_FILE_NAME, &pucFile, &ulFileSize ) ) )
+            {
+                pxHeader = ( const TLSSessionFileHeader_t * ) pucFile; /*lint !e9087 !e826 The size is checked below. */
+
+                /* Only accept a complete session written by this firmware. */
+                if( ( ulFileSize >= ( sizeof( TLSSessionFileHeader_t ) + sizeof( mbedtls_ssl_session ) ) ) &&
+                    ( MBEDTLS_VERSION_NUMBER == pxHeader->ulVersion ) &&
+                    ( sizeof( mbedtls_ssl_session ) == pxHeader->ulSessionSize ) &&
+                    ( '\0' != pxHeader->cDestination[ 0 ] ) &&
+                    ( '\0' == pxHeader->cDestination[ tlsconfigSESSION_CACHE_MAX_DESTINATION_LENGTH ] ) )
+                {
+                    memcpy( &xSession, pucFile + sizeof( TLSSessionFileHeader_t ), sizeof( mbedtls_ssl_session ) );
+                    xSession.peer_cert = NULL;
+                    xTicketLength = ulFileSize - sizeof( TLSSessionFileHeader_t ) - sizeof( mbedtls_ssl_session );
+
+                    #if defined( MBEDTLS_SSL_SESSION_TICKETS )
+                        xSession.ticket = NULL;
+
+                        if( ( xTicketLength == xSession.ticket_len ) && ( 0 != xTicketLength ) )
+                        {
+                            xSession.ticket = mbedtls_calloc( 1, xTicketLength );
+
+                            if( NULL != xSession.ticket )
+                            {
+                                memcpy( xSession.ticket,
+                                        pucFile + sizeof( TLSSessionFileHeader_t ) + sizeof( mbedtls_ssl_session ),
+                                        xTicketLength );
+                                xTicketLength = 0;
+                            }
+                        }
+                        else if( xTicketLength == xSession.ticket_len )
+                        {
+                            xTicketLength = 0;
+                        }
+                    #endif /* if defined( MBEDTLS_SSL_SESSION_TICKETS ) */
+
+                    /* Anything left over means that the file is not valid. */
+                    if( 0 == xTicketLength )
+                    {
+                        vTaskSuspendAll();
+                        {
+                            /* A session negotiated since the reset is newer. */
+                            if( NULL == prvFindSession( pxHeader->cDestination ) )
+                            {
+                                prvStoreSession( pxHeader->cDestination, &xSession );
+                            }
+                            else
+                            {
+                                mbedtls_ssl_session_free( &xSession );
+                            }
+                        }
+                        ( void ) xTaskResumeAll();
+                    }
+
+                    /* The cache, if it took the session, owns the ticket now,
+                     * and only the copy of the master secret is left. */
+                    prvZeroize( &xSession, sizeof( mbedtls_ssl_session ) );
+                }
+
+                PKCS11_PAL_ReleaseFileData( pucFile, ulFileSize );
+            }
+        }
+
+    #endif /* if ( tlsconfigSESSION_CACHE_USE_PAL == 1 ) */
+
+/**
+ * @brief Offer the cached session of the server, if any, in the next
+ * handshake.
+ *
+ * @param[in] pCtx Caller context.
+ *
+ * @return Zero on success.
+ */
+static int prvRestoreSession( TLSContext_t * pCtx )
+{
+    int lResult = 0;
+    TLSSessionCacheEntry_t * pxEntry = NULL;
+
+    #if ( tlsconfigSESSION_CACHE_USE_PAL == 1 )
+        prvLoadSessionFile();
+    #endif
+
+    vTaskSuspendAll();
+    {
+        pxEntry = prvFindSession( pCtx->pcDestination );
+
+        if( NULL != pxEntry )
+        {
+            pxEntry->ulLastUsed = ++ulSessionCacheClock;
+            lResult = mbedtls_ssl_set_session( &pCtx->mbedSslCtx, &pxEntry->xSession );
+            pCtx->xSessionOffered = pdTRUE;
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return lResult;
+}
+
+/**
+ * @brief Store the session negotiated in the handshake in the cache.
+ *
+ * @param[in] pCtx Caller context.
+ */
+static void prvSaveSession( TLSContext_t * pCtx )
+{
+    mbedtls_ssl_session xSession;
+    TLSSessionCacheEntry_t * pxEntry = NULL;
+    BaseType_t xNewMaster = pdTRUE;
+
+    #if ( tlsconfigSESSION_CACHE_USE_PAL == 1 )
+        uint8_t * pucFile = NULL;
+        uint32_t ulFileSize = 0;
+    #endif
+
+    mbedtls_ssl_session_init( &xSession );
+
+    if( 0 == mbedtls_ssl_get_session( &pCtx->mbedSslCtx, &xSession ) )
+    {
+        /* The server certificate chain was verified in the full handshake,
+         * and is not needed to resume the session. */
+        mbedtls_x509_crt_free( xSession.peer_cert );
+        mbedtls_free( xSession.peer_cert );
+        xSession.peer_cert = NULL;
+
+        #if ( tlsconfigSESSION_CACHE_USE_PAL == 1 )
+            pucFile = prvEncodeSessionFile( pCtx->pcDestination, &xSession, &ulFileSize );
+        #endif
+
+        vTaskSuspendAll();
+        {
+            /* A resumed session keeps its master secret. Only the ticket,
+             * if any, is renewed. */
+            pxEntry = prvFindSession( pCtx->pcDestination );
+
+            if( ( NULL != pxEntry ) &&
+                ( 0 == memcmp( pxEntry->xSession.master, xSession.master, sizeof( xSession.master ) ) ) )
+            {
+                xNewMaster = pdFALSE;
+            }
+
+            prvStoreSession( pCtx->pcDestination, &xSession );
+        }
+        ( void ) xTaskResumeAll();
+
+        #if ( tlsconfigSESSION_CACHE_USE_PAL == 1 )
+            if( NULL != pucFile )
+            {
+                if( pdTRUE == xNewMaster )
+                {
+                    ( void ) PKCS11_PAL_SaveFile( tlsconfigSESSION_CACHE_FILE_NAME, pucFile, ulFileSize );
+                }
+
+                prvZeroize( pucFile, ulFileSize );
+                vPortFree( pucFile );
+            }
+        #endif
+
+        /* The cache owns the session now. */
+        prvZeroize( &xSession, sizeof( mbedtls_ssl_session ) );
+    }
+    else
+    {
+        mbedtls_ssl_session_free( &xSession );
+    }
+
+    ( void ) xNewMaster;
+}
+
+#endif /* if ( tlsconfigENABLE_SESSION_RESUMPTION == 1 ) */
+
+/*
+ * Interface routines.
+ */
+
+BaseType_t TLS_Init( void ** ppvContext,
+                     TLSParams_t * pxParams )
+{
+    BaseType_t xResult = 0;
+    TLSContext_t * pCtx = NULL;
+
+    /* Allocate an internal context. */
+    pCtx = ( TLSContext_t * ) pvPortMalloc( sizeof( TLSContext_t ) ); /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+    if( NULL != pCtx )
+    {
+        memset( pCtx, 0, sizeof( TLSContext_t ) );
+        *ppvContext = pCtx;
+
+        /* Initialize the context. */
+        pCtx->pcDestination = pxParams->pcDestination;
+        pCtx->pcServerCertificate = pxParams->pcServerCertificate;
+        pCtx->ulServerCertificateLength = pxParams->ulServerCertificateLength;
+        pCtx->ppcAlpnProtocols = pxParams->ppcAlpnProtocols;
+        pCtx->ulAlpnProtocolsCount = pxParams->ulAlpnProtocolsCount;
+        pCtx->pxNetworkRecv = pxParams->pxNetworkRecv;
+        pCtx->pxNetworkSend = pxParams->pxNetworkSend;
+        pCtx->pvCallerContext = pxParams->pvCallerContext;
+
+        /* Only read the fields that the structure of the caller has. */
+        if( ( pxParams->ulSize >= ( offsetof( TLSParams_t, ulMaxFragmentLength ) + sizeof( uint32_t ) ) ) &&
+            ( 0 != pxParams->ulMaxFragmentLength ) )
+        {
+            pCtx->ulMaxFragmentLength = pxParams->ulMaxFragmentLength;
+        }
+        else
+        {
+            pCtx->ulMaxFragmentLength = tlsconfigMAX_FRAGMENT_LENGTH;
+        }
+
+        if( ( pxParams->ulSize >= ( offsetof( TLSParams_t, ulCipherSuitePolicy ) + sizeof( uint32_t ) ) ) &&
+            ( 0 != pxParams->ulCipherSuitePolicy ) )
+        {
+            pCtx->ulCipherSuitePolicy = pxParams->ulCipherSuitePolicy;
+        }
+        else
+        {
+            pCtx->ulCipherSuitePolicy = tlsconfigCIPHER_SUITE_POLICY;
+        }
+    }
+    else
+    {
+        xResult = ( BaseType_t ) CKR_HOST_MEMORY;
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+#ifdef MBEDTLS_DEBUG_C
+    static void prvTlsDebugPrint( void * ctx,
+                                  int level,
+                                  const char * file,
+                                  int line,
+                                  const char * str )
+    {
+        /* Unused parameters. */
+        ( void ) ctx;
+        ( void ) file;
+        ( void ) line;
+
+        /* Send the debug string to the portable logger. */
+        vLoggingPrintf( "mbedTLS: |%d| %s", level, str );
+    }
+#endif /* ifdef MBEDTLS_DEBUG_C */
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Configures the connection for its handshake.
+ *
+ * @param[in] pCtx Caller context.
+ *
+ * @return Zero on success.
+ */
+static BaseType_t prvStartHandshake( TLSContext_t * pCtx )
+{
+    BaseType_t xResult = 0;
+
+    /* Ensure that the FreeRTOS heap is used. */
+    CRYPTO_ConfigureHeap();
+
+    /* Initialize mbedTLS structures. */
+    mbedtls_ssl_init( &pCtx->mbedSslCtx );
+    mbedtls_ssl_config_init( &pCtx->mbedSslConfig );
+    mbedtls_x509_crt_init( &pCtx->mbedX509CA );
+
+    /* Get the credentials shared with the other TLS contexts. */
+    xResult = prvAcquireCredentials( &pCtx->pxCredentials );
+
+    /* Decode the override root certificate. The default ones are shared. */
+    if( ( 0 == xResult ) && ( NULL != pCtx->pcServerCertificate ) )
+    {
+        xResult = mbedtls_x509_crt_parse( &pCtx->mbedX509CA,
+                                          ( const unsigned char * ) pCtx->pcServerCertificate,
+                                          pCtx->ulServerCertificateLength );
+    }
+
+    /* Start with protocol defaults. */
+    if( 0 == xResult )
+    {
+        xResult = mbedtls_ssl_config_defaults( &pCtx->mbedSslConfig,
+                                               MBEDTLS_SSL_IS_CLIENT,
+                                               MBEDTLS_SSL_TRANSPORT_STREAM,
+                                               MBEDTLS_SSL_PRESET_DEFAULT );
+    }
+
+    #if defined( MBEDTLS_SSL_SESSION_TICKETS )
+        if( 0 == xResult )
+        {
+            /* Only ask for session tickets if they are going to be used. */
+            #if ( tlsconfigENABLE_SESSION_RESUMPTION == 1 )
+                mbedtls_ssl_conf_session_tickets( &pCtx->mbedSslConfig, MBEDTLS_SSL_SESSION_TICKETS_ENABLED );
+            #else
+                mbedtls_ssl_conf_session_tickets( &pCtx->mbedSslConfig, MBEDTLS_SSL_SESSION_TICKETS_DISABLED );
+            #endif
+        }
+    #endif
+
+    if( 0 == xResult )
+    {
+        /* Use a callback for additional server certificate validation. */
+        mbedtls_ssl_conf_verify( &pCtx->mbedSslConfig,
+                                 &prvCheckCertificate,
+                                 pCtx );
+
+        /* Server certificate validation is mandatory. */
+        mbedtls_ssl_conf_authmode( &pCtx->mbedSslConfig, MBEDTLS_SSL_VERIFY_REQUIRED );
+
+        /* Set the RNG callback. */
+        mbedtls_ssl_conf_rng( &pCtx->mbedSslConfig, &prvGenerateRandomBytes, pCtx ); /*lint !e546 Nothing wrong here. */
+
+        /* Set issuer certificate: either the override or the default. */
+        if( NULL != pCtx->pcServerCertificate )
+        {
+            mbedtls_ssl_conf_ca_chain( &pCtx->mbedSslConfig, &pCtx->mbedX509CA, NULL );
+        }
+        else
+        {
+            mbedtls_ssl_conf_ca_chain( &pCtx->mbedSslConfig, &pCtx->pxCredentials->mbedX509CA, NULL );
+        }
+
+        /* Attach the client certificate and private key. */
+        xResult = mbedtls_ssl_conf_own_cert( &pCtx->mbedSslConfig,
+                                             &pCtx->pxCredentials->mbedX509Cli,
+                                             &pCtx->pxCredentials->mbedPkCtx );
+    }
+
+    if( 0 == xResult )
+    {
+        xResult = prvSetCipherSuites( pCtx );
+    }
+
+    #if defined( MBEDTLS_SSL_MAX_FRAGMENT_LENGTH )
+        if( ( 0 == xResult ) && ( 0 != pCtx->ulMaxFragmentLength ) )
+        {
+            /* Ask the server for small records. */
+            xResult = prvSetMaxFragmentLength( pCtx );
+        }
+    #endif
+
+    if( ( 0 == xResult ) && ( NULL != pCtx->ppcAlpnProtocols ) )
+    {
+        /* Include an application protocol list in the TLS ClientHello
+         * message. */
+        xResult = mbedtls_ssl_conf_alpn_protocols(
+            &pCtx->mbedSslConfig,
+            pCtx->ppcAlpnProtocols );
+    }
+
+    #ifdef MBEDTLS_DEBUG_C
+
+        /* If mbedTLS is being compiled with debug support, assume that the
+         * runtime configuration should use verbose output. */
+        mbedtls_ssl_conf_dbg( &pCtx->mbedSslConfig, prvTlsDebugPrint, NULL );
+        mbedtls_debug_set_threshold( tlsDEBUG_VERBOSE );
+    #endif
+
+    if( 0 == xResult )
+    {
+        /* Set the resulting protocol configuration. */
+        xResult = mbedtls_ssl_setup( &pCtx->mbedSslCtx, &pCtx->mbedSslConfig );
+    }
+
+    /* Set the hostname, if requested. */
+    if( ( 0 == xResult ) && ( NULL != pCtx->pcDestination ) )
+    {
+        xResult = mbedtls_ssl_set_hostname( &pCtx->mbedSslCtx, pCtx->pcDestination );
+    }
+
+    #if ( tlsconfigENABLE_SESSION_RESUMPTION == 1 )
+
+        /* Offer the session of the previous connection to the server. */
+        if( ( 0 == xResult ) &&
+            ( NULL != pCtx->pcDestination ) &&
+            ( tlsconfigSESSION_CACHE_MAX_DESTINATION_LENGTH >= strlen( pCtx->pcDestination ) ) )
+        {
+            xResult = prvRestoreSession( pCtx );
+        }
+    #endif
+
+    /* Set the socket callbacks. */
+    if( 0 == xResult )
+    {
+        mbedtls_ssl_set_bio( &pCtx->mbedSslCtx,
+                             pCtx,
+                             prvNetworkSend,
+                             prvNetworkRecv,
+                             NULL );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Keeps or forgets the session once the handshake is over, and frees
+ * what the handshake no longer needs.
+ *
+ * @param[in] pCtx Caller context.
+ * @param[in] xResult Result of the handshake.
+ */
+static void prvEndHandshake( TLSContext_t * pCtx,
+                             BaseType_t xResult )
+{
+    #if ( tlsconfigENABLE_SESSION_RESUMPTION == 1 )
+        if( ( 0 == xResult ) &&
+            ( NULL != pCtx->pcDestination ) &&
+            ( tlsconfigSESSION_CACHE_MAX_DESTINATION_LENGTH >= strlen( pCtx->pcDestination ) ) )
+        {
+            /* Keep the session for the next connection. */
+            prvSaveSession( pCtx );
+        }
+        else if( ( pdTRUE == pCtx->xSessionOffered ) &&
+                 ( ( MBEDTLS_ERR_SSL_FATAL_ALERT_MESSAGE == xResult ) ||
+                   ( MBEDTLS_ERR_SSL_BAD_HS_SERVER_HELLO == xResult ) ||
+                   ( MBEDTLS_ERR_SSL_BAD_HS_FINISHED == xResult ) ||
+                   ( MBEDTLS_ERR_SSL_INVALID_MAC == xResult ) ) )
+        {
+            /* The server did not accept the session the way it was
+             * offered. Network errors leave the session in the cache. */
+            prvForgetSession( pCtx->pcDestination );
+        }
+    #else
+        ( void ) xResult;
+    #endif
+
+    /* Free up allocated memory. */
+    mbedtls_x509_crt_free( &pCtx->mbedX509CA );
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TLS_Connect( void * pvContext )
+{
+    BaseType_t xResult = 0;
+    TLSContext_t * pCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+    xResult = prvStartHandshake( pCtx );
+
+    if( 0 == xResult )
+    {
+        /* Negotiate. */
+        while( 0 != ( xResult = mbedtls_ssl_handshake( &pCtx->mbedSslCtx ) ) )
+        {
+            if( ( MBEDTLS_ERR_SSL_WANT_READ != xResult ) &&
+                ( MBEDTLS_ERR_SSL_WANT_WRITE != xResult ) )
+            {
+                break;
+            }
+        }
+    }
+
+    prvEndHandshake( pCtx, xResult );
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TLS_ConnectStep( void * pvContext )
+{
+    BaseType_t xResult = 0;
+    TLSContext_t * pCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+    if( pdFALSE == pCtx->xHandshakeStarted )
+    {
+        pCtx->xHandshakeStarted = pdTRUE;
+        pCtx->xNonBlocking = pdTRUE;
+        xResult = prvStartHandshake( pCtx );
+    }
+
+    /* Process one handshake message, so that the task is not held for the
+     * whole of the cryptography of the handshake at once. */
+    if( 0 == xResult )
+    {
+        xResult = mbedtls_ssl_handshake_step( &pCtx->mbedSslCtx );
+    }
+
+    if( ( 0 == xResult ) && ( MBEDTLS_SSL_HANDSHAKE_OVER != pCtx->mbedSslCtx.state ) )
+    {
+        xResult = tlsCONNECT_IN_PROGRESS;
+    }
+    else if( MBEDTLS_ERR_SSL_WANT_READ == xResult )
+    {
+        xResult = tlsCONNECT_WANT_READ;
+    }
+    else if( MBEDTLS_ERR_SSL_WANT_WRITE == xResult )
+    {
+        xResult = tlsCONNECT_WANT_WRITE;
+    }
+    else
+    {
+        /* The connection blocks again once it is established. */
+        pCtx->xNonBlocking = pdFALSE;
+        prvEndHandshake( pCtx, xResult );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TLS_Recv( void * pvContext,
+                     unsigned char * pucReadBuffer,
+                     size_t xReadLength )
+{
+    BaseType_t xResult = 0;
+    TLSContext_t * pCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+    size_t xRead = 0;
+
+    if( NULL != pCtx )
+    {
+        while( xRead < xReadLength )
+        {
+            xResult = mbedtls_ssl_read( &pCtx->mbedSslCtx,
+                                        pucReadBuffer + xRead,
+                                        xReadLength - xRead );
+
+            if( 0 < xResult )
+            {
+                /* Got data, so update the tally and keep looping. */
+                xRead += ( size_t ) xResult;
+            }
+            else
+            {
+                if( ( 0 == xResult ) || ( MBEDTLS_ERR_SSL_WANT_READ != xResult ) )
+                {
+                    /* No data and no error or call read again, if indicated, otherwise return error. */
+                    break;
+                }
+            }
+        }
+    }
+
+    if( 0 <= xResult )
+    {
+        xResult = ( BaseType_t ) xRead;
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TLS_Send( void * pvContext,
+                     const unsigned char * pucMsg,
+                     size_t xMsgLength )
+{
+    BaseType_t xResult = 0;
+    TLSContext_t * pCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+    size_t xWritten = 0;
+
+    if( NULL != pCtx )
+    {
+        while( xWritten < xMsgLength )
+        {
+            xResult = mbedtls_ssl_write( &pCtx->mbedSslCtx,
+                                         pucMsg + xWritten,
+                                         xMsgLength - xWritten );
 
             if( 0 < xResult )
             {
@@ -660,6 +1692,167 @@ BaseType_t TLS_Send( void * pvContext,
 
 /*-----------------------------------------------------------*/
 
+BaseType_t TLS_RecvInto( void * pvContext,
+                         const TLSIoVector_t * pxVectors,
+                         size_t xVectorCount )
+{
+    BaseType_t xResult = 0;
+    size_t xVector = 0;
+    size_t xRead = 0;
+
+    for( xVector = 0; xVector < xVectorCount; xVector++ )
+    {
+        xResult = TLS_Recv( pvContext,
+                            ( unsigned char * ) pxVectors[ xVector ].pvData,
+                            pxVectors[ xVector ].xLength );
+
+        if( 0 <= xResult )
+        {
+            xRead += ( size_t ) xResult;
+        }
+
+        if( ( size_t ) xResult != pxVectors[ xVector ].xLength )
+        {
+            /* The connection was closed or failed. */
+            break;
+        }
+    }
+
+    if( 0 <= xResult )
+    {
+        xResult = ( BaseType_t ) xRead;
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TLS_SendV( void * pvContext,
+                      const TLSIoVector_t * pxVectors,
+                      size_t xVectorCount )
+{
+    BaseType_t xResult = 0;
+    size_t xWritten = 0;
+    size_t xVector = 0;
+
+    #if defined( MBEDTLS_SSL_CBC_RECORD_SPLITTING ) || defined( MBEDTLS_SSL_RENEGOTIATION )
+
+        /* mbedtls_ssl_write has to see every record for these, so each
+         * buffer is sent separately. */
+        for( xVector = 0; xVector < xVectorCount; xVector++ )
+        {
+            xResult = TLS_Send( pvContext,
+                                ( const unsigned char * ) pxVectors[ xVector ].pvData,
+                                pxVectors[ xVector ].xLength );
+
+            if( 0 <= xResult )
+            {
+                xWritten += ( size_t ) xResult;
+            }
+
+            if( ( size_t ) xResult != pxVectors[ xVector ].xLength )
+            {
+                break;
+            }
+        }
+    #else /* if defined( MBEDTLS_SSL_CBC_RECORD_SPLITTING ) || defined( MBEDTLS_SSL_RENEGOTIATION ) */
+        TLSContext_t * pCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+        mbedtls_ssl_context * pxSsl = NULL;
+        size_t xOffset = 0;
+        size_t xRecordLength = 0;
+        size_t xMaxRecordLength = 0;
+        size_t xCopyLength = 0;
+
+        if( NULL != pCtx )
+        {
+            pxSsl = &pCtx->mbedSslCtx;
+
+            /* This does what mbedtls_ssl_write does for one record, except
+             * that the record is filled from the buffers of the caller. */
+            if( MBEDTLS_SSL_HANDSHAKE_OVER != pxSsl->state )
+            {
+                xResult = MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+            }
+
+            #if defined( MBEDTLS_SSL_MAX_FRAGMENT_LENGTH )
+                xMaxRecordLength = mbedtls_ssl_get_max_frag_len( pxSsl );
+            #else
+                xMaxRecordLength = MBEDTLS_SSL_OUT_CONTENT_LEN;
+            #endif
+
+            /* Finish sending a record left by an earlier call. */
+            while( ( 0 == xResult ) && ( 0 != pxSsl->out_left ) )
+            {
+                xResult = mbedtls_ssl_flush_output( pxSsl );
+
+                if( MBEDTLS_ERR_SSL_WANT_WRITE == xResult )
+                {
+                    xResult = 0;
+                }
+            }
+
+            while( ( 0 == xResult ) && ( xVector < xVectorCount ) )
+            {
+                /* Gather the next record. */
+                xRecordLength = 0;
+
+                while( ( xVector < xVectorCount ) && ( xRecordLength < xMaxRecordLength ) )
+                {
+                    xCopyLength = pxVectors[ xVector ].xLength - xOffset;
+
+                    if( xCopyLength > ( xMaxRecordLength - xRecordLength ) )
+                    {
+                        xCopyLength = xMaxRecordLength - xRecordLength;
+                    }
+
+                    memcpy( pxSsl->out_msg + xRecordLength,
+                            ( const uint8_t * ) pxVectors[ xVector ].pvData + xOffset,
+                            xCopyLength );
+                    xRecordLength += xCopyLength;
+                    xOffset += xCopyLength;
+
+                    if( xOffset == pxVectors[ xVector ].xLength )
+                    {
+                        xVector++;
+                        xOffset = 0;
+                    }
+                }
+
+                if( 0 == xRecordLength )
+                {
+                    /* Only empty buffers were left. */
+                    break;
+                }
+
+                /* Encrypt the record and send it. */
+                pxSsl->out_msglen = xRecordLength;
+                pxSsl->out_msgtype = MBEDTLS_SSL_MSG_APPLICATION_DATA;
+                xResult = mbedtls_ssl_write_record( pxSsl );
+
+                while( MBEDTLS_ERR_SSL_WANT_WRITE == xResult )
+                {
+                    xResult = mbedtls_ssl_flush_output( pxSsl );
+                }
+
+                if( 0 == xResult )
+                {
+                    xWritten += xRecordLength;
+                }
+            }
+        }
+    #endif /* if defined( MBEDTLS_SSL_CBC_RECORD_SPLITTING ) || defined( MBEDTLS_SSL_RENEGOTIATION ) */
+
+    if( 0 <= xResult )
+    {
+        xResult = ( BaseType_t ) xWritten;
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
 void TLS_Cleanup( void * pvContext )
 {
     TLSContext_t * pCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
@@ -671,15 +1864,71 @@ void TLS_Cleanup( void * pvContext )
         mbedtls_ssl_free( &pCtx->mbedSslCtx );
         mbedtls_ssl_config_free( &pCtx->mbedSslConfig );
 
-        /* Cleanup PKCS#11. */
-        if( ( NULL != pCtx->pxP11FunctionList ) &&
-            ( NULL != pCtx->pxP11FunctionList->C_CloseSession ) )
+        /* Release the shared credentials. */
+        if( NULL != pCtx->pxCredentials )
         {
-            pCtx->pxP11FunctionList->C_CloseSession( pCtx->xP11Session ); /*lint !e534 This function always return CKR_OK. */
-            pCtx->pxP11FunctionList->C_Finalize( NULL );                  /*lint !e534 This function always return CKR_OK. */
+            prvReleaseCredentials( pCtx->pxCredentials );
         }
 
         /* Free memory. */
         vPortFree( pCtx );
     }
 }
+
+/*-----------------------------------------------------------*/
+
+void TLS_ClearSessionCache( void )
+{
+    #if ( tlsconfigENABLE_SESSION_RESUMPTION == 1 )
+        uint32_t ulIndex = 0;
+
+        #if ( tlsconfigSESSION_CACHE_USE_PAL == 1 )
+            TLSSessionFileHeader_t xHeader;
+        #endif
+
+        vTaskSuspendAll();
+        {
+            for( ulIndex = 0; ulIndex < tlsconfigSESSION_CACHE_SIZE; ulIndex++ )
+            {
+                mbedtls_ssl_session_free( &xSessionCache[ ulIndex ].xSession );
+                xSessionCache[ ulIndex ].cDestination[ 0 ] = '\0';
+            }
+
+            #if ( tlsconfigSESSION_CACHE_USE_PAL == 1 )
+                /* Do not read back the file being cleared. */
+                xSessionFileLoaded = pdTRUE;
+            #endif
+        }
+        ( void ) xTaskResumeAll();
+
+        #if ( tlsconfigSESSION_CACHE_USE_PAL == 1 )
+            /* Overwrite the session file with one that holds no session. */
+            memset( &xHeader, 0, sizeof( xHeader ) );
+            xHeader.ulVersion = MBEDTLS_VERSION_NUMBER;
+            ( void ) PKCS11_PAL_SaveFile( tlsconfigSESSION_CACHE_FILE_NAME,
+                                          ( uint8_t * ) &xHeader,
+                                          sizeof( xHeader ) );
+        #endif
+    #endif /* if ( tlsconfigENABLE_SESSION_RESUMPTION == 1 ) */
+}
+
+/*-----------------------------------------------------------*/
+
+void TLS_ReleaseCredentials( void )
+{
+    TLSCredentials_t * pxCredentials = NULL;
+
+    vTaskSuspendAll();
+    {
+        pxCredentials = pxCurrentCredentials;
+        pxCurrentCredentials = NULL;
+    }
+    ( void ) xTaskResumeAll();
+
+    /* Contexts that are still using the credentials keep them until
+     * TLS_Cleanup. */
+    if( NULL != pxCredentials )
+    {
+        prvReleaseCredentials( pxCredentials );
+    }
+}
@@ -0,0 +1,426 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_test_bufferpool.c
+ * @brief Tests for the central buffer pool.
+ *
+ * The tests only rely on the BufferPool interface and the class statistics,
+ * so they apply to every implementation in lib/bufferpool.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Bufferpool includes. */
+#include "aws_bufferpool.h"
+
+/* Unity framework includes. */
+#include "unity_fixture.h"
+
+/**
+ * @brief The maximum number of buffers the tests take at the same time.
+ */
+#define testbufferpoolMAX_BUFFERS               ( 64 )
+
+/**
+ * @brief Parameters of the stress test.
+ */
+/** @{ */
+#define testbufferpoolSTRESS_TASKS              ( 4 )
+#define testbufferpoolSTRESS_ITERATIONS         ( 20000 )
+#define testbufferpoolSTRESS_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 4 )
+#define testbufferpoolSTRESS_TIMEOUT            pdMS_TO_TICKS( 60000UL )
+/** @} */
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The buffers taken by the test being run.
+ */
+static uint8_t * pucBuffers[ testbufferpoolMAX_BUFFERS ];
+
+/**
+ * @brief The number of entries in pucBuffers.
+ */
+static uint32_t ulBufferCount;
+
+/**
+ * @brief The task waiting for the stress tasks to finish.
+ */
+static TaskHandle_t xStressRunnerTask;
+
+/**
+ * @brief The length of the largest buffers in the pool.
+ */
+static uint32_t ulLargestBufferSize;
+
+/**
+ * @brief The number of times each stress task found a buffer modified by
+ * another task while it owned it.
+ */
+static volatile uint32_t ulStressErrors[ testbufferpoolSTRESS_TASKS ];
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Returns the length of the largest buffers in the pool.
+ */
+static uint32_t prvGetLargestBufferSize( void );
+
+/**
+ * @brief Takes two buffers at a time, fills them with a pattern unique to the
+ * task, yields and checks that the pattern is intact before returning them.
+ *
+ * @param[in] pvParameters The number of the task.
+ */
+static void prvStressTask( void * pvParameters );
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Gets a buffer of the given length and records it for the tear down
+ * to return.
+ *
+ * @param[in] ulRequestedLength The length to request.
+ * @param[out] pulBufferLength The length of the buffer returned.
+ *
+ * @return The buffer, or NULL if none was available.
+ */
+static uint8_t * prvGetBuffer( uint32_t ulRequestedLength,
+                               uint32_t * pulBufferLength )
+{
+    uint8_t * pucBuffer;
+
+    *pulBufferLength = ulRequestedLength;
+    pucBuffer = BUFFERPOOL_GetFreeBuffer( pulBufferLength );
+
+    if( pucBuffer != NULL )
+    {
+        TEST_ASSERT_TRUE( ulBufferCount < testbufferpoolMAX_BUFFERS );
+        pucBuffers[ ulBufferCount++ ] = pucBuffer;
+
+        /* The whole length must be usable. */
+        memset( pucBuffer, 0xA5, *pulBufferLength );
+    }
+
+    return pucBuffer;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Returns the statistics of the given class.
+ */
+static BufferPoolClassStats_t prvGetClassStats( uint32_t ulClass )
+{
+    BufferPoolClassStats_t xStats;
+
+    TEST_ASSERT_EQUAL( pdPASS, BUFFERPOOL_GetClassStats( ulClass, &( xStats ) ) );
+
+    return xStats;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvGetLargestBufferSize( void )
+{
+    uint32_t ulClass, ulLargestSize = 0;
+
+    for( ulClass = 0; ulClass < BUFFERPOOL_GetNumClasses(); ulClass++ )
+    {
+        if( prvGetClassStats( ulClass ).ulNumBuffers > 0 )
+        {
+            ulLargestSize = prvGetClassStats( ulClass ).ulBufferSize;
+        }
+    }
+
+    return ulLargestSize;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStressTask( void * pvParameters )
+{
+    const uint32_t ulTask = ( uint32_t ) ( size_t ) pvParameters;
+    const uint8_t ucPattern = ( uint8_t ) ( 0xA0 + ulTask );
+    uint32_t ulRandom = ulTask + 1, ulIteration, x, y;
+    uint8_t * pucOwned[ 2 ];
+    uint32_t ulOwnedLength[ 2 ];
+
+    for( ulIteration = 0; ulIteration < testbufferpoolSTRESS_ITERATIONS; ulIteration++ )
+    {
+        for( x = 0; x < 2; x++ )
+        {
+            /* Request a pseudo random length. */
+            ulRandom ^= ulRandom << 13;
+            ulRandom ^= ulRandom >> 17;
+            ulRandom ^= ulRandom << 5;
+            ulOwnedLength[ x ] = 1 + ( ulRandom % ulLargestBufferSize );
+
+            /* The pool may be exhausted by the other tasks. */
+            pucOwned[ x ] = BUFFERPOOL_GetFreeBuffer( &( ulOwnedLength[ x ] ) );
+
+            if( pucOwned[ x ] != NULL )
+            {
+                memset( pucOwned[ x ], ucPattern, ulOwnedLength[ x ] );
+            }
+        }
+
+        /* Let the other tasks run while the buffers are owned. */
+        if( ( ulIteration & 0x03 ) == 0 )
+        {
+            taskYIELD();
+        }
+
+        for( x = 0; x < 2; x++ )
+        {
+            if( pucOwned[ x ] != NULL )
+            {
+                for( y = 0; y < ulOwnedLength[ x ]; y++ )
+                {
+                    if( pucOwned[ x ][ y ] != ucPattern )
+                    {
+                        ulStressErrors[ ulTask ]++;
+                        break;
+                    }
+                }
+
+                BUFFERPOOL_ReturnBuffer( pucOwned[ x ] );
+            }
+        }
+    }
+
+    xTaskNotifyGive( xStressRunnerTask );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+TEST_GROUP( Full_BUFFERPOOL );
+/*-----------------------------------------------------------*/
+
+TEST_SETUP( Full_BUFFERPOOL )
+{
+    uint32_t x;
+
+    ulBufferCount = 0;
+
+    /* Every test starts with all the buffers free. */
+    for( x = 0; x < BUFFERPOOL_GetNumClasses(); x++ )
+    {
+        TEST_ASSERT_EQUAL_UINT32( 0, prvGetClassStats( x ).ulBuffersInUse );
+    }
+}
+/*-----------------------------------------------------------*/
+
+TEST_TEAR_DOWN( Full_BUFFERPOOL )
+{
+    uint32_t x;
+
+    for( x = 0; x < ulBufferCount; x++ )
+    {
+        BUFFERPOOL_ReturnBuffer( pucBuffers[ x ] );
+    }
+}
+/*-----------------------------------------------------------*/
+
+TEST_GROUP_RUNNER( Full_BUFFERPOOL )
+{
+    RUN_TEST_CASE( Full_BUFFERPOOL, GetReturnBuffer_HappyCase );
+    RUN_TEST_CASE( Full_BUFFERPOOL, GetFreeBuffer_BestFitClass );
+    RUN_TEST_CASE( Full_BUFFERPOOL, GetFreeBuffer_LargerClassWhenExhausted );
+    RUN_TEST_CASE( Full_BUFFERPOOL, GetFreeBuffer_TooLarge );
+    RUN_TEST_CASE( Full_BUFFERPOOL, GetFreeBuffer_AllBuffersInUse );
+    RUN_TEST_CASE( Full_BUFFERPOOL, GetClassStats_InvalidClass );
+    RUN_TEST_CASE( Full_BUFFERPOOL, GetReturnBuffer_MultipleTasks );
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_BUFFERPOOL, GetReturnBuffer_HappyCase )
+{
+    uint8_t * pucBuffer;
+    uint32_t ulBufferLength, ulClass;
+
+    pucBuffer = prvGetBuffer( 1, &( ulBufferLength ) );
+    TEST_ASSERT_NOT_NULL( pucBuffer );
+    TEST_ASSERT_TRUE( ulBufferLength >= 1 );
+    TEST_ASSERT_EQUAL( 0, ( ( size_t ) pucBuffer ) & portBYTE_ALIGNMENT_MASK );
+
+    /* The buffer comes from the smallest class with buffers. */
+    for( ulClass = 0; prvGetClassStats( ulClass ).ulNumBuffers == 0; ulClass++ )
+    {
+    }
+
+    TEST_ASSERT_EQUAL_UINT32( prvGetClassStats( ulClass ).ulBufferSize, ulBufferLength );
+    TEST_ASSERT_EQUAL_UINT32( 1, prvGetClassStats( ulClass ).ulBuffersInUse );
+    TEST_ASSERT_TRUE( prvGetClassStats( ulClass ).ulHighWaterMark >= 1 );
+
+    BUFFERPOOL_ReturnBuffer( pucBuffer );
+    ulBufferCount = 0;
+
+    TEST_ASSERT_EQUAL_UINT32( 0, prvGetClassStats( ulClass ).ulBuffersInUse );
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_BUFFERPOOL, GetFreeBuffer_BestFitClass )
+{
+    BufferPoolClassStats_t xStats;
+    uint32_t ulBufferLength, ulClass;
+
+    /* A request of exactly the size of a class is served from that class. */
+    for( ulClass = 0; ulClass < BUFFERPOOL_GetNumClasses(); ulClass++ )
+    {
+        xStats = prvGetClassStats( ulClass );
+
+        if( xStats.ulNumBuffers > 0 )
+        {
+            TEST_ASSERT_NOT_NULL( prvGetBuffer( xStats.ulBufferSize, &( ulBufferLength ) ) );
+            TEST_ASSERT_EQUAL_UINT32( xStats.ulBufferSize, ulBufferLength );
+            TEST_ASSERT_EQUAL_UINT32( 1, prvGetClassStats( ulClass ).ulBuffersInUse );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_BUFFERPOOL, GetFreeBuffer_LargerClassWhenExhausted )
+{
+    BufferPoolClassStats_t xSmallStats, xLargeStats;
+    uint32_t x, ulBufferLength;
+
+    if( BUFFERPOOL_GetNumClasses() < 2 )
+    {
+        TEST_IGNORE_MESSAGE( "The buffer pool has a single class." );
+    }
+
+    xSmallStats = prvGetClassStats( 0 );
+    xLargeStats = prvGetClassStats( 1 );
+
+    if( ( xSmallStats.ulNumBuffers == 0 ) || ( xLargeStats.ulNumBuffers == 0 ) )
+    {
+        TEST_IGNORE_MESSAGE( "The first two classes must have buffers." );
+    }
+
+    /* Take all the buffers of the smallest class. */
+    for( x = 0; x < xSmallStats.ulNumBuffers; x++ )
+    {
+        TEST_ASSERT_NOT_NULL( prvGetBuffer( 1, &( ulBufferLength ) ) );
+        TEST_ASSERT_EQUAL_UINT32( xSmallStats.ulBufferSize, ulBufferLength );
+    }
+
+    /* The next request is served from the next class. */
+    TEST_ASSERT_NOT_NULL( prvGetBuffer( 1, &( ulBufferLength ) ) );
+    TEST_ASSERT_EQUAL_UINT32( xLargeStats.ulBufferSize, ulBufferLength );
+    TEST_ASSERT_EQUAL_UINT32( 1, prvGetClassStats( 1 ).ulBuffersInUse );
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_BUFFERPOOL, GetFreeBuffer_TooLarge )
+{
+    uint32_t ulBufferLength;
+
+    TEST_ASSERT_NULL( prvGetBuffer( prvGetLargestBufferSize() + 1, &( ulBufferLength ) ) );
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_BUFFERPOOL, GetFreeBuffer_AllBuffersInUse )
+{
+    BufferPoolClassStats_t xStats;
+    uint32_t ulClass, ulTotalBuffers = 0, ulBufferLength;
+
+    for( ulClass = 0; ulClass < BUFFERPOOL_GetNumClasses(); ulClass++ )
+    {
+        ulTotalBuffers += prvGetClassStats( ulClass ).ulNumBuffers;
+    }
+
+    TEST_ASSERT_TRUE( ulTotalBuffers <= testbufferpoolMAX_BUFFERS );
+
+    /* The smallest requests are served from every class in turn. */
+    while( prvGetBuffer( 1, &( ulBufferLength ) ) != NULL )
+    {
+    }
+
+    TEST_ASSERT_EQUAL_UINT32( ulTotalBuffers, ulBufferCount );
+
+    for( ulClass = 0; ulClass < BUFFERPOOL_GetNumClasses(); ulClass++ )
+    {
+        xStats = prvGetClassStats( ulClass );
+        TEST_ASSERT_EQUAL_UINT32( xStats.ulNumBuffers, xStats.ulBuffersInUse );
+        TEST_ASSERT_EQUAL_UINT32( xStats.ulNumBuffers, xStats.ulHighWaterMark );
+    }
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_BUFFERPOOL, GetClassStats_InvalidClass )
+{
+    BufferPoolClassStats_t xStats;
+
+    TEST_ASSERT_EQUAL( pdFAIL, BUFFERPOOL_GetClassStats( BUFFERPOOL_GetNumClasses(), &( xStats ) ) );
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_BUFFERPOOL, GetReturnBuffer_MultipleTasks )
+{
+    uint32_t x, ulClass, ulNotified, ulFinished = 0;
+
+    xStressRunnerTask = xTaskGetCurrentTaskHandle();
+    ulLargestBufferSize = prvGetLargestBufferSize();
+    memset( ( void * ) ulStressErrors, 0x00, sizeof( ulStressErrors ) );
+
+    /* The stress tasks share the priority of this task so that they are
+     * time sliced with each other. */
+    for( x = 0; x < testbufferpoolSTRESS_TASKS; x++ )
+    {
+        TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( prvStressTask,
+                                                "BufStress",
+                                                testbufferpoolSTRESS_TASK_STACK_SIZE,
+                                                ( void * ) ( size_t ) x,
+                                                uxTaskPriorityGet( NULL ),
+                                                NULL ) );
+    }
+
+    /* Wait for all the stress tasks to finish. */
+    while( ulFinished < testbufferpoolSTRESS_TASKS )
+    {
+        ulNotified = ulTaskNotifyTake( pdTRUE, testbufferpoolSTRESS_TIMEOUT );
+        TEST_ASSERT_TRUE( ulNotified > 0 );
+        ulFinished += ulNotified;
+    }
+
+    /* No buffer was given to two tasks at the same time. */
+    for( x = 0; x < testbufferpoolSTRESS_TASKS; x++ )
+    {
+        TEST_ASSERT_EQUAL_UINT32( 0, ulStressErrors[ x ] );
+    }
+
+    /* Every buffer was returned, and the statistics never counted more
+     * buffers in use than there are. */
+    for( ulClass = 0; ulClass < BUFFERPOOL_GetNumClasses(); ulClass++ )
+    {
+        TEST_ASSERT_EQUAL_UINT32( 0, prvGetClassStats( ulClass ).ulBuffersInUse );
+        TEST_ASSERT_TRUE( prvGetClassStats( ulClass ).ulHighWaterMark <= prvGetClassStats( ulClass ).ulNumBuffers );
+    }
+
+    /* Let the idle task free the deleted tasks. */
+    vTaskDelay( pdMS_TO_TICKS( 10UL ) );
+}
+/*-----------------------------------------------------------*/
@@ -44,11 +44,15 @@ TEST_SETUP( Full_CRYPTO )
 
 TEST_TEAR_DOWN( Full_CRYPTO )
 {
+    /* Do not leave a cached signer key allocated from the heap these tests
+     * ran with. */
+    CRYPTO_ClearSignerKeyCache();
 }
 
 TEST_GROUP_RUNNER( Full_CRYPTO )
 {
     RUN_TEST_CASE( Full_CRYPTO, AFQP_VerifySignatureTestVectors );
+    RUN_TEST_CASE( Full_CRYPTO, AbortSignatureVerification );
 }
 
 TEST( Full_CRYPTO, AFQP_VerifySignatureTestVectors )
@@ -281,3 +285,29 @@ TEST( Full_CRYPTO, AFQP_VerifySignatureTestVectors )
     TEST_ASSERT_FALSE( xResult );
     /** @}*/
 }
+
+TEST( Full_CRYPTO, AbortSignatureVerification )
+{
+    BaseType_t xResult = pdFALSE;
+    void * pvSignatureVerificationContext = NULL;
+    uint8_t ucData[ 64 ] = { 0 };
+    size_t xFreeHeapBefore = xPortGetFreeHeapSize();
+
+    /* An abandoned verification gives all of its memory back. */
+    xResult = CRYPTO_SignatureVerificationStart(
+        &pvSignatureVerificationContext,
+        cryptoASYMMETRIC_ALGORITHM_ECDSA,
+        cryptoHASH_ALGORITHM_SHA256 );
+    TEST_ASSERT_TRUE( xResult );
+
+    CRYPTO_SignatureVerificationUpdate(
+        pvSignatureVerificationContext,
+        ucData,
+        sizeof( ucData ) );
+
+    CRYPTO_SignatureVerificationAbort( pvSignatureVerificationContext );
+    TEST_ASSERT_EQUAL( xFreeHeapBefore, xPortGetFreeHeapSize() );
+
+    /* Aborting no verification does nothing. */
+    CRYPTO_SignatureVerificationAbort( NULL );
+}
@@ -0,0 +1,312 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_benchmark.c
+ * @brief Result reporting for the benchmark test groups.
+ */
+
+/* Standard includes. */
+#include <stdlib.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Benchmark include. */
+#include "aws_benchmark.h"
+
+/*-----------------------------------------------------------*/
+
+/* The task whose heap is counted, and what has been counted. */
+static TaskHandle_t xHeapCountTask = NULL;
+static int32_t lHeapInUse = 0;
+static int32_t lHeapPeak = 0;
+
+/* Free heap after the last allocation or free. The heap trace macros are
+ * called after the free heap size is updated, so the difference is the size
+ * of the block, including what the heap added to it. */
+static size_t xLastFreeHeapSize = 0;
+
+/* The task whose heap events are recorded, and where they are recorded. */
+static TaskHandle_t xHeapRecordTask = NULL;
+static BenchmarkHeapEvent_t * pxHeapEvents = NULL;
+static size_t xHeapMaxEvents = 0;
+static size_t xHeapEventCount = 0;
+
+/* The task that is counted, what has been counted, the task switched out
+ * last, and when the counted task was last switched in. */
+static TaskHandle_t xTaskCountTask = NULL;
+static uint32_t ulTaskSwitchedIn = 0;
+static uint32_t ulTaskQueueReceives = 0;
+static uint64_t ullTaskRunTimeNs = 0;
+static TaskHandle_t xSwitchedOutTask = NULL;
+static uint64_t ullTaskSwitchedInAt = 0;
+
+/*-----------------------------------------------------------*/
+
+static int prvCompareSamples( const void * pvLeft,
+                              const void * pvRight )
+{
+    uint32_t ulLeft = *( ( const uint32_t * ) pvLeft );
+    uint32_t ulRight = *( ( const uint32_t * ) pvRight );
+    int iResult = 0;
+
+    if( ulLeft < ulRight )
+    {
+        iResult = -1;
+    }
+    else if( ulLeft > ulRight )
+    {
+        iResult = 1;
+    }
+
+    return iResult;
+}
+/*-----------------------------------------------------------*/
+
+void BENCHMARK_Report( const char * pcGroup,
+                       const char * pcCase,
+                       const char * pcMetric,
+                       uint64_t ullValue,
+                       const char * pcUnit )
+{
+    configPRINTF( ( "BENCHMARK,%s,%s,%s,%llu,%s\r\n",
+                    pcGroup,
+                    pcCase,
+                    pcMetric,
+                    ( unsigned long long ) ullValue,
+                    pcUnit ) );
+}
+/*-----------------------------------------------------------*/
+
+void BENCHMARK_ReportSamples( const char * pcGroup,
+                              const char * pcCase,
+                              uint32_t * pulSamples,
+                              size_t xSampleCount,
+                              const char * pcUnit )
+{
+    uint64_t ullTotal = 0;
+    size_t x;
+
+    configASSERT( pulSamples != NULL );
+    configASSERT( xSampleCount > 0 );
+
+    qsort( pulSamples, xSampleCount, sizeof( uint32_t ), prvCompareSamples );
+
+    for( x = 0; x < xSampleCount; x++ )
+    {
+        ullTotal += pulSamples[ x ];
+    }
+
+    BENCHMARK_Report( pcGroup, pcCase, "min", pulSamples[ 0 ], pcUnit );
+    BENCHMARK_Report( pcGroup, pcCase, "mean", ullTotal / xSampleCount, pcUnit );
+    BENCHMARK_Report( pcGroup, pcCase, "p50", pulSamples[ ( xSampleCount * 50 ) / 100 ], pcUnit );
+    BENCHMARK_Report( pcGroup, pcCase, "p90", pulSamples[ ( xSampleCount * 90 ) / 100 ], pcUnit );
+    BENCHMARK_Report( pcGroup, pcCase, "p99", pulSamples[ ( xSampleCount * 99 ) / 100 ], pcUnit );
+    BENCHMARK_Report( pcGroup, pcCase, "max", pulSamples[ xSampleCount - 1 ], pcUnit );
+}
+/*-----------------------------------------------------------*/
+
+void BENCHMARK_HeapCountStart( TaskHandle_t xTask )
+{
+    vTaskSuspendAll();
+    {
+        xHeapCountTask = xTask;
+        lHeapInUse = 0;
+        lHeapPeak = 0;
+        xLastFreeHeapSize = xPortGetFreeHeapSize();
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void BENCHMARK_HeapCountGet( int32_t * plInUse,
+                             int32_t * plPeak )
+{
+    vTaskSuspendAll();
+    {
+        *plInUse = lHeapInUse;
+        *plPeak = lHeapPeak;
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void BENCHMARK_HeapRecordStart( TaskHandle_t xTask,
+                                BenchmarkHeapEvent_t * pxEvents,
+                                size_t xMaxEvents )
+{
+    vTaskSuspendAll();
+    {
+        pxHeapEvents = pxEvents;
+        xHeapMaxEvents = xMaxEvents;
+        xHeapEventCount = 0;
+        xHeapRecordTask = xTask;
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+size_t BENCHMARK_HeapRecordStop( void )
+{
+    size_t xEventCount = 0;
+
+    vTaskSuspendAll();
+    {
+        xHeapRecordTask = NULL;
+        xEventCount = xHeapEventCount;
+    }
+    ( void ) xTaskResumeAll();
+
+    return xEventCount;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRecordHeapEvent( void * pvAddress,
+                                size_t xSize )
+{
+    /* Called with the scheduler suspended. */
+    if( ( NULL != xHeapRecordTask ) && ( xTaskGetCurrentTaskHandle() == xHeapRecordTask ) )
+    {
+        if( xHeapEventCount < xHeapMaxEvents )
+        {
+            pxHeapEvents[ xHeapEventCount ].pvAddress = pvAddress;
+            pxHeapEvents[ xHeapEventCount ].xSize = xSize;
+        }
+
+        xHeapEventCount++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void BENCHMARK_TraceMalloc( void * pvAddress,
+                            size_t xSize )
+{
+    size_t xFreeHeapSize = xPortGetFreeHeapSize();
+
+    if( NULL != pvAddress )
+    {
+        prvRecordHeapEvent( pvAddress, xSize );
+    }
+
+    /* Called with the scheduler suspended. */
+    if( ( NULL != xHeapCountTask ) && ( xTaskGetCurrentTaskHandle() == xHeapCountTask ) )
+    {
+        lHeapInUse += ( int32_t ) ( xLastFreeHeapSize - xFreeHeapSize );
+
+        if( lHeapInUse > lHeapPeak )
+        {
+            lHeapPeak = lHeapInUse;
+        }
+    }
+
+    xLastFreeHeapSize = xFreeHeapSize;
+}
+/*-----------------------------------------------------------*/
+
+void BENCHMARK_TraceFree( void * pvAddress,
+                          size_t xSize )
+{
+    size_t xFreeHeapSize = xPortGetFreeHeapSize();
+
+    ( void ) xSize;
+
+    prvRecordHeapEvent( pvAddress, 0 );
+
+    /* Called with the scheduler suspended. */
+    if( ( NULL != xHeapCountTask ) && ( xTaskGetCurrentTaskHandle() == xHeapCountTask ) )
+    {
+        lHeapInUse -= ( int32_t ) ( xFreeHeapSize - xLastFreeHeapSize );
+    }
+
+    xLastFreeHeapSize = xFreeHeapSize;
+}
+/*-----------------------------------------------------------*/
+
+void BENCHMARK_TaskCountStart( TaskHandle_t xTask )
+{
+    vTaskSuspendAll();
+    {
+        xTaskCountTask = xTask;
+        ulTaskSwitchedIn = 0;
+        ulTaskQueueReceives = 0;
+        ullTaskRunTimeNs = 0;
+        ullTaskSwitchedInAt = benchmarkconfigGET_TIME_NS();
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void BENCHMARK_TaskCountGet( uint32_t * pulSwitchedIn,
+                             uint32_t * pulQueueReceives,
+                             uint64_t * pullRunTimeNs )
+{
+    vTaskSuspendAll();
+    {
+        *pulSwitchedIn = ulTaskSwitchedIn;
+        *pulQueueReceives = ulTaskQueueReceives;
+        *pullRunTimeNs = ullTaskRunTimeNs;
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void BENCHMARK_TraceTaskSwitchedOut( void )
+{
+    /* Called by the scheduler before it selects the next task, which can be
+     * the same one. */
+    xSwitchedOutTask = xTaskGetCurrentTaskHandle();
+
+    if( ( NULL != xTaskCountTask ) && ( xSwitchedOutTask == xTaskCountTask ) )
+    {
+        ullTaskRunTimeNs += benchmarkconfigGET_TIME_NS() - ullTaskSwitchedInAt;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void BENCHMARK_TraceTaskSwitchedIn( void )
+{
+    if( ( NULL != xTaskCountTask ) && ( xTaskGetCurrentTaskHandle() == xTaskCountTask ) )
+    {
+        if( xSwitchedOutTask != xTaskCountTask )
+        {
+            ulTaskSwitchedIn++;
+        }
+
+        ullTaskSwitchedInAt = benchmarkconfigGET_TIME_NS();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void BENCHMARK_TraceQueueReceive( void )
+{
+    /* Called with interrupts masked. */
+    if( ( NULL != xTaskCountTask ) && ( xTaskGetCurrentTaskHandle() == xTaskCountTask ) )
+    {
+        ulTaskQueueReceives++;
+    }
+}
+/*-----------------------------------------------------------*/
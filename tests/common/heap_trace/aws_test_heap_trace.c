@@ -0,0 +1,208 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_test_heap_trace.c
+ * @brief Tests for the heap trace.
+ *
+ * The heap trace macros of the platform must call the heap trace hooks, see
+ * aws_heap_trace.h.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Heap trace includes. */
+#include "aws_heap_trace.h"
+#include "aws_heap_trace_config_defaults.h"
+
+/* Unity framework includes. */
+#include "unity_fixture.h"
+
+#define testheaptraceBLOCK_SIZE    ( 100 )
+#define testheaptraceBLOCKS        ( 4 )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Records read from the ring.
+ */
+static HeapTraceRecord_t xRecords[ heaptraceconfigRING_LENGTH ];
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Finds the record of a call to the heap by the calling task.
+ *
+ * @param[in] xCount The number of records in xRecords.
+ * @param[in] pvAddress The memory allocated or freed.
+ * @param[in] xIsFree pdTRUE to find the free of the memory.
+ *
+ * @return The record, or NULL if it was not recorded.
+ */
+static const HeapTraceRecord_t * prvFindRecord( size_t xCount,
+                                                const void * pvAddress,
+                                                BaseType_t xIsFree );
+/*-----------------------------------------------------------*/
+
+static const HeapTraceRecord_t * prvFindRecord( size_t xCount,
+                                                const void * pvAddress,
+                                                BaseType_t xIsFree )
+{
+    const HeapTraceRecord_t * pxFound = NULL;
+    size_t x;
+
+    for( x = 0; x < xCount; x++ )
+    {
+        if( ( xRecords[ x ].pvAddress == pvAddress ) &&
+            ( xRecords[ x ].xIsFree == xIsFree ) &&
+            ( xRecords[ x ].xTask == xTaskGetCurrentTaskHandle() ) )
+        {
+            pxFound = &xRecords[ x ];
+        }
+    }
+
+    return pxFound;
+}
+/*-----------------------------------------------------------*/
+
+TEST_GROUP( Full_HEAP_TRACE );
+
+TEST_SETUP( Full_HEAP_TRACE )
+{
+}
+
+TEST_TEAR_DOWN( Full_HEAP_TRACE )
+{
+    HEAPTRACE_Stop();
+}
+
+TEST_GROUP_RUNNER( Full_HEAP_TRACE )
+{
+    RUN_TEST_CASE( Full_HEAP_TRACE, RecordsMallocAndFree );
+    RUN_TEST_CASE( Full_HEAP_TRACE, RingKeepsNewestRecords );
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_HEAP_TRACE, RecordsMallocAndFree )
+{
+    void * pvBlocks[ testheaptraceBLOCKS ];
+    void * pvUntraced = NULL;
+    const HeapTraceRecord_t * pxMalloc = NULL;
+    const HeapTraceRecord_t * pxFree = NULL;
+    size_t xCount = 0;
+    uint32_t ulRecorded = 0;
+    uint32_t ulBlock = 0;
+
+    HEAPTRACE_Start();
+
+    for( ulBlock = 0; ulBlock < testheaptraceBLOCKS; ulBlock++ )
+    {
+        pvBlocks[ ulBlock ] = pvPortMalloc( testheaptraceBLOCK_SIZE );
+        TEST_ASSERT_NOT_NULL( pvBlocks[ ulBlock ] );
+    }
+
+    /* Print the blocks still allocated, as heap_trace_report.py reads them. */
+    vPortFree( pvBlocks[ 0 ] );
+    HEAPTRACE_Dump();
+
+    for( ulBlock = 1; ulBlock < testheaptraceBLOCKS; ulBlock++ )
+    {
+        vPortFree( pvBlocks[ ulBlock ] );
+    }
+
+    HEAPTRACE_Stop();
+
+    /* Nothing is recorded once stopped. */
+    pvUntraced = pvPortMalloc( testheaptraceBLOCK_SIZE );
+    vPortFree( pvUntraced );
+
+    xCount = HEAPTRACE_Read( xRecords, heaptraceconfigRING_LENGTH, &ulRecorded );
+    TEST_ASSERT_EQUAL( ulRecorded, xCount );
+    TEST_ASSERT_TRUE( xCount >= ( 2 * testheaptraceBLOCKS ) );
+
+    for( ulBlock = 0; ulBlock < testheaptraceBLOCKS; ulBlock++ )
+    {
+        pxMalloc = prvFindRecord( xCount, pvBlocks[ ulBlock ], pdFALSE );
+        pxFree = prvFindRecord( xCount, pvBlocks[ ulBlock ], pdTRUE );
+        TEST_ASSERT_NOT_NULL( pxMalloc );
+        TEST_ASSERT_NOT_NULL( pxFree );
+        TEST_ASSERT_TRUE( pxMalloc < pxFree );
+
+        /* The size includes the block header of the heap. */
+        TEST_ASSERT_TRUE( pxMalloc->ulSize > testheaptraceBLOCK_SIZE );
+        TEST_ASSERT_TRUE( pxFree->ulSize >= pxMalloc->ulSize );
+        TEST_ASSERT_NOT_NULL( pxMalloc->pvCaller );
+        TEST_ASSERT_NOT_NULL( pxFree->pvCaller );
+        TEST_ASSERT_TRUE( pxMalloc->ulTime <= pxFree->ulTime );
+    }
+
+    /* The blocks were all allocated by the same call. */
+    TEST_ASSERT_EQUAL_PTR( prvFindRecord( xCount, pvBlocks[ 0 ], pdFALSE )->pvCaller,
+                           prvFindRecord( xCount, pvBlocks[ 1 ], pdFALSE )->pvCaller );
+
+    if( pvUntraced != pvBlocks[ 0 ] )
+    {
+        TEST_ASSERT_NULL( prvFindRecord( xCount, pvUntraced, pdFALSE ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_HEAP_TRACE, RingKeepsNewestRecords )
+{
+    void * pvBlock = NULL;
+    size_t xCount = 0;
+    uint32_t ulRecorded = 0;
+    uint32_t ulCall = 0;
+
+    HEAPTRACE_Start();
+
+    /* Two records per call, so the ring wraps. */
+    for( ulCall = 0; ulCall < heaptraceconfigRING_LENGTH; ulCall++ )
+    {
+        pvBlock = pvPortMalloc( testheaptraceBLOCK_SIZE + ulCall );
+        TEST_ASSERT_NOT_NULL( pvBlock );
+        vPortFree( pvBlock );
+    }
+
+    HEAPTRACE_Stop();
+
+    xCount = HEAPTRACE_Read( xRecords, heaptraceconfigRING_LENGTH, &ulRecorded );
+    TEST_ASSERT_EQUAL( heaptraceconfigRING_LENGTH, xCount );
+    TEST_ASSERT_TRUE( ulRecorded >= ( 2 * heaptraceconfigRING_LENGTH ) );
+
+    /* The newest record is the last free, and the oldest are dropped. */
+    TEST_ASSERT_EQUAL_PTR( pvBlock, xRecords[ xCount - 1 ].pvAddress );
+    TEST_ASSERT_EQUAL( pdTRUE, xRecords[ xCount - 1 ].xIsFree );
+    TEST_ASSERT_TRUE( xRecords[ 0 ].ulSize > ( testheaptraceBLOCK_SIZE + ( heaptraceconfigRING_LENGTH / 4 ) ) );
+
+    /* Fewer records can be read, the newest ones. */
+    xCount = HEAPTRACE_Read( xRecords, 2, NULL );
+    TEST_ASSERT_EQUAL( 2, xCount );
+    TEST_ASSERT_EQUAL_PTR( pvBlock, xRecords[ 1 ].pvAddress );
+    TEST_ASSERT_EQUAL( pdFALSE, xRecords[ 0 ].xIsFree );
+}
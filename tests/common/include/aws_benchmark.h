@@ -0,0 +1,223 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_benchmark.h
+ * @brief Helpers shared by the benchmark test groups.
+ *
+ * Benchmarks are ordinary Unity test groups that, in addition to asserting
+ * correctness, report measurements as machine readable lines of the form:
+ *
+ * BENCHMARK,<group>,<case>,<metric>,<value>,<unit>
+ *
+ * so results can be extracted from the test log with a simple filter and
+ * compared between builds.
+ */
+
+#ifndef _AWS_BENCHMARK_H_
+#define _AWS_BENCHMARK_H_
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Benchmark configuration include. */
+#include "aws_benchmark_config.h"
+
+/**
+ * @brief Returns a nanosecond time stamp used to time benchmark iterations.
+ *
+ * Platforms with a high resolution clock should define this in
+ * aws_benchmark_config.h.  The default is derived from the tick count, so
+ * only measurements much longer than a tick are meaningful with it.
+ *
+ * Platforms with a cycle counter can also define benchmarkconfigGET_CYCLES()
+ * to return it, for the benchmarks that report cycles per operation. It has
+ * no default; cycles are not reported without it.
+ */
+#ifndef benchmarkconfigGET_TIME_NS
+    #define benchmarkconfigGET_TIME_NS() \
+    ( ( uint64_t ) xTaskGetTickCount() * ( 1000000000ULL / ( uint64_t ) configTICK_RATE_HZ ) )
+#endif
+
+/**
+ * @brief Number of iterations timed by each latency benchmark.
+ */
+#ifndef benchmarkconfigITERATIONS
+    #define benchmarkconfigITERATIONS    ( 1000 )
+#endif
+
+/**
+ * @brief Number of the FreeRTOS heap implementation built in, e.g. 4 for
+ * heap_4.c, or zero if it is not known.
+ *
+ * Only used to report the statistics that a particular heap keeps.
+ */
+#ifndef benchmarkconfigHEAP
+    #define benchmarkconfigHEAP    ( 0 )
+#endif
+
+/**
+ * @brief An allocation or a free recorded by BENCHMARK_HeapRecordStart.
+ */
+typedef struct BenchmarkHeapEvent
+{
+    void * pvAddress; /**< The memory returned by pvPortMalloc or passed to vPortFree. */
+    size_t xSize;     /**< The size the heap allocated for the request, header included, or zero for a free. */
+} BenchmarkHeapEvent_t;
+
+/**
+ * @brief Report a single measurement.
+ *
+ * @param[in] pcGroup The benchmark group, normally the Unity test group name.
+ * @param[in] pcCase The benchmark case within the group.
+ * @param[in] pcMetric The quantity measured, e.g. "p50" or "msgs_per_sec".
+ * @param[in] ullValue The measured value.
+ * @param[in] pcUnit The unit of ullValue, e.g. "ns".
+ */
+void BENCHMARK_Report( const char * pcGroup,
+                       const char * pcCase,
+                       const char * pcMetric,
+                       uint64_t ullValue,
+                       const char * pcUnit );
+
+/**
+ * @brief Report the distribution of a set of latency samples.
+ *
+ * Reports the minimum, mean, 50th, 90th, 99th percentile and maximum of the
+ * samples.  The sample array is sorted in place.
+ *
+ * @param[in] pcGroup The benchmark group, normally the Unity test group name.
+ * @param[in] pcCase The benchmark case within the group.
+ * @param[in,out] pulSamples The samples.
+ * @param[in] xSampleCount The number of entries in pulSamples.
+ * @param[in] pcUnit The unit of the samples, e.g. "ns".
+ */
+void BENCHMARK_ReportSamples( const char * pcGroup,
+                              const char * pcCase,
+                              uint32_t * pulSamples,
+                              size_t xSampleCount,
+                              const char * pcUnit );
+
+/**
+ * @brief Start counting the FreeRTOS heap allocated and freed by one task.
+ *
+ * The heap trace macros of the platform must call BENCHMARK_TraceMalloc and
+ * BENCHMARK_TraceFree, otherwise nothing is counted:
+ * @code
+ * #define traceMALLOC( pvAddress, uiSize )    BENCHMARK_TraceMalloc( pvAddress, uiSize )
+ * #define traceFREE( pvAddress, uiSize )      BENCHMARK_TraceFree( pvAddress, uiSize )
+ * @endcode
+ *
+ * The bytes counted are the ones the heap reports as taken by each block, so
+ * they include the block headers and the alignment padding of the heap.
+ *
+ * @param[in] xTask The task whose allocations are counted.
+ */
+void BENCHMARK_HeapCountStart( TaskHandle_t xTask );
+
+/**
+ * @brief Read the heap counted since BENCHMARK_HeapCountStart.
+ *
+ * @param[out] plInUse Bytes allocated minus bytes freed by the task. It is
+ * negative if the task freed more than it allocated since the start.
+ * @param[out] plPeak Highest value plInUse has had since the start.
+ */
+void BENCHMARK_HeapCountGet( int32_t * plInUse,
+                             int32_t * plPeak );
+
+/**
+ * @brief Start recording the allocations and frees of one task.
+ *
+ * The heap trace macros must call the hooks, see BENCHMARK_HeapCountStart.
+ * Allocations that fail are not recorded. The events can be replayed against
+ * the heap to time it with the allocation pattern of real code.
+ *
+ * @param[in] xTask The task whose allocations are recorded.
+ * @param[out] pxEvents Array the events are recorded into, in order.
+ * @param[in] xMaxEvents The number of entries in pxEvents.
+ */
+void BENCHMARK_HeapRecordStart( TaskHandle_t xTask,
+                                BenchmarkHeapEvent_t * pxEvents,
+                                size_t xMaxEvents );
+
+/**
+ * @brief Stop recording started by BENCHMARK_HeapRecordStart.
+ *
+ * @return The number of events seen. It is more than the xMaxEvents passed
+ * to BENCHMARK_HeapRecordStart if some of them did not fit.
+ */
+size_t BENCHMARK_HeapRecordStop( void );
+
+/**
+ * @brief Heap trace hooks, see BENCHMARK_HeapCountStart.
+ */
+void BENCHMARK_TraceMalloc( void * pvAddress,
+                            size_t xSize );
+void BENCHMARK_TraceFree( void * pvAddress,
+                          size_t xSize );
+
+/**
+ * @brief Start counting how often one task is switched in, the messages it
+ * receives from queues and the time it runs.
+ *
+ * The trace macros of the platform must call the hooks, otherwise nothing is
+ * counted:
+ * @code
+ * #define traceTASK_SWITCHED_IN()          BENCHMARK_TraceTaskSwitchedIn()
+ * #define traceTASK_SWITCHED_OUT()         BENCHMARK_TraceTaskSwitchedOut()
+ * #define traceQUEUE_RECEIVE( pxQueue )    BENCHMARK_TraceQueueReceive()
+ * @endcode
+ *
+ * The run time is measured with benchmarkconfigGET_TIME_NS from the switch in
+ * to the switch out, so it includes the interrupts taken meanwhile.
+ *
+ * @param[in] xTask The task that is counted.
+ */
+void BENCHMARK_TaskCountStart( TaskHandle_t xTask );
+
+/**
+ * @brief Read what was counted since BENCHMARK_TaskCountStart.
+ *
+ * @param[out] pulSwitchedIn The number of times the task was switched in.
+ * @param[out] pulQueueReceives The number of messages the task received.
+ * @param[out] pullRunTimeNs The time the task ran for, in nanoseconds.
+ */
+void BENCHMARK_TaskCountGet( uint32_t * pulSwitchedIn,
+                             uint32_t * pulQueueReceives,
+                             uint64_t * pullRunTimeNs );
+
+/**
+ * @brief Task trace hooks, see BENCHMARK_TaskCountStart.
+ */
+void BENCHMARK_TraceTaskSwitchedIn( void );
+void BENCHMARK_TraceTaskSwitchedOut( void );
+void BENCHMARK_TraceQueueReceive( void );
+
+#endif /* _AWS_BENCHMARK_H_ */
@@ -59,6 +59,36 @@
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 /*-----------------------------------------------------------*/
 
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+    MQTTBool_t Test_prvStoreSubscription( MQTTContext_t * pxMQTTContext,
+                                          const uint8_t * const pucTopic,
+                                          uint16_t usTopicLength,
+                                          void * pvPublishCallbackContext,
+                                          MQTTPublishCallback_t pxPublishCallback )
+    {
+        return prvStoreSubscription( pxMQTTContext, pucTopic, usTopicLength, pvPublishCallbackContext, pxPublishCallback );
+    }
+/*-----------------------------------------------------------*/
+
+    void Test_prvRemoveSubscription( MQTTContext_t * pxMQTTContext,
+                                     const uint8_t * const pucTopic,
+                                     uint16_t usTopicLength )
+    {
+        prvRemoveSubscription( pxMQTTContext, pucTopic, usTopicLength );
+    }
+/*-----------------------------------------------------------*/
+
+    MQTTBool_t Test_prvInvokeSubscriptionCallbacks( MQTTContext_t * pxMQTTContext,
+                                                    const MQTTPublishData_t * pxPublishData,
+                                                    MQTTBool_t * pxSubscriptionCallbackInvoked )
+    {
+        return prvInvokeSubscriptionCallbacks( pxMQTTContext, pxPublishData, pxSubscriptionCallbackInvoked );
+    }
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+/*-----------------------------------------------------------*/
+
 void Test_prvResetMQTTContext( MQTTContext_t * pxMQTTContext )
 {
     prvResetMQTTContext( pxMQTTContext );
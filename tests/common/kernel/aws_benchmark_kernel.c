@@ -0,0 +1,747 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_benchmark_kernel.c
+ * @brief Context switch, queue and stream buffer benchmarks for the kernel.
+ *
+ * Each case is timed with and without a set of load tasks that share the
+ * priority of the tasks being measured, so the cost of round robin scheduling
+ * through tasks.c and queue.c is included in the loaded figures.
+ *
+ * The create and delete cases time a semaphore, a small queue and a timer
+ * created and deleted again, and report the heap each one takes, which is 0
+ * when the object comes from the pools of configSEMAPHORE_POOL_LENGTH,
+ * configQUEUE_POOL_LENGTH and configTIMER_POOL_LENGTH.
+ *
+ * The timer reset case times xTimerReset and xTimerStart against a growing
+ * number of active timers, which is flat with configUSE_TIMER_WHEEL and grows
+ * with the sorted timer lists. aws_test_timers.c checks that the timers
+ * expire on time.
+ *
+ * The timer command case resets a few timers in bursts from a task at the
+ * priority of the timer service task, as a protocol task resets its timers
+ * for each packet, and reports the messages the timer service task received
+ * and the time it ran, which configUSE_TIMER_COMMAND_COALESCING cuts down.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "timers.h"
+#include "stream_buffer.h"
+
+/* Benchmark framework includes. */
+#include "aws_benchmark.h"
+
+/* Unity framework includes. */
+#include "unity_fixture.h"
+
+/* Priority of all tasks created by the benchmarks.  The test runner task is
+ * raised to this priority for the duration of each case. */
+#ifndef benchmarkconfigKERNEL_TASK_PRIORITY
+    #define benchmarkconfigKERNEL_TASK_PRIORITY    ( tskIDLE_PRIORITY + 2 )
+#endif
+
+/* Number of load tasks created by the loaded variants of each case. */
+#ifndef benchmarkconfigKERNEL_LOAD_TASKS
+    #define benchmarkconfigKERNEL_LOAD_TASKS    ( 4 )
+#endif
+
+/* Largest number of active timers xTimerReset and xTimerStart are timed
+ * against. */
+#ifndef benchmarkconfigKERNEL_ACTIVE_TIMERS
+    #define benchmarkconfigKERNEL_ACTIVE_TIMERS    ( 2048 )
+#endif
+
+/* Number of timer commands sent by the timer command case. */
+#ifndef benchmarkconfigKERNEL_TIMER_COMMANDS
+    #define benchmarkconfigKERNEL_TIMER_COMMANDS    ( 4096 )
+#endif
+
+/* Total number of bytes sent through the stream buffer. */
+#ifndef benchmarkconfigKERNEL_STREAM_BYTES
+    #define benchmarkconfigKERNEL_STREAM_BYTES    ( 1024UL * 1024UL )
+#endif
+
+#define kernelbenchmarkGROUP                "Full_KERNEL_BENCHMARK"
+#define kernelbenchmarkSTACK_SIZE           ( configMINIMAL_STACK_SIZE * 4 )
+#define kernelbenchmarkLOAD_QUEUE_LENGTH    ( 4 )
+#define kernelbenchmarkSTREAM_BUFFER_SIZE   ( 1024 )
+#define kernelbenchmarkSTREAM_CHUNK_SIZE    ( 64 )
+#define kernelbenchmarkTIMEOUT              pdMS_TO_TICKS( 5000UL )
+#define kernelbenchmarkOBJECT_QUEUE_LENGTH  ( 4 )
+#define kernelbenchmarkOBJECTS              ( 8 )
+#define kernelbenchmarkTIMER_PERIOD         pdMS_TO_TICKS( 60000UL )
+#define kernelbenchmarkCOMMAND_TIMERS       ( 4 )
+#define kernelbenchmarkCOMMAND_BURST        ( 8 )
+
+/*-----------------------------------------------------------*/
+
+/* Samples of the case being run. */
+static uint32_t ulSamples[ benchmarkconfigITERATIONS ];
+
+/* The tasks created by each case. */
+static TaskHandle_t xRunnerTask = NULL;
+static TaskHandle_t xPeerTask = NULL;
+static TaskHandle_t xLoadTasks[ benchmarkconfigKERNEL_LOAD_TASKS ];
+static QueueHandle_t xLoadQueues[ benchmarkconfigKERNEL_LOAD_TASKS ];
+
+/* Queues used by the queue round trip case. */
+static QueueHandle_t xRequestQueue = NULL;
+static QueueHandle_t xResponseQueue = NULL;
+
+/* Stream buffer used by the stream buffer case. */
+static StreamBufferHandle_t xStreamBuffer = NULL;
+
+/* The kind of kernel object created and deleted by the create and delete
+ * cases. */
+typedef enum
+{
+    eKernelObjectSemaphore,
+    eKernelObjectQueue,
+    eKernelObjectTimer
+} KernelObject_t;
+
+/* Objects created by the create and delete cases, deleted by the tear down
+ * if a case fails half way. */
+static void * pvObjects[ kernelbenchmarkOBJECTS ];
+static KernelObject_t eObjectsKind;
+
+/* Timers created by the timer cases. */
+static TimerHandle_t xTimers[ benchmarkconfigKERNEL_ACTIVE_TIMERS ];
+static volatile uint32_t ulTimerCommandFailures;
+
+/* Priority of the test runner before the case started. */
+static UBaseType_t uxRunnerPriority;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Continuously pass an item through a private queue, yielding between each
+ * operation so it competes with the task being measured.
+ */
+static void prvLoadTask( void * pvParameters )
+{
+    QueueHandle_t xQueue = ( QueueHandle_t ) pvParameters;
+    uint32_t ulItem = 0;
+
+    for( ; ; )
+    {
+        ( void ) xQueueSend( xQueue, &ulItem, 0 );
+        taskYIELD();
+        ( void ) xQueueReceive( xQueue, &ulItem, 0 );
+        ulItem++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvStartLoad( void )
+{
+    UBaseType_t x;
+
+    for( x = 0; x < benchmarkconfigKERNEL_LOAD_TASKS; x++ )
+    {
+        xLoadQueues[ x ] = xQueueCreate( kernelbenchmarkLOAD_QUEUE_LENGTH, sizeof( uint32_t ) );
+        TEST_ASSERT_NOT_NULL( xLoadQueues[ x ] );
+
+        TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( prvLoadTask,
+                                                "BenchLoad",
+                                                kernelbenchmarkSTACK_SIZE,
+                                                xLoadQueues[ x ],
+                                                benchmarkconfigKERNEL_TASK_PRIORITY,
+                                                &( xLoadTasks[ x ] ) ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Wait to be notified by the runner, then notify it straight back.
+ */
+static void prvNotifyEchoTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        xTaskNotifyGive( xRunnerTask );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Wait for an item on the request queue and post it to the response queue.
+ */
+static void prvQueueEchoTask( void * pvParameters )
+{
+    uint32_t ulItem;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        if( xQueueReceive( xRequestQueue, &ulItem, portMAX_DELAY ) == pdPASS )
+        {
+            ( void ) xQueueSend( xResponseQueue, &ulItem, portMAX_DELAY );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Drain the stream buffer, notifying the runner once every byte sent has
+ * been received.
+ */
+static void prvStreamConsumerTask( void * pvParameters )
+{
+    uint8_t ucChunk[ kernelbenchmarkSTREAM_CHUNK_SIZE ];
+    uint32_t ulReceived = 0;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ulReceived += ( uint32_t ) xStreamBufferReceive( xStreamBuffer,
+                                                         ucChunk,
+                                                         sizeof( ucChunk ),
+                                                         portMAX_DELAY );
+
+        if( ulReceived >= benchmarkconfigKERNEL_STREAM_BYTES )
+        {
+            ulReceived = 0;
+            xTaskNotifyGive( xRunnerTask );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Reset the timers in bursts, then change the period of the first one and
+ * stop the second, and notify the runner.
+ */
+static void prvTimerCommandTask( void * pvParameters )
+{
+    uint32_t x;
+
+    ( void ) pvParameters;
+
+    for( x = 0; x < benchmarkconfigKERNEL_TIMER_COMMANDS; x++ )
+    {
+        if( xTimerReset( xTimers[ x % kernelbenchmarkCOMMAND_TIMERS ], kernelbenchmarkTIMEOUT ) != pdPASS )
+        {
+            ulTimerCommandFailures++;
+        }
+
+        /* The timer task shares this priority, so it only runs when this
+         * task yields or blocks on a full timer queue. */
+        if( ( x % kernelbenchmarkCOMMAND_BURST ) == ( kernelbenchmarkCOMMAND_BURST - 1 ) )
+        {
+            taskYIELD();
+        }
+    }
+
+    if( ( xTimerChangePeriod( xTimers[ 0 ], kernelbenchmarkTIMER_PERIOD * 2, kernelbenchmarkTIMEOUT ) != pdPASS ) ||
+        ( xTimerReset( xTimers[ 0 ], kernelbenchmarkTIMEOUT ) != pdPASS ) ||
+        ( xTimerStop( xTimers[ 1 ], kernelbenchmarkTIMEOUT ) != pdPASS ) )
+    {
+        ulTimerCommandFailures++;
+    }
+
+    xTaskNotifyGive( xRunnerTask );
+
+    for( ; ; )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvCreatePeer( TaskFunction_t pxPeerFunction )
+{
+    TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( pxPeerFunction,
+                                            "BenchPeer",
+                                            kernelbenchmarkSTACK_SIZE,
+                                            NULL,
+                                            benchmarkconfigKERNEL_TASK_PRIORITY,
+                                            &xPeerTask ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunContextSwitch( const char * pcCase )
+{
+    uint64_t ullStart;
+    uint32_t x;
+
+    prvCreatePeer( prvNotifyEchoTask );
+
+    for( x = 0; x < benchmarkconfigITERATIONS; x++ )
+    {
+        ullStart = benchmarkconfigGET_TIME_NS();
+        xTaskNotifyGive( xPeerTask );
+        TEST_ASSERT_EQUAL( 1, ulTaskNotifyTake( pdTRUE, kernelbenchmarkTIMEOUT ) );
+
+        /* Each round trip is two context switches. */
+        ulSamples[ x ] = ( uint32_t ) ( ( benchmarkconfigGET_TIME_NS() - ullStart ) / 2ULL );
+    }
+
+    BENCHMARK_ReportSamples( kernelbenchmarkGROUP, pcCase, ulSamples, benchmarkconfigITERATIONS, "ns" );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunQueueRoundTrip( const char * pcCase )
+{
+    uint64_t ullStart;
+    uint32_t x, ulItem;
+
+    xRequestQueue = xQueueCreate( 1, sizeof( uint32_t ) );
+    xResponseQueue = xQueueCreate( 1, sizeof( uint32_t ) );
+    TEST_ASSERT_NOT_NULL( xRequestQueue );
+    TEST_ASSERT_NOT_NULL( xResponseQueue );
+
+    prvCreatePeer( prvQueueEchoTask );
+
+    for( x = 0; x < benchmarkconfigITERATIONS; x++ )
+    {
+        ullStart = benchmarkconfigGET_TIME_NS();
+        TEST_ASSERT_EQUAL( pdPASS, xQueueSend( xRequestQueue, &x, kernelbenchmarkTIMEOUT ) );
+        TEST_ASSERT_EQUAL( pdPASS, xQueueReceive( xResponseQueue, &ulItem, kernelbenchmarkTIMEOUT ) );
+        ulSamples[ x ] = ( uint32_t ) ( benchmarkconfigGET_TIME_NS() - ullStart );
+
+        TEST_ASSERT_EQUAL_UINT32( x, ulItem );
+    }
+
+    BENCHMARK_ReportSamples( kernelbenchmarkGROUP, pcCase, ulSamples, benchmarkconfigITERATIONS, "ns" );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunStreamBuffer( const char * pcCase )
+{
+    uint8_t ucChunk[ kernelbenchmarkSTREAM_CHUNK_SIZE ];
+    uint64_t ullStart, ullElapsed;
+    uint32_t ulSent = 0;
+
+    memset( ucChunk, 0xA5, sizeof( ucChunk ) );
+
+    xStreamBuffer = xStreamBufferCreate( kernelbenchmarkSTREAM_BUFFER_SIZE, kernelbenchmarkSTREAM_CHUNK_SIZE );
+    TEST_ASSERT_NOT_NULL( xStreamBuffer );
+
+    prvCreatePeer( prvStreamConsumerTask );
+
+    ullStart = benchmarkconfigGET_TIME_NS();
+
+    while( ulSent < benchmarkconfigKERNEL_STREAM_BYTES )
+    {
+        ulSent += ( uint32_t ) xStreamBufferSend( xStreamBuffer,
+                                                  ucChunk,
+                                                  sizeof( ucChunk ),
+                                                  kernelbenchmarkTIMEOUT );
+    }
+
+    TEST_ASSERT_EQUAL( 1, ulTaskNotifyTake( pdTRUE, kernelbenchmarkTIMEOUT ) );
+    ullElapsed = benchmarkconfigGET_TIME_NS() - ullStart;
+
+    BENCHMARK_Report( kernelbenchmarkGROUP, pcCase, "elapsed", ullElapsed, "ns" );
+
+    if( ullElapsed > 0 )
+    {
+        BENCHMARK_Report( kernelbenchmarkGROUP,
+                          pcCase,
+                          "throughput",
+                          ( ( uint64_t ) ulSent * 1000000000ULL ) / ullElapsed,
+                          "bytes_per_sec" );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvTimerCallback( TimerHandle_t xTimer )
+{
+    ( void ) xTimer;
+}
+/*-----------------------------------------------------------*/
+
+static void * prvCreateObject( KernelObject_t eKind )
+{
+    void * pvObject = NULL;
+
+    switch( eKind )
+    {
+        case eKernelObjectSemaphore:
+            pvObject = xSemaphoreCreateBinary();
+            break;
+
+        case eKernelObjectQueue:
+            pvObject = xQueueCreate( kernelbenchmarkOBJECT_QUEUE_LENGTH, sizeof( uint32_t ) );
+            break;
+
+        case eKernelObjectTimer:
+            pvObject = xTimerCreate( "BenchTimer", pdMS_TO_TICKS( 1000UL ), pdFALSE, NULL, prvTimerCallback );
+            break;
+    }
+
+    return pvObject;
+}
+/*-----------------------------------------------------------*/
+
+static void prvDeleteObject( KernelObject_t eKind,
+                             void * pvObject )
+{
+    if( eKind == eKernelObjectTimer )
+    {
+        /* The timer task runs at a higher priority, so the timer is freed
+         * before this returns. */
+        TEST_ASSERT_EQUAL( pdPASS, xTimerDelete( ( TimerHandle_t ) pvObject, kernelbenchmarkTIMEOUT ) );
+    }
+    else
+    {
+        vQueueDelete( ( QueueHandle_t ) pvObject );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunCreateDelete( const char * pcCase,
+                                KernelObject_t eKind )
+{
+    uint64_t ullStart;
+    int32_t lInUse, lPeak;
+    uint32_t x;
+
+    eObjectsKind = eKind;
+
+    /* Heap taken by each object, while kernelbenchmarkOBJECTS of them are
+     * alive.  The timer task frees timers, so only the peak is meaningful. */
+    BENCHMARK_HeapCountStart( xRunnerTask );
+
+    for( x = 0; x < kernelbenchmarkOBJECTS; x++ )
+    {
+        pvObjects[ x ] = prvCreateObject( eKind );
+        TEST_ASSERT_NOT_NULL( pvObjects[ x ] );
+    }
+
+    BENCHMARK_HeapCountGet( &lInUse, &lPeak );
+    BENCHMARK_HeapCountStart( NULL );
+
+    for( x = 0; x < kernelbenchmarkOBJECTS; x++ )
+    {
+        prvDeleteObject( eKind, pvObjects[ x ] );
+        pvObjects[ x ] = NULL;
+    }
+
+    BENCHMARK_Report( kernelbenchmarkGROUP,
+                      pcCase,
+                      "heap_per_object",
+                      ( uint64_t ) ( lPeak / kernelbenchmarkOBJECTS ),
+                      "bytes" );
+
+    for( x = 0; x < benchmarkconfigITERATIONS; x++ )
+    {
+        ullStart = benchmarkconfigGET_TIME_NS();
+        pvObjects[ 0 ] = prvCreateObject( eKind );
+        TEST_ASSERT_NOT_NULL( pvObjects[ 0 ] );
+        prvDeleteObject( eKind, pvObjects[ 0 ] );
+        pvObjects[ 0 ] = NULL;
+        ulSamples[ x ] = ( uint32_t ) ( benchmarkconfigGET_TIME_NS() - ullStart );
+    }
+
+    BENCHMARK_ReportSamples( kernelbenchmarkGROUP, pcCase, ulSamples, benchmarkconfigITERATIONS, "ns" );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunTimerReset( uint32_t ulActiveTimers )
+{
+    TimerHandle_t xLastTimer;
+    char cCase[ 32 ];
+    uint64_t ullStart;
+    uint32_t x;
+
+    /* Each timer expires after the ones created before it, so on a sorted
+     * list the last one is filed at the end. */
+    for( x = 0; x < ulActiveTimers; x++ )
+    {
+        if( xTimers[ x ] == NULL )
+        {
+            xTimers[ x ] = xTimerCreate( "BenchTimer", kernelbenchmarkTIMER_PERIOD + x, pdFALSE, ( void * ) ( size_t ) x, prvTimerCallback );
+            TEST_ASSERT_NOT_NULL( xTimers[ x ] );
+            TEST_ASSERT_EQUAL( pdPASS, xTimerStart( xTimers[ x ], kernelbenchmarkTIMEOUT ) );
+        }
+    }
+
+    xLastTimer = xTimers[ ulActiveTimers - 1 ];
+
+    /* The timer task runs at a higher priority, so each command is processed
+     * before the call returns. */
+    for( x = 0; x < benchmarkconfigITERATIONS; x++ )
+    {
+        ullStart = benchmarkconfigGET_TIME_NS();
+        TEST_ASSERT_EQUAL( pdPASS, xTimerReset( xLastTimer, kernelbenchmarkTIMEOUT ) );
+        ulSamples[ x ] = ( uint32_t ) ( benchmarkconfigGET_TIME_NS() - ullStart );
+    }
+
+    ( void ) snprintf( cCase, sizeof( cCase ), "TimerReset%lu", ( unsigned long ) ulActiveTimers );
+    BENCHMARK_ReportSamples( kernelbenchmarkGROUP, cCase, ulSamples, benchmarkconfigITERATIONS, "ns" );
+
+    for( x = 0; x < benchmarkconfigITERATIONS; x++ )
+    {
+        TEST_ASSERT_EQUAL( pdPASS, xTimerStop( xLastTimer, kernelbenchmarkTIMEOUT ) );
+        ullStart = benchmarkconfigGET_TIME_NS();
+        TEST_ASSERT_EQUAL( pdPASS, xTimerStart( xLastTimer, kernelbenchmarkTIMEOUT ) );
+        ulSamples[ x ] = ( uint32_t ) ( benchmarkconfigGET_TIME_NS() - ullStart );
+    }
+
+    ( void ) snprintf( cCase, sizeof( cCase ), "TimerStart%lu", ( unsigned long ) ulActiveTimers );
+    BENCHMARK_ReportSamples( kernelbenchmarkGROUP, cCase, ulSamples, benchmarkconfigITERATIONS, "ns" );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunTimerCommands( void )
+{
+    const uint32_t ulCommands = benchmarkconfigKERNEL_TIMER_COMMANDS + 3;
+    uint32_t ulSwitchedIn, ulQueueReceives, x;
+    uint64_t ullStart, ullElapsed, ullRunTimeNs;
+
+    for( x = 0; x < kernelbenchmarkCOMMAND_TIMERS; x++ )
+    {
+        xTimers[ x ] = xTimerCreate( "BenchTimer", kernelbenchmarkTIMER_PERIOD, pdFALSE, ( void * ) ( size_t ) x, prvTimerCallback );
+        TEST_ASSERT_NOT_NULL( xTimers[ x ] );
+        TEST_ASSERT_EQUAL( pdPASS, xTimerStart( xTimers[ x ], kernelbenchmarkTIMEOUT ) );
+    }
+
+    ulTimerCommandFailures = 0;
+    BENCHMARK_TaskCountStart( xTimerGetTimerDaemonTaskHandle() );
+    ullStart = benchmarkconfigGET_TIME_NS();
+
+    TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( prvTimerCommandTask,
+                                            "BenchTmrCmd",
+                                            kernelbenchmarkSTACK_SIZE,
+                                            NULL,
+                                            configTIMER_TASK_PRIORITY,
+                                            &xPeerTask ) );
+
+    /* The timer task runs before this task once the sender blocks, so every
+     * command has been processed when the notification is taken. */
+    TEST_ASSERT_EQUAL( 1, ulTaskNotifyTake( pdTRUE, kernelbenchmarkTIMEOUT ) );
+    ullElapsed = benchmarkconfigGET_TIME_NS() - ullStart;
+    BENCHMARK_TaskCountGet( &ulSwitchedIn, &ulQueueReceives, &ullRunTimeNs );
+
+    TEST_ASSERT_EQUAL_UINT32( 0, ulTimerCommandFailures );
+    TEST_ASSERT_TRUE( xTimerIsTimerActive( xTimers[ 0 ] ) != pdFALSE );
+    TEST_ASSERT_EQUAL_UINT32( kernelbenchmarkTIMER_PERIOD * 2, xTimerGetPeriod( xTimers[ 0 ] ) );
+    TEST_ASSERT_TRUE( xTimerIsTimerActive( xTimers[ 1 ] ) == pdFALSE );
+    TEST_ASSERT_TRUE( xTimerIsTimerActive( xTimers[ 2 ] ) != pdFALSE );
+
+    BENCHMARK_Report( kernelbenchmarkGROUP, "TimerCommands", "queue_messages", ulQueueReceives, "messages" );
+    BENCHMARK_Report( kernelbenchmarkGROUP, "TimerCommands", "timer_task_switches", ulSwitchedIn, "switches" );
+    BENCHMARK_Report( kernelbenchmarkGROUP, "TimerCommands", "timer_task_time_per_command", ullRunTimeNs / ulCommands, "ns" );
+    BENCHMARK_Report( kernelbenchmarkGROUP, "TimerCommands", "time_per_command", ullElapsed / ulCommands, "ns" );
+}
+/*-----------------------------------------------------------*/
+
+TEST_GROUP( Full_KERNEL_BENCHMARK );
+
+/*-----------------------------------------------------------*/
+
+TEST_SETUP( Full_KERNEL_BENCHMARK )
+{
+    xRunnerTask = xTaskGetCurrentTaskHandle();
+    uxRunnerPriority = uxTaskPriorityGet( NULL );
+    vTaskPrioritySet( NULL, benchmarkconfigKERNEL_TASK_PRIORITY );
+
+    xPeerTask = NULL;
+    memset( xLoadTasks, 0x00, sizeof( xLoadTasks ) );
+    memset( xLoadQueues, 0x00, sizeof( xLoadQueues ) );
+    memset( pvObjects, 0x00, sizeof( pvObjects ) );
+    memset( xTimers, 0x00, sizeof( xTimers ) );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST_TEAR_DOWN( Full_KERNEL_BENCHMARK )
+{
+    UBaseType_t x;
+
+    for( x = 0; x < benchmarkconfigKERNEL_LOAD_TASKS; x++ )
+    {
+        if( xLoadTasks[ x ] != NULL )
+        {
+            vTaskDelete( xLoadTasks[ x ] );
+        }
+
+        if( xLoadQueues[ x ] != NULL )
+        {
+            vQueueDelete( xLoadQueues[ x ] );
+        }
+    }
+
+    for( x = 0; x < kernelbenchmarkOBJECTS; x++ )
+    {
+        if( pvObjects[ x ] != NULL )
+        {
+            prvDeleteObject( eObjectsKind, pvObjects[ x ] );
+        }
+    }
+
+    for( x = 0; x < benchmarkconfigKERNEL_ACTIVE_TIMERS; x++ )
+    {
+        if( xTimers[ x ] != NULL )
+        {
+            ( void ) xTimerDelete( xTimers[ x ], kernelbenchmarkTIMEOUT );
+        }
+    }
+
+    if( xPeerTask != NULL )
+    {
+        vTaskDelete( xPeerTask );
+    }
+
+    if( xRequestQueue != NULL )
+    {
+        vQueueDelete( xRequestQueue );
+        xRequestQueue = NULL;
+    }
+
+    if( xResponseQueue != NULL )
+    {
+        vQueueDelete( xResponseQueue );
+        xResponseQueue = NULL;
+    }
+
+    if( xStreamBuffer != NULL )
+    {
+        vStreamBufferDelete( xStreamBuffer );
+        xStreamBuffer = NULL;
+    }
+
+    vTaskPrioritySet( NULL, uxRunnerPriority );
+
+    /* Let the idle task free the deleted tasks. */
+    vTaskDelay( pdMS_TO_TICKS( 10UL ) );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST_GROUP_RUNNER( Full_KERNEL_BENCHMARK )
+{
+    RUN_TEST_CASE( Full_KERNEL_BENCHMARK, ContextSwitch );
+    RUN_TEST_CASE( Full_KERNEL_BENCHMARK, ContextSwitchLoaded );
+    RUN_TEST_CASE( Full_KERNEL_BENCHMARK, QueueRoundTrip );
+    RUN_TEST_CASE( Full_KERNEL_BENCHMARK, QueueRoundTripLoaded );
+    RUN_TEST_CASE( Full_KERNEL_BENCHMARK, StreamBuffer );
+    RUN_TEST_CASE( Full_KERNEL_BENCHMARK, StreamBufferLoaded );
+    RUN_TEST_CASE( Full_KERNEL_BENCHMARK, SemaphoreCreateDelete );
+    RUN_TEST_CASE( Full_KERNEL_BENCHMARK, QueueCreateDelete );
+    RUN_TEST_CASE( Full_KERNEL_BENCHMARK, TimerCreateDelete );
+    RUN_TEST_CASE( Full_KERNEL_BENCHMARK, TimerReset );
+    RUN_TEST_CASE( Full_KERNEL_BENCHMARK, TimerCommands );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_KERNEL_BENCHMARK, ContextSwitch )
+{
+    prvRunContextSwitch( "ContextSwitch" );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_KERNEL_BENCHMARK, ContextSwitchLoaded )
+{
+    prvStartLoad();
+    prvRunContextSwitch( "ContextSwitchLoaded" );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_KERNEL_BENCHMARK, QueueRoundTrip )
+{
+    prvRunQueueRoundTrip( "QueueRoundTrip" );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_KERNEL_BENCHMARK, QueueRoundTripLoaded )
+{
+    prvStartLoad();
+    prvRunQueueRoundTrip( "QueueRoundTripLoaded" );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_KERNEL_BENCHMARK, StreamBuffer )
+{
+    prvRunStreamBuffer( "StreamBuffer" );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_KERNEL_BENCHMARK, StreamBufferLoaded )
+{
+    prvStartLoad();
+    prvRunStreamBuffer( "StreamBufferLoaded" );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_KERNEL_BENCHMARK, SemaphoreCreateDelete )
+{
+    prvRunCreateDelete( "SemaphoreCreateDelete", eKernelObjectSemaphore );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_KERNEL_BENCHMARK, QueueCreateDelete )
+{
+    prvRunCreateDelete( "QueueCreateDelete", eKernelObjectQueue );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_KERNEL_BENCHMARK, TimerCreateDelete )
+{
+    prvRunCreateDelete( "TimerCreateDelete", eKernelObjectTimer );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_KERNEL_BENCHMARK, TimerReset )
+{
+    /* The timers of each count are kept active for the next. */
+    prvRunTimerReset( 1 );
+    prvRunTimerReset( benchmarkconfigKERNEL_ACTIVE_TIMERS / 64 );
+    prvRunTimerReset( benchmarkconfigKERNEL_ACTIVE_TIMERS / 8 );
+    prvRunTimerReset( benchmarkconfigKERNEL_ACTIVE_TIMERS );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_KERNEL_BENCHMARK, TimerCommands )
+{
+    prvRunTimerCommands();
+}
@@ -0,0 +1,536 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_test_heap_6.c
+ * @brief Tests for the TLSF heap of heap_6.c.
+ *
+ * The tests build a private copy of heap_6.c over regions of their own, so
+ * they run whichever heap the application uses, and can exhaust the heap and
+ * define its regions again for each test.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Unity framework includes. */
+#include "unity_fixture.h"
+
+/* The private copy of the heap has its own names, does not call the malloc
+ * failed hook when it is exhausted, and is not recorded by the heap trace. */
+#define pvPortMalloc                       pvTestHeapMalloc
+#define vPortFree                          vTestHeapFree
+#define xPortGetFreeHeapSize               xTestHeapGetFreeHeapSize
+#define xPortGetMinimumEverFreeHeapSize    xTestHeapGetMinimumEverFreeHeapSize
+#define vPortInitialiseBlocks              vTestHeapInitialiseBlocks
+#define uxPortGetHeapClassStats            uxTestHeapGetHeapClassStats
+#define vPortDefineHeapRegions             vTestHeapDefineHeapRegions
+
+#undef configUSE_MALLOC_FAILED_HOOK
+#define configUSE_MALLOC_FAILED_HOOK       0
+#undef traceMALLOC
+#define traceMALLOC( pvAddress, uiSize )
+#undef traceFREE
+#define traceFREE( pvAddress, uiSize )
+
+#include "../../../lib/FreeRTOS/portable/MemMang/heap_6.c"
+
+#define testheap6REGION_SIZE      ( ( size_t ) 64U * 1024U )
+#define testheap6HEAP_SIZE        ( testheap6REGION_SIZE * 2U )
+#define testheap6BLOCKS           ( 512 )
+#define testheap6SMALL_REQUEST    ( ( size_t ) 100U )
+/*-----------------------------------------------------------*/
+
+/* The memory of the regions, from an aligned address so that the tests know
+ * where each block is, and the blocks allocated by a test. */
+static uint8_t ucHeapMemory[ testheap6HEAP_SIZE + portBYTE_ALIGNMENT ];
+static uint8_t * pucHeap = NULL;
+static void * pvBlocks[ testheap6BLOCKS ];
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Empties the private heap, and defines its regions again.
+ *
+ * @param[in] pxHeapRegions The regions, terminated by a region of size 0.
+ */
+static void prvDefineRegions( const HeapRegion_t * pxHeapRegions );
+
+/**
+ * @brief Defines the whole of the test memory as a single region.
+ */
+static void prvDefineSingleRegion( void );
+
+/**
+ * @brief Returns the size of the block that a request takes, header
+ * included.
+ *
+ * @param[in] xWantedSize The size requested.
+ */
+static size_t prvBlockSize( size_t xWantedSize );
+
+/**
+ * @brief Returns the first level class of a block size, worked out without
+ * the bit scans of the heap.
+ *
+ * @param[in] xBlockSize The size of the block, header included.
+ */
+static UBaseType_t prvClassOf( size_t xBlockSize );
+
+/**
+ * @brief Returns the smallest size of the free list a block belongs to.
+ *
+ * A request is served from a list whose blocks are all large enough, so this
+ * is the largest block that a free block of xBlockSize is sure to serve.
+ *
+ * @param[in] xBlockSize The size of the free block, header included.
+ */
+static size_t prvListFloor( size_t xBlockSize );
+
+/**
+ * @brief Returns the size of the block that holds memory returned by
+ * pvPortMalloc().
+ *
+ * @param[in] pv The memory.
+ */
+static size_t prvAllocatedBlockSize( const void * pv );
+
+/**
+ * @brief Returns the number of free blocks of every class.
+ */
+static size_t prvFreeBlockCount( void );
+/*-----------------------------------------------------------*/
+
+static void prvDefineRegions( const HeapRegion_t * pxHeapRegions )
+{
+    memset( pxFreeLists, 0x00, sizeof( pxFreeLists ) );
+    memset( ulSecondLevelBitmaps, 0x00, sizeof( ulSecondLevelBitmaps ) );
+    memset( xClassStats, 0x00, sizeof( xClassStats ) );
+    ulFirstLevelBitmap = 0U;
+    xFreeBytesRemaining = 0U;
+    xMinimumEverFreeBytesRemaining = 0U;
+    xBlockAllocatedBit = 0U;
+
+    vPortDefineHeapRegions( pxHeapRegions );
+}
+/*-----------------------------------------------------------*/
+
+static void prvDefineSingleRegion( void )
+{
+    const HeapRegion_t xHeapRegions[] =
+    {
+        { pucHeap, testheap6HEAP_SIZE },
+        { NULL,    0                  }
+    };
+
+    prvDefineRegions( xHeapRegions );
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvBlockSize( size_t xWantedSize )
+{
+    size_t xBlockSize = xWantedSize + xHeapStructSize;
+
+    xBlockSize = ( xBlockSize + portBYTE_ALIGNMENT - 1U ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+    if( xBlockSize < xMinimumBlockSize )
+    {
+        xBlockSize = xMinimumBlockSize;
+    }
+
+    return xBlockSize;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvClassOf( size_t xBlockSize )
+{
+    UBaseType_t uxClass = 0;
+
+    while( xBlockSize >= heapSMALL_BLOCK_SIZE )
+    {
+        xBlockSize >>= 1;
+        uxClass++;
+    }
+
+    return uxClass;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvListFloor( size_t xBlockSize )
+{
+    size_t xStep = 1U;
+
+    if( xBlockSize >= heapSMALL_BLOCK_SIZE )
+    {
+        while( ( xBlockSize >> heapSL_INDEX_COUNT_LOG2 ) >= ( xStep << 1 ) )
+        {
+            xStep <<= 1;
+        }
+
+        xBlockSize &= ~( xStep - 1U );
+    }
+
+    return xBlockSize;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvAllocatedBlockSize( const void * pv )
+{
+    const BlockHeader_t * pxBlock = ( const void * ) ( ( ( const uint8_t * ) pv ) - xHeapStructSize );
+
+    return pxBlock->xBlockSize & ~xBlockAllocatedBit;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvFreeBlockCount( void )
+{
+    HeapClassStats_t xStats[ heapFL_INDEX_COUNT ];
+    UBaseType_t uxClass;
+    size_t xCount = 0;
+
+    ( void ) uxPortGetHeapClassStats( xStats, heapFL_INDEX_COUNT );
+
+    for( uxClass = 0; uxClass < heapFL_INDEX_COUNT; uxClass++ )
+    {
+        xCount += xStats[ uxClass ].xFreeBlocks;
+    }
+
+    return xCount;
+}
+/*-----------------------------------------------------------*/
+
+TEST_GROUP( Full_HEAP_6 );
+
+TEST_SETUP( Full_HEAP_6 )
+{
+    pucHeap = ( uint8_t * ) ( ( ( size_t ) ucHeapMemory + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) );
+    memset( pvBlocks, 0x00, sizeof( pvBlocks ) );
+}
+
+TEST_TEAR_DOWN( Full_HEAP_6 )
+{
+}
+
+TEST_GROUP_RUNNER( Full_HEAP_6 )
+{
+    RUN_TEST_CASE( Full_HEAP_6, ClassBoundaries );
+    RUN_TEST_CASE( Full_HEAP_6, FreeOrders );
+    RUN_TEST_CASE( Full_HEAP_6, ExhaustionAndRecovery );
+    RUN_TEST_CASE( Full_HEAP_6, MultipleRegions );
+    RUN_TEST_CASE( Full_HEAP_6, ClassStats );
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_HEAP_6, ClassBoundaries )
+{
+    HeapClassStats_t xBefore[ heapFL_INDEX_COUNT ];
+    HeapClassStats_t xAfter[ heapFL_INDEX_COUNT ];
+    size_t xInitialFree, xBoundary;
+    UBaseType_t uxClass;
+    void * pvAtBoundary;
+    void * pvBelowBoundary;
+
+    prvDefineSingleRegion();
+    xInitialFree = xPortGetFreeHeapSize();
+
+    /* The smallest block, and requests the heap cannot take. */
+    pvBlocks[ 0 ] = pvPortMalloc( 1 );
+    TEST_ASSERT_NOT_NULL( pvBlocks[ 0 ] );
+    TEST_ASSERT_EQUAL( xMinimumBlockSize, prvAllocatedBlockSize( pvBlocks[ 0 ] ) );
+    TEST_ASSERT_NULL( pvPortMalloc( 0 ) );
+    TEST_ASSERT_NULL( pvPortMalloc( heapMAXIMUM_BLOCK_SIZE ) );
+    TEST_ASSERT_NULL( pvPortMalloc( ( size_t ) -1 ) );
+    vPortFree( pvBlocks[ 0 ] );
+
+    /* A block of the smallest size of each class, and a block just below
+     * it, which belongs to the class below. */
+    for( uxClass = 1; ( ( size_t ) 1 << ( uxClass + heapFL_INDEX_SHIFT - 1U ) ) <= ( testheap6HEAP_SIZE / 4U ); uxClass++ )
+    {
+        xBoundary = ( size_t ) 1 << ( uxClass + heapFL_INDEX_SHIFT - 1U );
+        ( void ) uxPortGetHeapClassStats( xBefore, heapFL_INDEX_COUNT );
+        TEST_ASSERT_EQUAL( xBoundary, xBefore[ uxClass ].xMinimumBlockSize );
+
+        pvAtBoundary = pvPortMalloc( xBoundary - xHeapStructSize );
+        pvBelowBoundary = pvPortMalloc( xBoundary - xHeapStructSize - portBYTE_ALIGNMENT );
+        TEST_ASSERT_NOT_NULL( pvAtBoundary );
+        TEST_ASSERT_NOT_NULL( pvBelowBoundary );
+        TEST_ASSERT_EQUAL( 0, ( ( size_t ) pvAtBoundary ) & portBYTE_ALIGNMENT_MASK );
+        TEST_ASSERT_EQUAL( xBoundary, prvAllocatedBlockSize( pvAtBoundary ) );
+        TEST_ASSERT_EQUAL( xBoundary - portBYTE_ALIGNMENT, prvAllocatedBlockSize( pvBelowBoundary ) );
+
+        ( void ) uxPortGetHeapClassStats( xAfter, heapFL_INDEX_COUNT );
+        TEST_ASSERT_EQUAL( xBefore[ uxClass ].xAllocations + 1U, xAfter[ uxClass ].xAllocations );
+        TEST_ASSERT_EQUAL( xBefore[ uxClass - 1U ].xAllocations + 1U, xAfter[ uxClass - 1U ].xAllocations );
+
+        /* The free block of exactly the boundary size is taken again, rather
+         * than the larger block above. */
+        vPortFree( pvAtBoundary );
+        TEST_ASSERT_EQUAL_PTR( pvAtBoundary, pvPortMalloc( xBoundary - xHeapStructSize ) );
+
+        vPortFree( pvBelowBoundary );
+        vPortFree( pvAtBoundary );
+        TEST_ASSERT_EQUAL( xInitialFree, xPortGetFreeHeapSize() );
+        TEST_ASSERT_EQUAL( 1, prvFreeBlockCount() );
+    }
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_HEAP_6, FreeOrders )
+{
+    /* Each order of freeing three neighbours, by index. */
+    static const uint8_t ucOrders[ 6 ][ 3 ] =
+    {
+        { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 }
+    };
+    size_t xInitialFree, xBlockSize, xExpectedFreeBlocks;
+    BaseType_t xFreed[ 3 ];
+    uint32_t ulOrder, ulStep, x;
+
+    xBlockSize = prvBlockSize( testheap6SMALL_REQUEST );
+
+    for( ulOrder = 0; ulOrder < 6; ulOrder++ )
+    {
+        prvDefineSingleRegion();
+        xInitialFree = xPortGetFreeHeapSize();
+
+        /* Three neighbours, the first at the bottom of the region, and a
+         * fourth block that keeps the third from the free remainder. */
+        for( x = 0; x < 4; x++ )
+        {
+            pvBlocks[ x ] = pvPortMalloc( testheap6SMALL_REQUEST );
+            TEST_ASSERT_NOT_NULL( pvBlocks[ x ] );
+            TEST_ASSERT_EQUAL_PTR( pucHeap + xHeapStructSize + ( x * xBlockSize ), pvBlocks[ x ] );
+        }
+
+        TEST_ASSERT_EQUAL( 1, prvFreeBlockCount() );
+        memset( xFreed, 0x00, sizeof( xFreed ) );
+
+        for( ulStep = 0; ulStep < 3; ulStep++ )
+        {
+            vPortFree( pvBlocks[ ucOrders[ ulOrder ][ ulStep ] ] );
+            xFreed[ ucOrders[ ulOrder ][ ulStep ] ] = pdTRUE;
+
+            /* Neighbours freed are merged, so there is a free block per run
+             * of them, and the remainder. */
+            xExpectedFreeBlocks = 1;
+
+            for( x = 0; x < 3; x++ )
+            {
+                if( ( xFreed[ x ] == pdTRUE ) && ( ( x == 0 ) || ( xFreed[ x - 1 ] == pdFALSE ) ) )
+                {
+                    xExpectedFreeBlocks++;
+                }
+            }
+
+            TEST_ASSERT_EQUAL( xExpectedFreeBlocks, prvFreeBlockCount() );
+            TEST_ASSERT_EQUAL( xInitialFree - ( ( 3U - ( ulStep + 1U ) ) + 1U ) * xBlockSize, xPortGetFreeHeapSize() );
+        }
+
+        /* The three merged into one block, which serves a request larger
+         * than two of them. */
+        pvBlocks[ 0 ] = pvPortMalloc( prvListFloor( 3 * xBlockSize ) - xHeapStructSize );
+        TEST_ASSERT_EQUAL_PTR( pucHeap + xHeapStructSize, pvBlocks[ 0 ] );
+        vPortFree( pvBlocks[ 0 ] );
+
+        /* The fourth merges with both sides. */
+        vPortFree( pvBlocks[ 3 ] );
+        TEST_ASSERT_EQUAL( 1, prvFreeBlockCount() );
+        TEST_ASSERT_EQUAL( xInitialFree, xPortGetFreeHeapSize() );
+    }
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_HEAP_6, ExhaustionAndRecovery )
+{
+    /* A block size at the bottom of its list, so that a free block of the
+     * size is always found. */
+    const size_t xBlockSize = 1024U;
+    size_t xInitialFree;
+    uint32_t ulCount, x;
+
+    prvDefineSingleRegion();
+    xInitialFree = xPortGetFreeHeapSize();
+
+    for( ulCount = 0; ulCount < testheap6BLOCKS; ulCount++ )
+    {
+        pvBlocks[ ulCount ] = pvPortMalloc( xBlockSize - xHeapStructSize );
+
+        if( pvBlocks[ ulCount ] == NULL )
+        {
+            break;
+        }
+    }
+
+    TEST_ASSERT_EQUAL( xInitialFree / xBlockSize, ulCount );
+    TEST_ASSERT_EQUAL( xInitialFree % xBlockSize, xPortGetFreeHeapSize() );
+    TEST_ASSERT_EQUAL( xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize() );
+
+    /* Every other block, which leaves holes of one block. */
+    for( x = 0; x < ulCount; x += 2 )
+    {
+        vPortFree( pvBlocks[ x ] );
+    }
+
+    TEST_ASSERT_NULL( pvPortMalloc( ( 2U * xBlockSize ) - xHeapStructSize ) );
+    pvBlocks[ 0 ] = pvPortMalloc( xBlockSize - xHeapStructSize );
+    TEST_ASSERT_NOT_NULL( pvBlocks[ 0 ] );
+
+    /* Then the rest, which merges them all again. */
+    for( x = 0; x < ulCount; x++ )
+    {
+        if( ( ( x % 2U ) == 1U ) || ( x == 0U ) )
+        {
+            vPortFree( pvBlocks[ x ] );
+        }
+    }
+
+    TEST_ASSERT_EQUAL( xInitialFree, xPortGetFreeHeapSize() );
+    TEST_ASSERT_EQUAL( 1, prvFreeBlockCount() );
+
+    /* The region serves the largest block its list is sure to hold. */
+    pvBlocks[ 0 ] = pvPortMalloc( prvListFloor( xInitialFree ) - xHeapStructSize );
+    TEST_ASSERT_EQUAL_PTR( pucHeap + xHeapStructSize, pvBlocks[ 0 ] );
+    vPortFree( pvBlocks[ 0 ] );
+    TEST_ASSERT_EQUAL( xInitialFree, xPortGetFreeHeapSize() );
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_HEAP_6, MultipleRegions )
+{
+    /* A large region and two small ones, with gaps between them, and not in
+     * address order. */
+    const size_t xSmallRegionSize = testheap6REGION_SIZE / 4U;
+    const HeapRegion_t xHeapRegions[] =
+    {
+        { pucHeap + testheap6REGION_SIZE,          testheap6REGION_SIZE },
+        { pucHeap,                                 xSmallRegionSize     },
+        { pucHeap + ( testheap6REGION_SIZE / 2U ), xSmallRegionSize     },
+        { NULL,                                    0                    }
+    };
+    size_t xInitialFree, xLargeBlock, xSmallBlock;
+
+    prvDefineRegions( xHeapRegions );
+    xInitialFree = xPortGetFreeHeapSize();
+
+    /* A free block per region, each region keeping an end marker. */
+    TEST_ASSERT_EQUAL( 3, prvFreeBlockCount() );
+    TEST_ASSERT_EQUAL( testheap6REGION_SIZE + ( 2U * xSmallRegionSize ) - ( 3U * xHeapStructSize ), xInitialFree );
+
+    /* The block larger than the small regions comes from the large one. */
+    xLargeBlock = prvListFloor( testheap6REGION_SIZE - xHeapStructSize );
+    pvBlocks[ 0 ] = pvPortMalloc( xLargeBlock - xHeapStructSize );
+    TEST_ASSERT_EQUAL_PTR( pucHeap + testheap6REGION_SIZE + xHeapStructSize, pvBlocks[ 0 ] );
+
+    /* The small regions serve a block each, and nothing larger. */
+    xSmallBlock = prvListFloor( xSmallRegionSize - xHeapStructSize );
+    TEST_ASSERT_NULL( pvPortMalloc( xSmallRegionSize ) );
+    pvBlocks[ 1 ] = pvPortMalloc( xSmallBlock - xHeapStructSize );
+    pvBlocks[ 2 ] = pvPortMalloc( xSmallBlock - xHeapStructSize );
+    TEST_ASSERT_NOT_NULL( pvBlocks[ 1 ] );
+    TEST_ASSERT_NOT_NULL( pvBlocks[ 2 ] );
+    TEST_ASSERT_TRUE( ( ( pvBlocks[ 1 ] == pucHeap + xHeapStructSize ) &&
+                        ( pvBlocks[ 2 ] == pucHeap + ( testheap6REGION_SIZE / 2U ) + xHeapStructSize ) ) ||
+                      ( ( pvBlocks[ 2 ] == pucHeap + xHeapStructSize ) &&
+                        ( pvBlocks[ 1 ] == pucHeap + ( testheap6REGION_SIZE / 2U ) + xHeapStructSize ) ) );
+    TEST_ASSERT_EQUAL( xInitialFree - xLargeBlock - ( 2U * xSmallBlock ), xPortGetFreeHeapSize() );
+
+    /* The regions are freed back to a block each, never merged. */
+    vPortFree( pvBlocks[ 1 ] );
+    vPortFree( pvBlocks[ 0 ] );
+    vPortFree( pvBlocks[ 2 ] );
+    TEST_ASSERT_EQUAL( xInitialFree, xPortGetFreeHeapSize() );
+    TEST_ASSERT_EQUAL( 3, prvFreeBlockCount() );
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_HEAP_6, ClassStats )
+{
+    /* Requests of a few classes, and how many of each are made. */
+    static const size_t xRequests[] = { 1, testheap6SMALL_REQUEST, 1000, 5000 };
+    static const uint32_t ulCounts[] = { 3, 4, 2, 2 };
+    HeapClassStats_t xStats[ heapFL_INDEX_COUNT + 1 ];
+    size_t xAllocations[ heapFL_INDEX_COUNT ] = { 0 };
+    size_t xFreeBytes = 0, xFreeBlocks = 0, xHoleSize;
+    UBaseType_t uxClass, uxClasses;
+    uint32_t ulRequest, ulCount = 0, x;
+
+    prvDefineSingleRegion();
+
+    uxClasses = uxPortGetHeapClassStats( xStats, heapFL_INDEX_COUNT + 1 );
+    TEST_ASSERT_EQUAL( heapFL_INDEX_COUNT, uxClasses );
+    TEST_ASSERT_EQUAL( 2, uxPortGetHeapClassStats( xStats, 2 ) );
+
+    /* The region is one free block. */
+    uxClass = prvClassOf( xPortGetFreeHeapSize() );
+    ( void ) uxPortGetHeapClassStats( xStats, heapFL_INDEX_COUNT );
+    TEST_ASSERT_EQUAL( 1, xStats[ uxClass ].xFreeBlocks );
+    TEST_ASSERT_EQUAL( xPortGetFreeHeapSize(), xStats[ uxClass ].xFreeBytes );
+
+    for( ulRequest = 0; ulRequest < sizeof( xRequests ) / sizeof( xRequests[ 0 ] ); ulRequest++ )
+    {
+        for( x = 0; x < ulCounts[ ulRequest ]; x++ )
+        {
+            pvBlocks[ ulCount ] = pvPortMalloc( xRequests[ ulRequest ] );
+            TEST_ASSERT_NOT_NULL( pvBlocks[ ulCount ] );
+            ulCount++;
+        }
+
+        xAllocations[ prvClassOf( prvBlockSize( xRequests[ ulRequest ] ) ) ] += ulCounts[ ulRequest ];
+    }
+
+    /* Free every other block of the second request, between blocks in
+     * use, so they stay holes of their own class. */
+    vPortFree( pvBlocks[ 3 ] );
+    vPortFree( pvBlocks[ 5 ] );
+    xHoleSize = prvBlockSize( testheap6SMALL_REQUEST );
+
+    ( void ) uxPortGetHeapClassStats( xStats, heapFL_INDEX_COUNT );
+
+    for( uxClass = 0; uxClass < uxClasses; uxClass++ )
+    {
+        TEST_ASSERT_EQUAL( xAllocations[ uxClass ], xStats[ uxClass ].xAllocations );
+        TEST_ASSERT_TRUE( ( xStats[ uxClass ].xFreeBlocks == 0 ) == ( xStats[ uxClass ].xFreeBytes == 0 ) );
+        xFreeBlocks += xStats[ uxClass ].xFreeBlocks;
+        xFreeBytes += xStats[ uxClass ].xFreeBytes;
+    }
+
+    TEST_ASSERT_EQUAL( 2, xStats[ prvClassOf( xHoleSize ) ].xFreeBlocks );
+    TEST_ASSERT_EQUAL( 2 * xHoleSize, xStats[ prvClassOf( xHoleSize ) ].xFreeBytes );
+    TEST_ASSERT_EQUAL( 3, xFreeBlocks );
+    TEST_ASSERT_EQUAL( xPortGetFreeHeapSize(), xFreeBytes );
+
+    for( x = 0; x < ulCount; x++ )
+    {
+        if( ( x != 3 ) && ( x != 5 ) )
+        {
+            vPortFree( pvBlocks[ x ] );
+        }
+    }
+
+    TEST_ASSERT_EQUAL( 1, prvFreeBlockCount() );
+}
@@ -0,0 +1,238 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_test_timers.c
+ * @brief Tests for the software timers.
+ *
+ * The tests hold with the sorted timer lists and with configUSE_TIMER_WHEEL,
+ * and with or without configUSE_TIMER_COMMAND_COALESCING.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+/* Unity framework includes. */
+#include "unity_fixture.h"
+
+#define testtimersTIMEOUT          pdMS_TO_TICKS( 5000UL )
+#define testtimersEXPIRY_SLACK     ( ( TickType_t ) 20 )
+#define testtimersEXPIRY_TIMERS    ( 10 )
+#define testtimersLATE_PERIOD      ( ( TickType_t ) 32 )
+#define testtimersLATE_TICKS       ( ( TickType_t ) 30 )
+#define testtimersDELETE_PERIOD    ( ( TickType_t ) 10 )
+/*-----------------------------------------------------------*/
+
+/* Timers created by the tests, deleted by the tear down if a test fails. */
+static TimerHandle_t xTimers[ testtimersEXPIRY_TIMERS ];
+
+/* The tick at which each timer expired last, and the number of times. */
+static volatile TickType_t xExpiredAt[ testtimersEXPIRY_TIMERS ];
+static volatile uint32_t ulExpiries[ testtimersEXPIRY_TIMERS ];
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Records the expiry of the timer whose ID is its index in xTimers.
+ *
+ * @param[in] xTimer The timer.
+ */
+static void prvRecordExpiryCallback( TimerHandle_t xTimer );
+
+/**
+ * @brief Keeps the timer service task busy, so that it processes the timers
+ * late.
+ *
+ * @param[in] pvParameter1 Unused.
+ * @param[in] ulTicks Number of ticks to run for.
+ */
+static void prvBusyTimerTask( void * pvParameter1,
+                              uint32_t ulTicks );
+
+/**
+ * @brief A function pended to fill the queue of the timer service task.
+ *
+ * @param[in] pvParameter1 Unused.
+ * @param[in] ulParameter2 Unused.
+ */
+static void prvIdleTimerTask( void * pvParameter1,
+                              uint32_t ulParameter2 );
+/*-----------------------------------------------------------*/
+
+static void prvRecordExpiryCallback( TimerHandle_t xTimer )
+{
+    uint32_t ulIndex = ( uint32_t ) ( size_t ) pvTimerGetTimerID( xTimer );
+
+    if( ulIndex < testtimersEXPIRY_TIMERS )
+    {
+        xExpiredAt[ ulIndex ] = xTaskGetTickCount();
+        ulExpiries[ ulIndex ]++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvBusyTimerTask( void * pvParameter1,
+                              uint32_t ulTicks )
+{
+    TickType_t xStart = xTaskGetTickCount();
+
+    ( void ) pvParameter1;
+
+    /* The timer service task has the highest priority, so the tick count
+     * moves on while nothing else runs. */
+    while( ( xTaskGetTickCount() - xStart ) < ( TickType_t ) ulTicks )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvIdleTimerTask( void * pvParameter1,
+                              uint32_t ulParameter2 )
+{
+    ( void ) pvParameter1;
+    ( void ) ulParameter2;
+}
+/*-----------------------------------------------------------*/
+
+TEST_GROUP( Full_KERNEL_TIMERS );
+
+TEST_SETUP( Full_KERNEL_TIMERS )
+{
+    memset( xTimers, 0x00, sizeof( xTimers ) );
+    memset( ( void * ) xExpiredAt, 0x00, sizeof( xExpiredAt ) );
+    memset( ( void * ) ulExpiries, 0x00, sizeof( ulExpiries ) );
+}
+
+TEST_TEAR_DOWN( Full_KERNEL_TIMERS )
+{
+    uint32_t x;
+
+    for( x = 0; x < testtimersEXPIRY_TIMERS; x++ )
+    {
+        if( xTimers[ x ] != NULL )
+        {
+            ( void ) xTimerDelete( xTimers[ x ], testtimersTIMEOUT );
+        }
+    }
+
+    /* Let the timer service task free the deleted timers. */
+    vTaskDelay( pdMS_TO_TICKS( 10UL ) );
+}
+
+TEST_GROUP_RUNNER( Full_KERNEL_TIMERS )
+{
+    RUN_TEST_CASE( Full_KERNEL_TIMERS, TimerExpiry );
+    RUN_TEST_CASE( Full_KERNEL_TIMERS, TimerExpiryLate );
+    RUN_TEST_CASE( Full_KERNEL_TIMERS, TimerDeleteQueueFull );
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_KERNEL_TIMERS, TimerExpiry )
+{
+    /* Expiries on each level of the timing wheel and on the boundaries
+     * between them. */
+    static const TickType_t xPeriods[ testtimersEXPIRY_TIMERS ] = { 1, 2, 31, 32, 33, 100, 1023, 1024, 1025, 1500 };
+    TickType_t xStartedAt[ testtimersEXPIRY_TIMERS ];
+    uint32_t x;
+
+    for( x = 0; x < testtimersEXPIRY_TIMERS; x++ )
+    {
+        xTimers[ x ] = xTimerCreate( "TestTimer", xPeriods[ x ], pdFALSE, ( void * ) ( size_t ) x, prvRecordExpiryCallback );
+        TEST_ASSERT_NOT_NULL( xTimers[ x ] );
+    }
+
+    /* Start the longest first, so the shorter ones are filed while the wheel
+     * holds timers further ahead. */
+    for( x = testtimersEXPIRY_TIMERS; x > 0; x-- )
+    {
+        xStartedAt[ x - 1 ] = xTaskGetTickCount();
+        TEST_ASSERT_EQUAL( pdPASS, xTimerStart( xTimers[ x - 1 ], testtimersTIMEOUT ) );
+    }
+
+    vTaskDelay( xPeriods[ testtimersEXPIRY_TIMERS - 1 ] + testtimersEXPIRY_SLACK * 2 );
+
+    for( x = 0; x < testtimersEXPIRY_TIMERS; x++ )
+    {
+        TEST_ASSERT_EQUAL_UINT32( 1, ulExpiries[ x ] );
+        TEST_ASSERT_TRUE( ( TickType_t ) ( xExpiredAt[ x ] - ( xStartedAt[ x ] + xPeriods[ x ] ) ) <= testtimersEXPIRY_SLACK );
+    }
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_KERNEL_TIMERS, TimerExpiryLate )
+{
+    TickType_t xStartedAt, xElapsed;
+
+    xTimers[ 0 ] = xTimerCreate( "TestTimer", testtimersLATE_PERIOD, pdTRUE, ( void * ) 0, prvRecordExpiryCallback );
+    TEST_ASSERT_NOT_NULL( xTimers[ 0 ] );
+
+    xStartedAt = xTaskGetTickCount();
+    TEST_ASSERT_EQUAL( pdPASS, xTimerStart( xTimers[ 0 ], testtimersTIMEOUT ) );
+
+    /* Keep the timer service task busy across the first expiry, so that the
+     * timer is the only active one and is reloaded late. */
+    vTaskDelay( testtimersLATE_PERIOD - 2 );
+    TEST_ASSERT_EQUAL( pdPASS, xTimerPendFunctionCall( prvBusyTimerTask, NULL, testtimersLATE_TICKS, testtimersTIMEOUT ) );
+
+    vTaskDelay( testtimersLATE_PERIOD * 4 );
+    TEST_ASSERT_EQUAL( pdPASS, xTimerStop( xTimers[ 0 ], testtimersTIMEOUT ) );
+    xElapsed = xTaskGetTickCount() - xStartedAt;
+
+    /* Once per period elapsed, however late the first expiry was. */
+    TEST_ASSERT_TRUE( ulExpiries[ 0 ] >= 4 );
+    TEST_ASSERT_TRUE( ulExpiries[ 0 ] <= ( xElapsed / testtimersLATE_PERIOD ) + 1 );
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_KERNEL_TIMERS, TimerDeleteQueueFull )
+{
+    BaseType_t xDeleted;
+
+    xTimers[ 0 ] = xTimerCreate( "TestTimer", testtimersDELETE_PERIOD, pdFALSE, ( void * ) 0, prvRecordExpiryCallback );
+    TEST_ASSERT_NOT_NULL( xTimers[ 0 ] );
+
+    /* With the scheduler suspended, the timer service task cannot empty its
+     * queue, and the commands do not block. */
+    vTaskSuspendAll();
+    {
+        ( void ) xTimerStart( xTimers[ 0 ], 0 );
+
+        while( xTimerPendFunctionCall( prvIdleTimerTask, NULL, 0, 0 ) == pdPASS )
+        {
+        }
+
+        xDeleted = xTimerDelete( xTimers[ 0 ], 0 );
+    }
+    ( void ) xTaskResumeAll();
+
+    /* A delete that could not be sent leaves the start in effect. */
+    TEST_ASSERT_EQUAL( pdFAIL, xDeleted );
+    vTaskDelay( testtimersDELETE_PERIOD + testtimersEXPIRY_SLACK );
+    TEST_ASSERT_EQUAL_UINT32( 1, ulExpiries[ 0 ] );
+}
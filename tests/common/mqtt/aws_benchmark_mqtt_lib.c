@@ -0,0 +1,517 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_benchmark_mqtt_lib.c
+ * @brief Throughput and latency benchmarks for the MQTT core library.
+ *
+ * The library is connected to a loopback broker stub which runs in the test
+ * task.  The stub parses everything the library sends, queues the CONNACK,
+ * SUBACK and PUBACK responses and echoes every publish back on the subscribed
+ * topic.  The queued bytes are then passed to MQTT_ParseReceivedData, so each
+ * iteration covers the serialization of the publish, the matching of its
+ * PUBACK and the dispatch of the echoed message to the subscription callback,
+ * with no network in the way.
+ *
+ * Each case reports the publish rate, the distribution of the time from
+ * handing the echoed bytes to the library to the subscription callback being
+ * invoked, the number of bytes the library copied per message (counted with
+ * mqttconfigTRACE_BYTES_COPIED), the number of send calls and the peak number
+ * of buffer pool buffers held by the library.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* MQTT includes. */
+#include "aws_mqtt_lib.h"
+#include "aws_mqtt_agent_config.h"
+
+/* Bufferpool includes. */
+#include "aws_bufferpool.h"
+
+/* Benchmark framework includes. */
+#include "aws_benchmark.h"
+
+/* Unity framework includes. */
+#include "unity_fixture.h"
+
+#define mqttbenchmarkGROUP                   "Full_MQTT_BENCHMARK"
+#define mqttbenchmarkTOPIC                   "bench/mqtt/echo"
+#define mqttbenchmarkTIMEOUT_TICKS           ( 1000 )
+#define mqttbenchmarkMAX_PAYLOAD_LENGTH      ( 768 )
+#define mqttbenchmarkBATCH_COUNT             ( 4 )
+#define mqttbenchmarkBROKER_QUEUE_SIZE       ( 4096 )
+
+/* MQTT control packet types and flags seen by the broker stub. */
+#define mqttbenchmarkCONTROL_TYPE_MASK       ( 0xF0 )
+#define mqttbenchmarkCONTROL_CONNECT         ( 0x10 )
+#define mqttbenchmarkCONTROL_CONNACK         ( 0x20 )
+#define mqttbenchmarkCONTROL_PUBLISH         ( 0x30 )
+#define mqttbenchmarkCONTROL_PUBACK          ( 0x40 )
+#define mqttbenchmarkCONTROL_SUBSCRIBE       ( 0x80 )
+#define mqttbenchmarkCONTROL_SUBACK          ( 0x90 )
+#define mqttbenchmarkPUBLISH_QOS1_FLAG       ( 0x02 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Bytes queued by the broker stub for the client.
+ */
+typedef struct BrokerQueue
+{
+    uint8_t ucData[ mqttbenchmarkBROKER_QUEUE_SIZE ];
+    uint32_t ulLength;
+} BrokerQueue_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Bytes copied by the MQTT library, see aws_mqtt_config.h.
+ */
+uint32_t ulMQTTBenchmarkBytesCopied = 0;
+
+/* Samples of the case being run. */
+static uint32_t ulSamples[ benchmarkconfigITERATIONS ];
+
+/* The MQTT context connected to the broker stub. */
+static MQTTContext_t xMQTTContext;
+
+/* CONNACK, SUBACK and PUBACK messages queued by the broker stub. */
+static BrokerQueue_t xBrokerResponses;
+
+/* Publish messages echoed by the broker stub. */
+static BrokerQueue_t xBrokerEchoes;
+
+/* Copy of a queue being parsed, so that the stub can queue more while the
+ * library parses it. */
+static uint8_t ucDeliveryBuffer[ mqttbenchmarkBROKER_QUEUE_SIZE ];
+
+/* The payload of every published message. */
+static uint8_t ucPayload[ mqttbenchmarkMAX_PAYLOAD_LENGTH ];
+
+/* Number of times the library called the send function. */
+static uint32_t ulSendCount;
+
+/* Number of buffer pool buffers currently and at most held by the library. */
+static uint32_t ulBuffersInUse;
+static uint32_t ulBuffersPeak;
+
+/* Number of messages dispatched to the subscription callback and the time
+ * the first of the current delivery was dispatched. */
+static uint32_t ulDispatched;
+static uint64_t ullFirstDispatchTime;
+
+/* Packet identifier of the next QoS1 message. */
+static uint16_t usNextPacketIdentifier;
+
+/*-----------------------------------------------------------*/
+
+static uint8_t * prvGetBuffer( uint32_t * pulBufferLength )
+{
+    uint8_t * pucBuffer = BUFFERPOOL_GetFreeBuffer( pulBufferLength );
+
+    if( pucBuffer != NULL )
+    {
+        ulBuffersInUse++;
+
+        if( ulBuffersInUse > ulBuffersPeak )
+        {
+            ulBuffersPeak = ulBuffersInUse;
+        }
+    }
+
+    return pucBuffer;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReturnBuffer( uint8_t * const pucBuffer )
+{
+    ulBuffersInUse--;
+    BUFFERPOOL_ReturnBuffer( pucBuffer );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBrokerQueue( BrokerQueue_t * pxQueue,
+                           const uint8_t * pucData,
+                           uint32_t ulDataLength )
+{
+    TEST_ASSERT_TRUE( ( pxQueue->ulLength + ulDataLength ) <= sizeof( pxQueue->ucData ) );
+
+    memcpy( &( pxQueue->ucData[ pxQueue->ulLength ] ), pucData, ulDataLength );
+    pxQueue->ulLength += ulDataLength;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * The send function registered with the library.  Acts on every packet
+ * sent by the client as a broker with a single subscriber, the client
+ * itself, would.
+ */
+static uint32_t prvBrokerSend( void * pvSendContext,
+                               const uint8_t * const pucData,
+                               uint32_t ulDataLength )
+{
+    uint32_t ulOffset = 0, ulNextByte, ulRemainingLength, ulPacketLength, ulShift;
+    uint8_t ucResponse[ 5 ];
+    uint16_t usTopicLength;
+
+    ( void ) pvSendContext;
+
+    ulSendCount++;
+
+    /* The library may send several packets at a time. */
+    while( ulOffset < ulDataLength )
+    {
+        ulNextByte = ulOffset + 1;
+        ulRemainingLength = 0;
+        ulShift = 0;
+
+        do
+        {
+            ulRemainingLength |= ( uint32_t ) ( pucData[ ulNextByte ] & 0x7F ) << ulShift;
+            ulShift += 7;
+        } while( ( pucData[ ulNextByte++ ] & 0x80 ) != 0 );
+
+        ulPacketLength = ( ulNextByte - ulOffset ) + ulRemainingLength;
+        TEST_ASSERT_TRUE( ( ulOffset + ulPacketLength ) <= ulDataLength );
+
+        switch( pucData[ ulOffset ] & mqttbenchmarkCONTROL_TYPE_MASK )
+        {
+            case mqttbenchmarkCONTROL_CONNECT:
+                ucResponse[ 0 ] = mqttbenchmarkCONTROL_CONNACK;
+                ucResponse[ 1 ] = 2;
+                ucResponse[ 2 ] = 0; /* Session present. */
+                ucResponse[ 3 ] = 0; /* Connection accepted. */
+                prvBrokerQueue( &xBrokerResponses, ucResponse, 4 );
+                break;
+
+            case mqttbenchmarkCONTROL_SUBSCRIBE:
+                ucResponse[ 0 ] = mqttbenchmarkCONTROL_SUBACK;
+                ucResponse[ 1 ] = 3;
+                ucResponse[ 2 ] = pucData[ ulNextByte ];     /* Packet identifier MSB. */
+                ucResponse[ 3 ] = pucData[ ulNextByte + 1 ]; /* Packet identifier LSB. */
+                ucResponse[ 4 ] = pucData[ ulOffset + ulPacketLength - 1 ]; /* Grant the requested QoS. */
+                prvBrokerQueue( &xBrokerResponses, ucResponse, 5 );
+                break;
+
+            case mqttbenchmarkCONTROL_PUBLISH:
+
+                if( ( pucData[ ulOffset ] & mqttbenchmarkPUBLISH_QOS1_FLAG ) != 0 )
+                {
+                    /* The packet identifier follows the topic. */
+                    usTopicLength = ( uint16_t ) ( ( ( uint16_t ) pucData[ ulNextByte ] << 8 ) | pucData[ ulNextByte + 1 ] );
+                    ucResponse[ 0 ] = mqttbenchmarkCONTROL_PUBACK;
+                    ucResponse[ 1 ] = 2;
+                    ucResponse[ 2 ] = pucData[ ulNextByte + 2 + usTopicLength ];
+                    ucResponse[ 3 ] = pucData[ ulNextByte + 3 + usTopicLength ];
+                    prvBrokerQueue( &xBrokerResponses, ucResponse, 4 );
+                }
+
+                /* The client is subscribed to every topic it publishes on. */
+                prvBrokerQueue( &xBrokerEchoes, &( pucData[ ulOffset ] ), ulPacketLength );
+                break;
+
+            default:
+                /* PUBACKs for the echoed messages and DISCONNECT need no
+                 * response. */
+                break;
+        }
+
+        ulOffset += ulPacketLength;
+    }
+
+    return ulDataLength;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Pass everything queued by the broker stub to the library.
+ */
+static void prvDeliver( BrokerQueue_t * pxQueue )
+{
+    uint32_t ulLength = pxQueue->ulLength;
+
+    if( ulLength > 0 )
+    {
+        memcpy( ucDeliveryBuffer, pxQueue->ucData, ulLength );
+        pxQueue->ulLength = 0;
+
+        TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_ParseReceivedData( &( xMQTTContext ), ucDeliveryBuffer, ( size_t ) ulLength ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static MQTTBool_t prvEventCallback( void * pvCallbackContext,
+                                    const MQTTEventCallbackParams_t * const pxParams )
+{
+    ( void ) pvCallbackContext;
+    ( void ) pxParams;
+
+    return eMQTTFalse;
+}
+/*-----------------------------------------------------------*/
+
+static MQTTBool_t prvPublishCallback( void * pvPublishCallbackContext,
+                                      const MQTTPublishData_t * const pxPublishData )
+{
+    uint64_t ullNow = benchmarkconfigGET_TIME_NS();
+
+    ( void ) pvPublishCallbackContext;
+    ( void ) pxPublishData;
+
+    if( ullFirstDispatchTime == 0 )
+    {
+        ullFirstDispatchTime = ullNow;
+    }
+
+    ulDispatched++;
+
+    return eMQTTFalse;
+}
+/*-----------------------------------------------------------*/
+
+static void prvConnectAndSubscribe( void )
+{
+    MQTTInitParams_t xInitParams;
+    MQTTConnectParams_t xConnectParams;
+    MQTTSubscribeParams_t xSubscribeParams;
+
+    memset( &( xInitParams ), 0x00, sizeof( xInitParams ) );
+    xInitParams.pxCallback = prvEventCallback;
+    xInitParams.pxMQTTSendFxn = prvBrokerSend;
+    xInitParams.xBufferPoolInterface.pxGetBufferFxn = prvGetBuffer;
+    xInitParams.xBufferPoolInterface.pxReturnBufferFxn = prvReturnBuffer;
+    TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_Init( &( xMQTTContext ), &( xInitParams ) ) );
+
+    memset( &( xConnectParams ), 0x00, sizeof( xConnectParams ) );
+    xConnectParams.pucClientId = ( const uint8_t * ) "benchmark";
+    xConnectParams.usClientIdLength = ( uint16_t ) strlen( ( const char * ) xConnectParams.pucClientId );
+    xConnectParams.usPacketIdentifier = 1;
+    xConnectParams.usKeepAliveIntervalSeconds = mqttconfigKEEP_ALIVE_INTERVAL_SECONDS;
+    xConnectParams.ulKeepAliveActualIntervalTicks = mqttconfigKEEP_ALIVE_ACTUAL_INTERVAL_TICKS;
+    xConnectParams.ulPingRequestTimeoutTicks = mqttconfigKEEP_ALIVE_TIMEOUT_TICKS;
+    xConnectParams.ulTimeoutTicks = mqttbenchmarkTIMEOUT_TICKS;
+    TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_Connect( &( xMQTTContext ), &( xConnectParams ) ) );
+    prvDeliver( &xBrokerResponses );
+    TEST_ASSERT_EQUAL( eMQTTConnected, xMQTTContext.xConnectionState );
+
+    memset( &( xSubscribeParams ), 0x00, sizeof( xSubscribeParams ) );
+    xSubscribeParams.pucTopic = ( const uint8_t * ) mqttbenchmarkTOPIC;
+    xSubscribeParams.usTopicLength = ( uint16_t ) strlen( mqttbenchmarkTOPIC );
+    xSubscribeParams.xQos = eMQTTQoS1;
+    xSubscribeParams.usPacketIdentifier = 2;
+    xSubscribeParams.ulTimeoutTicks = mqttbenchmarkTIMEOUT_TICKS;
+    xSubscribeParams.pxPublishCallback = prvPublishCallback;
+    TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_Subscribe( &( xMQTTContext ), &( xSubscribeParams ) ) );
+    prvDeliver( &xBrokerResponses );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunPublish( const char * pcCase,
+                           MQTTQoS_t xQoS,
+                           uint32_t ulPayloadLength,
+                           uint32_t ulBatchCount )
+{
+    MQTTPublishParams_t xPublishParams[ mqttbenchmarkBATCH_COUNT ];
+    uint64_t ullStart, ullElapsed, ullDeliveryStart;
+    uint32_t x, y, ulMessages = benchmarkconfigITERATIONS * ulBatchCount;
+
+    configASSERT( ulPayloadLength <= mqttbenchmarkMAX_PAYLOAD_LENGTH );
+    configASSERT( ( ulBatchCount > 0 ) && ( ulBatchCount <= mqttbenchmarkBATCH_COUNT ) );
+
+    prvConnectAndSubscribe();
+
+    memset( xPublishParams, 0x00, sizeof( xPublishParams ) );
+
+    for( y = 0; y < ulBatchCount; y++ )
+    {
+        xPublishParams[ y ].pucTopic = ( const uint8_t * ) mqttbenchmarkTOPIC;
+        xPublishParams[ y ].usTopicLength = ( uint16_t ) strlen( mqttbenchmarkTOPIC );
+        xPublishParams[ y ].xQos = xQoS;
+        xPublishParams[ y ].pvData = ucPayload;
+        xPublishParams[ y ].ulDataLength = ulPayloadLength;
+        xPublishParams[ y ].ulTimeoutTicks = mqttbenchmarkTIMEOUT_TICKS;
+    }
+
+    /* Only count what happens while publishing. */
+    ulMQTTBenchmarkBytesCopied = 0;
+    ulSendCount = 0;
+    ulBuffersPeak = ulBuffersInUse;
+    ulDispatched = 0;
+
+    ullStart = benchmarkconfigGET_TIME_NS();
+
+    for( x = 0; x < benchmarkconfigITERATIONS; x++ )
+    {
+        if( xQoS == eMQTTQoS1 )
+        {
+            for( y = 0; y < ulBatchCount; y++ )
+            {
+                if( usNextPacketIdentifier == 0 )
+                {
+                    usNextPacketIdentifier++;
+                }
+
+                xPublishParams[ y ].usPacketIdentifier = usNextPacketIdentifier++;
+            }
+        }
+
+        if( ulBatchCount == 1 )
+        {
+            TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_Publish( &( xMQTTContext ), &( xPublishParams[ 0 ] ) ) );
+        }
+        else
+        {
+            TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_PublishV( &( xMQTTContext ), xPublishParams, ulBatchCount ) );
+        }
+
+        prvDeliver( &xBrokerResponses );
+
+        ullFirstDispatchTime = 0;
+        ullDeliveryStart = benchmarkconfigGET_TIME_NS();
+        prvDeliver( &xBrokerEchoes );
+        ulSamples[ x ] = ( uint32_t ) ( ullFirstDispatchTime - ullDeliveryStart );
+    }
+
+    ullElapsed = benchmarkconfigGET_TIME_NS() - ullStart;
+
+    TEST_ASSERT_EQUAL_UINT32( ulMessages, ulDispatched );
+
+    BENCHMARK_Report( mqttbenchmarkGROUP, pcCase, "messages", ulMessages, "msgs" );
+
+    if( ullElapsed > 0 )
+    {
+        BENCHMARK_Report( mqttbenchmarkGROUP,
+                          pcCase,
+                          "publish_rate",
+                          ( ( uint64_t ) ulMessages * 1000000000ULL ) / ullElapsed,
+                          "msgs_per_sec" );
+    }
+
+    BENCHMARK_ReportSamples( mqttbenchmarkGROUP, pcCase, ulSamples, benchmarkconfigITERATIONS, "ns" );
+    BENCHMARK_Report( mqttbenchmarkGROUP, pcCase, "bytes_copied_per_msg", ulMQTTBenchmarkBytesCopied / ulMessages, "bytes" );
+    BENCHMARK_Report( mqttbenchmarkGROUP, pcCase, "send_calls", ulSendCount, "calls" );
+    BENCHMARK_Report( mqttbenchmarkGROUP, pcCase, "pool_peak", ulBuffersPeak, "buffers" );
+}
+/*-----------------------------------------------------------*/
+
+TEST_GROUP( Full_MQTT_BENCHMARK );
+
+/*-----------------------------------------------------------*/
+
+TEST_SETUP( Full_MQTT_BENCHMARK )
+{
+    memset( &( xMQTTContext ), 0x00, sizeof( xMQTTContext ) );
+    memset( ucPayload, 0xA5, sizeof( ucPayload ) );
+    xBrokerResponses.ulLength = 0;
+    xBrokerEchoes.ulLength = 0;
+    ulBuffersInUse = 0;
+    ulBuffersPeak = 0;
+}
+
+/*-----------------------------------------------------------*/
+
+TEST_TEAR_DOWN( Full_MQTT_BENCHMARK )
+{
+    ( void ) MQTT_Disconnect( &( xMQTTContext ) );
+
+    /* Every buffer taken by the library must have been returned. */
+    TEST_ASSERT_EQUAL_UINT32( 0, ulBuffersInUse );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST_GROUP_RUNNER( Full_MQTT_BENCHMARK )
+{
+    RUN_TEST_CASE( Full_MQTT_BENCHMARK, PublishQoS0Payload16 );
+    RUN_TEST_CASE( Full_MQTT_BENCHMARK, PublishQoS0Payload256 );
+    RUN_TEST_CASE( Full_MQTT_BENCHMARK, PublishQoS0Payload768 );
+    RUN_TEST_CASE( Full_MQTT_BENCHMARK, PublishQoS1Payload16 );
+    RUN_TEST_CASE( Full_MQTT_BENCHMARK, PublishQoS1Payload256 );
+    RUN_TEST_CASE( Full_MQTT_BENCHMARK, PublishQoS1Payload768 );
+    RUN_TEST_CASE( Full_MQTT_BENCHMARK, PublishVQoS0Payload16 );
+    RUN_TEST_CASE( Full_MQTT_BENCHMARK, PublishVQoS1Payload16 );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_MQTT_BENCHMARK, PublishQoS0Payload16 )
+{
+    prvRunPublish( "PublishQoS0Payload16", eMQTTQoS0, 16, 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_MQTT_BENCHMARK, PublishQoS0Payload256 )
+{
+    prvRunPublish( "PublishQoS0Payload256", eMQTTQoS0, 256, 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_MQTT_BENCHMARK, PublishQoS0Payload768 )
+{
+    prvRunPublish( "PublishQoS0Payload768", eMQTTQoS0, 768, 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_MQTT_BENCHMARK, PublishQoS1Payload16 )
+{
+    prvRunPublish( "PublishQoS1Payload16", eMQTTQoS1, 16, 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_MQTT_BENCHMARK, PublishQoS1Payload256 )
+{
+    prvRunPublish( "PublishQoS1Payload256", eMQTTQoS1, 256, 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_MQTT_BENCHMARK, PublishQoS1Payload768 )
+{
+    prvRunPublish( "PublishQoS1Payload768", eMQTTQoS1, 768, 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_MQTT_BENCHMARK, PublishVQoS0Payload16 )
+{
+    prvRunPublish( "PublishVQoS0Payload16", eMQTTQoS0, 16, mqttbenchmarkBATCH_COUNT );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_MQTT_BENCHMARK, PublishVQoS1Payload16 )
+{
+    prvRunPublish( "PublishVQoS1Payload16", eMQTTQoS1, 16, mqttbenchmarkBATCH_COUNT );
+}
@@ -51,6 +51,10 @@
 #define mqttagenttestTOPIC_NAME    ( ( const uint8_t * ) "freertos/tests/echo" )
 
 #define mqttagenttestMESSAGE       "Hello from the test."
+
+/* Number of messages published back to back in the asynchronous publish test. */
+#define mqttagenttestASYNC_PUBLISH_COUNT    ( 20 )
+#define mqttagenttestBATCH_PUBLISH_COUNT    ( 4 )
 #define mqttagenttestFAILUREPRINTF( x )    vLoggingPrintf x
 
 /* The parameters below are definable so the test can run on most target. */
@@ -224,6 +228,19 @@ static MQTTBool_t prvMQTTCallback( void * pvUserData,
     return eMQTTFalse;
 }
 
+/**
+ * @brief Completion callback for MQTT_AGENT_PublishAsync and MQTT_AGENT_PublishBatch.
+ */
+static void prvPublishCompleteCallback( void * pvCompletionContext,
+                                        MQTTAgentReturnCode_t xResult )
+{
+    /* Give the semaphore to signal a successful completion. */
+    if( xResult == eMQTTAgentSuccess )
+    {
+        xSemaphoreGive( ( SemaphoreHandle_t ) pvCompletionContext );
+    }
+}
+
 /*-----------------------------------------------------------*/
 
 
@@ -367,6 +384,8 @@ TEST_GROUP_RUNNER( Full_MQTT_Agent )
 {
     RUN_TEST_CASE( Full_MQTT_Agent, AFQP_MQTT_Agent_SubscribePublishDefaultPort );
     RUN_TEST_CASE( Full_MQTT_Agent, AFQP_MQTT_Agent_InvalidCredentials );
+    RUN_TEST_CASE( Full_MQTT_Agent, AFQP_MQTT_Agent_SubscribePublishAsync );
+    RUN_TEST_CASE( Full_MQTT_Agent, AFQP_MQTT_Agent_SubscribePublishBatch );
 }
 TEST_GROUP_RUNNER( Full_MQTT_Agent_Stress_Tests )
 {
@@ -442,6 +461,220 @@ TEST( Full_MQTT_Agent, AFQP_MQTT_Agent_InvalidCredentials )
 }
 /*-----------------------------------------------------------*/
 
+/* Test for publishing messages back to back without waiting for each PUBACK. */
+TEST( Full_MQTT_Agent, AFQP_MQTT_Agent_SubscribePublishAsync )
+{
+    MQTTAgentReturnCode_t xReturned;
+    SemaphoreHandle_t xReceivedSemaphore = NULL, xCompletedSemaphore = NULL;
+    MQTTAgentHandle_t xMQTTHandle = NULL;
+    MQTTAgentSubscribeParams_t xSubscribeParams;
+    MQTTAgentPublishParams_t xPublishParameters;
+    BaseType_t xMQTTAgentCreated = pdFALSE, xMQTTAgentConnected = pdFALSE;
+    MQTTAgentConnectParams_t xConnectParameters;
+    uint32_t ulMessage;
+
+    memcpy( &xConnectParameters, &xDefaultConnectParameters, sizeof( MQTTAgentConnectParams_t ) );
+
+    /* Initialize the semaphores counting received and completed messages. */
+    xReceivedSemaphore = xSemaphoreCreateCounting( mqttagenttestASYNC_PUBLISH_COUNT, 0 );
+    TEST_ASSERT_NOT_NULL( xReceivedSemaphore );
+    xCompletedSemaphore = xSemaphoreCreateCounting( mqttagenttestASYNC_PUBLISH_COUNT, 0 );
+    TEST_ASSERT_NOT_NULL( xCompletedSemaphore );
+
+    /* Fill in the MQTTAgentConnectParams_t member that is not const. */
+    xConnectParameters.usClientIdLength = ( uint16_t ) strlen(
+        ( char * ) xConnectParameters.pucClientId );
+
+    if( TEST_PROTECT() )
+    {
+        /* The MQTT client object must be created before it can be used. */
+        xReturned = MQTT_AGENT_Create( &xMQTTHandle );
+        TEST_ASSERT_EQUAL_INT( xReturned, eMQTTAgentSuccess );
+        xMQTTAgentCreated = pdTRUE;
+
+        /* Connect to the broker. */
+        xReturned = MQTT_AGENT_Connect( xMQTTHandle,
+                                        &xConnectParameters,
+                                        mqttagenttestTIMEOUT );
+        TEST_ASSERT_EQUAL_INT( xReturned, eMQTTAgentSuccess );
+        xMQTTAgentConnected = pdTRUE;
+
+        /* Setup subscribe parameters to subscribe to echo topic. */
+        xSubscribeParams.pucTopic = mqttagenttestTOPIC_NAME;
+        xSubscribeParams.pvPublishCallbackContext = xReceivedSemaphore;
+        xSubscribeParams.pxPublishCallback = prvMQTTCallback;
+        xSubscribeParams.usTopicLength = ( uint16_t ) strlen( ( const char * ) mqttagenttestTOPIC_NAME );
+        xSubscribeParams.xQoS = eMQTTQoS1;
+
+        /* Subscribe to the topic. */
+        xReturned = MQTT_AGENT_Subscribe( xMQTTHandle,
+                                          &xSubscribeParams,
+                                          mqttagenttestTIMEOUT );
+        TEST_ASSERT_EQUAL_INT( xReturned, eMQTTAgentSuccess );
+
+        /* Setup the publish parameters. */
+        memset( &( xPublishParameters ), 0x00, sizeof( xPublishParameters ) );
+        xPublishParameters.pucTopic = mqttagenttestTOPIC_NAME;
+        xPublishParameters.pvData = mqttagenttestMESSAGE;
+        xPublishParameters.usTopicLength = ( uint16_t ) strlen( ( const char * ) mqttagenttestTOPIC_NAME );
+        xPublishParameters.ulDataLength = ( uint32_t ) strlen( mqttagenttestMESSAGE );
+        xPublishParameters.xQoS = eMQTTQoS1;
+
+        /* Publish the messages without waiting for the PUBACKs. More
+         * messages than the in-flight window are published so that some
+         * of the calls have to wait for room in the window. */
+        for( ulMessage = 0; ulMessage < mqttagenttestASYNC_PUBLISH_COUNT; ulMessage++ )
+        {
+            xReturned = MQTT_AGENT_PublishAsync( xMQTTHandle,
+                                                 &( xPublishParameters ),
+                                                 prvPublishCompleteCallback,
+                                                 xCompletedSemaphore,
+                                                 mqttagenttestTIMEOUT );
+            TEST_ASSERT_EQUAL_INT( xReturned, eMQTTAgentSuccess );
+        }
+
+        /* Every message must be acknowledged and echoed back. */
+        for( ulMessage = 0; ulMessage < mqttagenttestASYNC_PUBLISH_COUNT; ulMessage++ )
+        {
+            if( pdFALSE == xSemaphoreTake( xCompletedSemaphore, mqttagenttestTIMEOUT ) )
+            {
+                TEST_FAIL();
+            }
+
+            if( pdFALSE == xSemaphoreTake( xReceivedSemaphore, mqttagenttestTIMEOUT ) )
+            {
+                TEST_FAIL();
+            }
+        }
+    }
+
+    if( xMQTTAgentConnected == pdTRUE )
+    {
+        /* Disconnect the client. */
+        xReturned = MQTT_AGENT_Disconnect( xMQTTHandle, mqttagenttestTIMEOUT );
+        TEST_ASSERT_EQUAL_INT( xReturned, eMQTTAgentSuccess );
+    }
+
+    if( xMQTTAgentCreated == pdTRUE )
+    {
+        /* Delete the MQTT client. */
+        xReturned = MQTT_AGENT_Delete( xMQTTHandle );
+        TEST_ASSERT_EQUAL_INT( xReturned, eMQTTAgentSuccess );
+    }
+
+    /* Free the semaphores. */
+    vSemaphoreDelete( xReceivedSemaphore );
+    vSemaphoreDelete( xCompletedSemaphore );
+}
+/*-----------------------------------------------------------*/
+
+/* Test for publishing several messages sent to the broker together. */
+TEST( Full_MQTT_Agent, AFQP_MQTT_Agent_SubscribePublishBatch )
+{
+    MQTTAgentReturnCode_t xReturned;
+    SemaphoreHandle_t xReceivedSemaphore = NULL, xCompletedSemaphore = NULL;
+    MQTTAgentHandle_t xMQTTHandle = NULL;
+    MQTTAgentSubscribeParams_t xSubscribeParams;
+    MQTTAgentPublishParams_t xPublishParameters[ mqttagenttestBATCH_PUBLISH_COUNT ];
+    BaseType_t xMQTTAgentCreated = pdFALSE, xMQTTAgentConnected = pdFALSE;
+    MQTTAgentConnectParams_t xConnectParameters;
+    uint32_t ulMessage;
+
+    memcpy( &xConnectParameters, &xDefaultConnectParameters, sizeof( MQTTAgentConnectParams_t ) );
+
+    /* Initialize the semaphores counting received and completed messages. */
+    xReceivedSemaphore = xSemaphoreCreateCounting( mqttagenttestBATCH_PUBLISH_COUNT, 0 );
+    TEST_ASSERT_NOT_NULL( xReceivedSemaphore );
+    xCompletedSemaphore = xSemaphoreCreateCounting( mqttagenttestBATCH_PUBLISH_COUNT, 0 );
+    TEST_ASSERT_NOT_NULL( xCompletedSemaphore );
+
+    /* Fill in the MQTTAgentConnectParams_t member that is not const. */
+    xConnectParameters.usClientIdLength = ( uint16_t ) strlen(
+        ( char * ) xConnectParameters.pucClientId );
+
+    if( TEST_PROTECT() )
+    {
+        /* The MQTT client object must be created before it can be used. */
+        xReturned = MQTT_AGENT_Create( &xMQTTHandle );
+        TEST_ASSERT_EQUAL_INT( xReturned, eMQTTAgentSuccess );
+        xMQTTAgentCreated = pdTRUE;
+
+        /* Connect to the broker. */
+        xReturned = MQTT_AGENT_Connect( xMQTTHandle,
+                                        &xConnectParameters,
+                                        mqttagenttestTIMEOUT );
+        TEST_ASSERT_EQUAL_INT( xReturned, eMQTTAgentSuccess );
+        xMQTTAgentConnected = pdTRUE;
+
+        /* Setup subscribe parameters to subscribe to echo topic. */
+        xSubscribeParams.pucTopic = mqttagenttestTOPIC_NAME;
+        xSubscribeParams.pvPublishCallbackContext = xReceivedSemaphore;
+        xSubscribeParams.pxPublishCallback = prvMQTTCallback;
+        xSubscribeParams.usTopicLength = ( uint16_t ) strlen( ( const char * ) mqttagenttestTOPIC_NAME );
+        xSubscribeParams.xQoS = eMQTTQoS1;
+
+        /* Subscribe to the topic. */
+        xReturned = MQTT_AGENT_Subscribe( xMQTTHandle,
+                                          &xSubscribeParams,
+                                          mqttagenttestTIMEOUT );
+        TEST_ASSERT_EQUAL_INT( xReturned, eMQTTAgentSuccess );
+
+        /* Setup the publish parameters of all the messages in the batch. */
+        memset( xPublishParameters, 0x00, sizeof( xPublishParameters ) );
+
+        for( ulMessage = 0; ulMessage < mqttagenttestBATCH_PUBLISH_COUNT; ulMessage++ )
+        {
+            xPublishParameters[ ulMessage ].pucTopic = mqttagenttestTOPIC_NAME;
+            xPublishParameters[ ulMessage ].pvData = mqttagenttestMESSAGE;
+            xPublishParameters[ ulMessage ].usTopicLength = ( uint16_t ) strlen( ( const char * ) mqttagenttestTOPIC_NAME );
+            xPublishParameters[ ulMessage ].ulDataLength = ( uint32_t ) strlen( mqttagenttestMESSAGE );
+            xPublishParameters[ ulMessage ].xQoS = eMQTTQoS1;
+        }
+
+        /* Publish all the messages together. */
+        xReturned = MQTT_AGENT_PublishBatch( xMQTTHandle,
+                                             xPublishParameters,
+                                             mqttagenttestBATCH_PUBLISH_COUNT,
+                                             prvPublishCompleteCallback,
+                                             xCompletedSemaphore,
+                                             mqttagenttestTIMEOUT );
+        TEST_ASSERT_EQUAL_INT( xReturned, eMQTTAgentSuccess );
+
+        /* Every message must be acknowledged and echoed back. */
+        for( ulMessage = 0; ulMessage < mqttagenttestBATCH_PUBLISH_COUNT; ulMessage++ )
+        {
+            if( pdFALSE == xSemaphoreTake( xCompletedSemaphore, mqttagenttestTIMEOUT ) )
+            {
+                TEST_FAIL();
+            }
+
+            if( pdFALSE == xSemaphoreTake( xReceivedSemaphore, mqttagenttestTIMEOUT ) )
+            {
+                TEST_FAIL();
+            }
+        }
+    }
+
+    if( xMQTTAgentConnected == pdTRUE )
+    {
+        /* Disconnect the client. */
+        xReturned = MQTT_AGENT_Disconnect( xMQTTHandle, mqttagenttestTIMEOUT );
+        TEST_ASSERT_EQUAL_INT( xReturned, eMQTTAgentSuccess );
+    }
+
+    if( xMQTTAgentCreated == pdTRUE )
+    {
+        /* Delete the MQTT client. */
+        xReturned = MQTT_AGENT_Delete( xMQTTHandle );
+        TEST_ASSERT_EQUAL_INT( xReturned, eMQTTAgentSuccess );
+    }
+
+    /* Free the semaphores. */
+    vSemaphoreDelete( xReceivedSemaphore );
+    vSemaphoreDelete( xCompletedSemaphore );
+}
+/*-----------------------------------------------------------*/
+
 /* Test for ping-ponging a message using AWS IoT MQTT broker support for port 443. */
 TEST( Full_MQTT_Agent_ALPN, MQTT_Agent_SubscribePublishAlpn )
 {
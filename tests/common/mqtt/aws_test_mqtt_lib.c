@@ -41,6 +41,7 @@
 
 /* Bufferpool includes. */
 #include "aws_bufferpool.h"
+#include "aws_bufferpool_config.h"
 
 /**
  * @brief The callback context registered with the MQTT Core library.
@@ -74,11 +75,20 @@
  * @brief MQTT Control packet types.
  */
 #define mqttCONTROL_CONNACK                   ( ( uint8_t ) 2 << ( uint8_t ) 4 )
+#define mqttCONTROL_PUBLISH                   ( ( uint8_t ) 3 << ( uint8_t ) 4 )
+#define mqttCONTROL_PUBACK                    ( ( uint8_t ) 4 << ( uint8_t ) 4 )
 
 /**
  * @brief MQTT Control packet flags.
  */
 #define mqttFLAGS_CONNACK                     ( ( uint8_t ) 0 ) /**< Reserved. */
+#define mqttFLAGS_PUBLISH_QOS0                ( ( uint8_t ) 0 ) /**< QoS0, no DUP, no RETAIN. */
+#define mqttFLAGS_PUBACK                      ( ( uint8_t ) 0 ) /**< Reserved. */
+
+/**
+ * @brief Size of the buffer recording the data sent by the library.
+ */
+#define testmqttlibSENT_DATA_BUFFER_SIZE      ( 256 )
 /*-----------------------------------------------------------*/
 
 /**
@@ -90,6 +100,9 @@ typedef struct CallbackCounter
     uint32_t ulConnACK;           /**< Number of times the callback is invoked for CONNACK message. */
     uint32_t ulUnexpectedConnACK; /**< Number of times the callback is invoked for unexpected CONNACK messages. */
     uint32_t ulDisconnect;        /**< Number of times the callback is invoked for disconnect message. */
+    uint32_t ulPublish;           /**< Number of times the callback is invoked for publish messages. */
+    uint32_t ulPubACK;            /**< Number of times the callback is invoked for PUBACK messages. */
+    const uint8_t * pucTopic;     /**< The topic pointer of the last received publish message. */
     uint32_t ulUnidentified;      /**< Number of times the callback is invoked for un-handled events. */
 } CallbackCounter_t;
 /*-----------------------------------------------------------*/
@@ -103,6 +116,21 @@ static MQTTContext_t xMQTTContext;
  * @brief Callback counter used by all the tests.
  */
 static CallbackCounter_t xCallbackCounter;
+
+/**
+ * @brief Number of times the network send callback is invoked.
+ */
+static uint32_t ulSendCount;
+
+/**
+ * @brief The data sent by the library since the last reset of ulSentDataLength.
+ */
+static uint8_t ucSentData[ testmqttlibSENT_DATA_BUFFER_SIZE ];
+
+/**
+ * @brief The number of bytes in ucSentData.
+ */
+static uint32_t ulSentDataLength;
 /*-----------------------------------------------------------*/
 
 /**
@@ -184,6 +212,82 @@ static MQTTReturnCode_t prvSendMQTTConnect( void );
  * @return The return value of MQTT_ParseReceivedData.
  */
 static MQTTReturnCode_t prvReceiveMQTTConnACK( void );
+
+/**
+ * @brief Mimics receiving data directly into the memory returned by
+ * MQTT_GetReceiveLocation and passes it to MQTT_ParseReceivedInPlace.
+ *
+ * @param[in] pucData The received data.
+ * @param[in] xDataLength The length of the received data.
+ *
+ * @return The return value of the last call to MQTT_GetReceiveLocation or
+ * MQTT_ParseReceivedInPlace.
+ */
+static MQTTReturnCode_t prvReceiveInPlace( const uint8_t * pucData,
+                                           size_t xDataLength );
+
+/**
+ * @brief Sets up the publish parameters used by the batch publish tests.
+ *
+ * The first message is QoS0 and the others are QoS1.
+ *
+ * @param[out] pxPublishParams The publish parameters to set up.
+ * @param[in] ulPublishCount The number of entries in pxPublishParams.
+ */
+static void prvSetupBatchPublishParams( MQTTPublishParams_t * pxPublishParams,
+                                        uint32_t ulPublishCount );
+
+/**
+ * @brief The publish callback registered with the subscription manager.
+ *
+ * Records the subscription whose callback was invoked in
+ * ulInvokedSubscriptions. The callback context points to the bit
+ * identifying the subscription.
+ *
+ * @param[in] pvPublishCallbackContext The callback context supplied while subscribing.
+ * @param[in] pxPublishData The received publish message.
+ *
+ * @return eMQTTFalse, i.e. the buffer ownership is not taken.
+ */
+static MQTTBool_t prvPublishCallback( void * pvPublishCallbackContext,
+                                      const MQTTPublishData_t * const pxPublishData );
+
+/**
+ * @brief Same as prvPublishCallback except that it takes the buffer ownership.
+ *
+ * @param[in] pvPublishCallbackContext The callback context supplied while subscribing.
+ * @param[in] pxPublishData The received publish message.
+ *
+ * @return eMQTTTrue, i.e. the buffer ownership is taken.
+ */
+static MQTTBool_t prvPublishCallbackTakeOwnership( void * pvPublishCallbackContext,
+                                                   const MQTTPublishData_t * const pxPublishData );
+
+/**
+ * @brief Checks that the subscription callbacks invoked for the given topic
+ * are exactly the ones of the stored topic filters that match it.
+ *
+ * @param[in] pcTopic The topic on which the publish message is received.
+ * @param[in] pcTopicFilters The topic filters stored in the subscription manager
+ * along with the callback context pointing to the corresponding bit in
+ * ulSubscriptionBits.
+ * @param[in] ulTopicFilterCount The number of elements in pcTopicFilters.
+ */
+static void prvCheckInvokedSubscriptions( const char * pcTopic,
+                                          const char * const * pcTopicFilters,
+                                          uint32_t ulTopicFilterCount );
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The callback contexts used for the subscriptions. Each one
+ * identifies one subscription.
+ */
+static uint32_t ulSubscriptionBits[ 32 ];
+
+/**
+ * @brief The subscriptions whose publish callbacks were invoked.
+ */
+static uint32_t ulInvokedSubscriptions;
 /*-----------------------------------------------------------*/
 
 static MQTTBool_t prvMQTTEventCallback( void * pvCallbackContext,
@@ -213,6 +317,17 @@ static MQTTBool_t prvMQTTEventCallback( void * pvCallbackContext,
 
             break;
 
+        case eMQTTPubACK:
+            xCallbackCounter.ulPubACK += 1;
+
+            break;
+
+        case eMQTTPublish:
+            xCallbackCounter.ulPublish += 1;
+            xCallbackCounter.pucTopic = pxParams->u.xPublishData.pucTopic;
+
+            break;
+
         default:
             xCallbackCounter.ulUnidentified += 1;
 
@@ -232,6 +347,16 @@ static uint32_t prvSendCallback( void * pvSendContext,
     /* Ensure that the correct context was supplied by the library. */
     TEST_ASSERT_EQUAL( pvSendContext, testmqttlibSEND_CONTEXT );
 
+    /* Record the sent data. */
+    ulSendCount += 1;
+
+    if( ( ulSentDataLength + ulDataLength ) <= sizeof( ucSentData ) )
+    {
+        memcpy( &( ucSentData[ ulSentDataLength ] ), pucData, ( size_t ) ulDataLength );
+    }
+
+    ulSentDataLength += ulDataLength;
+
     /* Mimic that everything was sent successfully. */
     return ulDataLength;
 }
@@ -254,6 +379,9 @@ static void prvInitializeCallbackCounter( void )
     xCallbackCounter.ulConnACK = 0;
     xCallbackCounter.ulUnexpectedConnACK = 0;
     xCallbackCounter.ulDisconnect = 0;
+    xCallbackCounter.ulPublish = 0;
+    xCallbackCounter.ulPubACK = 0;
+    xCallbackCounter.pucTopic = NULL;
     xCallbackCounter.ulUnidentified = 0;
 }
 /*-----------------------------------------------------------*/
@@ -323,6 +451,111 @@ static MQTTReturnCode_t prvReceiveMQTTConnACK( void )
 }
 /*-----------------------------------------------------------*/
 
+static MQTTReturnCode_t prvReceiveInPlace( const uint8_t * pucData,
+                                           size_t xDataLength )
+{
+    MQTTReturnCode_t xReturnCode = eMQTTSuccess;
+    uint8_t * pucLocation;
+    size_t xLength;
+
+    while( ( xDataLength > 0 ) && ( xReturnCode == eMQTTSuccess ) )
+    {
+        xReturnCode = MQTT_GetReceiveLocation( &( xMQTTContext ), &( pucLocation ), &( xLength ) );
+
+        if( xReturnCode == eMQTTSuccess )
+        {
+            /* Mimic a socket receive which returns fewer bytes than asked for. */
+            if( xLength > xDataLength )
+            {
+                xLength = xDataLength;
+            }
+
+            memcpy( pucLocation, pucData, xLength );
+            xReturnCode = MQTT_ParseReceivedInPlace( &( xMQTTContext ), xLength );
+
+            pucData += xLength;
+            xDataLength -= xLength;
+        }
+    }
+
+    return xReturnCode;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetupBatchPublishParams( MQTTPublishParams_t * pxPublishParams,
+                                        uint32_t ulPublishCount )
+{
+    uint32_t x;
+    static const char * const pcPayload = "payload";
+
+    for( x = 0; x < ulPublishCount; x++ )
+    {
+        pxPublishParams[ x ].pucTopic = ( const uint8_t * ) "aws/batch";
+        pxPublishParams[ x ].usTopicLength = ( uint16_t ) strlen( "aws/batch" );
+        pxPublishParams[ x ].xQos = ( x == 0 ) ? eMQTTQoS0 : eMQTTQoS1;
+        pxPublishParams[ x ].pvData = pcPayload;
+        pxPublishParams[ x ].ulDataLength = ( uint32_t ) strlen( pcPayload );
+        pxPublishParams[ x ].usPacketIdentifier = ( uint16_t ) ( x + 2 );
+        pxPublishParams[ x ].ulTimeoutTicks = testmqttlibOPERATION_TIMEOUT_TICKS;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static MQTTBool_t prvPublishCallback( void * pvPublishCallbackContext,
+                                      const MQTTPublishData_t * const pxPublishData )
+{
+    ( void ) pxPublishData;
+
+    ulInvokedSubscriptions |= *( ( uint32_t * ) pvPublishCallbackContext );
+
+    return eMQTTFalse;
+}
+/*-----------------------------------------------------------*/
+
+static MQTTBool_t prvPublishCallbackTakeOwnership( void * pvPublishCallbackContext,
+                                                   const MQTTPublishData_t * const pxPublishData )
+{
+    ( void ) prvPublishCallback( pvPublishCallbackContext, pxPublishData );
+
+    return eMQTTTrue;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCheckInvokedSubscriptions( const char * pcTopic,
+                                          const char * const * pcTopicFilters,
+                                          uint32_t ulTopicFilterCount )
+{
+    MQTTPublishData_t xPublishData;
+    MQTTBool_t xCallbackInvoked, xBufferOwnershipTaken;
+    uint32_t ulExpectedSubscriptions = 0, x;
+
+    /* The expected callbacks are the ones of the topic filters
+     * which prvDoesTopicMatchTopicFilter matches with the topic. */
+    for( x = 0; x < ulTopicFilterCount; x++ )
+    {
+        if( ( pcTopicFilters[ x ] != NULL ) &&
+            ( Test_prvDoesTopicMatchTopicFilter( ( const uint8_t * ) pcTopic,
+                                                 ( uint16_t ) strlen( pcTopic ),
+                                                 ( const uint8_t * ) pcTopicFilters[ x ],
+                                                 ( uint16_t ) strlen( pcTopicFilters[ x ] ) ) == eMQTTTrue ) )
+        {
+            ulExpectedSubscriptions |= ulSubscriptionBits[ x ];
+        }
+    }
+
+    memset( &( xPublishData ), 0x00, sizeof( xPublishData ) );
+    xPublishData.pucTopic = ( const uint8_t * ) pcTopic;
+    xPublishData.usTopicLength = ( uint16_t ) strlen( pcTopic );
+
+    ulInvokedSubscriptions = 0;
+    xBufferOwnershipTaken = Test_prvInvokeSubscriptionCallbacks( &( xMQTTContext ), &( xPublishData ), &( xCallbackInvoked ) );
+
+    TEST_ASSERT_EQUAL( eMQTTFalse, xBufferOwnershipTaken );
+    TEST_ASSERT_EQUAL_HEX32_MESSAGE( ulExpectedSubscriptions, ulInvokedSubscriptions, pcTopic );
+    TEST_ASSERT_EQUAL( ( ulExpectedSubscriptions != 0 ) ? eMQTTTrue : eMQTTFalse, xCallbackInvoked );
+}
+/*-----------------------------------------------------------*/
+
 /* Define Test Group. */
 TEST_GROUP( Full_MQTT );
 /*-----------------------------------------------------------*/
@@ -342,6 +575,10 @@ TEST_SETUP( Full_MQTT )
 
     /* Reset callback counters before each test. */
     prvInitializeCallbackCounter();
+
+    /* Reset the record of the sent data. */
+    ulSendCount = 0;
+    ulSentDataLength = 0;
 }
 /*-----------------------------------------------------------*/
 
@@ -366,6 +603,10 @@ TEST_GROUP_RUNNER( Full_MQTT )
     RUN_TEST_CASE( Full_MQTT, AFQP_prvDoesTopicMatchTopicFilter_MatchCases );
     RUN_TEST_CASE( Full_MQTT, AFQP_prvDoesTopicMatchTopicFilter_NotMatchCases );
 
+    RUN_TEST_CASE( Full_MQTT, AFQP_prvInvokeSubscriptionCallbacks_MatchingSubscriptions );
+    RUN_TEST_CASE( Full_MQTT, AFQP_prvInvokeSubscriptionCallbacks_RemovedSubscriptions );
+    RUN_TEST_CASE( Full_MQTT, AFQP_prvInvokeSubscriptionCallbacks_OwnershipTaken );
+
     /* MQTT_Init tests. */
     RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_Init_HappyCase );
     RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_Init_NULLParams );
@@ -381,6 +622,15 @@ TEST_GROUP_RUNNER( Full_MQTT )
     RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_Connect_SecondConnectWhileAlreadyConnected );
     RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_Connect_SecondConnectWhileWaitingForConnACK );
     RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_Connect_NetworkSendFailed );
+
+    /* In place receive tests. */
+    RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_ParseReceivedInPlace_HappyCase );
+    RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_GetReceiveLocation_NotConnected );
+
+    /* Batch publish tests. */
+    RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_PublishV_HappyCase );
+    RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_PublishV_TooLargeBatch );
+    RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_PublishV_NotConnected );
 }
 /*-----------------------------------------------------------*/
 
@@ -561,6 +811,13 @@ TEST( Full_MQTT, AFQP_prvDoesTopicMatchTopicFilter_MatchCases )
                                                                   ( uint16_t ) strlen( "aws/#" ) );
     TEST_ASSERT_EQUAL( eMQTTTrue, xTopicMatchesTopicFilter );
 
+    /* "aws/#" should match "aws/" as '#' matches the empty last level. */
+    xTopicMatchesTopicFilter = Test_prvDoesTopicMatchTopicFilter( ( const uint8_t * ) "aws/",
+                                                                  ( uint16_t ) strlen( "aws/" ),
+                                                                  ( const uint8_t * ) "aws/#",
+                                                                  ( uint16_t ) strlen( "aws/#" ) );
+    TEST_ASSERT_EQUAL( eMQTTTrue, xTopicMatchesTopicFilter );
+
     /* "aws/+" should match "aws/" - MQTT protocol spec.*/
     xTopicMatchesTopicFilter = Test_prvDoesTopicMatchTopicFilter( ( const uint8_t * ) "aws/",
                                                                   ( uint16_t ) strlen( "aws/" ),
@@ -698,6 +955,167 @@ TEST( Full_MQTT, AFQP_prvDoesTopicMatchTopicFilter_NotMatchCases )
 }
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Topics used to check the subscription callbacks which are invoked.
+ */
+static const char * const pcTestTopics[] =
+{
+    "aws",
+    "aws/",
+    "aws/iot",
+    "aws/iot/shadow",
+    "aws/iot/shadow/update/accepted",
+    "aws/jobs/shadow",
+    "aws//shadow",
+    "aws//",
+    "/aws",
+    "iot/aws",
+    "sport/tennis/player1"
+};
+
+/**
+ * @brief Topic filters stored in the subscription manager.
+ */
+static const char * const pcTestTopicFilters[] =
+{
+    "aws/iot",
+    "aws/+",
+    "aws/#",
+    "aws/+/shadow",
+    "#",
+    "+/+",
+    "aws//+",
+    "aws/iot/shadow/#"
+};
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that prvInvokeSubscriptionCallbacks invokes the callbacks of
+ * all the stored topic filters matching the topic, and only those.
+ */
+TEST( Full_MQTT, AFQP_prvInvokeSubscriptionCallbacks_MatchingSubscriptions )
+{
+    uint32_t x;
+
+    for( x = 0; x < sizeof( pcTestTopicFilters ) / sizeof( pcTestTopicFilters[ 0 ] ); x++ )
+    {
+        ulSubscriptionBits[ x ] = ( uint32_t ) 1 << x;
+        TEST_ASSERT_EQUAL( eMQTTTrue, Test_prvStoreSubscription( &( xMQTTContext ),
+                                                                 ( const uint8_t * ) pcTestTopicFilters[ x ],
+                                                                 ( uint16_t ) strlen( pcTestTopicFilters[ x ] ),
+                                                                 &( ulSubscriptionBits[ x ] ),
+                                                                 prvPublishCallback ) );
+    }
+
+    for( x = 0; x < sizeof( pcTestTopics ) / sizeof( pcTestTopics[ 0 ] ); x++ )
+    {
+        prvCheckInvokedSubscriptions( pcTestTopics[ x ],
+                                      pcTestTopicFilters,
+                                      sizeof( pcTestTopicFilters ) / sizeof( pcTestTopicFilters[ 0 ] ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that removed subscriptions are no longer invoked and that the
+ * remaining and newly stored ones still are.
+ */
+TEST( Full_MQTT, AFQP_prvInvokeSubscriptionCallbacks_RemovedSubscriptions )
+{
+    const char * pcTopicFilters[ sizeof( pcTestTopicFilters ) / sizeof( pcTestTopicFilters[ 0 ] ) ];
+    uint32_t x;
+
+    for( x = 0; x < sizeof( pcTestTopicFilters ) / sizeof( pcTestTopicFilters[ 0 ] ); x++ )
+    {
+        pcTopicFilters[ x ] = pcTestTopicFilters[ x ];
+        ulSubscriptionBits[ x ] = ( uint32_t ) 1 << x;
+        TEST_ASSERT_EQUAL( eMQTTTrue, Test_prvStoreSubscription( &( xMQTTContext ),
+                                                                 ( const uint8_t * ) pcTopicFilters[ x ],
+                                                                 ( uint16_t ) strlen( pcTopicFilters[ x ] ),
+                                                                 &( ulSubscriptionBits[ x ] ),
+                                                                 prvPublishCallback ) );
+    }
+
+    /* Remove the topic filters which were stored first, so that the
+     * remaining ones sharing their topic levels outlive them. */
+    Test_prvRemoveSubscription( &( xMQTTContext ), ( const uint8_t * ) "aws/iot", ( uint16_t ) strlen( "aws/iot" ) );
+    pcTopicFilters[ 0 ] = NULL;
+    Test_prvRemoveSubscription( &( xMQTTContext ), ( const uint8_t * ) "aws/+", ( uint16_t ) strlen( "aws/+" ) );
+    pcTopicFilters[ 1 ] = NULL;
+
+    /* Removing a topic filter which is not stored has no effect. */
+    Test_prvRemoveSubscription( &( xMQTTContext ), ( const uint8_t * ) "aws/iot/shadow", ( uint16_t ) strlen( "aws/iot/shadow" ) );
+
+    for( x = 0; x < sizeof( pcTestTopics ) / sizeof( pcTestTopics[ 0 ] ); x++ )
+    {
+        prvCheckInvokedSubscriptions( pcTestTopics[ x ], pcTopicFilters, sizeof( pcTopicFilters ) / sizeof( pcTopicFilters[ 0 ] ) );
+    }
+
+    /* Reuse the free entries. */
+    pcTopicFilters[ 0 ] = "aws/iot/shadow";
+    pcTopicFilters[ 1 ] = "aws/iot";
+
+    for( x = 0; x < 2; x++ )
+    {
+        TEST_ASSERT_EQUAL( eMQTTTrue, Test_prvStoreSubscription( &( xMQTTContext ),
+                                                                 ( const uint8_t * ) pcTopicFilters[ x ],
+                                                                 ( uint16_t ) strlen( pcTopicFilters[ x ] ),
+                                                                 &( ulSubscriptionBits[ x ] ),
+                                                                 prvPublishCallback ) );
+    }
+
+    for( x = 0; x < sizeof( pcTestTopics ) / sizeof( pcTestTopics[ 0 ] ); x++ )
+    {
+        prvCheckInvokedSubscriptions( pcTestTopics[ x ], pcTopicFilters, sizeof( pcTopicFilters ) / sizeof( pcTopicFilters[ 0 ] ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that no other callback is invoked once a callback takes the
+ * buffer ownership, and that exact matches are invoked first.
+ */
+TEST( Full_MQTT, AFQP_prvInvokeSubscriptionCallbacks_OwnershipTaken )
+{
+    MQTTPublishData_t xPublishData;
+    MQTTBool_t xCallbackInvoked, xBufferOwnershipTaken;
+
+    ulSubscriptionBits[ 0 ] = 1;
+    ulSubscriptionBits[ 1 ] = 2;
+
+    /* The wild-card subscription is stored first. */
+    TEST_ASSERT_EQUAL( eMQTTTrue, Test_prvStoreSubscription( &( xMQTTContext ),
+                                                             ( const uint8_t * ) "aws/#",
+                                                             ( uint16_t ) strlen( "aws/#" ),
+                                                             &( ulSubscriptionBits[ 1 ] ),
+                                                             prvPublishCallback ) );
+    TEST_ASSERT_EQUAL( eMQTTTrue, Test_prvStoreSubscription( &( xMQTTContext ),
+                                                             ( const uint8_t * ) "aws/iot",
+                                                             ( uint16_t ) strlen( "aws/iot" ),
+                                                             &( ulSubscriptionBits[ 0 ] ),
+                                                             prvPublishCallbackTakeOwnership ) );
+
+    memset( &( xPublishData ), 0x00, sizeof( xPublishData ) );
+    xPublishData.pucTopic = ( const uint8_t * ) "aws/iot";
+    xPublishData.usTopicLength = ( uint16_t ) strlen( "aws/iot" );
+
+    ulInvokedSubscriptions = 0;
+    xBufferOwnershipTaken = Test_prvInvokeSubscriptionCallbacks( &( xMQTTContext ), &( xPublishData ), &( xCallbackInvoked ) );
+    TEST_ASSERT_EQUAL( eMQTTTrue, xBufferOwnershipTaken );
+    TEST_ASSERT_EQUAL( eMQTTTrue, xCallbackInvoked );
+    TEST_ASSERT_EQUAL_HEX32( 1, ulInvokedSubscriptions );
+
+    xPublishData.pucTopic = ( const uint8_t * ) "aws/jobs";
+    xPublishData.usTopicLength = ( uint16_t ) strlen( "aws/jobs" );
+
+    ulInvokedSubscriptions = 0;
+    xBufferOwnershipTaken = Test_prvInvokeSubscriptionCallbacks( &( xMQTTContext ), &( xPublishData ), &( xCallbackInvoked ) );
+    TEST_ASSERT_EQUAL( eMQTTFalse, xBufferOwnershipTaken );
+    TEST_ASSERT_EQUAL( eMQTTTrue, xCallbackInvoked );
+    TEST_ASSERT_EQUAL_HEX32( 2, ulInvokedSubscriptions );
+}
+/*-----------------------------------------------------------*/
+
 /**
  * @brief MQTT context initialization happy case.
  */
@@ -1075,3 +1493,198 @@ TEST( Full_MQTT, AFQP_MQTT_Connect_NetworkSendFailed )
     TEST_ASSERT_EQUAL( 0, xCallbackCounter.ulUnidentified );
 }
 /*-----------------------------------------------------------*/
+
+/**
+ * @brief MQTT in place receive - Happy case.
+ *
+ * Receives the CONNACK and a publish message directly into the locations
+ * returned by MQTT_GetReceiveLocation and checks that the publish message is
+ * reported to the callback without being copied.
+ */
+TEST( Full_MQTT, AFQP_MQTT_ParseReceivedInPlace_HappyCase )
+{
+    MQTTReturnCode_t xReturnCode;
+    uint8_t * pucLocation;
+    size_t xLength;
+    static const uint8_t ucConnACKMessage[] =
+    {
+        mqttCONTROL_CONNACK | mqttFLAGS_CONNACK, /* Fixed header control packet type. */
+        2,                                       /* Fixed header remaining length - always 2 for CONNACK. */
+        0,                                       /* Bit 0 is SP - Session Present. */
+        0,                                       /* Return code. */
+    };
+    static const uint8_t ucPublishMessage[] =
+    {
+        mqttCONTROL_PUBLISH | mqttFLAGS_PUBLISH_QOS0, /* Fixed header control packet type. */
+        14,                                           /* Fixed header remaining length. */
+        0, 7,                                         /* Topic length. */
+        'a', 'w', 's', '/', 'i', 'o', 't',            /* Topic. */
+        'h', 'e', 'l', 'l', 'o'                       /* Payload. */
+    };
+
+    /* Send MQTT Connect message. */
+    xReturnCode = prvSendMQTTConnect();
+    TEST_ASSERT_EQUAL( eMQTTSuccess, xReturnCode );
+
+    /* Receive CONNACK in place. */
+    xReturnCode = prvReceiveInPlace( ucConnACKMessage, sizeof( ucConnACKMessage ) );
+    TEST_ASSERT_EQUAL( eMQTTSuccess, xReturnCode );
+    TEST_ASSERT_EQUAL( eMQTTConnected, xMQTTContext.xConnectionState );
+    TEST_ASSERT_EQUAL( 1, xCallbackCounter.ulConnACK );
+
+    /* Receive the fixed header of the publish message. */
+    xReturnCode = prvReceiveInPlace( ucPublishMessage, 2 );
+    TEST_ASSERT_EQUAL( eMQTTSuccess, xReturnCode );
+
+    /* The rest of the message must be requested in one go. */
+    xReturnCode = MQTT_GetReceiveLocation( &( xMQTTContext ), &( pucLocation ), &( xLength ) );
+    TEST_ASSERT_EQUAL( eMQTTSuccess, xReturnCode );
+    TEST_ASSERT_EQUAL( sizeof( ucPublishMessage ) - 2, xLength );
+
+    memcpy( pucLocation, &( ucPublishMessage[ 2 ] ), xLength );
+    xReturnCode = MQTT_ParseReceivedInPlace( &( xMQTTContext ), xLength );
+    TEST_ASSERT_EQUAL( eMQTTSuccess, xReturnCode );
+
+    /* The topic reported to the callback must point to the
+     * location the message was received into. */
+    TEST_ASSERT_EQUAL( 1, xCallbackCounter.ulPublish );
+    TEST_ASSERT_EQUAL_PTR( pucLocation + 2, xCallbackCounter.pucTopic );
+
+    /* No other callback must have been invoked. */
+    TEST_ASSERT_EQUAL( 0, xCallbackCounter.ulUnidentified );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief MQTT in place receive - Not connected.
+ */
+TEST( Full_MQTT, AFQP_MQTT_GetReceiveLocation_NotConnected )
+{
+    MQTTReturnCode_t xReturnCode;
+    uint8_t * pucLocation;
+    size_t xLength;
+
+    /* No receive location must be returned before connecting. */
+    xReturnCode = MQTT_GetReceiveLocation( &( xMQTTContext ), &( pucLocation ), &( xLength ) );
+    TEST_ASSERT_EQUAL( eMQTTClientNotConnected, xReturnCode );
+
+    /* No callback must have been invoked. */
+    TEST_ASSERT_EQUAL( 0, xCallbackCounter.ulUnidentified );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief MQTT batch publish - Happy case.
+ *
+ * The batch must be sent with one call to the send function and must be
+ * identical to the messages sent one by one with MQTT_Publish.
+ */
+TEST( Full_MQTT, AFQP_MQTT_PublishV_HappyCase )
+{
+    MQTTReturnCode_t xReturnCode;
+    MQTTPublishParams_t xPublishParams[ 3 ];
+    uint8_t ucExpectedData[ testmqttlibSENT_DATA_BUFFER_SIZE ];
+    uint32_t ulExpectedDataLength, x;
+    uint8_t ucPUBACKMessage[] =
+    {
+        mqttCONTROL_PUBACK | mqttFLAGS_PUBACK, /* Fixed header control packet type. */
+        2,                                     /* Fixed header remaining length - always 2 for PUBACK. */
+        0,                                     /* Packet identifier MSB. */
+        0,                                     /* Packet identifier LSB. */
+    };
+
+    prvSetupBatchPublishParams( xPublishParams, 3 );
+
+    /* Connect. */
+    TEST_ASSERT_EQUAL( eMQTTSuccess, prvSendMQTTConnect() );
+    TEST_ASSERT_EQUAL( eMQTTSuccess, prvReceiveMQTTConnACK() );
+
+    /* Publish the messages one by one to know what to expect. */
+    ulSentDataLength = 0;
+
+    for( x = 0; x < 3; x++ )
+    {
+        TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_Publish( &( xMQTTContext ), &( xPublishParams[ x ] ) ) );
+    }
+
+    ulExpectedDataLength = ulSentDataLength;
+    TEST_ASSERT_TRUE( ulExpectedDataLength <= sizeof( ucExpectedData ) );
+    memcpy( ucExpectedData, ucSentData, ( size_t ) ulExpectedDataLength );
+
+    /* Acknowledge the QoS1 messages. */
+    for( x = 1; x < 3; x++ )
+    {
+        ucPUBACKMessage[ 3 ] = ( uint8_t ) xPublishParams[ x ].usPacketIdentifier;
+        TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_ParseReceivedData( &( xMQTTContext ), ucPUBACKMessage, sizeof( ucPUBACKMessage ) ) );
+    }
+
+    TEST_ASSERT_EQUAL( 2, xCallbackCounter.ulPubACK );
+
+    /* Publish the same messages as a batch. */
+    ulSendCount = 0;
+    ulSentDataLength = 0;
+    xReturnCode = MQTT_PublishV( &( xMQTTContext ), xPublishParams, 3 );
+    TEST_ASSERT_EQUAL( eMQTTSuccess, xReturnCode );
+
+    /* The batch must have been sent in one go. */
+    TEST_ASSERT_EQUAL( 1, ulSendCount );
+    TEST_ASSERT_EQUAL( ulExpectedDataLength, ulSentDataLength );
+    TEST_ASSERT_EQUAL_UINT8_ARRAY( ucExpectedData, ucSentData, ulExpectedDataLength );
+
+    /* The QoS1 messages must be waiting for PUBACKs. */
+    for( x = 1; x < 3; x++ )
+    {
+        ucPUBACKMessage[ 3 ] = ( uint8_t ) xPublishParams[ x ].usPacketIdentifier;
+        TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_ParseReceivedData( &( xMQTTContext ), ucPUBACKMessage, sizeof( ucPUBACKMessage ) ) );
+    }
+
+    TEST_ASSERT_EQUAL( 4, xCallbackCounter.ulPubACK );
+
+    /* No other callback must have been invoked. */
+    TEST_ASSERT_EQUAL( 0, xCallbackCounter.ulUnidentified );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief MQTT batch publish - The batch does not fit in one buffer.
+ */
+TEST( Full_MQTT, AFQP_MQTT_PublishV_TooLargeBatch )
+{
+    MQTTReturnCode_t xReturnCode;
+    MQTTPublishParams_t xPublishParams[ 3 ];
+    static uint8_t ucLargePayload[ bufferpoolconfigBUFFER_SIZE / 2 ];
+
+    prvSetupBatchPublishParams( xPublishParams, 3 );
+    xPublishParams[ 1 ].pvData = ucLargePayload;
+    xPublishParams[ 1 ].ulDataLength = sizeof( ucLargePayload );
+    xPublishParams[ 2 ].pvData = ucLargePayload;
+    xPublishParams[ 2 ].ulDataLength = sizeof( ucLargePayload );
+
+    /* Connect. */
+    TEST_ASSERT_EQUAL( eMQTTSuccess, prvSendMQTTConnect() );
+    TEST_ASSERT_EQUAL( eMQTTSuccess, prvReceiveMQTTConnACK() );
+
+    /* Nothing must be sent. */
+    ulSendCount = 0;
+    xReturnCode = MQTT_PublishV( &( xMQTTContext ), xPublishParams, 3 );
+    TEST_ASSERT_EQUAL( eMQTTNoFreeBuffer, xReturnCode );
+    TEST_ASSERT_EQUAL( 0, ulSendCount );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief MQTT batch publish - Not connected.
+ */
+TEST( Full_MQTT, AFQP_MQTT_PublishV_NotConnected )
+{
+    MQTTReturnCode_t xReturnCode;
+    MQTTPublishParams_t xPublishParams[ 2 ];
+
+    prvSetupBatchPublishParams( xPublishParams, 2 );
+
+    ulSendCount = 0;
+    xReturnCode = MQTT_PublishV( &( xMQTTContext ), xPublishParams, 2 );
+    TEST_ASSERT_EQUAL( eMQTTClientNotConnected, xReturnCode );
+    TEST_ASSERT_EQUAL( 0, ulSendCount );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,371 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_test_ota_window.c
+ * @brief Tests for the stream request window of the OTA agent.
+ *
+ * The download tests run the request window against a simulated stream
+ * service on a virtual clock, so the download time of an image can be
+ * measured for different window sizes without a network. Every request
+ * reaches the service after a one way latency, the service sends the
+ * requested blocks one after the other over a link which takes a fixed time
+ * per block, and each block reaches the device after the same latency.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* OTA includes. */
+#include "aws_ota_window.h"
+
+/* Unity framework includes. */
+#include "unity_fixture.h"
+
+/* Benchmark includes. */
+#include "aws_benchmark.h"
+
+/**
+ * @brief Parameters of the simulated download.
+ */
+/** @{ */
+#define testotawindowIMAGE_SIZE            ( 1024UL * 1024UL )
+#define testotawindowBLOCK_SIZE            ( 1024UL )
+#define testotawindowNUM_BLOCKS            ( testotawindowIMAGE_SIZE / testotawindowBLOCK_SIZE )
+#define testotawindowBITMAP_LEN            ( testotawindowNUM_BLOCKS / 8UL )
+#define testotawindowBLOCKS_PER_REQUEST    ( 32UL )
+#define testotawindowLATENCY_MS            ( 25UL )   /* One way latency between the device and the service. */
+#define testotawindowBLOCK_TIME_MS         ( 1UL )    /* Time the service takes to send one block. */
+#define testotawindowTIMEOUT_MS            ( 2000UL ) /* Time without any traffic after which the device requests the gaps. */
+#define testotawindowLOSS_INTERVAL         ( 97UL )   /* Every this many blocks sent, one is lost. */
+#define testotawindowMAX_BLOCKS_SENT       ( 4UL * testotawindowNUM_BLOCKS )
+/** @} */
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A block sent by the simulated service.
+ */
+typedef struct BlockInTransit
+{
+    uint32_t ulArrivalTime; /**< Virtual time at which the block reaches the device. */
+    uint16_t usBlock;       /**< Index of the block. */
+    uint8_t ucLost;         /**< The block never reaches the device. */
+} BlockInTransit_t;
+
+/**
+ * @brief Results of a simulated download.
+ */
+typedef struct DownloadResult
+{
+    uint32_t ulTimeMs;        /**< Virtual time at which the last block arrived. */
+    uint32_t ulRequests;      /**< Number of requests sent. */
+    uint32_t ulBlocksSent;    /**< Number of blocks sent by the service. */
+    uint32_t ulDuplicates;    /**< Number of blocks received more than once. */
+    uint32_t ulTimeouts;      /**< Number of times the device timed out and requested the gaps. */
+} DownloadResult_t;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Block bitmap of the image, a set bit is a block not received yet.
+ */
+static uint8_t ucBitmap[ testotawindowBITMAP_LEN ];
+
+/**
+ * @brief The blocks sent by the service in the order in which they arrive.
+ */
+static BlockInTransit_t xBlocksInTransit[ testotawindowMAX_BLOCKS_SENT ];
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Downloads the image from the simulated service.
+ *
+ * @param[in] ulWindowSize Number of requests in flight.
+ * @param[in] xLossy Lose every testotawindowLOSS_INTERVAL-th block sent.
+ * @param[out] pxResult The results of the download.
+ */
+static void prvSimulateDownload( uint32_t ulWindowSize,
+                                 BaseType_t xLossy,
+                                 DownloadResult_t * const pxResult );
+/*-----------------------------------------------------------*/
+
+static void prvSimulateDownload( uint32_t ulWindowSize,
+                                 BaseType_t xLossy,
+                                 DownloadResult_t * const pxResult )
+{
+    OTA_RequestWindow_t xWindow;
+    uint32_t ulNow = 0, ulLastActivity = 0, ulLinkFree = 0;
+    uint32_t ulHead = 0, ulTail = 0;
+    uint32_t ulBlocksRemaining = testotawindowNUM_BLOCKS;
+    uint32_t ulByteOffset, ulByteCount, ulBlock, ulSendTime;
+    BlockInTransit_t * pxBlock;
+
+    memset( ucBitmap, 0xFF, sizeof( ucBitmap ) );
+    memset( pxResult, 0x00, sizeof( DownloadResult_t ) );
+    OTA_WINDOW_Init( &xWindow, ulWindowSize, testotawindowBLOCKS_PER_REQUEST );
+
+    while( ulBlocksRemaining > 0 )
+    {
+        /* Send the requests there is room for, like the OTA agent does after
+         * each block and after each timeout. */
+        while( OTA_WINDOW_GetNextRequest( &xWindow, ucBitmap, sizeof( ucBitmap ), &ulByteOffset, &ulByteCount ) == pdTRUE )
+        {
+            pxResult->ulRequests++;
+            ulLastActivity = ulNow;
+
+            /* The service sends the blocks missing at the time of the request. */
+            for( ulBlock = ulByteOffset * 8; ulBlock < ( ulByteOffset + ulByteCount ) * 8; ulBlock++ )
+            {
+                if( ( ucBitmap[ ulBlock / 8 ] & ( 1U << ( ulBlock % 8 ) ) ) != 0 )
+                {
+                    TEST_ASSERT_TRUE( ulTail < testotawindowMAX_BLOCKS_SENT );
+
+                    ulSendTime = ulNow + testotawindowLATENCY_MS;
+
+                    if( ulSendTime > ulLinkFree )
+                    {
+                        ulLinkFree = ulSendTime;
+                    }
+
+                    ulLinkFree += testotawindowBLOCK_TIME_MS;
+                    pxBlock = &xBlocksInTransit[ ulTail++ ];
+                    pxBlock->ulArrivalTime = ulLinkFree + testotawindowLATENCY_MS;
+                    pxBlock->usBlock = ( uint16_t ) ulBlock;
+                    pxBlock->ucLost = ( uint8_t ) ( ( xLossy == pdTRUE ) && ( ( ulTail % testotawindowLOSS_INTERVAL ) == 0 ) );
+                    pxResult->ulBlocksSent++;
+                }
+            }
+        }
+
+        if( ( ulHead == ulTail ) || ( xBlocksInTransit[ ulHead ].ulArrivalTime > ( ulLastActivity + testotawindowTIMEOUT_MS ) ) )
+        {
+            /* Nothing arrives before the request timer expires. */
+            TEST_ASSERT_TRUE( pxResult->ulTimeouts < testotawindowNUM_BLOCKS );
+            ulNow = ulLastActivity + testotawindowTIMEOUT_MS;
+            ulLastActivity = ulNow;
+            pxResult->ulTimeouts++;
+            OTA_WINDOW_Reset( &xWindow );
+        }
+        else
+        {
+            pxBlock = &xBlocksInTransit[ ulHead++ ];
+            ulNow = pxBlock->ulArrivalTime;
+
+            if( pxBlock->ucLost == 0U )
+            {
+                ulLastActivity = ulNow;
+                ulBlock = pxBlock->usBlock;
+
+                if( ( ucBitmap[ ulBlock / 8 ] & ( 1U << ( ulBlock % 8 ) ) ) != 0 )
+                {
+                    ucBitmap[ ulBlock / 8 ] &= ( uint8_t ) ~( 1U << ( ulBlock % 8 ) );
+                    ulBlocksRemaining--;
+                    OTA_WINDOW_BlockReceived( &xWindow );
+                }
+                else
+                {
+                    pxResult->ulDuplicates++;
+                }
+            }
+        }
+    }
+
+    pxResult->ulTimeMs = ulNow;
+}
+/*-----------------------------------------------------------*/
+
+TEST_GROUP( Full_OTA_WINDOW );
+/*-----------------------------------------------------------*/
+
+TEST_SETUP( Full_OTA_WINDOW )
+{
+}
+/*-----------------------------------------------------------*/
+
+TEST_TEAR_DOWN( Full_OTA_WINDOW )
+{
+}
+/*-----------------------------------------------------------*/
+
+TEST_GROUP_RUNNER( Full_OTA_WINDOW )
+{
+    RUN_TEST_CASE( Full_OTA_WINDOW, GetNextRequest_FillsWindow );
+    RUN_TEST_CASE( Full_OTA_WINDOW, GetNextRequest_SkipsReceivedBlocks );
+    RUN_TEST_CASE( Full_OTA_WINDOW, Reset_RequestsOnlyGaps );
+    RUN_TEST_CASE( Full_OTA_WINDOW, Download1MB );
+    RUN_TEST_CASE( Full_OTA_WINDOW, Download1MBWithLoss );
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_OTA_WINDOW, GetNextRequest_FillsWindow )
+{
+    OTA_RequestWindow_t xWindow;
+    uint32_t ulByteOffset, ulByteCount, ulRequest, ulBlock;
+
+    memset( ucBitmap, 0xFF, sizeof( ucBitmap ) );
+    OTA_WINDOW_Init( &xWindow, 4, testotawindowBLOCKS_PER_REQUEST );
+
+    /* The window takes four consecutive ranges. */
+    for( ulRequest = 0; ulRequest < 4; ulRequest++ )
+    {
+        TEST_ASSERT_EQUAL( pdTRUE, OTA_WINDOW_GetNextRequest( &xWindow, ucBitmap, sizeof( ucBitmap ), &ulByteOffset, &ulByteCount ) );
+        TEST_ASSERT_EQUAL_UINT32( ulRequest * testotawindowBLOCKS_PER_REQUEST / 8, ulByteOffset );
+        TEST_ASSERT_EQUAL_UINT32( testotawindowBLOCKS_PER_REQUEST / 8, ulByteCount );
+    }
+
+    TEST_ASSERT_EQUAL( pdFALSE, OTA_WINDOW_GetNextRequest( &xWindow, ucBitmap, sizeof( ucBitmap ), &ulByteOffset, &ulByteCount ) );
+
+    /* Receiving one range worth of blocks makes room for the next range. */
+    for( ulBlock = 0; ulBlock < testotawindowBLOCKS_PER_REQUEST - 1; ulBlock++ )
+    {
+        OTA_WINDOW_BlockReceived( &xWindow );
+    }
+
+    TEST_ASSERT_EQUAL( pdFALSE, OTA_WINDOW_GetNextRequest( &xWindow, ucBitmap, sizeof( ucBitmap ), &ulByteOffset, &ulByteCount ) );
+    OTA_WINDOW_BlockReceived( &xWindow );
+    TEST_ASSERT_EQUAL( pdTRUE, OTA_WINDOW_GetNextRequest( &xWindow, ucBitmap, sizeof( ucBitmap ), &ulByteOffset, &ulByteCount ) );
+    TEST_ASSERT_EQUAL_UINT32( 4 * testotawindowBLOCKS_PER_REQUEST / 8, ulByteOffset );
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_OTA_WINDOW, GetNextRequest_SkipsReceivedBlocks )
+{
+    OTA_RequestWindow_t xWindow;
+    uint32_t ulByteOffset, ulByteCount;
+
+    /* Only one block in the fifth byte and the last byte are missing. */
+    memset( ucBitmap, 0x00, sizeof( ucBitmap ) );
+    ucBitmap[ 5 ] = 0x10;
+    ucBitmap[ sizeof( ucBitmap ) - 1 ] = 0xFF;
+    OTA_WINDOW_Init( &xWindow, 1, testotawindowBLOCKS_PER_REQUEST );
+
+    TEST_ASSERT_EQUAL( pdTRUE, OTA_WINDOW_GetNextRequest( &xWindow, ucBitmap, sizeof( ucBitmap ), &ulByteOffset, &ulByteCount ) );
+    TEST_ASSERT_EQUAL_UINT32( 5, ulByteOffset );
+    TEST_ASSERT_EQUAL_UINT32( testotawindowBLOCKS_PER_REQUEST / 8, ulByteCount );
+
+    /* A window of one request waits for the only missing block of the range. */
+    TEST_ASSERT_EQUAL( pdFALSE, OTA_WINDOW_GetNextRequest( &xWindow, ucBitmap, sizeof( ucBitmap ), &ulByteOffset, &ulByteCount ) );
+    ucBitmap[ 5 ] = 0x00;
+    OTA_WINDOW_BlockReceived( &xWindow );
+
+    /* The last range is cut at the end of the bitmap. */
+    TEST_ASSERT_EQUAL( pdTRUE, OTA_WINDOW_GetNextRequest( &xWindow, ucBitmap, sizeof( ucBitmap ), &ulByteOffset, &ulByteCount ) );
+    TEST_ASSERT_EQUAL_UINT32( sizeof( ucBitmap ) - 1, ulByteOffset );
+    TEST_ASSERT_EQUAL_UINT32( 1, ulByteCount );
+
+    ucBitmap[ sizeof( ucBitmap ) - 1 ] = 0x00;
+    TEST_ASSERT_EQUAL( pdFALSE, OTA_WINDOW_GetNextRequest( &xWindow, ucBitmap, sizeof( ucBitmap ), &ulByteOffset, &ulByteCount ) );
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_OTA_WINDOW, Reset_RequestsOnlyGaps )
+{
+    OTA_RequestWindow_t xWindow;
+    uint32_t ulByteOffset, ulByteCount;
+
+    memset( ucBitmap, 0xFF, sizeof( ucBitmap ) );
+    OTA_WINDOW_Init( &xWindow, 2, testotawindowBLOCKS_PER_REQUEST );
+
+    while( OTA_WINDOW_GetNextRequest( &xWindow, ucBitmap, sizeof( ucBitmap ), &ulByteOffset, &ulByteCount ) == pdTRUE )
+    {
+    }
+
+    /* Everything except a gap in the middle of the image arrived. */
+    memset( ucBitmap, 0x00, sizeof( ucBitmap ) );
+    ucBitmap[ 40 ] = 0x0F;
+    ucBitmap[ 41 ] = 0x01;
+
+    /* After a timeout the next request starts at the gap. */
+    OTA_WINDOW_Reset( &xWindow );
+    TEST_ASSERT_EQUAL( pdTRUE, OTA_WINDOW_GetNextRequest( &xWindow, ucBitmap, sizeof( ucBitmap ), &ulByteOffset, &ulByteCount ) );
+    TEST_ASSERT_EQUAL_UINT32( 40, ulByteOffset );
+    TEST_ASSERT_EQUAL_UINT32( 5, xWindow.ulBlocksInFlight );
+
+    /* The window has room for another request, but nothing else is missing. */
+    TEST_ASSERT_EQUAL( pdFALSE, OTA_WINDOW_GetNextRequest( &xWindow, ucBitmap, sizeof( ucBitmap ), &ulByteOffset, &ulByteCount ) );
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_OTA_WINDOW, Download1MB )
+{
+    static const uint32_t ulWindowSizes[] = { 1, 2, 4, 8 };
+    DownloadResult_t xResult;
+    uint32_t ulSingleRequestTime = 0;
+    char cCase[ 16 ];
+    uint32_t x;
+
+    for( x = 0; x < sizeof( ulWindowSizes ) / sizeof( ulWindowSizes[ 0 ] ); x++ )
+    {
+        prvSimulateDownload( ulWindowSizes[ x ], pdFALSE, &xResult );
+
+        /* Every block is requested exactly once. */
+        TEST_ASSERT_EQUAL_UINT32( testotawindowNUM_BLOCKS, xResult.ulBlocksSent );
+        TEST_ASSERT_EQUAL_UINT32( testotawindowNUM_BLOCKS / testotawindowBLOCKS_PER_REQUEST, xResult.ulRequests );
+        TEST_ASSERT_EQUAL_UINT32( 0, xResult.ulDuplicates );
+        TEST_ASSERT_EQUAL_UINT32( 0, xResult.ulTimeouts );
+
+        if( ulWindowSizes[ x ] == 1 )
+        {
+            ulSingleRequestTime = xResult.ulTimeMs;
+        }
+        else
+        {
+            /* Keeping several requests in flight hides the round trips. */
+            TEST_ASSERT_TRUE( xResult.ulTimeMs < ulSingleRequestTime );
+        }
+
+        snprintf( cCase, sizeof( cCase ), "Window%u", ( unsigned ) ulWindowSizes[ x ] );
+        BENCHMARK_Report( "Full_OTA_WINDOW", cCase, "download_time", xResult.ulTimeMs, "ms" );
+        BENCHMARK_Report( "Full_OTA_WINDOW", cCase, "requests", xResult.ulRequests, "count" );
+    }
+
+    /* With the default window, the link to the service never idles after
+     * the first round trip. */
+    prvSimulateDownload( 4, pdFALSE, &xResult );
+    TEST_ASSERT_EQUAL_UINT32( ( 2 * testotawindowLATENCY_MS ) + ( testotawindowNUM_BLOCKS * testotawindowBLOCK_TIME_MS ), xResult.ulTimeMs );
+}
+/*-----------------------------------------------------------*/
+
+TEST( Full_OTA_WINDOW, Download1MBWithLoss )
+{
+    DownloadResult_t xResult;
+
+    prvSimulateDownload( 4, pdTRUE, &xResult );
+
+    /* The lost blocks are requested again after a timeout, and nothing
+     * which already arrived is sent twice. */
+    TEST_ASSERT_TRUE( xResult.ulTimeouts > 0 );
+    TEST_ASSERT_EQUAL_UINT32( 0, xResult.ulDuplicates );
+    TEST_ASSERT_TRUE( xResult.ulBlocksSent > testotawindowNUM_BLOCKS );
+    TEST_ASSERT_TRUE( xResult.ulBlocksSent < ( testotawindowNUM_BLOCKS + ( testotawindowNUM_BLOCKS / 32 ) ) );
+
+    BENCHMARK_Report( "Full_OTA_WINDOW", "Window4Lossy", "download_time", xResult.ulTimeMs, "ms" );
+    BENCHMARK_Report( "Full_OTA_WINDOW", "Window4Lossy", "blocks_sent", xResult.ulBlocksSent, "count" );
+    BENCHMARK_Report( "Full_OTA_WINDOW", "Window4Lossy", "timeouts", xResult.ulTimeouts, "count" );
+}
+/*-----------------------------------------------------------*/
@@ -37,6 +37,7 @@
 #include "aws_crypto.h"
 #include "aws_clientcredential.h"
 #include "aws_pkcs11.h"
+#include "aws_pkcs11_config.h"
 #include "aws_dev_mode_key_provisioning.h"
 #include "aws_test_pkcs11_config.h"
 
@@ -74,6 +75,12 @@ typedef struct SignVerifyTaskParams
 /* Event group used to synchronize tasks. */
 static EventGroupHandle_t xSyncEventGroup;
 
+/* Write file to filesystem (see PAL), to change the stored objects behind
+ * the back of the module. */
+extern BaseType_t PKCS11_PAL_SaveFile( char * pcFileName,
+                                       uint8_t * pucData,
+                                       uint32_t ulDataSize );
+
 /*-----------------------------------------------------------*/
 /*                Certificates used in tests.                */
 /*-----------------------------------------------------------*/
@@ -924,6 +931,96 @@ static CK_RV prvSignVerifyRoundTrip( CK_MECHANISM_TYPE xMechanism,
 
 /*-----------------------------------------------------------*/
 
+/* Opens another session, and returns its private key and the key type. */
+static CK_RV prvOpenSessionWithKey( CK_FUNCTION_LIST_PTR pxFunctionList,
+                                    CK_SLOT_ID xSlotId,
+                                    CK_SESSION_HANDLE * pxSession,
+                                    CK_OBJECT_HANDLE * pxPrivateKey,
+                                    CK_ULONG * pulKeyType )
+{
+    CK_RV xResult = 0;
+    CK_OBJECT_CLASS xObjClass = CKO_PRIVATE_KEY;
+    CK_ATTRIBUTE xTemplate = { CKA_CLASS, &xObjClass, sizeof( xObjClass ) };
+    CK_ULONG ulCount = 0;
+
+    xResult = pxFunctionList->C_OpenSession( xSlotId,
+                                             CKF_SERIAL_SESSION,
+                                             NULL,
+                                             NULL,
+                                             pxSession );
+
+    if( 0 == xResult )
+    {
+        xResult = pxFunctionList->C_FindObjectsInit( *pxSession, &xTemplate, 1 );
+    }
+
+    if( 0 == xResult )
+    {
+        xResult = pxFunctionList->C_FindObjects( *pxSession, pxPrivateKey, 1, &ulCount );
+    }
+
+    if( 0 == xResult )
+    {
+        xResult = pxFunctionList->C_FindObjectsFinal( *pxSession );
+    }
+
+    if( 0 == xResult )
+    {
+        xTemplate.type = CKA_KEY_TYPE;
+        xTemplate.pValue = pulKeyType;
+        xTemplate.ulValueLen = sizeof( *pulKeyType );
+        xResult = pxFunctionList->C_GetAttributeValue( *pxSession, *pxPrivateKey, &xTemplate, 1 );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Signs a hash with the private key of a session, and verifies it. */
+static CK_RV prvSignVerifyInSession( CK_FUNCTION_LIST_PTR pxFunctionList,
+                                     CK_SESSION_HANDLE xSession,
+                                     CK_OBJECT_HANDLE xPrivateKey,
+                                     CK_MECHANISM_TYPE xMechanism )
+{
+    CK_RV xResult = 0;
+    CK_MECHANISM xMech = { xMechanism, NULL, 0 };
+    CK_BYTE pucHash[ cryptoSHA256_DIGEST_BYTES ] = { 0 };
+    CK_BYTE pucSignature[ 256 ] = { 0 };
+    CK_ULONG ulSignatureLength = sizeof( pucSignature );
+
+    memset( pucHash, 0xA5, sizeof( pucHash ) );
+
+    xResult = pxFunctionList->C_SignInit( xSession, &xMech, xPrivateKey );
+
+    if( 0 == xResult )
+    {
+        xResult = pxFunctionList->C_Sign( xSession,
+                                          pucHash,
+                                          sizeof( pucHash ),
+                                          pucSignature,
+                                          &ulSignatureLength );
+    }
+
+    if( 0 == xResult )
+    {
+        xResult = pxFunctionList->C_VerifyInit( xSession, &xMech, xPrivateKey );
+    }
+
+    if( 0 == xResult )
+    {
+        xResult = pxFunctionList->C_Verify( xSession,
+                                            pucHash,
+                                            sizeof( pucHash ),
+                                            pucSignature,
+                                            ulSignatureLength );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
 static void prvSignVerifyTask( void * pvParameters )
 {
     SignVerifyTaskParams_t * pxTaskParams;
@@ -1022,6 +1119,18 @@ TEST_GROUP_RUNNER( Full_PKCS11 )
     RUN_TEST_CASE( Full_PKCS11, AFQP_SignVerifyRoundTripWithCorrectECPublicKey );
     RUN_TEST_CASE( Full_PKCS11, AFQP_SignVerifyRoundTripWithWrongECPublicKey );
 
+    /* Multi-part sign-verify test using the ECDSA/SHA256 mechanism that hashes
+     * in the module. */
+    RUN_TEST_CASE( Full_PKCS11, AFQP_SignVerifyMultiPartEC );
+
+    /* Sign and verify calls with a session handle that is not valid. */
+    RUN_TEST_CASE( Full_PKCS11, AFQP_SignVerifyInvalidSession );
+
+    /* The objects shared by the sessions are loaded again once they change,
+     * and stay usable by the sessions that hold them. */
+    RUN_TEST_CASE( Full_PKCS11, AFQP_ObjectCacheCreateObject );
+    RUN_TEST_CASE( Full_PKCS11, AFQP_ObjectCacheDestroyObject );
+
     /* Test signature verification with output from OpenSSL. Also attempts to
      * verify an invalid signature. */
     RUN_TEST_CASE( Full_PKCS11, AFQP_SignVerifyCryptoApiInteropRSA );
@@ -2644,6 +2753,256 @@ TEST( Full_PKCS11, AFQP_SignVerifyRoundTripWithWrongECPublicKey )
 
 /*-----------------------------------------------------------*/
 
+TEST( Full_PKCS11, AFQP_SignVerifyMultiPartEC )
+{
+    CK_RV xResult = 0;
+    CK_FUNCTION_LIST_PTR pxFunctionList = NULL;
+    CK_SLOT_ID xSlotId = 0;
+    CK_SESSION_HANDLE xSession = 0;
+    CK_OBJECT_HANDLE xPrivateKey = 0;
+    CK_OBJECT_CLASS xObjClass = CKO_PRIVATE_KEY;
+    CK_ATTRIBUTE xTemplate = { CKA_CLASS, &xObjClass, sizeof( xObjClass ) };
+    CK_ULONG ulCount = 0;
+    CK_MECHANISM xMech = { CKM_ECDSA_SHA256, NULL, 0 };
+    CK_BYTE pucMessage[ 3 * cryptoSHA256_DIGEST_BYTES ] = { 0 };
+    CK_BYTE pucHash[ cryptoSHA256_DIGEST_BYTES ] = { 0 };
+    CK_BYTE pucSignature[ 256 ] = { 0 };
+    CK_ULONG ulSignatureLength = sizeof( pucSignature );
+    CK_ULONG ulOffset = 0;
+
+    /* Reprovision with test ECDSA certificate and private key. */
+    prvReprovision( pcValidECDSACertificate, pcValidECDSAPrivateKey, CKK_EC );
+
+    memset( pucMessage, 0xA5, sizeof( pucMessage ) );
+    ( void ) mbedtls_sha256_ret( pucMessage, sizeof( pucMessage ), pucHash, 0 );
+
+    xResult = prvInitializeAndStartSession(
+        &pxFunctionList,
+        &xSlotId,
+        &xSession );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+
+    /* Get the private key handle. */
+    xResult = pxFunctionList->C_FindObjectsInit( xSession, &xTemplate, 1 );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    xResult = pxFunctionList->C_FindObjects( xSession, &xPrivateKey, 1, &ulCount );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    xResult = pxFunctionList->C_FindObjectsFinal( xSession );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+
+    /* Sign the message in parts of uneven length. */
+    xResult = pxFunctionList->C_SignInit( xSession, &xMech, xPrivateKey );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+
+    for( ulOffset = 0; ulOffset < sizeof( pucMessage ); ulOffset += 7 )
+    {
+        xResult = pxFunctionList->C_SignUpdate(
+            xSession,
+            pucMessage + ulOffset,
+            ( sizeof( pucMessage ) - ulOffset < 7 ) ? sizeof( pucMessage ) - ulOffset : 7 );
+        TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    }
+
+    xResult = pxFunctionList->C_SignFinal( xSession, pucSignature, &ulSignatureLength );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+
+    /* The operation is finished; further parts are rejected. */
+    xResult = pxFunctionList->C_SignUpdate( xSession, pucMessage, sizeof( pucMessage ) );
+    TEST_ASSERT_EQUAL_INT32( CKR_OPERATION_NOT_INITIALIZED, xResult );
+
+    /* Verify in a single part. */
+    xResult = pxFunctionList->C_VerifyInit( xSession, &xMech, xPrivateKey );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    xResult = pxFunctionList->C_Verify( xSession,
+                                        pucMessage,
+                                        sizeof( pucMessage ),
+                                        pucSignature,
+                                        ulSignatureLength );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+
+    /* Verify the hash computed outside of the module. */
+    xMech.mechanism = CKM_ECDSA;
+    xResult = pxFunctionList->C_VerifyInit( xSession, &xMech, xPrivateKey );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    xResult = pxFunctionList->C_Verify( xSession,
+                                        pucHash,
+                                        sizeof( pucHash ),
+                                        pucSignature,
+                                        ulSignatureLength );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+
+    /* Verify in two parts with a changed message. */
+    pucMessage[ 0 ]++;
+    xMech.mechanism = CKM_ECDSA_SHA256;
+    xResult = pxFunctionList->C_VerifyInit( xSession, &xMech, xPrivateKey );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    xResult = pxFunctionList->C_VerifyUpdate( xSession, pucMessage, cryptoSHA256_DIGEST_BYTES );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    xResult = pxFunctionList->C_VerifyUpdate( xSession,
+                                              pucMessage + cryptoSHA256_DIGEST_BYTES,
+                                              sizeof( pucMessage ) - cryptoSHA256_DIGEST_BYTES );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    xResult = pxFunctionList->C_VerifyFinal( xSession, pucSignature, ulSignatureLength );
+    TEST_ASSERT_EQUAL_INT32( CKR_SIGNATURE_INVALID, xResult );
+
+    pxFunctionList->C_CloseSession( xSession );
+    pxFunctionList->C_Finalize( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_PKCS11, AFQP_SignVerifyInvalidSession )
+{
+    CK_RV xResult = 0;
+    CK_FUNCTION_LIST_PTR pxFunctionList = NULL;
+    CK_SLOT_ID xSlotId = 0;
+    CK_SESSION_HANDLE xSession = 0;
+    CK_MECHANISM xMech = { CKM_ECDSA_SHA256, NULL, 0 };
+    CK_BYTE pucMessage[ cryptoSHA256_DIGEST_BYTES ] = { 0 };
+    CK_BYTE pucSignature[ 256 ] = { 0 };
+    CK_ULONG ulSignatureLength = sizeof( pucSignature );
+
+    xResult = prvInitializeAndStartSession(
+        &pxFunctionList,
+        &xSlotId,
+        &xSession );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+
+    /* Each call is rejected without touching any session. */
+    xResult = pxFunctionList->C_SignInit( CK_INVALID_HANDLE, &xMech, 0 );
+    TEST_ASSERT_EQUAL_INT32( CKR_SESSION_HANDLE_INVALID, xResult );
+    xResult = pxFunctionList->C_SignUpdate( CK_INVALID_HANDLE, pucMessage, sizeof( pucMessage ) );
+    TEST_ASSERT_EQUAL_INT32( CKR_SESSION_HANDLE_INVALID, xResult );
+    xResult = pxFunctionList->C_SignFinal( CK_INVALID_HANDLE, pucSignature, &ulSignatureLength );
+    TEST_ASSERT_EQUAL_INT32( CKR_SESSION_HANDLE_INVALID, xResult );
+    xResult = pxFunctionList->C_Sign( CK_INVALID_HANDLE,
+                                      pucMessage,
+                                      sizeof( pucMessage ),
+                                      pucSignature,
+                                      &ulSignatureLength );
+    TEST_ASSERT_EQUAL_INT32( CKR_SESSION_HANDLE_INVALID, xResult );
+
+    xResult = pxFunctionList->C_VerifyInit( CK_INVALID_HANDLE, &xMech, 0 );
+    TEST_ASSERT_EQUAL_INT32( CKR_SESSION_HANDLE_INVALID, xResult );
+    xResult = pxFunctionList->C_VerifyUpdate( CK_INVALID_HANDLE, pucMessage, sizeof( pucMessage ) );
+    TEST_ASSERT_EQUAL_INT32( CKR_SESSION_HANDLE_INVALID, xResult );
+    xResult = pxFunctionList->C_VerifyFinal( CK_INVALID_HANDLE, pucSignature, ulSignatureLength );
+    TEST_ASSERT_EQUAL_INT32( CKR_SESSION_HANDLE_INVALID, xResult );
+    xResult = pxFunctionList->C_Verify( CK_INVALID_HANDLE,
+                                        pucMessage,
+                                        sizeof( pucMessage ),
+                                        pucSignature,
+                                        ulSignatureLength );
+    TEST_ASSERT_EQUAL_INT32( CKR_SESSION_HANDLE_INVALID, xResult );
+
+    pxFunctionList->C_CloseSession( xSession );
+    pxFunctionList->C_Finalize( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_PKCS11, AFQP_ObjectCacheCreateObject )
+{
+    CK_RV xResult = 0;
+    CK_FUNCTION_LIST_PTR pxFunctionList = NULL;
+    CK_SLOT_ID xSlotId = 0;
+    CK_SESSION_HANDLE xOldSession = 0;
+    CK_SESSION_HANDLE xNewSession = 0;
+    CK_OBJECT_HANDLE xOldKey = 0;
+    CK_OBJECT_HANDLE xNewKey = 0;
+    CK_ULONG ulKeyType = 0;
+    CK_ATTRIBUTE xTemplate = { CKA_KEY_TYPE, &ulKeyType, sizeof( ulKeyType ) };
+
+    prvReprovision( pcValidECDSACertificate, pcValidECDSAPrivateKey, CKK_EC );
+
+    /* Initialize the module, the sessions are opened below. */
+    xResult = prvInitializeAndStartSession( &pxFunctionList, &xSlotId, &xOldSession );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    pxFunctionList->C_CloseSession( xOldSession );
+
+    xResult = prvOpenSessionWithKey( pxFunctionList, xSlotId, &xOldSession, &xOldKey, &ulKeyType );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    TEST_ASSERT_EQUAL( CKK_EC, ulKeyType );
+
+    /* C_CreateObject stores an RSA certificate and key. */
+    prvReprovision( pcValidRSACertificate, pcValidRSAPrivateKey, CKK_RSA );
+
+    /* A new session loads them. */
+    xResult = prvOpenSessionWithKey( pxFunctionList, xSlotId, &xNewSession, &xNewKey, &ulKeyType );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    TEST_ASSERT_EQUAL( CKK_RSA, ulKeyType );
+    xResult = prvSignVerifyInSession( pxFunctionList, xNewSession, xNewKey, CKM_SHA256_RSA_PKCS );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+
+    /* The old session keeps the EC key it holds. */
+    xResult = pxFunctionList->C_GetAttributeValue( xOldSession, xOldKey, &xTemplate, 1 );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    TEST_ASSERT_EQUAL( CKK_EC, ulKeyType );
+    xResult = prvSignVerifyInSession( pxFunctionList, xOldSession, xOldKey, CKM_ECDSA );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+
+    pxFunctionList->C_CloseSession( xNewSession );
+    pxFunctionList->C_CloseSession( xOldSession );
+    pxFunctionList->C_Finalize( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_PKCS11, AFQP_ObjectCacheDestroyObject )
+{
+    CK_RV xResult = 0;
+    CK_FUNCTION_LIST_PTR pxFunctionList = NULL;
+    CK_SLOT_ID xSlotId = 0;
+    CK_SESSION_HANDLE xSessions[ 3 ] = { 0 };
+    CK_OBJECT_HANDLE xKeys[ 3 ] = { 0 };
+    CK_ULONG ulKeyType = 0;
+
+    prvReprovision( pcValidRSACertificate, pcValidRSAPrivateKey, CKK_RSA );
+
+    /* Initialize the module, the sessions are opened below. */
+    xResult = prvInitializeAndStartSession( &pxFunctionList, &xSlotId, &xSessions[ 0 ] );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    pxFunctionList->C_CloseSession( xSessions[ 0 ] );
+
+    xResult = prvOpenSessionWithKey( pxFunctionList, xSlotId, &xSessions[ 0 ], &xKeys[ 0 ], &ulKeyType );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    TEST_ASSERT_EQUAL( CKK_RSA, ulKeyType );
+
+    /* Store an EC certificate and key without the module knowing. The
+     * sessions keep using the objects already loaded. */
+    TEST_ASSERT_TRUE( PKCS11_PAL_SaveFile( pkcs11configFILE_NAME_CLIENT_CERTIFICATE,
+                                           ( uint8_t * ) pcValidECDSACertificate,
+                                           sizeof( pcValidECDSACertificate ) ) );
+    TEST_ASSERT_TRUE( PKCS11_PAL_SaveFile( pkcs11configFILE_NAME_KEY,
+                                           ( uint8_t * ) pcValidECDSAPrivateKey,
+                                           sizeof( pcValidECDSAPrivateKey ) ) );
+
+    xResult = prvOpenSessionWithKey( pxFunctionList, xSlotId, &xSessions[ 1 ], &xKeys[ 1 ], &ulKeyType );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    TEST_ASSERT_EQUAL( CKK_RSA, ulKeyType );
+
+    /* Once the key is destroyed, a new session loads the stored objects. */
+    xResult = pxFunctionList->C_DestroyObject( xSessions[ 1 ], xKeys[ 1 ] );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+
+    xResult = prvOpenSessionWithKey( pxFunctionList, xSlotId, &xSessions[ 2 ], &xKeys[ 2 ], &ulKeyType );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    TEST_ASSERT_EQUAL( CKK_EC, ulKeyType );
+    xResult = prvSignVerifyInSession( pxFunctionList, xSessions[ 2 ], xKeys[ 2 ], CKM_ECDSA );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+
+    /* The first session still signs with the RSA key it holds. */
+    xResult = prvSignVerifyInSession( pxFunctionList, xSessions[ 0 ], xKeys[ 0 ], CKM_SHA256_RSA_PKCS );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+
+    pxFunctionList->C_CloseSession( xSessions[ 2 ] );
+    pxFunctionList->C_CloseSession( xSessions[ 1 ] );
+    pxFunctionList->C_CloseSession( xSessions[ 0 ] );
+    pxFunctionList->C_Finalize( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
 TEST( Full_PKCS11, AFQP_SignVerifyCryptoApiInteropRSA )
 {
     CK_RV xResult = 0;
@@ -111,6 +111,10 @@ static void RunTests( void )
         RUN_TEST_GROUP( Full_Shadow );
     #endif
 
+    #if ( testrunnerFULL_BUFFERPOOL_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_BUFFERPOOL );
+    #endif
+
     #if ( testrunnerFULL_MQTT_ENABLED == 1 )
         RUN_TEST_GROUP( Full_MQTT );
     #endif
@@ -139,6 +143,18 @@ static void RunTests( void )
         RUN_TEST_GROUP( Full_OTA_PAL );
     #endif
 
+    #if ( testrunnerFULL_OTA_WINDOW_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_OTA_WINDOW );
+    #endif
+
+    #if ( testrunnerFULL_KERNEL_TIMERS_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_KERNEL_TIMERS );
+    #endif
+
+    #if ( testrunnerFULL_HEAP_6_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_HEAP_6 );
+    #endif
+
     #if ( testrunnerFULL_PKCS11_ENABLED == 1 )
         RUN_TEST_GROUP( Full_PKCS11 );
     #endif
@@ -147,6 +163,10 @@ static void RunTests( void )
         RUN_TEST_GROUP( Full_CRYPTO );
     #endif
 
+    #if ( testrunnerFULL_HEAP_TRACE_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_HEAP_TRACE );
+    #endif
+
     #if ( testrunnerFULL_TLS_ENABLED == 1 )
         RUN_TEST_GROUP( Full_TLS );
     #endif
@@ -159,6 +179,22 @@ static void RunTests( void )
         RUN_TEST_GROUP( Full_DEFENDER );
     #endif
 
+    #if ( testrunnerFULL_KERNEL_BENCHMARK_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_KERNEL_BENCHMARK );
+    #endif
+
+    #if ( testrunnerFULL_MQTT_BENCHMARK_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_MQTT_BENCHMARK );
+    #endif
+
+    #if ( testrunnerFULL_TLS_BENCHMARK_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_TLS_BENCHMARK );
+    #endif
+
+    #if ( testrunnerFULL_CRYPTO_BENCHMARK_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_CRYPTO_BENCHMARK );
+    #endif
+
     #if ( testrunnerFULL_POSIX_ENABLED == 1 )
         RUN_TEST_GROUP( Full_POSIX_CLOCK );
         RUN_TEST_GROUP( Full_POSIX_MQUEUE );
@@ -208,6 +244,12 @@ void TEST_RUNNER_RunTests_task( void * pvParameters )
         exit( 0 );
     #endif
 
+    /* Hosted builds stop the scheduler so that the process can exit with the
+     * test result once every test has run. */
+    #if ( testrunnerEND_SCHEDULER_ON_COMPLETION == 1 )
+        vTaskEndScheduler();
+    #endif
+
     /* This task has finished.  FreeRTOS does not allow a task to run off the
      * end of its implementing function, so the task must be deleted. */
     vTaskDelete( NULL );
@@ -38,6 +38,7 @@
 /* Provisioning include. */
 #include "aws_dev_mode_key_provisioning.h"
 #include "aws_pkcs11.h"
+#include "aws_tls.h"
 
 
 /*
@@ -123,6 +124,7 @@ static void prvConnectWithProvisioning( ProvisioningParams_t * pxProvisioningPar
     {
         /* Provision the device with the supplied parameters. */
         vAlternateKeyProvisioning( pxProvisioningParams );
+        TLS_ReleaseCredentials();
 
         /* Create socket. */
         xSocket = SOCKETS_Socket( SOCKETS_AF_INET, SOCKETS_SOCK_STREAM, SOCKETS_IPPROTO_TCP );
@@ -174,6 +176,7 @@ static void prvConnectWithProvisioning( ProvisioningParams_t * pxProvisioningPar
      * device with default RSA certs so that subsequent tests
      * are not changed. */
     vDevModeKeyProvisioning();
+    TLS_ReleaseCredentials();
 }
 /*-----------------------------------------------------------*/
 
@@ -0,0 +1,86 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/* Standard includes. */
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* mbedTLS includes. */
+#include "mbedtls/entropy.h"
+
+/*-----------------------------------------------------------*/
+
+int mbedtls_hardware_poll( void * data,
+                           unsigned char * output,
+                           size_t len,
+                           size_t * olen )
+{
+    int lStatus = MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
+    int lFile = -1;
+    ssize_t xRead = 0;
+    size_t xTotal = 0;
+
+    /* Unferenced parameter. */
+    ( void ) data;
+
+    /*
+     * This is port-specific for the Linux simulator, so just use the
+     * kernel random device.
+     */
+    lFile = open( "/dev/urandom", O_RDONLY );
+
+    if( lFile >= 0 )
+    {
+        while( xTotal < len )
+        {
+            xRead = read( lFile, output + xTotal, len - xTotal );
+
+            if( xRead > 0 )
+            {
+                xTotal += ( size_t ) xRead;
+            }
+            else if( ( xRead < 0 ) && ( errno == EINTR ) )
+            {
+                /* Interrupted by the tick signal of the simulator. */
+                continue;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        if( xTotal == len )
+        {
+            lStatus = 0;
+            *olen = len;
+        }
+
+        ( void ) close( lFile );
+    }
+
+    return lStatus;
+}
@@ -0,0 +1,153 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file main.c
+ * @brief Entry point of the Linux simulator test runner.
+ */
+
+/* Standard includes. */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library includes. */
+#include "aws_bufferpool.h"
+
+/* Test runner includes. */
+#include "aws_test_runner.h"
+
+/* Unity includes. */
+#include "unity.h"
+
+#define mainTEST_RUNNER_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 8 )
+#define mainTEST_RUNNER_TASK_PRIORITY      ( tskIDLE_PRIORITY + 1 )
+
+/* Set by the Makefile for the heaps that take their memory from
+ * vPortDefineHeapRegions() rather than from configTOTAL_HEAP_SIZE. */
+#ifndef mainDEFINE_HEAP_REGIONS
+    #define mainDEFINE_HEAP_REGIONS    0
+#endif
+
+/*-----------------------------------------------------------*/
+
+#if ( mainDEFINE_HEAP_REGIONS == 1 )
+
+/* The heap is split into two regions so that the heap is tested across
+ * regions, as it would be on a device with internal and external RAM. Both
+ * are carved out of one array, as the regions must be listed in increasing
+ * address order and the linker does not keep separate arrays in order. */
+    #define mainHEAP_REGION_SIZE    ( configTOTAL_HEAP_SIZE / 2 )
+
+    static uint8_t ucHeapRegions[ mainHEAP_REGION_SIZE * 2 ] __attribute__( ( aligned( portBYTE_ALIGNMENT ) ) );
+
+    static const HeapRegion_t xHeapRegions[] =
+    {
+        { &( ucHeapRegions[ 0 ] ),                    mainHEAP_REGION_SIZE },
+        { &( ucHeapRegions[ mainHEAP_REGION_SIZE ] ), mainHEAP_REGION_SIZE },
+        { NULL,                                       0                    }
+    };
+#endif
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    #if ( mainDEFINE_HEAP_REGIONS == 1 )
+        vPortDefineHeapRegions( xHeapRegions );
+    #endif
+
+    /* The full system initialization also starts the MQTT agent and the
+     * sockets, which the simulator does not use. */
+    ( void ) BUFFERPOOL_Init();
+
+    xTaskCreate( TEST_RUNNER_RunTests_task,
+                 "TestRunner",
+                 mainTEST_RUNNER_TASK_STACK_SIZE,
+                 NULL,
+                 mainTEST_RUNNER_TASK_PRIORITY,
+                 NULL );
+
+    /* Only returns once the test runner calls vTaskEndScheduler(). */
+    vTaskStartScheduler();
+
+    return ( Unity.TestFailures == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingPrintf( const char * pcFormat,
+                     ... )
+{
+    va_list xArgs;
+
+    /* Prevent a context switch while the C library holds the stdout lock,
+     * otherwise another task printing would deadlock. */
+    vTaskSuspendAll();
+    {
+        va_start( xArgs, pcFormat );
+        vprintf( pcFormat, xArgs );
+        va_end( xArgs );
+        fflush( stdout );
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingPrint( const char * pcMessage )
+{
+    vLoggingPrintf( "%s", pcMessage );
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationIdleHook( void )
+{
+    /* There is nothing else for the host CPU to do until the next tick, so
+     * sleep rather than spin.  The tick signal interrupts the sleep. */
+    ( void ) usleep( 1000 );
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+    vAssertCalled( __FILE__, __LINE__ );
+}
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    uint32_t ulLine )
+{
+    taskDISABLE_INTERRUPTS();
+
+    printf( "vAssertCalled %s, %ld\n", pcFile, ( long ) ulLine );
+    fflush( stdout );
+
+    abort();
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,165 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/*-----------------------------------------------------------
+* Application specific definitions.
+*
+* These definitions should be adjusted for your particular hardware and
+* application requirements.
+*
+* THESE PARAMETERS ARE DESCRIBED WITHIN THE 'CONFIGURATION' SECTION OF THE
+* FreeRTOS API DOCUMENTATION AVAILABLE ON THE FreeRTOS.org WEB SITE.
+* http://www.freertos.org/a00110.html
+*----------------------------------------------------------*/
+#define configENABLE_BACKWARD_COMPATIBILITY        0
+#define configUSE_PREEMPTION                       1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION    1
+#define configMAX_PRIORITIES                       ( 7 )
+#define configTICK_RATE_HZ                         ( 1000 )
+#define configMINIMAL_STACK_SIZE                   ( ( unsigned short ) 60 ) /* In this simulated case, the stack only has to hold one small structure as the real stack is part of the pthread. */
+#define configTOTAL_HEAP_SIZE                      ( ( size_t ) ( 2048U * 1024U ) )
+#define configMAX_TASK_NAME_LEN                    ( 15 )
+#define configUSE_TRACE_FACILITY                   1
+#define configUSE_16_BIT_TICKS                     0
+#define configIDLE_SHOULD_YIELD                    1
+#define configUSE_CO_ROUTINES                      0
+#define configUSE_MUTEXES                          1
+#define configUSE_RECURSIVE_MUTEXES                1
+#define configQUEUE_REGISTRY_SIZE                  0
+#define configUSE_APPLICATION_TASK_TAG             1
+#define configUSE_COUNTING_SEMAPHORES              1
+#define configUSE_ALTERNATIVE_API                  0
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS    3
+#define configRECORD_STACK_HIGH_ADDRESS            1
+
+/* Hook function related definitions. */
+#define configUSE_TICK_HOOK                        0
+#define configUSE_IDLE_HOOK                        1
+#define configUSE_MALLOC_FAILED_HOOK               1
+#define configCHECK_FOR_STACK_OVERFLOW             0 /* Not applicable to the POSIX port. */
+
+/* Software timer related definitions. */
+#define configUSE_TIMERS                           1
+#define configTIMER_TASK_PRIORITY                  ( configMAX_PRIORITIES - 1 )
+#define configTIMER_QUEUE_LENGTH                   5
+#define configTIMER_TASK_STACK_DEPTH               ( configMINIMAL_STACK_SIZE * 2 )
+
+/* Event group related definitions. */
+#define configUSE_EVENT_GROUPS                     1
+
+/* Run time stats gathering definitions. */
+#define configGENERATE_RUN_TIME_STATS              0
+
+/* Co-routine definitions. */
+#define configMAX_CO_ROUTINE_PRIORITIES            ( 2 )
+
+/* All kernel objects are allocated from the FreeRTOS heap. */
+#define configSUPPORT_DYNAMIC_ALLOCATION           1
+#define configSUPPORT_STATIC_ALLOCATION            0
+
+/* Set the following definitions to 1 to include the API function, or zero
+ * to exclude the API function. */
+#define INCLUDE_vTaskPrioritySet                   1
+#define INCLUDE_uxTaskPriorityGet                  1
+#define INCLUDE_vTaskDelete                        1
+#define INCLUDE_vTaskCleanUpResources              0
+#define INCLUDE_vTaskSuspend                       1
+#define INCLUDE_vTaskDelayUntil                    1
+#define INCLUDE_vTaskDelay                         1
+#define INCLUDE_uxTaskGetStackHighWaterMark        1
+#define INCLUDE_xTaskGetSchedulerState             1
+#define INCLUDE_xTimerGetTimerTaskHandle           1
+#define INCLUDE_xTaskGetIdleTaskHandle             0
+#define INCLUDE_xQueueGetMutexHolder               1
+#define INCLUDE_eTaskGetState                      1
+#define INCLUDE_xEventGroupSetBitsFromISR          1
+#define INCLUDE_xTimerPendFunctionCall             1
+#define INCLUDE_xTaskGetCurrentTaskHandle          1
+#define INCLUDE_xTaskAbortDelay                    1
+
+#define configUSE_STATS_FORMATTING_FUNCTIONS       1
+
+/* Assert call defined for debug builds. */
+void vAssertCalled( const char * pcFile,
+                    uint32_t ulLine );
+
+#define configASSERT( x )    if( ( x ) == 0 ) vAssertCalled( __FILE__, __LINE__ )
+
+/* The function that implements FreeRTOS printf style output, and the macro
+ * that maps the configPRINTF() macros to that function. */
+void vLoggingPrintf( char const * pcFormat,
+                     ... );
+#define configPRINTF( X )    vLoggingPrintf X
+
+/* Non-format version thread-safe print. */
+extern void vLoggingPrint( const char * pcMessage );
+#define configPRINT( X )     vLoggingPrint( X )
+
+/* The platform that FreeRTOS is running on. */
+#define configPLATFORM_NAME    "LinuxSim"
+
+/* Let the benchmarks count the heap used by a task, and record the heap
+ * calls while the heap trace is started. The trace macros expand in the heap,
+ * so the return address is the caller of pvPortMalloc or vPortFree. */
+extern void BENCHMARK_TraceMalloc( void * pvAddress,
+                                   size_t xSize );
+extern void BENCHMARK_TraceFree( void * pvAddress,
+                                 size_t xSize );
+extern void HEAPTRACE_Malloc( void * pvAddress,
+                              size_t xSize,
+                              void * pvCaller );
+extern void HEAPTRACE_Free( void * pvAddress,
+                            size_t xSize,
+                            void * pvCaller );
+#define traceMALLOC( pvAddress, uiSize )                                          \
+    do {                                                                          \
+        BENCHMARK_TraceMalloc( pvAddress, uiSize );                               \
+        HEAPTRACE_Malloc( pvAddress, uiSize, __builtin_return_address( 0 ) );     \
+    } while( 0 )
+#define traceFREE( pvAddress, uiSize )                                            \
+    do {                                                                          \
+        BENCHMARK_TraceFree( pvAddress, uiSize );                                 \
+        HEAPTRACE_Free( pvAddress, uiSize, __builtin_return_address( 0 ) );       \
+    } while( 0 )
+
+/* Let the benchmarks count the context switches to a task, the messages it
+ * receives and the time it runs, e.g. for the timer service task. */
+extern void BENCHMARK_TraceTaskSwitchedIn( void );
+extern void BENCHMARK_TraceTaskSwitchedOut( void );
+extern void BENCHMARK_TraceQueueReceive( void );
+#define traceTASK_SWITCHED_IN()          BENCHMARK_TraceTaskSwitchedIn()
+#define traceTASK_SWITCHED_OUT()         BENCHMARK_TraceTaskSwitchedOut()
+#define traceQUEUE_RECEIVE( pxQueue )    BENCHMARK_TraceQueueReceive()
+
+/* Resume TLS sessions, and keep the most recent one in the PKCS#11 PAL
+ * storage, so that the TLS benchmark can compare full and abbreviated
+ * handshakes. */
+#define tlsconfigENABLE_SESSION_RESUMPTION    1
+#define tlsconfigSESSION_CACHE_USE_PAL        1
+
+#endif /* FREERTOS_CONFIG_H */
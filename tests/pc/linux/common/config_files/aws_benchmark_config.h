@@ -0,0 +1,47 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_benchmark_config.h
+ * @brief Benchmark configuration for the Linux simulator.
+ */
+
+#ifndef _AWS_BENCHMARK_CONFIG_H_
+#define _AWS_BENCHMARK_CONFIG_H_
+
+/* The POSIX port exposes the host monotonic clock. */
+#define benchmarkconfigGET_TIME_NS()    ullPortGetMonotonicTimeNs()
+
+/* The time stamp counter of x86 hosts counts cycles at the nominal frequency
+ * of the processor. */
+#if defined( __x86_64__ ) || defined( __i386__ )
+    #include <x86intrin.h>
+    #define benchmarkconfigGET_CYCLES()    __rdtsc()
+#endif
+
+/* Number of iterations timed by each latency benchmark. */
+#define benchmarkconfigITERATIONS       ( 10000 )
+
+#endif /* _AWS_BENCHMARK_CONFIG_H_ */
@@ -0,0 +1,59 @@
+/*
+ * Amazon FreeRTOS V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_bufferpool_config.h
+ * @brief Buffer Pool config options.
+ */
+
+#ifndef _AWS_BUFFER_POOL_CONFIG_H_
+#define _AWS_BUFFER_POOL_CONFIG_H_
+
+/**
+ * @brief The number of buffers in the static buffer pool.
+ */
+#define bufferpoolconfigNUM_BUFFERS    ( 8 )
+
+/**
+ * @brief The size of each buffer in the static buffer pool.
+ */
+#define bufferpoolconfigBUFFER_SIZE    ( 1024 )
+
+/**
+ * @brief The size classes of the size classed buffer pool.
+ *
+ * The largest class matches the buffers of the static buffer pool, so that
+ * the tests behave the same with either implementation.
+ */
+#define bufferpoolconfigCLASS0_BUFFER_SIZE    ( 64 )
+#define bufferpoolconfigCLASS0_NUM_BUFFERS    ( 8 )
+#define bufferpoolconfigCLASS1_BUFFER_SIZE    ( 256 )
+#define bufferpoolconfigCLASS1_NUM_BUFFERS    ( 8 )
+#define bufferpoolconfigCLASS2_BUFFER_SIZE    bufferpoolconfigBUFFER_SIZE
+#define bufferpoolconfigCLASS2_NUM_BUFFERS    bufferpoolconfigNUM_BUFFERS
+#define bufferpoolconfigCLASS3_BUFFER_SIZE    ( 4096 )
+#define bufferpoolconfigCLASS3_NUM_BUFFERS    ( 0 )
+
+#endif /* _AWS_BUFFER_POOL_CONFIG_H_ */
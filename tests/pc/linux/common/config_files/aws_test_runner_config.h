@@ -0,0 +1,66 @@
+/*
+ * Amazon FreeRTOS V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+#ifndef AWS_TEST_RUNNER_CONFIG_H
+#define AWS_TEST_RUNNER_CONFIG_H
+
+/* Uncomment this line if you want to run AFQP tests only. */
+/* #define testrunnerAFQP_ENABLED */
+
+#define testrunnerUNSUPPORTED                      0
+
+/* The Linux simulator has no network interface, so only the tests that run
+ * entirely on the host are supported. */
+#define testrunnerFULL_WIFI_ENABLED                testrunnerUNSUPPORTED
+#define testrunnerFULL_MEMORYLEAK_ENABLED          testrunnerUNSUPPORTED
+#define testrunnerFULL_GGD_ENABLED                 testrunnerUNSUPPORTED
+#define testrunnerFULL_GGD_HELPER_ENABLED          testrunnerUNSUPPORTED
+#define testrunnerFULL_MQTT_AGENT_ENABLED          testrunnerUNSUPPORTED
+#define testrunnerFULL_MQTT_ALPN_ENABLED           testrunnerUNSUPPORTED
+#define testrunnerFULL_MQTT_STRESS_TEST_ENABLED    testrunnerUNSUPPORTED
+#define testrunnerFULL_SHADOW_ENABLED              testrunnerUNSUPPORTED
+#define testrunnerFULL_TCP_ENABLED                 testrunnerUNSUPPORTED
+#define testrunnerFULL_TLS_ENABLED                 testrunnerUNSUPPORTED
+
+/* Supported tests. 0 = Disabled, 1 = Enabled */
+#define testrunnerFULL_BUFFERPOOL_ENABLED          1
+#define testrunnerFULL_CRYPTO_ENABLED              1
+#define testrunnerFULL_CRYPTO_BENCHMARK_ENABLED    1
+#define testrunnerFULL_HEAP_6_ENABLED              1
+#define testrunnerFULL_HEAP_TRACE_ENABLED          1
+#define testrunnerFULL_KERNEL_BENCHMARK_ENABLED    1
+#define testrunnerFULL_KERNEL_TIMERS_ENABLED       1
+#define testrunnerFULL_MQTT_ENABLED                1
+#define testrunnerFULL_MQTT_BENCHMARK_ENABLED      1
+#define testrunnerFULL_OTA_WINDOW_ENABLED          1
+#define testrunnerFULL_PKCS11_ENABLED              1
+#define testrunnerFULL_TLS_BENCHMARK_ENABLED       1
+
+/* Stop the scheduler once all tests have run so the process exits with the
+ * test result. */
+#define testrunnerEND_SCHEDULER_ON_COMPLETION      1
+
+#endif /* AWS_TEST_RUNNER_CONFIG_H */